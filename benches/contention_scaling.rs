@@ -0,0 +1,73 @@
+//! Detector contention scaling
+//!
+//! Measures lock throughput as the number of threads grows. Threads are paired
+//! on their own Mutex, so every pair contends and goes through the detector's
+//! slow path, but unrelated pairs never touch the same lock. Each thread also
+//! takes read locks on a private RwLock, which always reports to the detector.
+//!
+//! With detector state sharded per lock and per thread, throughput should keep
+//! growing with the thread count instead of flattening on one global mutex.
+//!
+//! Run with `cargo bench --bench contention_scaling`.
+
+use criterion::{BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use deloxide::{Mutex, RwLock};
+use std::hint::black_box;
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::{Duration, Instant};
+
+const THREAD_COUNTS: &[usize] = &[1, 2, 4, 8, 16, 32];
+const OPS_PER_THREAD: u64 = 2_000;
+
+/// Run `iters` rounds of `OPS_PER_THREAD` lock operations on `threads` threads
+fn run_contended(threads: usize, iters: u64) -> Duration {
+    let pairs: Vec<Arc<Mutex<u64>>> = (0..threads.div_ceil(2))
+        .map(|_| Arc::new(Mutex::new(0)))
+        .collect();
+    let barrier = Arc::new(Barrier::new(threads + 1));
+
+    let handles: Vec<_> = (0..threads)
+        .map(|i| {
+            let mutex = Arc::clone(&pairs[i / 2]);
+            let barrier = Arc::clone(&barrier);
+            thread::spawn(move || {
+                let rwlock = RwLock::new(0u64);
+                barrier.wait();
+                for _ in 0..iters * OPS_PER_THREAD {
+                    *mutex.lock() += 1;
+                    black_box(*rwlock.read());
+                }
+            })
+        })
+        .collect();
+
+    barrier.wait();
+    let start = Instant::now();
+    for handle in handles {
+        handle.join().unwrap();
+    }
+    start.elapsed()
+}
+
+fn bench_contention_scaling(c: &mut Criterion) {
+    deloxide::Deloxide::new()
+        .callback(|info| panic!("Unexpected deadlock: {info:?}"))
+        .start()
+        .expect("Failed to initialize detector");
+
+    let mut group = c.benchmark_group("contention_scaling");
+    group.sample_size(10);
+    for &threads in THREAD_COUNTS {
+        group.throughput(Throughput::Elements(threads as u64 * OPS_PER_THREAD * 2));
+        group.bench_with_input(
+            BenchmarkId::from_parameter(threads),
+            &threads,
+            |b, &threads| b.iter_custom(|iters| run_contended(threads, iters)),
+        );
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_contention_scaling);
+criterion_main!(benches);
@@ -0,0 +1,77 @@
+//! Lock churn with many live threads
+//!
+//! Measures create/lock/unlock/destroy cycles of short-lived locks, the
+//! pattern of per-request mutexes, while `n` other threads hold locks in the
+//! detector. Each measured batch runs `CYCLES` cycles. Destroying a lock only
+//! visits the threads recorded in its own state, so the cost per cycle should
+//! stay flat as the number of live threads grows.
+//!
+//! Run with `cargo bench --bench lock_churn`.
+
+use criterion::{BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use deloxide::__bench::Detector;
+use std::hint::black_box;
+
+const THREAD_COUNTS: &[usize] = &[10, 1000, 10_000];
+const CYCLES: u64 = 1_000_000;
+
+/// A detector in which threads `1..=n` each hold a lock of their own
+fn busy_detector(n: usize) -> Detector {
+    let detector = Detector::new();
+    for thread_id in 1..=n {
+        detector.create_mutex(thread_id, Some(thread_id));
+        black_box(detector.complete_acquire(thread_id, thread_id));
+    }
+    detector
+}
+
+fn bench_mutex_churn(c: &mut Criterion) {
+    let mut group = c.benchmark_group("lock_churn/mutex");
+    group.sample_size(10);
+    group.throughput(Throughput::Elements(CYCLES));
+    for &n in THREAD_COUNTS {
+        group.bench_with_input(BenchmarkId::from_parameter(n), &n, |b, &n| {
+            let detector = busy_detector(n);
+            let worker = n + 1;
+            let mut next_lock = n + 1;
+            b.iter(|| {
+                for _ in 0..CYCLES {
+                    let lock_id = next_lock;
+                    next_lock += 1;
+                    detector.create_mutex(lock_id, Some(worker));
+                    black_box(detector.complete_acquire(worker, lock_id));
+                    detector.release_mutex(worker, lock_id);
+                    detector.destroy_mutex(lock_id);
+                }
+            });
+        });
+    }
+    group.finish();
+}
+
+fn bench_rwlock_churn(c: &mut Criterion) {
+    let mut group = c.benchmark_group("lock_churn/rwlock");
+    group.sample_size(10);
+    group.throughput(Throughput::Elements(CYCLES));
+    for &n in THREAD_COUNTS {
+        group.bench_with_input(BenchmarkId::from_parameter(n), &n, |b, &n| {
+            let detector = busy_detector(n);
+            let worker = n + 1;
+            let mut next_lock = n + 1;
+            b.iter(|| {
+                for _ in 0..CYCLES {
+                    let lock_id = next_lock;
+                    next_lock += 1;
+                    detector.create_rwlock(lock_id, Some(worker));
+                    detector.complete_read(worker, lock_id);
+                    detector.release_read(worker, lock_id);
+                    detector.destroy_rwlock(lock_id);
+                }
+            });
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_mutex_churn, bench_rwlock_churn);
+criterion_main!(benches);
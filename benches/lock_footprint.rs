@@ -0,0 +1,109 @@
+//! Per-lock memory overhead and lock creation throughput
+//!
+//! Prints the size of a tracked Mutex next to the parking_lot and std
+//! mutexes it replaces, then measures how fast threads can create and drop
+//! uncontended locks. Lock IDs come from per-thread blocks, so creation
+//! should scale with the thread count instead of bouncing one counter
+//! between cores.
+//!
+//! Sizes on x86_64:
+//!
+//! | Type                     | default | `compact-locks` |
+//! |--------------------------|---------|-----------------|
+//! | `deloxide::Mutex<()>`    | 32      | 12              |
+//! | `deloxide::Mutex<u64>`   | 40      | 24              |
+//! | `parking_lot::Mutex<()>` | 1       | 1               |
+//! | `parking_lot::Mutex<u64>`| 16      | 16              |
+//!
+//! With `compact-locks` a lock also skips the detector entirely until it is
+//! contended, unless logging, lock classes or statistics need it earlier.
+//!
+//! Run with `cargo bench --bench lock_footprint`, and again with
+//! `--features compact-locks` to compare.
+
+use criterion::{BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use deloxide::Mutex;
+use std::hint::black_box;
+use std::mem::size_of;
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::{Duration, Instant};
+
+const THREAD_COUNTS: &[usize] = &[1, 4, 16];
+const LOCKS_PER_THREAD: u64 = 100_000;
+
+/// Print the in-memory size of tracked and untracked mutexes
+fn report_sizes() {
+    let overhead = |name: &str, tracked: usize, untracked: usize| {
+        println!(
+            "{name:<24} {tracked:>3} bytes, {:>3} more than parking_lot",
+            tracked - untracked
+        );
+    };
+    println!(
+        "lock_footprint: compact-locks {}",
+        if cfg!(feature = "compact-locks") {
+            "on"
+        } else {
+            "off"
+        }
+    );
+    overhead(
+        "deloxide::Mutex<()>",
+        size_of::<Mutex<()>>(),
+        size_of::<parking_lot::Mutex<()>>(),
+    );
+    overhead(
+        "deloxide::Mutex<u64>",
+        size_of::<Mutex<u64>>(),
+        size_of::<parking_lot::Mutex<u64>>(),
+    );
+    println!(
+        "{:<24} {:>3} bytes",
+        "std::sync::Mutex<u64>",
+        size_of::<std::sync::Mutex<u64>>()
+    );
+}
+
+/// Create, lock once and drop `iters * LOCKS_PER_THREAD` locks on each thread
+fn run_creation(threads: usize, iters: u64) -> Duration {
+    let barrier = Arc::new(Barrier::new(threads + 1));
+    let handles: Vec<_> = (0..threads)
+        .map(|_| {
+            let barrier = Arc::clone(&barrier);
+            thread::spawn(move || {
+                barrier.wait();
+                for i in 0..iters * LOCKS_PER_THREAD {
+                    let mutex = Mutex::new(i);
+                    black_box(*mutex.lock());
+                }
+            })
+        })
+        .collect();
+
+    barrier.wait();
+    let start = Instant::now();
+    for handle in handles {
+        handle.join().unwrap();
+    }
+    start.elapsed()
+}
+
+fn bench_lock_creation(c: &mut Criterion) {
+    report_sizes();
+
+    let mut group = c.benchmark_group("lock_footprint/create");
+    group.sample_size(10);
+    for &threads in THREAD_COUNTS {
+        group.throughput(Throughput::Elements(threads as u64 * LOCKS_PER_THREAD));
+        group.bench_with_input(
+            BenchmarkId::from_parameter(threads),
+            &threads,
+            |b, &threads| b.iter_custom(|iters| run_creation(threads, iters)),
+        );
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_lock_creation);
+criterion_main!(benches);
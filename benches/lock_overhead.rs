@@ -0,0 +1,233 @@
+//! Lock overhead compared to raw `parking_lot`
+//!
+//! Measures the four primitives on their hot paths, each next to the
+//! `parking_lot` type it wraps:
+//! - `Mutex::lock`, uncontended and contended by two threads
+//! - `RwLock::read` and `RwLock::write`, uncontended and contended
+//! - `Condvar` ping-pong between two threads
+//!
+//! Cargo features change the hot paths at compile time, so run the suite once
+//! per feature combination (`make bench` does all of them). Benchmark IDs
+//! carry the active features, so the results of different combinations are
+//! tracked separately.
+//!
+//! Run with `cargo bench --bench lock_overhead [--features <feature>]`.
+
+use criterion::{BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use std::hint::black_box;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::{Duration, Instant};
+
+/// Operations per thread in one round of a contended benchmark
+const OPS_PER_ROUND: u64 = 1_000;
+
+/// Name of the enabled feature combination
+fn features() -> String {
+    let enabled: Vec<&str> = [
+        (cfg!(feature = "logging-and-visualization"), "logging"),
+        (cfg!(feature = "lock-order-graph"), "lock-order-graph"),
+        (cfg!(feature = "stress-test"), "stress-test"),
+    ]
+    .into_iter()
+    .filter_map(|(on, name)| on.then_some(name))
+    .collect();
+
+    if enabled.is_empty() {
+        "default".to_string()
+    } else {
+        enabled.join("+")
+    }
+}
+
+fn start_detector() {
+    let mut config = deloxide::Deloxide::new();
+    #[cfg(feature = "logging-and-visualization")]
+    {
+        config = config.with_log(std::env::temp_dir().join("deloxide_lock_overhead.log"));
+    }
+    config = config.callback(|info| panic!("Unexpected deadlock: {info:?}"));
+    config.start().expect("Failed to initialize detector");
+}
+
+/// Run `iters` rounds of `op` on two threads at once and time until both finish
+fn run_pair<F>(iters: u64, op: F) -> Duration
+where
+    F: Fn() + Send + Sync + 'static,
+{
+    let op = Arc::new(op);
+    let barrier = Arc::new(Barrier::new(3));
+    let handles: Vec<_> = (0..2)
+        .map(|_| {
+            let op = Arc::clone(&op);
+            let barrier = Arc::clone(&barrier);
+            thread::spawn(move || {
+                barrier.wait();
+                for _ in 0..iters * OPS_PER_ROUND {
+                    op();
+                }
+            })
+        })
+        .collect();
+
+    barrier.wait();
+    let start = Instant::now();
+    for handle in handles {
+        handle.join().unwrap();
+    }
+    start.elapsed()
+}
+
+/// Bounce a token between two threads `iters * OPS_PER_ROUND` times
+///
+/// `wait` blocks until the shared turn equals its argument and then hands
+/// the turn to the other thread.
+fn run_ping_pong<F>(iters: u64, wait: F) -> Duration
+where
+    F: Fn(bool) + Send + Sync + 'static,
+{
+    let wait = Arc::new(wait);
+    let other = {
+        let wait = Arc::clone(&wait);
+        thread::spawn(move || {
+            for _ in 0..iters * OPS_PER_ROUND {
+                wait(true);
+            }
+        })
+    };
+
+    let start = Instant::now();
+    for _ in 0..iters * OPS_PER_ROUND {
+        wait(false);
+    }
+    other.join().unwrap();
+    start.elapsed()
+}
+
+fn bench_mutex(c: &mut Criterion) {
+    let features = features();
+    let mut group = c.benchmark_group("mutex_lock");
+
+    let raw = parking_lot::Mutex::new(0u64);
+    group.bench_function(
+        BenchmarkId::new("uncontended/parking_lot", &features),
+        |b| b.iter(|| *raw.lock() += 1),
+    );
+    let tracked = deloxide::Mutex::new(0u64);
+    group.bench_function(BenchmarkId::new("uncontended/deloxide", &features), |b| {
+        b.iter(|| *tracked.lock() += 1)
+    });
+
+    group.throughput(Throughput::Elements(2 * OPS_PER_ROUND));
+    group.bench_function(BenchmarkId::new("contended/parking_lot", &features), |b| {
+        b.iter_custom(|iters| {
+            let mutex = Arc::new(parking_lot::Mutex::new(0u64));
+            run_pair(iters, move || *mutex.lock() += 1)
+        })
+    });
+    group.bench_function(BenchmarkId::new("contended/deloxide", &features), |b| {
+        b.iter_custom(|iters| {
+            let mutex = Arc::new(deloxide::Mutex::new(0u64));
+            run_pair(iters, move || *mutex.lock() += 1)
+        })
+    });
+    group.finish();
+}
+
+fn bench_rwlock(c: &mut Criterion) {
+    let features = features();
+    let mut group = c.benchmark_group("rwlock");
+
+    let raw = parking_lot::RwLock::new(0u64);
+    let tracked = deloxide::RwLock::new(0u64);
+    group.bench_function(BenchmarkId::new("read/parking_lot", &features), |b| {
+        b.iter(|| black_box(*raw.read()))
+    });
+    group.bench_function(BenchmarkId::new("read/deloxide", &features), |b| {
+        b.iter(|| black_box(*tracked.read()))
+    });
+    group.bench_function(BenchmarkId::new("write/parking_lot", &features), |b| {
+        b.iter(|| *raw.write() += 1)
+    });
+    group.bench_function(BenchmarkId::new("write/deloxide", &features), |b| {
+        b.iter(|| *tracked.write() += 1)
+    });
+
+    // Two threads, each alternating between reads and writes
+    group.throughput(Throughput::Elements(2 * OPS_PER_ROUND));
+    group.bench_function(BenchmarkId::new("contended/parking_lot", &features), |b| {
+        b.iter_custom(|iters| {
+            let lock = Arc::new(parking_lot::RwLock::new(0u64));
+            let turn = AtomicBool::new(false);
+            run_pair(iters, move || {
+                if turn.fetch_xor(true, Ordering::Relaxed) {
+                    *lock.write() += 1;
+                } else {
+                    black_box(*lock.read());
+                }
+            })
+        })
+    });
+    group.bench_function(BenchmarkId::new("contended/deloxide", &features), |b| {
+        b.iter_custom(|iters| {
+            let lock = Arc::new(deloxide::RwLock::new(0u64));
+            let turn = AtomicBool::new(false);
+            run_pair(iters, move || {
+                if turn.fetch_xor(true, Ordering::Relaxed) {
+                    *lock.write() += 1;
+                } else {
+                    black_box(*lock.read());
+                }
+            })
+        })
+    });
+    group.finish();
+}
+
+fn bench_condvar(c: &mut Criterion) {
+    let features = features();
+    let mut group = c.benchmark_group("condvar_ping_pong");
+    group.sample_size(10);
+    group.throughput(Throughput::Elements(2 * OPS_PER_ROUND));
+
+    group.bench_function(BenchmarkId::new("parking_lot", &features), |b| {
+        b.iter_custom(|iters| {
+            let state = Arc::new((parking_lot::Mutex::new(false), parking_lot::Condvar::new()));
+            run_ping_pong(iters, move |mine| {
+                let (turn, condvar) = &*state;
+                let mut turn = turn.lock();
+                while *turn != mine {
+                    condvar.wait(&mut turn);
+                }
+                *turn = !mine;
+                condvar.notify_one();
+            })
+        })
+    });
+    group.bench_function(BenchmarkId::new("deloxide", &features), |b| {
+        b.iter_custom(|iters| {
+            let state = Arc::new((deloxide::Mutex::new(false), deloxide::Condvar::new()));
+            run_ping_pong(iters, move |mine| {
+                let (turn, condvar) = &*state;
+                let mut turn = turn.lock();
+                while *turn != mine {
+                    condvar.wait(&mut turn);
+                }
+                *turn = !mine;
+                condvar.notify_one();
+            })
+        })
+    });
+    group.finish();
+}
+
+fn bench_lock_overhead(c: &mut Criterion) {
+    start_detector();
+    bench_mutex(c);
+    bench_rwlock(c);
+    bench_condvar(c);
+}
+
+criterion_group!(benches, bench_lock_overhead);
+criterion_main!(benches);
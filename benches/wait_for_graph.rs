@@ -0,0 +1,66 @@
+//! Wait-for graph microbenchmarks
+//!
+//! Measures the cost of the two operations on the detector's contended path:
+//! `add_edge` (including its cycle check) and `clear_wait_edges`. Each graph
+//! is pre-populated with `n` threads arranged in waiting chains of length 8,
+//! the shape produced by threads queueing behind each other on locks.
+//!
+//! Run with `cargo bench --bench wait_for_graph`.
+
+use criterion::{BenchmarkId, Criterion, criterion_group, criterion_main};
+use deloxide::__bench::WaitForGraph;
+use std::hint::black_box;
+
+const THREAD_COUNTS: &[usize] = &[10, 100, 1000];
+const CHAIN_LEN: usize = 8;
+
+/// Build a graph of `n` threads where thread `t` waits for `t + 1` within each chain
+fn chained_graph(n: usize) -> WaitForGraph {
+    let mut graph = WaitForGraph::new();
+    for t in 1..=n {
+        graph.add_thread(t);
+        if t % CHAIN_LEN != 0 && t < n {
+            graph.add_edge(t, t + 1);
+        }
+    }
+    graph
+}
+
+fn bench_add_edge(c: &mut Criterion) {
+    let mut group = c.benchmark_group("wait_for_graph/add_edge");
+    for &n in THREAD_COUNTS {
+        group.bench_with_input(BenchmarkId::from_parameter(n), &n, |b, &n| {
+            let mut graph = chained_graph(n);
+            // Connect the tail of the first chain to the head of the last one,
+            // so the cycle check has to walk a whole chain before giving up.
+            let from = CHAIN_LEN.min(n);
+            let to = n - (n - 1) % CHAIN_LEN;
+            b.iter(|| {
+                black_box(graph.add_edge(black_box(from), black_box(to)));
+                graph.remove_edge(from, to);
+            });
+        });
+    }
+    group.finish();
+}
+
+fn bench_clear_wait_edges(c: &mut Criterion) {
+    let mut group = c.benchmark_group("wait_for_graph/clear_wait_edges");
+    for &n in THREAD_COUNTS {
+        group.bench_with_input(BenchmarkId::from_parameter(n), &n, |b, &n| {
+            let mut graph = chained_graph(n);
+            let waiter = n / 2;
+            b.iter(|| {
+                // A waiter blocked on a few readers acquires the lock
+                for holder in 1..=4 {
+                    graph.add_edge(waiter, (waiter + holder * CHAIN_LEN) % n + 1);
+                }
+                graph.clear_wait_edges(black_box(waiter));
+            });
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_add_edge, bench_clear_wait_edges);
+criterion_main!(benches);
@@ -0,0 +1,104 @@
+// FFI lock overhead benchmark
+//
+// Measures the cost of one deloxide_lock_mutex/deloxide_unlock_mutex pair
+// next to a raw pthread mutex, uncontended and with two threads contending
+// for the same lock.
+//
+// Build and run with: make bench
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "deloxide.h"
+
+#define ITERATIONS 1000000
+
+static void* g_tracked;
+static pthread_mutex_t g_raw = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t g_barrier;
+static volatile unsigned long g_counter;
+
+static void deadlock_callback(const char* json_info) {
+    fprintf(stderr, "Unexpected deadlock: %s\n", json_info);
+    exit(1);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void raw_loop(void) {
+    for (int i = 0; i < ITERATIONS; i++) {
+        pthread_mutex_lock(&g_raw);
+        g_counter++;
+        pthread_mutex_unlock(&g_raw);
+    }
+}
+
+static void tracked_loop(void) {
+    for (int i = 0; i < ITERATIONS; i++) {
+        deloxide_lock_mutex(g_tracked);
+        g_counter++;
+        deloxide_unlock_mutex(g_tracked);
+    }
+}
+
+struct worker_args {
+    void (*loop)(void);
+    uintptr_t parent;
+};
+
+static void* worker(void* arg) {
+    struct worker_args* args = arg;
+    uintptr_t tid = deloxide_get_thread_id();
+    deloxide_register_thread_spawn(tid, args->parent);
+    pthread_barrier_wait(&g_barrier);
+    args->loop();
+    deloxide_register_thread_exit(tid);
+    return NULL;
+}
+
+// Time `loop` on `threads` threads and return nanoseconds per lock/unlock pair
+static double run(void (*loop)(void), int threads) {
+    pthread_t handles[2];
+    struct worker_args args = { .loop = loop, .parent = deloxide_get_thread_id() };
+
+    pthread_barrier_init(&g_barrier, NULL, threads + 1);
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&handles[i], NULL, worker, &args);
+    }
+    pthread_barrier_wait(&g_barrier);
+    double start = now_ns();
+    for (int i = 0; i < threads; i++) {
+        pthread_join(handles[i], NULL);
+    }
+    double elapsed = now_ns() - start;
+    pthread_barrier_destroy(&g_barrier);
+    return elapsed / ((double)ITERATIONS * threads);
+}
+
+int main(void) {
+    if (deloxide_init(NULL, deadlock_callback) != 0) {
+        fprintf(stderr, "Failed to initialize deloxide\n");
+        return 1;
+    }
+    g_tracked = deloxide_create_mutex();
+
+    // Warm up both paths before measuring
+    raw_loop();
+    tracked_loop();
+
+    printf("%-24s %14s %14s %10s\n", "case", "pthread ns/op", "deloxide ns/op", "overhead");
+    for (int threads = 1; threads <= 2; threads++) {
+        double raw = run(raw_loop, threads);
+        double tracked = run(tracked_loop, threads);
+        const char* name = threads == 1 ? "uncontended" : "contended (2 threads)";
+        printf("%-24s %14.1f %14.1f %9.2fx\n", name, raw, tracked, tracked / raw);
+    }
+
+    deloxide_destroy_mutex(g_tracked);
+    return 0;
+}
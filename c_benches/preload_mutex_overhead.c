@@ -0,0 +1,99 @@
+// LD_PRELOAD shim overhead benchmark
+//
+// Plain pthread program that measures one lock/unlock pair of a pthread
+// mutex and RwLock, uncontended and with two threads contending. Run it once
+// as is and once with the preload shim to compare:
+//
+//   bin/bench/preload_mutex_overhead
+//   LD_PRELOAD=target/release/libdeloxide_preload.so bin/bench/preload_mutex_overhead
+//
+// Build and run both with: make bench
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ITERATIONS 1000000
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t g_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_barrier_t g_barrier;
+static volatile unsigned long g_counter;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void mutex_loop(void) {
+    for (int i = 0; i < ITERATIONS; i++) {
+        pthread_mutex_lock(&g_mutex);
+        g_counter++;
+        pthread_mutex_unlock(&g_mutex);
+    }
+}
+
+static void read_loop(void) {
+    for (int i = 0; i < ITERATIONS; i++) {
+        pthread_rwlock_rdlock(&g_rwlock);
+        g_counter++;
+        pthread_rwlock_unlock(&g_rwlock);
+    }
+}
+
+static void write_loop(void) {
+    for (int i = 0; i < ITERATIONS; i++) {
+        pthread_rwlock_wrlock(&g_rwlock);
+        g_counter++;
+        pthread_rwlock_unlock(&g_rwlock);
+    }
+}
+
+static void* worker(void* arg) {
+    void (*loop)(void) = (void (*)(void))arg;
+    pthread_barrier_wait(&g_barrier);
+    loop();
+    return NULL;
+}
+
+// Time `loop` on `threads` threads and return nanoseconds per lock/unlock pair
+static double run(void (*loop)(void), int threads) {
+    pthread_t handles[2];
+
+    pthread_barrier_init(&g_barrier, NULL, threads + 1);
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&handles[i], NULL, worker, (void*)loop);
+    }
+    pthread_barrier_wait(&g_barrier);
+    double start = now_ns();
+    for (int i = 0; i < threads; i++) {
+        pthread_join(handles[i], NULL);
+    }
+    double elapsed = now_ns() - start;
+    pthread_barrier_destroy(&g_barrier);
+    return elapsed / ((double)ITERATIONS * threads);
+}
+
+int main(void) {
+    static const struct {
+        const char* name;
+        void (*loop)(void);
+    } cases[] = {
+        { "mutex", mutex_loop },
+        { "rwlock read", read_loop },
+        { "rwlock write", write_loop },
+    };
+
+    printf("%s\n", getenv("LD_PRELOAD") ? "with preload shim" : "plain pthreads");
+    printf("%-16s %14s %14s\n", "case", "1 thread ns/op", "2 threads ns/op");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        // Warm up before measuring
+        cases[i].loop();
+        double single = run(cases[i].loop, 1);
+        double contended = run(cases[i].loop, 2);
+        printf("%-16s %14.1f %14.1f\n", cases[i].name, single, contended);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Compile with: gcc -Iinclude lock_mutexes_no_deadlock.c -Ltarget/release -ldeloxide -lpthread -o lock_mutexes_no_deadlock
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "deloxide.h"
+#include "test_util.h"
+
+#define N 5
+#define MEALS 20
+
+// Use shared test util globals/callback
+
+struct phil_args {
+    void* forks[N];
+    int index;
+};
+
+void* philosopher(void* arg) {
+    struct phil_args* a = arg;
+    void* forks[2] = { a->forks[a->index], a->forks[(a->index + 1) % N] };
+
+    // Both forks at once, so the left-then-right cycle never forms
+    for (int meal = 0; meal < MEALS; meal++) {
+        if (deloxide_lock_mutexes(forks, 2) != 0) {
+            fprintf(stderr, "Failed to lock both forks\n");
+            exit(1);
+        }
+        usleep(1000);  // eating
+        UNLOCK_MUTEX(forks[1]);
+        UNLOCK_MUTEX(forks[0]);
+    }
+    return NULL;
+}
+
+DEFINE_TRACKED_THREAD(philosopher)
+
+int main() {
+    deloxide_test_init();
+
+    void* forks[N];
+    for (int i = 0; i < N; i++) {
+        forks[i] = deloxide_create_mutex();
+    }
+
+    pthread_t threads[N];
+    struct phil_args args[N];
+    for (int i = 0; i < N; i++) {
+        args[i].index = i;
+        memcpy(args[i].forks, forks, sizeof(forks));
+        CREATE_TRACKED_THREAD(threads[i], philosopher, &args[i]);
+    }
+
+    for (int i = 0; i < N; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // A repeated mutex is rejected instead of self-deadlocking
+    void* twice[2] = { forks[0], forks[0] };
+    if (deloxide_lock_mutexes(twice, 2) != -2) {
+        fprintf(stderr, "Repeated mutex was not rejected\n");
+        return 1;
+    }
+
+    if (DEADLOCK_FLAG) {
+        fprintf(stderr, "False deadlock detected with deloxide_lock_mutexes!\n");
+        return 1;
+    } else {
+        printf("✔ No deadlock detected with deloxide_lock_mutexes (expected)\n");
+        return 0;
+    }
+}
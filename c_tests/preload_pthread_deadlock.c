@@ -0,0 +1,58 @@
+// Plain pthread program, no Deloxide calls: run under the preload shim with
+//   LD_PRELOAD=target/release/libdeloxide_preload.so DELOXIDE_DEADLOCK_EXIT_CODE=0 \
+//     bin/preload_pthread_deadlock
+//
+// The shim exits the process with status 0 once it reports the deadlock.
+// Without it (or if it misses the cycle) main gives up and returns 1.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+static pthread_mutex_t lock_a = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t lock_b = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t table = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_mutex_t ready_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ready_cond = PTHREAD_COND_INITIALIZER;
+static int ready = 0;
+
+struct two_args {
+    pthread_mutex_t* first;
+    pthread_mutex_t* second;
+};
+
+static void* cross_lock(void* arg) {
+    struct two_args* a = arg;
+
+    // Exercise the RwLock and condvar hooks, and line both threads up
+    pthread_rwlock_rdlock(&table);
+    pthread_rwlock_unlock(&table);
+    pthread_mutex_lock(&ready_lock);
+    ready++;
+    pthread_cond_broadcast(&ready_cond);
+    while (ready < 2) {
+        pthread_cond_wait(&ready_cond, &ready_lock);
+    }
+    pthread_mutex_unlock(&ready_lock);
+
+    pthread_mutex_lock(a->first);
+    usleep(100000);  // 100 ms
+    pthread_mutex_lock(a->second);
+    return NULL;
+}
+
+int main(void) {
+    struct two_args arg1 = { .first = &lock_a, .second = &lock_b };
+    struct two_args arg2 = { .first = &lock_b, .second = &lock_a };
+
+    pthread_rwlock_wrlock(&table);
+    pthread_rwlock_unlock(&table);
+
+    pthread_t t1, t2;
+    pthread_create(&t1, NULL, cross_lock, &arg1);
+    pthread_create(&t2, NULL, cross_lock, &arg2);
+
+    sleep(2);
+    fprintf(stderr, "No deadlock detected in preloaded pthread test\n");
+    return 1;
+}
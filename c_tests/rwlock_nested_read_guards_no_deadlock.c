@@ -0,0 +1,62 @@
+// Compile with: gcc -Iinclude rwlock_nested_read_guards_no_deadlock.c -Ltarget/release -ldeloxide -lpthread -o rwlock_nested_read_guards
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "deloxide.h"
+#include "test_util.h"
+
+// One thread holds read locks on several RwLocks at once and releases them
+// out of order. Each release must drop the guard of the right lock.
+
+static void* locks[3];
+
+void* writer(void* arg) {
+    (void)arg;
+    // Succeeds only once every read lock on locks[0] has been released
+    RWLOCK_WRITE(locks[0]);
+    RWUNLOCK_WRITE(locks[0]);
+    return NULL;
+}
+
+DEFINE_TRACKED_THREAD(writer)
+
+int main() {
+    deloxide_test_init();
+
+    for (int i = 0; i < 3; ++i) {
+        locks[i] = deloxide_create_rwlock();
+    }
+
+    RWLOCK_READ(locks[0]);
+    RWLOCK_READ(locks[1]);
+    RWLOCK_READ(locks[2]);
+
+    // Releasing a lock that is not held must not release another one
+    if (deloxide_rw_unlock_write(locks[1]) != -2) {
+        fprintf(stderr, "Unlocking a write lock that is not held should fail\n");
+        return 1;
+    }
+
+    RWUNLOCK_READ(locks[1]);
+    RWUNLOCK_READ(locks[0]);
+
+    pthread_t t;
+    CREATE_TRACKED_THREAD(t, writer, NULL);
+    pthread_join(t, NULL);
+
+    RWUNLOCK_READ(locks[2]);
+    if (deloxide_rw_unlock_read(locks[2]) != -2) {
+        fprintf(stderr, "Unlocking a read lock twice should fail\n");
+        return 1;
+    }
+
+    if (DEADLOCK_FLAG) {
+        fprintf(stderr, "False deadlock detected with nested read locks!\n");
+        return 1;
+    } else {
+        printf("✔ No deadlock detected with nested read locks (expected)\n");
+        return 0;
+    }
+}
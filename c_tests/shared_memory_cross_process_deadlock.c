@@ -0,0 +1,94 @@
+// Compile with: gcc -Iinclude shared_memory_cross_process_deadlock.c -Ltarget/release -ldeloxide -lpthread -o shared_memory_cross_process_deadlock
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "deloxide.h"
+#include "test_util.h"
+
+// Process-shared mutexes, as two worker processes would share them
+struct shared_locks {
+    pthread_mutex_t mutexes[2];
+    pthread_barrier_t both_hold_one;
+};
+
+struct worker_args {
+    struct shared_locks* locks;
+    int first;
+};
+
+// The key of each mutex is its index, which every process agrees on
+static void shared_lock(struct shared_locks* locks, int index) {
+    deloxide_shared_lock_attempt(index + 1);
+    pthread_mutex_lock(&locks->mutexes[index]);
+    deloxide_shared_lock_acquired(index + 1);
+}
+
+void* worker(void* arg) {
+    struct worker_args* a = arg;
+    shared_lock(a->locks, a->first);
+    pthread_barrier_wait(&a->locks->both_hold_one);
+    shared_lock(a->locks, 1 - a->first);
+    return NULL;
+}
+
+// Lock one mutex and then the other, which the other process holds
+static int run(const char* region, struct shared_locks* locks, int first) {
+    deloxide_test_init();
+    if (deloxide_attach_shared_memory(region) != 0) {
+        fprintf(stderr, "Failed to attach %s\n", region);
+        return 1;
+    }
+
+    pthread_t thread;
+    struct worker_args args = { locks, first };
+    pthread_create(&thread, NULL, worker, &args);
+    return wait_for_deadlock_ms(DEADLOCK_TIMEOUT_MS, 10) ? 0 : 1;
+}
+
+int main() {
+    char region[64];
+    snprintf(region, sizeof(region), "/tmp/deloxide_shared_%d.region", (int)getpid());
+
+    struct shared_locks* locks = mmap(NULL, sizeof(*locks), PROT_READ | PROT_WRITE,
+                                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (locks == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&locks->mutexes[0], &mutex_attr);
+    pthread_mutex_init(&locks->mutexes[1], &mutex_attr);
+    pthread_barrierattr_t barrier_attr;
+    pthread_barrierattr_init(&barrier_attr);
+    pthread_barrierattr_setpshared(&barrier_attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&locks->both_hold_one, &barrier_attr, 2);
+
+    // Fork before initializing Deloxide, whose threads would not survive it
+    pid_t child = fork();
+    if (child == 0) {
+        _exit(run(region, locks, 1));
+    }
+
+    int failed = run(region, locks, 0);
+    int status = 0;
+    waitpid(child, &status, 0);
+    unlink(region);
+
+    if (failed) {
+        fprintf(stderr, "No deadlock detected across processes\n");
+        return 1;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "The other process did not detect the deadlock\n");
+        return 1;
+    }
+    printf("Deadlock detected across processes!\n%s\n", DEADLOCK_INFO);
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Deadlock between caller-allocated locks: one statically initialized, one
+// embedded in a struct. Neither is created with deloxide_create_mutex.
+// Compile with: gcc -Iinclude static_lock_deadlock.c -Ltarget/release -ldeloxide -lpthread -o static_lock_deadlock
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "deloxide.h"
+#include "test_util.h"
+
+static deloxide_mutex_t global_lock = DELOXIDE_MUTEX_INITIALIZER;
+static deloxide_rwlock_t config_lock = DELOXIDE_RWLOCK_INITIALIZER;
+
+struct account {
+    deloxide_mutex_t lock;
+    deloxide_cond_t changed;
+    long balance;
+};
+
+static struct account acc;
+
+// Locks global_lock, then the embedded account lock
+void* global_then_account(void* unused) {
+    (void)unused;
+    LOCK_MUTEX(&global_lock);
+    usleep(100000);  // 100 ms
+    LOCK_MUTEX(&acc.lock);
+    return NULL;
+}
+
+// Locks the embedded account lock, then global_lock
+void* account_then_global(void* unused) {
+    (void)unused;
+    LOCK_MUTEX(&acc.lock);
+    usleep(100000);  // 100 ms
+    LOCK_MUTEX(&global_lock);
+    return NULL;
+}
+
+DEFINE_TRACKED_THREAD(global_then_account)
+DEFINE_TRACKED_THREAD(account_then_global)
+
+int main() {
+    deloxide_test_init();
+
+    if (deloxide_mutex_init(&acc.lock) != 0 || deloxide_cond_init(&acc.changed) != 0) {
+        fprintf(stderr, "Failed to initialize embedded locks\n");
+        return 1;
+    }
+
+    // The embedded and static locks work like heap ones before the deadlock
+    RWLOCK_WRITE(&config_lock);
+    RWUNLOCK_WRITE(&config_lock);
+    RWLOCK_READ(&config_lock);
+    RWUNLOCK_READ(&config_lock);
+    LOCK_MUTEX(&acc.lock);
+    acc.balance = 100;
+    CONDVAR_NOTIFY_ALL(&acc.changed);
+    if (deloxide_condvar_wait_timeout(&acc.changed, &acc.lock, 10) != 1) {
+        fprintf(stderr, "Expected the condvar wait to time out\n");
+        return 1;
+    }
+    UNLOCK_MUTEX(&acc.lock);
+    if (deloxide_get_mutex_creator(&acc.lock) != deloxide_get_thread_id()) {
+        fprintf(stderr, "First user of the embedded mutex is not its creator\n");
+        return 1;
+    }
+
+    // Destroying and re-initializing gives a fresh mutex
+    deloxide_mutex_destroy(&acc.lock);
+    deloxide_mutex_init(&acc.lock);
+
+    pthread_t t1, t2;
+    CREATE_TRACKED_THREAD(t1, global_then_account, NULL);
+    CREATE_TRACKED_THREAD(t2, account_then_global, NULL);
+
+    // Wait up to 2 s
+    wait_for_deadlock_ms(2000, 100);
+
+    if (DEADLOCK_FLAG) {
+        printf("Deadlock detected (static locks)!\n%s\n", DEADLOCK_INFO);
+        return 0;
+    } else {
+        fprintf(stderr, "No deadlock detected between static locks\n");
+        return 1;
+    }
+}
@@ -0,0 +1,85 @@
+// Compile with: gcc -Iinclude trylock_backoff_no_deadlock.c -Ltarget/release -ldeloxide -lpthread -o trylock_backoff_no_deadlock
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "deloxide.h"
+#include "test_util.h"
+
+#define ROUNDS 200
+
+// Use shared test util globals/callback
+
+struct backoff_args {
+    void* first;
+    void* second;
+    int timed;
+};
+
+// Take the locks in opposite orders, backing off instead of blocking on the
+// second one, so the threads never deadlock
+void* worker(void* arg) {
+    struct backoff_args* a = arg;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (;;) {
+            LOCK_MUTEX(a->first);
+            int result = a->timed ? deloxide_lock_mutex_timeout(a->second, 1)
+                                  : deloxide_try_lock_mutex(a->second);
+            if (result == 0) {
+                break;
+            }
+            if (result != 1) {
+                fprintf(stderr, "Unexpected result %d\n", result);
+                exit(1);
+            }
+            UNLOCK_MUTEX(a->first);
+            usleep(100);
+        }
+        UNLOCK_MUTEX(a->second);
+        UNLOCK_MUTEX(a->first);
+    }
+    return NULL;
+}
+
+DEFINE_TRACKED_THREAD(worker)
+
+int main() {
+    deloxide_test_init();
+
+    void* a = deloxide_create_mutex();
+    void* b = deloxide_create_mutex();
+
+    pthread_t threads[2];
+    struct backoff_args args[2] = {
+        { a, b, 0 },
+        { b, a, 1 },
+    };
+    for (int i = 0; i < 2; i++) {
+        CREATE_TRACKED_THREAD(threads[i], worker, &args[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // The same for RwLocks
+    void* rwlock = deloxide_create_rwlock();
+    RWLOCK_WRITE(rwlock);
+    int busy = deloxide_rw_try_write(rwlock) == 1;
+    RWUNLOCK_WRITE(rwlock);
+    if (!busy || deloxide_rw_try_read(rwlock) != 0 || deloxide_rw_try_read(rwlock) != 0) {
+        fprintf(stderr, "Unexpected RwLock trylock result\n");
+        return 1;
+    }
+    RWUNLOCK_READ(rwlock);
+    RWUNLOCK_READ(rwlock);
+
+    if (DEADLOCK_FLAG) {
+        fprintf(stderr, "False deadlock detected with trylock back-off!\n");
+        return 1;
+    } else {
+        printf("✔ No deadlock detected with trylock back-off (expected)\n");
+        return 0;
+    }
+}
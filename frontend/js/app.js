@@ -961,6 +961,101 @@ function checkForSharedScenario() {
   }
 }
 
+/**
+ * Load logs streamed by `deloxide serve`
+ *
+ * The server answers each request with the next chunk of the log (a gzipped
+ * MessagePack [events, deadlock] pair, like the `logs` parameter) and the
+ * cursor to continue from. The visualization is drawn as soon as the first
+ * chunk arrives and then follows the log as it grows.
+ */
+function loadStreamedLogs(streamUrl) {
+  const STREAM_RENDER_INTERVAL_MS = 1000
+  const STREAM_POLL_INTERVAL_MS = 500
+
+  let cursor = ""
+  let events = []
+  let deadlock = null
+  let rendered = false
+  let lastRender = 0
+  let dirty = false
+
+  document.getElementById("loading").style.display = "block"
+  document.getElementById("loading").innerHTML =
+    '<div class="spinner"></div><p>Waiting for the log...</p>'
+
+  function render() {
+    if (events.length === 0) return
+    const processed = transformRawObject([events, deadlock])
+    const following = !rendered || currentStep >= logData.length
+
+    currentScenario = processed
+    logData = processed.logs
+    graphStateData = processed.graph_state
+    lastRender = Date.now()
+    dirty = false
+
+    if (!rendered) {
+      rendered = true
+      resetVisualization()
+      currentStep = 1
+      initVisualization()
+      showVisualizationElements()
+      initTimeline()
+      updateVisualization()
+      console.log("Streamed visualization loaded")
+      return
+    }
+
+    initTimeline()
+    // Stay on the step being looked at, unless it was the last one
+    if (following && !isPlaying) {
+      currentStep = logData.length
+    }
+    updateVisualization()
+  }
+
+  async function poll() {
+    let pending = false
+    try {
+      const response = await fetch(`${streamUrl}?cursor=${encodeURIComponent(cursor)}`, { cache: "no-store" })
+      if (!response.ok) {
+        throw new Error(`${response.status} ${await response.text()}`)
+      }
+      if (response.headers.get("X-Deloxide-Reset") === "1") {
+        console.log("Log was rewritten, starting over")
+        events = []
+        deadlock = null
+      }
+      cursor = response.headers.get("X-Deloxide-Cursor") || ""
+      pending = response.headers.get("X-Deloxide-Pending") === "1"
+
+      const chunk = msgpack.decode(pako.ungzip(new Uint8Array(await response.arrayBuffer())))
+      if (chunk[0].length > 0 || chunk[1]) {
+        events = events.concat(chunk[0])
+        deadlock = chunk[1] || deadlock
+        dirty = true
+      }
+      if (dirty && (!rendered || Date.now() - lastRender >= STREAM_RENDER_INTERVAL_MS || !pending)) {
+        render()
+      }
+    } catch (error) {
+      console.error("Error streaming logs:", error)
+      if (!rendered) {
+        document.getElementById("loading").innerHTML = `
+                <div class="error-message">
+                    <i class="fas fa-exclamation-triangle"></i> 
+                    Error streaming logs: ${error.message}
+                </div>`
+      }
+    }
+    // Catch up without waiting while the server has more, then follow the file
+    setTimeout(poll, pending ? 0 : STREAM_POLL_INTERVAL_MS)
+  }
+
+  poll()
+}
+
 // Helper function to validate deadlock log structure
 function validateDeadlockLog(json) {
   // Standard format check
@@ -1207,7 +1302,8 @@ function initVisualization() {
     .on("tick", ticked)
 
   // Fixed initial positions for better visual consistency during reset
-  if (graphStateData && graphStateData.length > 0 && graphStateData[0].nodes) {
+  // (only for precomputed states; computed ones all start from an empty graph)
+  if (Array.isArray(graphStateData) && graphStateData.length > 0 && graphStateData[0].nodes) {
     const initialState = graphStateData[0]
 
     // Create a map of node positions
@@ -1239,6 +1335,32 @@ function initVisualization() {
   updateVisualization()
 }
 
+// Spawn entries of the current logs, looked up for every node on every step
+let spawnInfoCache = null
+
+/**
+ * Main thread and spawn log entries by thread and resource id
+ *
+ * Computed once per log instead of scanning the whole log for every node,
+ * which made each step cost as much as the log is long.
+ */
+function getSpawnInfo() {
+  if (!spawnInfoCache || spawnInfoCache.logs !== logData) {
+    const info = { logs: logData, mainThreadId: null, threads: new Map(), resources: new Map() }
+    logData.forEach((entry) => {
+      if (entry.type !== "spawn") return
+      // The first spawned entity with a parent_id that's not 0 gives the main thread
+      if (!info.mainThreadId && entry.parent_id !== 0) {
+        info.mainThreadId = entry.parent_id
+      }
+      if (!info.threads.has(entry.thread_id)) info.threads.set(entry.thread_id, entry)
+      if (!info.resources.has(entry.resource_id)) info.resources.set(entry.resource_id, entry)
+    })
+    spawnInfoCache = info
+  }
+  return spawnInfoCache
+}
+
 /**
  * Update the visualization based on current step
  */
@@ -1258,7 +1380,7 @@ function updateVisualization() {
   document.getElementById("next-btn").disabled = currentStep >= logData.length
 
   // Get current graph state
-  const currentState = graphStateData[currentStep - 1]
+  const currentState = graphStateData.at(currentStep - 1)
   
   // Get current log entry
   const logEntry = logData[currentStep - 1]
@@ -1270,7 +1392,7 @@ function updateVisualization() {
     
     // If there's a next state specifically for the deadlock, use that instead
     if (currentStep < graphStateData.length) {
-      const nextState = graphStateData[currentStep];
+      const nextState = graphStateData.at(currentStep);
       // Check if the next state has deadlock links
       const hasDeadlockLinks = nextState.links.some(link => link.type === "deadlock");
       if (hasDeadlockLinks) {
@@ -1367,15 +1489,7 @@ function updateVisualization() {
       }
       
       // Identify main thread
-      let mainThreadId = null;
-      // Find the first thread with parent_id that's not 0 (the main thread)
-      for (let i = 0; i < logData.length; i++) {
-        const log = logData[i];
-        if (log.type === "spawn" && log.parent_id !== 0 && !mainThreadId) {
-          mainThreadId = log.parent_id;
-          break;
-        }
-      }
+      const { mainThreadId, threads } = getSpawnInfo();
       
       // Mark this node as main thread if it matches
       if (threadId === mainThreadId) {
@@ -1384,9 +1498,7 @@ function updateVisualization() {
       }
       
       // Add parent_id information from log data if available
-      const threadLogEntry = logData.find(entry => 
-        entry.thread_id === threadId && entry.type === "spawn"
-      );
+      const threadLogEntry = threads.get(threadId);
       
       if (threadLogEntry && threadLogEntry.parent_id) {
         node.parent_id = threadLogEntry.parent_id;
@@ -1401,19 +1513,10 @@ function updateVisualization() {
       const resourceId = node.id.substring(1); // Remove the 'R' prefix
       
       // Find main thread ID
-      let mainThreadId = null;
-      for (let i = 0; i < logData.length; i++) {
-        const log = logData[i];
-        if (log.type === "spawn" && log.parent_id !== 0 && !mainThreadId) {
-          mainThreadId = log.parent_id;
-          break;
-        }
-      }
+      const { mainThreadId, resources } = getSpawnInfo();
       
       // Add parent_id for resources if available
-      const resourceLogEntry = logData.find(entry => 
-        entry.resource_id === resourceId && entry.type === "spawn"
-      );
+      const resourceLogEntry = resources.get(resourceId);
       
       if (resourceLogEntry && resourceLogEntry.parent_id) {
         node.parent_id = resourceLogEntry.parent_id;
@@ -2619,6 +2722,7 @@ function initApp() {
   // Check for shared data in URL first
   const urlParams = new URLSearchParams(window.location.search)
   const hasSharedData = urlParams.has("data") || urlParams.has("logs") || urlParams.has("log")
+  const streamUrl = urlParams.get("stream")
 
   // Initialize theme
   initTheme()
@@ -2643,7 +2747,10 @@ function initApp() {
   // Set initial animation speed
   updateAnimationSpeedDisplay()
 
-  if (hasSharedData) {
+  if (streamUrl) {
+    // Follow the log streamed by `deloxide serve`
+    loadStreamedLogs(streamUrl)
+  } else if (hasSharedData) {
     // Process shared data
     checkForSharedScenario()
   } else if (!isFileUploaded) {
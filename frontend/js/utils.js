@@ -41,6 +41,50 @@ function isExitEvent(eventType) {
   return eventType.includes("exit") || eventType === "exit";
 }
 
+// Event type mapping with unique codes for each event type
+// (the codes of `Events::code` in src/core/types.rs)
+const EVENT_TYPES = {
+  // Thread lifecycle
+  0: "thread_spawn",
+  1: "thread_exit",
+
+  // Mutex lifecycle 
+  2: "mutex_spawn",
+  3: "mutex_exit",
+
+  // RwLock lifecycle
+  4: "rwlock_spawn",
+  5: "rwlock_exit",
+
+  // Condvar lifecycle
+  6: "condvar_spawn",
+  7: "condvar_exit",
+
+  // Mutex interactions
+  10: "mutex_attempt",
+  11: "mutex_acquired",
+  12: "mutex_released",
+
+  // RwLock interactions
+  20: "rwlock_read_attempt",
+  21: "rwlock_read_acquired",
+  22: "rwlock_read_released",
+  23: "rwlock_write_attempt",
+  24: "rwlock_write_acquired",
+  25: "rwlock_write_released",
+
+  // Condvar interactions
+  30: "condvar_wait_begin",
+  31: "condvar_wait_end",
+  32: "condvar_notify_one",
+  33: "condvar_notify_all",
+
+  // Legacy generic events for backward compatibility
+  40: "attempt",
+  41: "acquired",
+  42: "released"
+};
+
 /**
  * Convert raw lock number to string representation
  * Returns the original lock number as a string
@@ -96,48 +140,6 @@ function transformLogs(rawLogs, resourceMapping) {
 
   logs.push(initLog);
 
-  // Event type mapping with unique codes for each event type
-  const eventTypes = {
-    // Thread lifecycle
-    0: "thread_spawn",
-    1: "thread_exit",
-
-    // Mutex lifecycle 
-    2: "mutex_spawn",
-    3: "mutex_exit",
-
-    // RwLock lifecycle
-    4: "rwlock_spawn",
-    5: "rwlock_exit",
-
-    // Condvar lifecycle
-    6: "condvar_spawn",
-    7: "condvar_exit",
-
-    // Mutex interactions
-    10: "mutex_attempt",
-    11: "mutex_acquired",
-    12: "mutex_released",
-
-    // RwLock interactions
-    20: "rwlock_read_attempt",
-    21: "rwlock_read_acquired",
-    22: "rwlock_read_released",
-    23: "rwlock_write_attempt",
-    24: "rwlock_write_acquired",
-    25: "rwlock_write_released",
-
-    // Condvar interactions
-    30: "condvar_wait_begin",
-    31: "condvar_wait_end",
-    32: "condvar_notify_one",
-    33: "condvar_notify_all",
-
-    // Legacy generic events for backward compatibility
-    40: "attempt",
-    41: "acquired",
-    42: "released"
-  };
 
   // Keep track of resource ownership and waiting threads for deadlock detection
   const resourceOwners = {}; // Maps resource_id to thread_id that owns it
@@ -160,7 +162,7 @@ function transformLogs(rawLogs, resourceMapping) {
       threadMapping[rawThread] = nextThreadIdx++;
     }
 
-    const type = eventTypes[eventCode] || "unknown";
+    const type = EVENT_TYPES[eventCode] || "unknown";
 
     // Skip unknown event types
     if (type === "unknown") continue;
@@ -501,322 +503,297 @@ function detectDeadlockCycle(resourceOwners, threadWaiting) {
 }
 
 /**
- * Generate graph state from logs' cumulative effect
+ * Number of events between two graph keyframes
  *
- * @param {Array} logs - Log array created by transformLogs
- * @param {Object} graphThreadMapping - { raw_thread_id: incrementalNum } e.g. {6164146352: 1, 6166292656: 2}
- * @param {Object} resourceMapping - { raw_lock: letter } e.g. {1:"A", 2:"B"}
+ * Must match `KEYFRAME_INTERVAL` in `src/showcase/encoder.rs`. Seeking to a
+ * step replays at most this many events from the nearest keyframe.
+ */
+const KEYFRAME_INTERVAL = 1000;
+
+/**
+ * Graph states of a log, computed on demand
  *
- * In graph state:
- * - Thread node ids are "T" + thread_id (e.g. "T123")
- * - Resource nodes are "R" + resource_id (e.g. "R1")
+ * Keeping a full copy of the graph for every step takes memory and time
+ * proportional to the log length times the graph size, which does not work
+ * for long logs. Instead only a snapshot of the graph (active nodes and
+ * links) is kept every KEYFRAME_INTERVAL steps; `at(index)` starts from the
+ * nearest snapshot, or from the last state asked for when that is closer,
+ * and replays the events in between.
+ *
+ * Supports `length` and `at(index)` like the plain arrays of states found in
+ * uploaded scenarios, so both can be used interchangeably.
  */
-function generateGraphStateFromLogs(logs, graphThreadMapping, resourceMapping) {
-  // Initialize empty collections for active nodes and links
-  const activeThreads = new Set();
-  const activeResources = new Set();
-  const graphStates = [];
-
-  // Create mappings to track nodes and links
-  const threadNodes = Object.keys(graphThreadMapping).map(threadId => ({
-    id: `T${threadId}`,
-    name: `Thread ${threadId}`,
-    type: "thread",
-  }));
-
-  const resourceNodes = Object.keys(resourceMapping).map((lockNum) => {
-    return {
-      id: `R${lockNum}`,
-      name: `Resource ${resourceMapping[lockNum]}`,
-      type: "resource",
-      lock_type: "mutex", // default, will be updated when resource is created
-    };
-  });
+class GraphStates {
+  /**
+   * @param {Array} logs - Log array created by transformLogs
+   * @param {Object} nodesMap - Node objects by id, shared by all states
+   * @param {Array} keyframes - Keyframes from the encoder, if any
+   */
+  constructor(logs, nodesMap, keyframes) {
+    this.logs = logs;
+    this.nodesMap = nodesMap;
+    this.keyframes = [{ index: 0, nodes: new Map(), links: new Map() }];
+    this.cursor = null;
+
+    // The terminal deadlock gets an extra state with the cycle drawn in
+    this.deadlockLog = logs.length > 1 && logs[logs.length - 1].type === "deadlock" &&
+      logs[logs.length - 1].cycle && logs[logs.length - 1].cycle.length >= 2
+      ? logs[logs.length - 1]
+      : null;
+    this.length = logs.length + (this.deadlockLog ? 1 : 0);
+
+    if (Array.isArray(keyframes) && keyframes.length > 0 && this.useKeyframes(keyframes)) {
+      return;
+    }
 
-  // Map of all possible nodes by id
-  const nodesMap = {};
-  threadNodes.forEach(node => {
-    nodesMap[node.id] = node;
-  });
-  resourceNodes.forEach(node => {
-    nodesMap[node.id] = node;
-  });
+    // No usable keyframes from the encoder: take them in a single pass
+    const nodes = new Map();
+    const links = new Map();
+    for (let index = 1; index < logs.length; index++) {
+      this.apply(logs[index], nodes, links);
+      if (index % KEYFRAME_INTERVAL === 0) {
+        this.keyframes.push({ index, nodes: new Map(nodes), links: new Map(links) });
+      }
+    }
+  }
 
-  // First state: empty graph with no nodes or links
-  graphStates.push({
-    step: 1,
-    nodes: [],
-    links: []
-  });
+  /**
+   * Adopt the keyframes of the encoder
+   *
+   * An encoder keyframe `[events, threads, resources, links]` describes the
+   * graph after the first `events` raw events, which is the state of the log
+   * of step `events + 1`. Keyframes whose step is missing from the logs
+   * (skipped or cut off events) are dropped.
+   */
+  useKeyframes(keyframes) {
+    // Resource types normally come from replaying their spawn events
+    for (let index = 1; index < this.logs.length; index++) {
+      const log = this.logs[index];
+      if (isSpawnEvent(log.type) && log.type !== "thread_spawn" && log.resource_id) {
+        const node = this.nodesMap[`R${log.resource_id}`];
+        if (node) {
+          node.lock_type = log.lock_type || "mutex";
+          node.name = `${lockTypeLabel(node.lock_type)} ${log.resource_id}`;
+        }
+      }
+    }
 
-  // Cumulative link state: key format is "T{thread_id}-R{resource_id}"
-  const cumulativeLinks = {};
+    const stepIndex = new Map();
+    this.logs.forEach((log, index) => {
+      if (index > 0 && log.type !== "deadlock") stepIndex.set(log.step, index);
+    });
+
+    keyframes.forEach(([events, threads, resources, links]) => {
+      const index = stepIndex.get(events + 1);
+      if (index === undefined) return;
+      const keyframe = { index, nodes: new Map(), links: new Map() };
+      threads.forEach(thread => this.addNode(keyframe.nodes, `T${thread}`, thread));
+      resources.forEach(resource => this.addNode(keyframe.nodes, `R${resource}`, null, resource));
+      links.forEach(([thread, resource, code]) => {
+        keyframe.links.set(`T${thread}-R${resource}`, EVENT_TYPES[code]);
+      });
+      this.keyframes.push(keyframe);
+    });
+    this.keyframes.sort((a, b) => a.index - b.index);
+    return this.keyframes.length > 1;
+  }
 
-  // Process each log event to build the graph state incrementally
-  logs.forEach((log, idx) => {
-    if (log.type === "init") return; // Skip the init log
+  /**
+   * Add the node with `id` to `nodes`, creating it the first time
+   */
+  addNode(nodes, id, threadId, resourceId) {
+    if (nodes.has(id)) return;
+    if (!this.nodesMap[id]) {
+      this.nodesMap[id] = threadId !== null && threadId !== undefined
+        ? { id, name: `Thread ${threadId}`, type: "thread" }
+        : { id, name: `Resource ${resourceId}`, type: "resource" };
+    }
+    nodes.set(id, this.nodesMap[id]);
+  }
 
-    const prevState = graphStates[graphStates.length - 1];
-    const currentNodes = [...prevState.nodes];
-    let currentLinks = [...prevState.links];
-    // Transient links that exist only for this step (e.g., notify)
-    const transientLinks = [];
+  /**
+   * Apply the effect of one log entry on the active nodes and links
+   */
+  apply(log, nodes, links) {
+    if (log.type === "init") return;
 
-    // Handle spawn events
     if (isSpawnEvent(log.type)) {
       if (log.type === "thread_spawn" && log.thread_id !== 0) {
-        // Thread spawn
-        const threadId = log.thread_id;
-        const nodeId = `T${threadId}`;
-
-        // Add thread to active set and to nodes if not already there
-        if (!activeThreads.has(nodeId)) {
-          activeThreads.add(nodeId);
-          // Create node if it doesn't exist in the map
-          if (!nodesMap[nodeId]) {
-            nodesMap[nodeId] = {
-              id: nodeId,
-              name: `Thread ${threadId}`,
-              type: "thread",
-            };
-          }
-          currentNodes.push(nodesMap[nodeId]);
-        }
+        this.addNode(nodes, `T${log.thread_id}`, log.thread_id);
       } else if (log.resource_id) {
-        // Resource creation (Mutex, RwLock, or Condvar)
         const resourceId = `R${log.resource_id.replace(/^[A-Z]/, '')}`;
-        const lockType = log.lock_type || "mutex";
-
-        // Add resource to active set and to nodes if not already there
-        if (!activeResources.has(resourceId)) {
-          activeResources.add(resourceId);
-
-          let lockTypeDesc = "";
-          switch (lockType) {
-            case "mutex": lockTypeDesc = "Mutex"; break;
-            case "rwlock": lockTypeDesc = "RwLock"; break;
-            case "condvar": lockTypeDesc = "Condvar"; break;
-            default: lockTypeDesc = "Resource"; break;
-          }
-
-          // Create node if it doesn't exist in the map
-          if (!nodesMap[resourceId]) {
-            nodesMap[resourceId] = {
-              id: resourceId,
-              name: `${lockTypeDesc} ${log.resource_id}`,
-              type: "resource",
-              lock_type: lockType,
-            };
+        if (!nodes.has(resourceId)) {
+          const lockType = log.lock_type || "mutex";
+          const name = `${lockTypeLabel(lockType)} ${log.resource_id}`;
+          if (!this.nodesMap[resourceId]) {
+            this.nodesMap[resourceId] = { id: resourceId, name, type: "resource", lock_type: lockType };
           } else {
-            // Update existing node with lock type info
-            nodesMap[resourceId].lock_type = lockType;
-            nodesMap[resourceId].name = `${lockTypeDesc} ${log.resource_id}`;
+            this.nodesMap[resourceId].lock_type = lockType;
+            this.nodesMap[resourceId].name = name;
           }
-          currentNodes.push(nodesMap[resourceId]);
+          nodes.set(resourceId, this.nodesMap[resourceId]);
         }
       }
-    }
-    // Check if this is an exit event (any type)
-    // Handle exit events
-    else if (isExitEvent(log.type)) {
+    } else if (isExitEvent(log.type)) {
       if (log.type === "thread_exit" && log.thread_id !== 0) {
-        // Thread exit
-        const threadId = log.thread_id;
-        const nodeId = `T${threadId}`;
-
-        // Remove thread from active set and from nodes
-        activeThreads.delete(nodeId);
-        const nodeIndex = currentNodes.findIndex(n => n.id === nodeId);
-        if (nodeIndex !== -1) {
-          currentNodes.splice(nodeIndex, 1);
+        const nodeId = `T${log.thread_id}`;
+        nodes.delete(nodeId);
+        for (const key of [...links.keys()]) {
+          if (key.startsWith(`${nodeId}-`)) links.delete(key);
         }
-
-        // Remove any links connected to this thread
-        Object.keys(cumulativeLinks).forEach(key => {
-          if (key.startsWith(`${nodeId}-`)) {
-            delete cumulativeLinks[key];
-          }
-        });
-
-        // Update links array to reflect removed links
-        currentLinks = Object.keys(cumulativeLinks).map(key => {
-          const [source, target] = key.split("-");
-          return { source, target, type: cumulativeLinks[key] };
-        });
       } else if (log.resource_id) {
-        // Resource removal
         const resourceId = `R${log.resource_id.replace(/^[A-Z]/, '')}`;
-
-        // Remove resource from active set and from nodes
-        activeResources.delete(resourceId);
-        const nodeIndex = currentNodes.findIndex(n => n.id === resourceId);
-        if (nodeIndex !== -1) {
-          currentNodes.splice(nodeIndex, 1);
+        nodes.delete(resourceId);
+        for (const key of [...links.keys()]) {
+          if (key.endsWith(`-${resourceId}`)) links.delete(key);
         }
-
-        // Remove any links connected to this resource
-        Object.keys(cumulativeLinks).forEach(key => {
-          if (key.endsWith(`-${resourceId}`)) {
-            delete cumulativeLinks[key];
-          }
-        });
-
-        // Update links array to reflect removed links
-        currentLinks = Object.keys(cumulativeLinks).map(key => {
-          const [source, target] = key.split("-");
-          return { source, target, type: cumulativeLinks[key] };
-        });
       }
-    }
-    // Handle resource access events (attempt, acquired, released, wait)
-    else if ((isAttemptEvent(log.type) || isWaitBeginEvent(log.type) || isAcquisitionEvent(log.type) || isReleaseEvent(log.type) || isWaitEndEvent(log.type)) &&
+    } else if ((isAttemptEvent(log.type) || isWaitBeginEvent(log.type) || isAcquisitionEvent(log.type) || isReleaseEvent(log.type) || isWaitEndEvent(log.type)) &&
       log.thread_id !== 0 && log.resource_id) {
-      const threadId = log.thread_id;
-      const sourceId = `T${threadId}`;
-      // Find the numeric key for this resource letter from resourceMapping
-      const resourceLetter = log.resource_id;
-      const resourceNum = Object.keys(resourceMapping).find(key => resourceMapping[key] === resourceLetter);
-      const targetId = `R${resourceNum}`;
-      const linkKey = `${sourceId}-${targetId}`;
+      const sourceId = `T${log.thread_id}`;
+      const targetId = `R${log.resource_id}`;
+      this.addNode(nodes, sourceId, log.thread_id);
+      this.addNode(nodes, targetId, null, log.resource_id);
 
-      // Make sure both nodes exist in the active sets
-      if (!activeThreads.has(sourceId)) {
-        activeThreads.add(sourceId);
-        // Create node if it doesn't exist in the map
-        if (!nodesMap[sourceId]) {
-          nodesMap[sourceId] = {
-            id: sourceId,
-            name: `Thread ${threadId}`,
-            type: "thread",
-          };
-        }
-        currentNodes.push(nodesMap[sourceId]);
-      }
-
-      if (!activeResources.has(targetId)) {
-        activeResources.add(targetId);
-        // Create node if it doesn't exist in the map
-        if (!nodesMap[targetId]) {
-          nodesMap[targetId] = {
-            id: targetId,
-            name: `Resource ${log.resource_id}`,
-            type: "resource",
-          };
-        }
-        currentNodes.push(nodesMap[targetId]);
-      }
-
-      // Update link state
+      const linkKey = `${sourceId}-${targetId}`;
       if (isReleaseEvent(log.type) || isWaitEndEvent(log.type)) {
-        // Remove the link when resource is released
-        delete cumulativeLinks[linkKey];
+        links.delete(linkKey);
       } else {
-        // Add or update link for attempt, wait_begin or acquired
-        cumulativeLinks[linkKey] = log.type;
+        links.set(linkKey, log.type);
       }
-
-      // Convert current link state to array for D3
-      currentLinks = Object.keys(cumulativeLinks).map(key => {
-        const [s, t] = key.split("-");
-        return { source: s, target: t, type: cumulativeLinks[key] };
+    } else if (log.type === "deadlock" && log.cycle && log.cycle.length >= 2) {
+      log.cycle.forEach(threadId => {
+        const node = nodes.get(`T${threadId}`);
+        if (node) node.inDeadlock = true;
       });
     }
-    // Handle deadlock event
-    else if (log.type === "deadlock") {
-      // Mark nodes in the deadlock cycle if exists
-      if (log.cycle && log.cycle.length >= 2) {
-        // Mark all threads in the deadlock cycle
-        log.cycle.forEach(threadId => {
-          const nodeId = `T${threadId}`;
-          const node = currentNodes.find(n => n.id === nodeId);
-          if (node) {
-            node.inDeadlock = true;
-          }
-        });
-      }
-    }
-
-    // Add the current state to graph states
-    graphStates.push({
-      step: graphStates.length + 1,
-      nodes: currentNodes,
-      links: [...currentLinks, ...transientLinks],
-    });
-  });
-
-  // If the last event was a deadlock, add deadlock links between threads in the cycle
-  const deadlockLog = logs.find(log => log.type === "deadlock");
-  if (deadlockLog && deadlockLog.cycle && deadlockLog.cycle.length >= 2) {
-    console.log("DEADLOCK DETECTED - Creating deadlock links", deadlockLog);
-    const lastState = graphStates[graphStates.length - 1];
-    const deadlockLinks = [...lastState.links];
-    const deadlockThreads = deadlockLog.cycle;
+  }
 
-    console.log("Deadlock threads in cycle:", deadlockThreads);
+  /**
+   * Graph state of the step at `index` (0-based)
+   */
+  at(index) {
+    if (index < 0 || index >= this.length) return undefined;
+    if (index === this.logs.length) return this.deadlockState();
+
+    // Start from the last state when moving forward a little, as during playback
+    let base = null;
+    if (this.cursor && this.cursor.index <= index && index - this.cursor.index <= KEYFRAME_INTERVAL) {
+      base = this.cursor;
+    }
+    let low = 0;
+    let high = this.keyframes.length - 1;
+    while (low < high) {
+      const mid = (low + high + 1) >> 1;
+      if (this.keyframes[mid].index <= index) low = mid; else high = mid - 1;
+    }
+    const keyframe = this.keyframes[low];
+    if (!base || keyframe.index > base.index) {
+      base = { index: keyframe.index, nodes: new Map(keyframe.nodes), links: new Map(keyframe.links) };
+    }
 
-    // Get thread waiting for resource information
-    const waitingForInfo = deadlockLog.deadlock_details.thread_waiting_for_locks;
-    console.log("Thread waiting for locks info:", waitingForInfo);
+    for (let step = base.index + 1; step <= index; step++) {
+      this.apply(this.logs[step], base.nodes, base.links);
+    }
+    base.index = index;
+    this.cursor = base;
 
-    // Create a mapping from thread to resource it's waiting for
-    const threadToResource = {};
-    waitingForInfo.forEach(info => {
-      threadToResource[info.thread_id] = info.resource_id;
-    });
-    console.log("Thread to resource mapping:", threadToResource);
+    return {
+      step: index + 1,
+      nodes: [...base.nodes.values()],
+      links: [...base.links].map(([key, type]) => {
+        const [source, target] = key.split("-");
+        return { source, target, type };
+      }),
+    };
+  }
 
-    // Create a mapping from resource to thread holding it
-    const resourceToThread = {};
+  /**
+   * Serialize as the plain array of states, for sharing a processed scenario
+   */
+  toJSON() {
+    return Array.from({ length: this.length }, (_, index) => this.at(index));
+  }
 
-    // Find resource owners by checking acquired links in the current state
-    lastState.links.forEach(link => {
-      if (link.type === "acquired" && link.source.startsWith("T") && link.target.startsWith("R")) {
-        const threadId = link.source.substring(1); // Remove 'T' prefix
-        const resourceId = link.target.substring(1); // Remove 'R' prefix
-        resourceToThread[resourceId] = threadId;
-      }
-    });
-    console.log("Resource to thread mapping:", resourceToThread);
+  /**
+   * Final state with direct links between the threads of the deadlock cycle
+   */
+  deadlockState() {
+    const lastState = this.at(this.logs.length - 1);
+    const deadlockLinks = [...lastState.links];
+    const deadlockThreads = this.deadlockLog.cycle;
 
-    // Create deadlock links directly between threads in the cycle
     for (let i = 0; i < deadlockThreads.length; i++) {
       const currentThread = deadlockThreads[i];
       const nextThread = deadlockThreads[(i + 1) % deadlockThreads.length];
-
-      console.log(`Creating deadlock link: T${currentThread} -> T${nextThread}`);
-
-      // Find the actual node objects instead of just using strings
       const sourceNode = lastState.nodes.find(node => node.id === `T${currentThread}`);
       const targetNode = lastState.nodes.find(node => node.id === `T${nextThread}`);
 
       if (sourceNode && targetNode) {
-        // Add direct thread-to-thread deadlock link with proper object references
         deadlockLinks.push({
           source: sourceNode,
           target: targetNode,
           type: "deadlock",
           isDeadlockEdge: true
         });
-        console.log("Added deadlock link with object references");
       } else {
         console.error("Could not find nodes for threads:", currentThread, nextThread);
-        console.log("Available nodes:", lastState.nodes.map(n => n.id));
       }
     }
 
-    console.log("Final deadlock links count:", deadlockLinks.length);
-
-    // Create the final graph state with the deadlock cycles
-    graphStates.push({
-      step: graphStates.length + 1,
-      nodes: lastState.nodes.map(node => ({ ...node })), // Create a deep copy to avoid reference issues
+    return {
+      step: this.length,
+      nodes: lastState.nodes.map(node => ({ ...node })),
       links: deadlockLinks,
-    });
+    };
+  }
+}
 
-    console.log("Added new graph state with deadlock links");
+/**
+ * Display name of a lock type
+ */
+function lockTypeLabel(lockType) {
+  switch (lockType) {
+    case "mutex": return "Mutex";
+    case "rwlock": return "RwLock";
+    case "condvar": return "Condvar";
+    default: return "Resource";
   }
+}
+
+/**
+ * Generate graph state from logs' cumulative effect
+ *
+ * @param {Array} logs - Log array created by transformLogs
+ * @param {Object} graphThreadMapping - { raw_thread_id: incrementalNum } e.g. {6164146352: 1, 6166292656: 2}
+ * @param {Object} resourceMapping - { raw_lock: letter } e.g. {1:"A", 2:"B"}
+ * @param {Array} keyframes - Optional keyframes computed by the encoder
+ * @returns {GraphStates} States of every step, computed on demand
+ *
+ * In graph state:
+ * - Thread node ids are "T" + thread_id (e.g. "T123")
+ * - Resource nodes are "R" + resource_id (e.g. "R1")
+ */
+function generateGraphStateFromLogs(logs, graphThreadMapping, resourceMapping, keyframes) {
+  // Map of all possible nodes by id
+  const nodesMap = {};
+  Object.keys(graphThreadMapping).forEach(threadId => {
+    nodesMap[`T${threadId}`] = {
+      id: `T${threadId}`,
+      name: `Thread ${threadId}`,
+      type: "thread",
+    };
+  });
+  Object.keys(resourceMapping).forEach(lockNum => {
+    nodesMap[`R${lockNum}`] = {
+      id: `R${lockNum}`,
+      name: `Resource ${resourceMapping[lockNum]}`,
+      type: "resource",
+      lock_type: "mutex", // default, will be updated when resource is created
+    };
+  });
 
-  return graphStates;
+  return new GraphStates(logs, nodesMap, keyframes);
 }
 
 /**
@@ -955,10 +932,13 @@ function transformRawObject(rawData) {
     }
   } catch (e) { console.warn('No terminal deadlock info or failed to parse', e); }
 
+  // Keyframes precomputed by the encoder: [events, deadlock, keyframes]
+  const keyframes = Array.isArray(rawData) && Array.isArray(rawData[2]) ? rawData[2] : null;
   const graph_state = generateGraphStateFromLogs(
     logs,
     graphThreadMapping,
-    resourceMapping
+    resourceMapping,
+    keyframes
   );
 
   return { logs, graph_state };
@@ -90,6 +90,68 @@
 #include <pthread.h>
 #endif
 
+/*
+ * --- Statically Initializable Lock Types ---
+ *
+ * Fixed-size lock objects that live wherever the caller puts them: in a
+ * global, on the stack or embedded in a struct. They need no heap
+ * allocation, and a global can be initialized statically, like a
+ * pthread_mutex_t:
+ *
+ *        static deloxide_mutex_t lock = DELOXIDE_MUTEX_INITIALIZER;
+ *
+ *        struct account {
+ *            deloxide_mutex_t lock;
+ *            long balance;
+ *        };
+ *        deloxide_mutex_init(&acc->lock);
+ *
+ * The lock gets its ID and is registered with the detector on first use,
+ * so the first thread that uses it is recorded as its creator. A pointer to
+ * one of these types can be passed to every function and macro that takes
+ * a lock pointer (LOCK_MUTEX, deloxide_condvar_wait, ...). Release them with
+ * deloxide_mutex_destroy(), deloxide_rwlock_destroy() and
+ * deloxide_cond_destroy(), never with the deloxide_destroy_* functions.
+ *
+ * The contents are opaque. The sizes leave room for every feature
+ * combination of the library.
+ */
+
+/** Size in bytes of deloxide_mutex_t. */
+#define DELOXIDE_MUTEX_SIZE 128
+/** Size in bytes of deloxide_rwlock_t. */
+#define DELOXIDE_RWLOCK_SIZE 128
+/** Size in bytes of deloxide_cond_t. */
+#define DELOXIDE_COND_SIZE 32
+
+/** A tracked mutex in caller-provided storage. */
+typedef union {
+    unsigned char opaque[DELOXIDE_MUTEX_SIZE];
+    uint64_t align;
+    void* align_ptr;
+} deloxide_mutex_t;
+
+/** A tracked RwLock in caller-provided storage. */
+typedef union {
+    unsigned char opaque[DELOXIDE_RWLOCK_SIZE];
+    uint64_t align;
+    void* align_ptr;
+} deloxide_rwlock_t;
+
+/** A tracked condition variable in caller-provided storage. */
+typedef union {
+    unsigned char opaque[DELOXIDE_COND_SIZE];
+    uint64_t align;
+    void* align_ptr;
+} deloxide_cond_t;
+
+/** Static initializer for deloxide_mutex_t. */
+#define DELOXIDE_MUTEX_INITIALIZER { { 0 } }
+/** Static initializer for deloxide_rwlock_t. */
+#define DELOXIDE_RWLOCK_INITIALIZER { { 0 } }
+/** Static initializer for deloxide_cond_t. */
+#define DELOXIDE_COND_INITIALIZER { { 0 } }
+
 /**
  * @brief Define a tracked thread function
  *
@@ -293,6 +355,93 @@ typedef struct {
  */
 int deloxide_init(const char* log_path, void (*callback)(const char* json_info));
 
+/** Number of entries each array of a deloxide_deadlock_info can hold */
+#define DELOXIDE_DEADLOCK_INFO_CAPACITY 64
+
+/** deloxide_deadlock_info.source: threads are blocked in a wait-for cycle */
+#define DELOXIDE_SOURCE_WAIT_FOR_GRAPH 0
+/** deloxide_deadlock_info.source: locks were taken in inconsistent order */
+#define DELOXIDE_SOURCE_LOCK_ORDER_VIOLATION 1
+
+/** @brief A thread and the lock it waits for. */
+typedef struct {
+    uintptr_t thread_id;
+    uintptr_t lock_id;
+} deloxide_thread_wait;
+
+/**
+ * @brief A deadlock report passed to the structured callback.
+ *
+ * All arrays point into a buffer allocated by deloxide_init() and are only
+ * valid until the callback returns.
+ */
+typedef struct {
+    /** DELOXIDE_SOURCE_WAIT_FOR_GRAPH or DELOXIDE_SOURCE_LOCK_ORDER_VIOLATION */
+    int source;
+    /** Threads forming the cycle */
+    const uintptr_t* thread_cycle;
+    size_t thread_cycle_len;
+    /** Lock each thread of the cycle waits for */
+    const deloxide_thread_wait* waits;
+    size_t waits_len;
+    /** Inconsistently ordered locks (or lock classes), NULL unless source is a lock order violation */
+    const uintptr_t* lock_order_cycle;
+    size_t lock_order_cycle_len;
+    /** Nanoseconds since deloxide_init() on a monotonic clock */
+    uint64_t timestamp_ns;
+    /** Non-zero if an array exceeded DELOXIDE_DEADLOCK_INFO_CAPACITY and was cut short */
+    int truncated;
+} deloxide_deadlock_info;
+
+/**
+ * @brief Register a callback that receives deadlocks as structs instead of JSON.
+ *
+ * Delivering a report allocates no memory, so the callback can safely trigger
+ * core dumps or recovery under memory pressure. It is invoked in addition to
+ * the JSON callback given to deloxide_init(), which may be NULL. It should be
+ * called before deloxide_init().
+ *
+ * @param callback Function to call for each deadlock, or NULL to remove it.
+ *
+ * @return 0 on success, 1 if already initialized
+ */
+int deloxide_set_deadlock_info_callback(void (*callback)(const deloxide_deadlock_info* info));
+
+/** Log format for deloxide_set_log_format(): one JSON object per line (default). */
+#define DELOXIDE_LOG_FORMAT_JSON 0
+/** Log format for deloxide_set_log_format(): compact binary records. */
+#define DELOXIDE_LOG_FORMAT_BINARY 1
+
+/**
+ * @brief Select the on-disk format of the log file.
+ *
+ * The binary format is several times smaller than JSON lines and cheaper to
+ * write. deloxide_showcase() and the deloxide CLI read both formats.
+ * It should be called before deloxide_init().
+ *
+ * @param format DELOXIDE_LOG_FORMAT_JSON or DELOXIDE_LOG_FORMAT_BINARY.
+ *
+ * @return 0 on success, 1 if already initialized, -1 if logging feature not enabled,
+ *         -2 if the format is unknown
+ */
+int deloxide_set_log_format(int format);
+
+/**
+ * @brief Keep only recent events in memory instead of streaming the log.
+ *
+ * In flight-recorder mode the log file passed to deloxide_init() is written
+ * only when a deadlock is detected or deloxide_flush_logs() is called. It then
+ * holds the most recent events plus the creation of every live thread and lock.
+ * It should be called before deloxide_init().
+ *
+ * @param capacity   Number of recent events to keep (must be non-zero).
+ * @param per_thread Non-zero to keep capacity events for each thread instead of in total.
+ *
+ * @return 0 on success, 1 if already initialized, -1 if logging feature not enabled,
+ *         -2 if capacity is zero
+ */
+int deloxide_enable_flight_recorder(size_t capacity, int per_thread);
+
 /**
  * @brief Check if a deadlock has been detected.
  *
@@ -311,6 +460,20 @@ int deloxide_is_deadlock_detected();
  */
 void deloxide_reset_deadlock_flag();
 
+/**
+ * @brief Get the counters of deadlock reports.
+ *
+ * Only the first report of each cycle (the same source and the same locks or
+ * lock classes) reaches the callback; repeats are counted as coalesced.
+ * Reports are dropped when too many of them wait for a slow callback.
+ * Any of the pointers may be NULL.
+ *
+ * @param delivered Receives the number of reports passed to the callback.
+ * @param coalesced Receives the number of repeats that were only counted.
+ * @param dropped   Receives the number of reports dropped for a full queue.
+ */
+void deloxide_get_report_stats(uint64_t* delivered, uint64_t* coalesced, uint64_t* dropped);
+
 /**
  * @brief Check if logging is currently enabled.
  *
@@ -346,6 +509,21 @@ void* deloxide_create_mutex();
  */
 void* deloxide_create_mutex_with_creator(uintptr_t creator_thread_id);
 
+/**
+ * @brief Create a new tracked mutex belonging to a named lock class.
+ *
+ * When lock order checking is keyed by class (see
+ * deloxide_enable_lock_order_checking()), all locks created with the same
+ * class name share one node in the lock order graph, so an ordering learned
+ * from one pair of locks applies to every other pair of the same classes.
+ * Without class ordering the name is ignored.
+ *
+ * @param class_name Null-terminated class name, or NULL for a class of its own.
+ *
+ * @return Opaque pointer to the mutex, or NULL on allocation failure.
+ */
+void* deloxide_create_mutex_with_class(const char* class_name);
+
 /**
  * @brief Destroy a tracked mutex.
  *
@@ -355,19 +533,103 @@ void* deloxide_create_mutex_with_creator(uintptr_t creator_thread_id);
  */
 void deloxide_destroy_mutex(void* mutex);
 
+/**
+ * @brief Initialize a caller-allocated mutex.
+ *
+ * Equivalent to assigning DELOXIDE_MUTEX_INITIALIZER. Nothing is allocated;
+ * the mutex is registered with the detector on first use.
+ *
+ * @param mutex Pointer to the mutex storage.
+ *
+ * @return  0 on success
+ *         -1 if mutex is NULL
+ *
+ * @note A mutex that is in use must be destroyed with deloxide_mutex_destroy() first.
+ */
+int deloxide_mutex_init(deloxide_mutex_t* mutex);
+
+/**
+ * @brief Destroy a caller-allocated mutex.
+ *
+ * Removes the mutex from tracking if it was ever used. The storage can be
+ * initialized again afterwards.
+ *
+ * @param mutex Pointer to an initialized mutex.
+ *
+ * @return  0 on success
+ *         -1 if mutex is NULL
+ *
+ * @note No thread may use the mutex during or after this call.
+ */
+int deloxide_mutex_destroy(deloxide_mutex_t* mutex);
+
 /**
  * @brief Lock a tracked mutex.
  *
  * Attempts to acquire the lock on a mutex while tracking the operation
  * for deadlock detection.
  *
- * @param mutex Pointer to a mutex created with deloxide_create_mutex.
+ * @param mutex Pointer to a mutex created with deloxide_create_mutex, or to
+ *              an initialized deloxide_mutex_t.
  *
  * @return  0 on success
  *         -1 if mutex is NULL
  */
 int deloxide_lock_mutex(void* mutex);
 
+/**
+ * @brief Try to lock a tracked mutex without blocking.
+ *
+ * A failed attempt is not logged and adds no wait-for edge, so trylock and
+ * back-off loops stay cheap and cannot cause false deadlock reports.
+ *
+ * @param mutex Pointer to a mutex created with deloxide_create_mutex, or to
+ *              an initialized deloxide_mutex_t.
+ *
+ * @return  0 if the mutex was acquired
+ *          1 if the mutex is held
+ *         -1 if mutex is NULL
+ */
+int deloxide_try_lock_mutex(void* mutex);
+
+/**
+ * @brief Lock a tracked mutex, giving up after a timeout.
+ *
+ * While blocked the thread waits for the owner like in deloxide_lock_mutex,
+ * so a deadlock is still detected. If the timeout runs out first, the wait
+ * is withdrawn from the detector. On a mutex the calling thread already
+ * holds, it times out without waiting for itself.
+ *
+ * @param mutex      Pointer to a mutex created with deloxide_create_mutex, or
+ *                   to an initialized deloxide_mutex_t.
+ * @param timeout_ms Timeout in milliseconds.
+ *
+ * @return  0 if the mutex was acquired
+ *          1 on timeout
+ *         -1 if mutex is NULL
+ */
+int deloxide_lock_mutex_timeout(void* mutex, unsigned long timeout_ms);
+
+/**
+ * @brief Lock several tracked mutexes at once.
+ *
+ * Acquires every mutex without holding some of them while blocking on
+ * another, so two calls over the same mutexes cannot deadlock whatever order
+ * they list them in, and no lock order is recorded between them. Each mutex
+ * is released separately with deloxide_unlock_mutex.
+ *
+ * @param mutexes Array of n pointers to mutexes created with
+ *                deloxide_create_mutex, or to initialized deloxide_mutex_t.
+ * @param n       Number of mutexes in the array.
+ *
+ * @return  0 on success
+ *         -1 if mutexes or one of its pointers is NULL
+ *         -2 if the same mutex appears twice
+ *
+ * @note The calling thread must not already hold any of the mutexes.
+ */
+int deloxide_lock_mutexes(void* const* mutexes, size_t n);
+
 /**
  * @brief Unlock a tracked mutex.
  *
@@ -377,6 +639,7 @@ int deloxide_lock_mutex(void* mutex);
  *
  * @return  0 on success
  *         -1 if mutex is NULL
+ *         -2 if the mutex is not held by the calling thread
  */
 int deloxide_unlock_mutex(void* mutex);
 
@@ -468,6 +731,246 @@ int deloxide_showcase(const char* log_path);
  */
 int deloxide_showcase_current();
 
+/*
+ * --- Lock Order Checking API ---
+ *
+ * Lock order checking reports inconsistent lock acquisition orders as
+ * potential deadlocks before any thread blocks. It is only available when
+ * Deloxide is compiled with the "lock-order-graph" feature.
+ */
+
+/**
+ * @brief Enable lock order checking.
+ *
+ * By default every lock is its own node in the lock order graph. With
+ * by_class set, locks are grouped by the class given to
+ * deloxide_create_mutex_with_class() / deloxide_create_rwlock_with_class();
+ * locks created without a class each form a class of their own. Nesting two
+ * locks of the same class is not checked. Reported cycles then hold class IDs,
+ * and "lock_order_classes" in the JSON names them.
+ * It should be called before deloxide_init().
+ *
+ * @param by_class Non-zero to key the ordering by lock class.
+ *
+ * @return 0 on success, 1 if already initialized, -1 if lock-order-graph feature not enabled
+ *
+ * @note This function is only available when Deloxide is compiled with the "lock-order-graph" feature.
+ */
+int deloxide_enable_lock_order_checking(int by_class);
+
+/*
+ * --- Sampling API ---
+ *
+ * Sampling caps the cost of keeping detection enabled in production.
+ * Unsampled lock acquisitions skip deadlock detection, lock order checking
+ * and logging entirely; a deadlock is reported only when every acquisition
+ * that forms it was sampled. Each release is handled like its acquisition,
+ * so a sampling decision that changes while a lock is held is safe.
+ * Each function replaces any sampling configured earlier.
+ */
+
+/**
+ * @brief Track only the lock acquisitions of a fraction of threads.
+ *
+ * It should be called before deloxide_init().
+ *
+ * @param rate Fraction of threads to track, in (0.0, 1.0].
+ *
+ * @return 0 on success, 1 if already initialized, -2 if rate is out of range
+ */
+int deloxide_enable_thread_sampling(double rate);
+
+/**
+ * @brief Track only the acquisitions of a fraction of locks.
+ *
+ * It should be called before deloxide_init().
+ *
+ * @param rate Fraction of locks to track, in (0.0, 1.0].
+ *
+ * @return 0 on success, 1 if already initialized, -2 if rate is out of range
+ */
+int deloxide_enable_lock_sampling(double rate);
+
+/**
+ * @brief Track lock acquisitions only during periodic windows.
+ *
+ * Every acquisition is tracked for on_ms milliseconds, then none for off_ms
+ * milliseconds, and so on. It should be called before deloxide_init().
+ *
+ * @param on_ms  Length of each tracked window in milliseconds (must be non-zero).
+ * @param off_ms Length of each untracked gap in milliseconds.
+ *
+ * @return 0 on success, 1 if already initialized, -2 if on_ms is zero
+ */
+int deloxide_enable_window_sampling(uint64_t on_ms, uint64_t off_ms);
+
+/**
+ * @brief Defer cycle detection until a thread has been blocked for a while.
+ *
+ * By default every contended acquisition searches for a deadlock before it
+ * blocks. With deferred detection the wait is only recorded, and a thread
+ * still blocked after threshold_ms searches for a deadlock through itself.
+ * Contended acquisitions get cheaper while a deadlock is reported up to
+ * threshold_ms later. It should be called before deloxide_init().
+ *
+ * @param threshold_ms How long a thread blocks before checking, in milliseconds (must be non-zero).
+ *
+ * @return 0 on success, 1 if already initialized, -2 if threshold_ms is zero
+ */
+int deloxide_enable_deferred_detection(uint64_t threshold_ms);
+
+/*
+ * --- Runtime Switch API ---
+ *
+ * Detection can be switched off and on while the program runs. While it is
+ * off, lock operations skip the detector and cost about as much as the
+ * underlying locks. The DELOXIDE_DETECTION environment variable ("on" or
+ * "off") overrides the initial state when deloxide_init() runs.
+ */
+
+/**
+ * @brief Switch deadlock detection on.
+ *
+ * Before deloxide_init() this undoes deloxide_disable_detection(). Locks that
+ * are held when detection is switched on are handed over once released.
+ *
+ * @return 0 on success
+ */
+int deloxide_enable_detection();
+
+/**
+ * @brief Switch deadlock detection off.
+ *
+ * Before deloxide_init() this makes the detector start with detection off.
+ *
+ * @return 0 on success
+ */
+int deloxide_disable_detection();
+
+/**
+ * @brief Check whether deadlock detection is switched on.
+ *
+ * @return 1 if lock operations are tracked, 0 if detection is off or the
+ *         detector has not been initialized
+ */
+int deloxide_is_detection_enabled();
+
+/*
+ * --- Lock Statistics API ---
+ *
+ * Lock statistics count acquisitions, contention, wait and hold times per
+ * lock. They are only available when Deloxide is compiled with the
+ * "lock-stats" feature. Counters are recorded per thread and merged when
+ * deloxide_get_lock_stats() takes a snapshot.
+ */
+
+/** Number of buckets in a wait-time histogram */
+#define DELOXIDE_WAIT_HISTOGRAM_BUCKETS 40
+
+/**
+ * @brief Contention statistics of one lock.
+ *
+ * Bucket i of wait_histogram counts contended waits of [2^i, 2^(i+1))
+ * nanoseconds; the last bucket also counts longer waits.
+ */
+typedef struct {
+    uintptr_t lock_id;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t total_wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t total_hold_ns;
+    uint64_t max_hold_ns;
+    uint64_t wait_histogram[DELOXIDE_WAIT_HISTOGRAM_BUCKETS];
+} deloxide_lock_stats;
+
+/**
+ * @brief Enable per-lock contention statistics.
+ *
+ * It should be called before deloxide_init().
+ *
+ * @return 0 on success, 1 if already initialized, -1 if lock-stats feature not enabled
+ *
+ * @note This function is only available when Deloxide is compiled with the "lock-stats" feature.
+ */
+int deloxide_enable_lock_stats();
+
+/**
+ * @brief Take a snapshot of the statistics of all live locks.
+ *
+ * Locks are ordered most contended first (by total wait time), so a small
+ * buffer receives the top-N report.
+ *
+ * @param buffer   Buffer receiving up to capacity entries (may be NULL if capacity is 0).
+ * @param capacity Number of entries the buffer can hold.
+ *
+ * @return The number of locks with statistics, which may exceed capacity,
+ *         or -1 if lock-stats feature not enabled
+ */
+int deloxide_get_lock_stats(deloxide_lock_stats* buffer, size_t capacity);
+
+/*
+ * --- Cross-Process Detection API ---
+ *
+ * Deadlocks over locks shared between processes, such as
+ * PTHREAD_PROCESS_SHARED mutexes in shared memory, are found through a
+ * shared region that every process attaches to. Each process publishes the
+ * owners and waiters of its shared locks under a key all processes agree
+ * on, e.g. the offset of the mutex in its segment, and one of them searches
+ * the combined wait-for graph. Threads in such a deadlock are reported by
+ * their global ID: the process ID in the upper 32 bits and the thread ID in
+ * the lower 32 bits. POSIX only.
+ */
+
+/**
+ * @brief Attach this process to a shared memory region.
+ *
+ * It should be called after deloxide_init(), whose callback also receives
+ * the deadlocks found across processes.
+ *
+ * @param path File backing the region (e.g. under /dev/shm), created if needed.
+ *
+ * @return 0 on success, 1 if already attached, -1 if path is NULL or invalid UTF-8,
+ *         -2 if the region could not be attached, -3 if not initialized
+ */
+int deloxide_attach_shared_memory(const char* path);
+
+/**
+ * @brief Publish that the current thread is about to block on a shared lock.
+ *
+ * @param key Key of the lock, the same in every process (0 is reserved).
+ *
+ * @return 0 if published, 1 if not attached or the region is full
+ */
+int deloxide_shared_lock_attempt(uint64_t key);
+
+/**
+ * @brief Publish that the current thread acquired a shared lock.
+ *
+ * @param key Key of the lock.
+ *
+ * @return 0 if published, 1 if not attached or the region is full
+ */
+int deloxide_shared_lock_acquired(uint64_t key);
+
+/**
+ * @brief Publish that the current thread released a shared lock.
+ *
+ * @param key Key of the lock.
+ *
+ * @return 0 if published, 1 if not attached or the region is full
+ */
+int deloxide_shared_lock_released(uint64_t key);
+
+/**
+ * @brief Withdraw a published wait on a shared lock, e.g. after a timeout.
+ *
+ * @param key Key of the lock.
+ *
+ * @return 0 if published, 1 if not attached or the region is full
+ */
+int deloxide_shared_lock_cancel(uint64_t key);
+
 /*
  * --- Stress Testing API ---
  *
@@ -509,6 +1012,50 @@ int deloxide_enable_random_stress(double probability, unsigned long min_delay_us
  */
 int deloxide_enable_component_stress(unsigned long min_delay_us, unsigned long max_delay_us);
 
+/**
+ * @brief Enable PCT (probabilistic concurrency testing) stress testing.
+ *
+ * Threads get random priorities that are enforced as delays before nested
+ * lock acquisitions, and at depth - 1 random acquisition points the current
+ * thread drops to the lowest priority. It should be called before
+ * deloxide_init().
+ *
+ * @param depth Bug depth to target, the number of change points plus one
+ * @param steps Expected number of lock acquisitions in a run
+ * @param min_delay_us Shortest delay worth waiting, in microseconds
+ * @param max_delay_us Delay of the lowest priority thread, in microseconds
+ *
+ * @return 0 on success, 1 if already initialized, -1 if stress-test feature not enabled
+ *
+ * @note This function is only available when Deloxide is compiled with the "stress-test" feature.
+ */
+int deloxide_enable_pct_stress(unsigned long depth, unsigned long steps, unsigned long min_delay_us, unsigned long max_delay_us);
+
+/**
+ * @brief Seed the random decisions of stress testing.
+ *
+ * Runs with the same seed make the same decisions as long as every thread
+ * reaches the same lock acquisitions. Without a seed, a random one is used.
+ * It should be called before deloxide_init().
+ *
+ * @param seed Seed of the run
+ *
+ * @return 0 on success, 1 if already initialized, -1 if stress-test feature not enabled
+ *
+ * @note This function is only available when Deloxide is compiled with the "stress-test" feature.
+ */
+int deloxide_set_stress_seed(uint64_t seed);
+
+/**
+ * @brief Get the seed of the current stress run.
+ *
+ * Print it when a run fails and pass it to deloxide_set_stress_seed() to
+ * repeat the run.
+ *
+ * @return The seed, or 0 if stress testing is not enabled
+ */
+uint64_t deloxide_get_stress_seed();
+
 /**
  * @brief Disable stress testing.
  *
@@ -541,6 +1088,16 @@ void* deloxide_create_rwlock();
  */
 void* deloxide_create_rwlock_with_creator(uintptr_t creator_thread_id);
 
+/**
+ * @brief Create a new tracked RwLock belonging to a named lock class.
+ *
+ * See deloxide_create_mutex_with_class(). Mutexes and RwLocks may share a class name.
+ *
+ * @param class_name Null-terminated class name, or NULL for a class of its own.
+ * @return Opaque pointer to the RwLock, or NULL on allocation failure.
+ */
+void* deloxide_create_rwlock_with_class(const char* class_name);
+
 /**
  * @brief Destroy a tracked RwLock.
  *
@@ -549,6 +1106,25 @@ void* deloxide_create_rwlock_with_creator(uintptr_t creator_thread_id);
  */
 void deloxide_destroy_rwlock(void* rwlock);
 
+/**
+ * @brief Initialize a caller-allocated RwLock.
+ *
+ * Equivalent to assigning DELOXIDE_RWLOCK_INITIALIZER; see deloxide_mutex_init().
+ *
+ * @param rwlock Pointer to the RwLock storage.
+ * @return  0 on success, -1 if rwlock is NULL
+ */
+int deloxide_rwlock_init(deloxide_rwlock_t* rwlock);
+
+/**
+ * @brief Destroy a caller-allocated RwLock.
+ *
+ * @param rwlock Pointer to an initialized RwLock.
+ * @return  0 on success, -1 if rwlock is NULL
+ * @note No thread may use or hold the RwLock during or after this call.
+ */
+int deloxide_rwlock_destroy(deloxide_rwlock_t* rwlock);
+
 /**
  * @brief Lock a tracked RwLock for reading.
  *
@@ -559,13 +1135,26 @@ void deloxide_destroy_rwlock(void* rwlock);
  */
 int deloxide_rw_lock_read(void* rwlock);
 
+/**
+ * @brief Try to lock a tracked RwLock for reading without blocking.
+ *
+ * A failed attempt is not logged and adds no wait-for edge.
+ *
+ * @param rwlock Pointer to a RwLock created with deloxide_create_rwlock.
+ * @return  0 if the read lock was acquired, 1 if the RwLock is write-locked,
+ *         -1 if rwlock is NULL
+ */
+int deloxide_rw_try_read(void* rwlock);
+
 /**
  * @brief Unlock a tracked RwLock from reading.
  *
- * Releases a shared (read) lock previously acquired on a RwLock.
+ * Releases a shared (read) lock previously acquired on a RwLock by the
+ * calling thread.
  *
  * @param rwlock Pointer to a RwLock created with deloxide_create_rwlock.
- * @return  0 on success, -1 if rwlock is NULL
+ * @return  0 on success, -1 if rwlock is NULL,
+ *         -2 if the calling thread holds no read lock on rwlock
  */
 int deloxide_rw_unlock_read(void* rwlock);
 
@@ -579,13 +1168,25 @@ int deloxide_rw_unlock_read(void* rwlock);
  */
 int deloxide_rw_lock_write(void* rwlock);
 
+/**
+ * @brief Try to lock a tracked RwLock for writing without blocking.
+ *
+ * A failed attempt is not logged and adds no wait-for edge.
+ *
+ * @param rwlock Pointer to a RwLock created with deloxide_create_rwlock.
+ * @return  0 if the write lock was acquired, 1 if the RwLock is held,
+ *         -1 if rwlock is NULL
+ */
+int deloxide_rw_try_write(void* rwlock);
+
 /**
  * @brief Unlock a tracked RwLock from writing.
  *
  * Releases an exclusive (write) lock previously acquired on a RwLock.
  *
  * @param rwlock Pointer to a RwLock created with deloxide_create_rwlock.
- * @return  0 on success, -1 if rwlock is NULL
+ * @return  0 on success, -1 if rwlock is NULL,
+ *         -2 if the calling thread does not hold the write lock
  */
 int deloxide_rw_unlock_write(void* rwlock);
 
@@ -625,6 +1226,25 @@ void* deloxide_create_condvar_with_creator(uintptr_t creator_thread_id);
  */
 void deloxide_destroy_condvar(void* condvar);
 
+/**
+ * @brief Initialize a caller-allocated condition variable.
+ *
+ * Equivalent to assigning DELOXIDE_COND_INITIALIZER; see deloxide_mutex_init().
+ *
+ * @param condvar Pointer to the condition variable storage.
+ * @return  0 on success, -1 if condvar is NULL
+ */
+int deloxide_cond_init(deloxide_cond_t* condvar);
+
+/**
+ * @brief Destroy a caller-allocated condition variable.
+ *
+ * @param condvar Pointer to an initialized condition variable.
+ * @return  0 on success, -1 if condvar is NULL
+ * @note No thread may wait on the condition variable during or after this call.
+ */
+int deloxide_cond_destroy(deloxide_cond_t* condvar);
+
 /**
  * @brief Wait on a condition variable.
  *
@@ -0,0 +1,145 @@
+//! `LD_PRELOAD` shim for unmodified pthread programs
+//!
+//! Build with `make preload` and run a program with
+//! `LD_PRELOAD=target/release/libdeloxide_preload.so ./program`. Every
+//! pthread mutex, RwLock and condition variable of the program is then
+//! tracked by Deloxide, with no source changes or recompilation.
+//!
+//! This crate only exports the interposed symbols; the hooks live in
+//! `deloxide::ffi::preload`, see there for the environment variables the shim
+//! reads.
+
+#![cfg(target_os = "linux")]
+// Each export has the contract of the pthread function it replaces
+#![allow(clippy::missing_safety_doc)]
+
+use deloxide::ffi::preload::{self, StartRoutine};
+use std::ffi::{c_int, c_void};
+
+extern "C" fn init() {
+    preload::init();
+}
+
+/// Initialize the detector before `main` (and before other constructors that
+/// are ordered after this library)
+#[used]
+#[unsafe(link_section = ".init_array")]
+static INIT: extern "C" fn() = init;
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_mutex_lock(mutex: *mut c_void) -> c_int {
+    unsafe { preload::mutex_lock(mutex) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_mutex_trylock(mutex: *mut c_void) -> c_int {
+    unsafe { preload::mutex_trylock(mutex) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_mutex_timedlock(
+    mutex: *mut c_void,
+    abstime: *const c_void,
+) -> c_int {
+    unsafe { preload::mutex_timedlock(mutex, abstime) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_mutex_unlock(mutex: *mut c_void) -> c_int {
+    unsafe { preload::mutex_unlock(mutex) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_mutex_destroy(mutex: *mut c_void) -> c_int {
+    unsafe { preload::mutex_destroy(mutex) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_rdlock(rwlock: *mut c_void) -> c_int {
+    unsafe { preload::rwlock_rdlock(rwlock) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_tryrdlock(rwlock: *mut c_void) -> c_int {
+    unsafe { preload::rwlock_tryrdlock(rwlock) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_timedrdlock(
+    rwlock: *mut c_void,
+    abstime: *const c_void,
+) -> c_int {
+    unsafe { preload::rwlock_timedrdlock(rwlock, abstime) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_wrlock(rwlock: *mut c_void) -> c_int {
+    unsafe { preload::rwlock_wrlock(rwlock) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_trywrlock(rwlock: *mut c_void) -> c_int {
+    unsafe { preload::rwlock_trywrlock(rwlock) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_timedwrlock(
+    rwlock: *mut c_void,
+    abstime: *const c_void,
+) -> c_int {
+    unsafe { preload::rwlock_timedwrlock(rwlock, abstime) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_unlock(rwlock: *mut c_void) -> c_int {
+    unsafe { preload::rwlock_unlock(rwlock) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_rwlock_destroy(rwlock: *mut c_void) -> c_int {
+    unsafe { preload::rwlock_destroy(rwlock) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_cond_wait(cond: *mut c_void, mutex: *mut c_void) -> c_int {
+    unsafe { preload::cond_wait(cond, mutex) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_cond_timedwait(
+    cond: *mut c_void,
+    mutex: *mut c_void,
+    abstime: *const c_void,
+) -> c_int {
+    unsafe { preload::cond_timedwait(cond, mutex, abstime) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_cond_signal(cond: *mut c_void) -> c_int {
+    unsafe { preload::cond_signal(cond) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_cond_broadcast(cond: *mut c_void) -> c_int {
+    unsafe { preload::cond_broadcast(cond) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_cond_destroy(cond: *mut c_void) -> c_int {
+    unsafe { preload::cond_destroy(cond) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn pthread_create(
+    thread: *mut c_void,
+    attr: *const c_void,
+    start_routine: StartRoutine,
+    arg: *mut c_void,
+) -> c_int {
+    unsafe { preload::create(thread, attr, start_routine, arg) }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C-unwind" fn pthread_exit(retval: *mut c_void) -> ! {
+    unsafe { preload::exit(retval) }
+}
@@ -0,0 +1,329 @@
+//! Stress campaigns: run a deadlock scenario many times across all cores
+//!
+//! A scenario is any program that exits successfully when Deloxide detected
+//! the deadlock it provokes and unsuccessfully (or not at all) otherwise,
+//! which is how the deadlock tests in `tests/` and `c_tests/` behave. Each
+//! run gets its own seed and a stress mode from the campaign through the
+//! `DELOXIDE_STRESS_SEED` and `DELOXIDE_STRESS_MODE` environment variables,
+//! so the scenario needs no changes beyond being built with "stress-test".
+//!
+//! Per mode, the campaign tracks the manifestation rate with its Wilson score
+//! interval and the time to detection of the runs that manifested, and stops
+//! once every interval is narrow enough.
+
+use anyhow::{Result, bail};
+use std::io::Write;
+use std::path::PathBuf;
+use std::process::{Command, Stdio};
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, mpsc};
+use std::thread;
+use std::time::{Duration, Instant};
+
+/// z-score of the 95% confidence level
+const Z_95: f64 = 1.96;
+
+/// Environment variables read by the detector (see `core::stress`)
+const STRESS_MODE_ENV: &str = "DELOXIDE_STRESS_MODE";
+const STRESS_SEED_ENV: &str = "DELOXIDE_STRESS_SEED";
+
+/// Number of manifesting seeds listed per mode in the report
+const SEEDS_SHOWN: usize = 5;
+
+/// Settings of a campaign
+pub struct Campaign {
+    /// Program and arguments of the scenario
+    pub command: Vec<String>,
+    /// Stress modes to compare, as accepted by `DELOXIDE_STRESS_MODE`
+    pub modes: Vec<String>,
+    /// Maximum number of runs per mode
+    pub iterations: u64,
+    /// Number of runs per mode before the campaign may stop early
+    pub min_iterations: u64,
+    /// Stop once the 95% interval of every mode is at most this wide on each side
+    pub precision: f64,
+    /// Number of runs executed in parallel
+    pub jobs: usize,
+    /// Runs still going after this long are killed and count as missed
+    pub timeout: Duration,
+    /// Seed from which the seed of every run is derived
+    pub seed: u64,
+    /// Label of the scenario in the CSV output
+    pub label: String,
+    /// File to append one CSV row per mode to
+    pub csv: Option<PathBuf>,
+}
+
+/// Outcome of one run
+struct Run {
+    mode: usize,
+    seed: u64,
+    manifested: bool,
+    elapsed: Duration,
+}
+
+/// Results of one stress mode
+#[derive(Default)]
+struct ModeStats {
+    runs: u64,
+    manifested: u64,
+    /// Time to detection of the runs that manifested
+    detection_times: Vec<Duration>,
+    /// Seeds of the runs that manifested, for replaying them
+    seeds: Vec<u64>,
+}
+
+impl ModeStats {
+    fn rate(&self) -> f64 {
+        if self.runs == 0 {
+            0.0
+        } else {
+            self.manifested as f64 / self.runs as f64
+        }
+    }
+
+    /// Wilson score interval of the manifestation rate at 95% confidence
+    fn interval(&self) -> (f64, f64) {
+        wilson_interval(self.manifested, self.runs, Z_95)
+    }
+
+    fn detection_quantile(&self, quantile: f64) -> Option<Duration> {
+        let mut times = self.detection_times.clone();
+        times.sort_unstable();
+        let index = ((times.len() as f64 - 1.0) * quantile).round() as usize;
+        times.get(index).copied()
+    }
+}
+
+/// Wilson score interval of `successes` out of `trials`
+///
+/// Unlike the normal approximation it stays meaningful for rates near 0% or
+/// 100%, which is where deadlock scenarios under stress usually end up.
+fn wilson_interval(successes: u64, trials: u64, z: f64) -> (f64, f64) {
+    if trials == 0 {
+        return (0.0, 1.0);
+    }
+    let n = trials as f64;
+    let p = successes as f64 / n;
+    let denominator = 1.0 + z * z / n;
+    let center = (p + z * z / (2.0 * n)) / denominator;
+    let margin = z * (p * (1.0 - p) / n + z * z / (4.0 * n * n)).sqrt() / denominator;
+    ((center - margin).max(0.0), (center + margin).min(1.0))
+}
+
+/// SplitMix64 step, used to spread the campaign seed over the runs
+fn mix(value: u64) -> u64 {
+    let mut z = value.wrapping_add(0x9E37_79B9_7F4A_7C15);
+    z = (z ^ (z >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+    z = (z ^ (z >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+    z ^ (z >> 31)
+}
+
+/// Run the scenario once and wait for it, killing it after `timeout`
+fn run_once(campaign: &Campaign, mode: &str, seed: u64) -> Result<(bool, Duration)> {
+    let start = Instant::now();
+    let mut child = Command::new(&campaign.command[0])
+        .args(&campaign.command[1..])
+        .env(STRESS_MODE_ENV, mode)
+        .env(STRESS_SEED_ENV, seed.to_string())
+        .stdin(Stdio::null())
+        .stdout(Stdio::null())
+        .stderr(Stdio::null())
+        .spawn()?;
+
+    loop {
+        if let Some(status) = child.try_wait()? {
+            return Ok((status.success(), start.elapsed()));
+        }
+        if start.elapsed() >= campaign.timeout {
+            let _ = child.kill();
+            let _ = child.wait();
+            return Ok((false, start.elapsed()));
+        }
+        thread::sleep(Duration::from_millis(5));
+    }
+}
+
+impl Campaign {
+    /// Whether every mode has enough runs and a narrow enough interval
+    fn is_confident(&self, stats: &[ModeStats]) -> bool {
+        stats.iter().all(|mode| {
+            let (low, high) = mode.interval();
+            mode.runs >= self.min_iterations && (high - low) / 2.0 <= self.precision
+        })
+    }
+
+    /// Run the campaign and print its report
+    pub fn run(self) -> Result<()> {
+        if self.command.is_empty() {
+            bail!("no scenario command given");
+        }
+        if self.modes.is_empty() {
+            bail!("no stress modes given");
+        }
+
+        let campaign = Arc::new(self);
+        let total = campaign.iterations * campaign.modes.len() as u64;
+        let next_run = Arc::new(AtomicU64::new(0));
+        let stop = Arc::new(AtomicBool::new(false));
+        let (tx, rx) = mpsc::channel::<Result<Run>>();
+
+        let workers: Vec<_> = (0..campaign.jobs.max(1))
+            .map(|_| {
+                let campaign = Arc::clone(&campaign);
+                let next_run = Arc::clone(&next_run);
+                let stop = Arc::clone(&stop);
+                let tx = tx.clone();
+                thread::spawn(move || {
+                    while !stop.load(Ordering::Relaxed) {
+                        let index = next_run.fetch_add(1, Ordering::Relaxed);
+                        if index >= total {
+                            break;
+                        }
+                        // Interleave the modes so an early stop leaves them balanced
+                        let mode = (index % campaign.modes.len() as u64) as usize;
+                        let seed = mix(campaign.seed ^ index);
+                        let run = run_once(&campaign, &campaign.modes[mode], seed).map(
+                            |(manifested, elapsed)| Run {
+                                mode,
+                                seed,
+                                manifested,
+                                elapsed,
+                            },
+                        );
+                        if tx.send(run).is_err() {
+                            break;
+                        }
+                    }
+                })
+            })
+            .collect();
+        drop(tx);
+
+        let started = Instant::now();
+        let mut stats: Vec<ModeStats> = campaign.modes.iter().map(|_| Default::default()).collect();
+        for run in rx {
+            let run = run?;
+            let mode = &mut stats[run.mode];
+            mode.runs += 1;
+            if run.manifested {
+                mode.manifested += 1;
+                mode.detection_times.push(run.elapsed);
+                mode.seeds.push(run.seed);
+            }
+            if campaign.is_confident(&stats) {
+                stop.store(true, Ordering::Relaxed);
+            }
+        }
+        for worker in workers {
+            let _ = worker.join();
+        }
+
+        campaign.report(&stats, started.elapsed())
+    }
+
+    /// Print a table of the results and append them to the CSV file
+    fn report(&self, stats: &[ModeStats], elapsed: Duration) -> Result<()> {
+        let confident = self.is_confident(stats);
+        println!(
+            "{} runs in {:.1?}, {} at a time{}",
+            stats.iter().map(|mode| mode.runs).sum::<u64>(),
+            elapsed,
+            self.jobs,
+            if confident {
+                ", stopped at the requested precision"
+            } else {
+                ""
+            }
+        );
+        println!(
+            "{:<10} {:>6} {:>8} {:>16} {:>12} {:>12}",
+            "mode", "runs", "rate", "95% interval", "median", "p95"
+        );
+
+        let format_time = |time: Option<Duration>| {
+            time.map_or_else(|| "-".to_string(), |time| format!("{time:.1?}"))
+        };
+        for (name, mode) in self.modes.iter().zip(stats) {
+            let (low, high) = mode.interval();
+            println!(
+                "{:<10} {:>6} {:>7.1}% {:>7.1}%-{:>5.1}% {:>12} {:>12}",
+                name,
+                mode.runs,
+                mode.rate() * 100.0,
+                low * 100.0,
+                high * 100.0,
+                format_time(mode.detection_quantile(0.5)),
+                format_time(mode.detection_quantile(0.95)),
+            );
+        }
+        for (name, mode) in self.modes.iter().zip(stats) {
+            if !mode.seeds.is_empty() {
+                let seeds: Vec<String> = mode
+                    .seeds
+                    .iter()
+                    .take(SEEDS_SHOWN)
+                    .map(u64::to_string)
+                    .collect();
+                println!("{name} manifested with seeds {}", seeds.join(", "));
+            }
+        }
+
+        if let Some(path) = &self.csv {
+            let is_new = !path.exists();
+            let mut file = std::fs::OpenOptions::new()
+                .create(true)
+                .append(true)
+                .open(path)?;
+            if is_new {
+                writeln!(
+                    file,
+                    "scenario,mode,runs,manifested,rate,ci_low,ci_high,median_detection_ms,p95_detection_ms"
+                )?;
+            }
+            let millis = |time: Option<Duration>| {
+                time.map_or_else(String::new, |time| {
+                    format!("{:.3}", time.as_secs_f64() * 1e3)
+                })
+            };
+            for (name, mode) in self.modes.iter().zip(stats) {
+                let (low, high) = mode.interval();
+                writeln!(
+                    file,
+                    "{},{},{},{},{:.4},{:.4},{:.4},{},{}",
+                    self.label,
+                    name,
+                    mode.runs,
+                    mode.manifested,
+                    mode.rate(),
+                    low,
+                    high,
+                    millis(mode.detection_quantile(0.5)),
+                    millis(mode.detection_quantile(0.95)),
+                )?;
+            }
+        }
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_wilson_interval() {
+        let (low, high) = wilson_interval(0, 0, Z_95);
+        assert_eq!((low, high), (0.0, 1.0));
+
+        // Never collapses to a point at the extremes
+        let (low, high) = wilson_interval(50, 50, Z_95);
+        assert!(low > 0.9 && low < 1.0 && high == 1.0);
+
+        // Narrows with more trials around the observed rate
+        let (low_small, high_small) = wilson_interval(5, 10, Z_95);
+        let (low_large, high_large) = wilson_interval(500, 1000, Z_95);
+        assert!(low_small < low_large && high_large < high_small);
+        assert!(low_large < 0.5 && 0.5 < high_large);
+    }
+}
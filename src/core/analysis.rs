@@ -0,0 +1,590 @@
+//! Offline analysis of recorded logs
+//!
+//! The "lock-order-graph" feature checks every nested acquisition against
+//! the global lock order while the program runs. The same check can be done
+//! after the fact from a log, which only costs the logging at runtime: the
+//! analyzer rebuilds the locks each thread held from the acquisition and
+//! release events, derives the lock order edges, and replays them in log
+//! order through the same [`LockOrderGraph`] the detector uses. It also
+//! rebuilds each lock's ownership over time to report per-lock contention,
+//! much like the "lock-stats" feature does online.
+//!
+//! Both replays are split across threads: held sets only depend on the
+//! events of one thread and ownership only on the events of one lock, so the
+//! events are partitioned by thread and by lock and each partition is
+//! replayed on its own. JSON logs are also parsed in parallel, line ranges
+//! at a time.
+
+use crate::core::graph::LockOrderGraph;
+use crate::core::logger::binary::{self, BinaryRecord};
+use crate::core::types::{DeadlockInfo, Events, LockId, ThreadId};
+use anyhow::{Context, Result};
+use fxhash::{FxHashMap, FxHashSet};
+use serde::Deserialize;
+use std::fmt::{self, Write};
+use std::path::Path;
+use std::thread;
+use std::time::Duration;
+
+/// An event of the log
+#[derive(Debug, Clone, Copy, Deserialize)]
+struct Event {
+    sequence: u64,
+    thread_id: ThreadId,
+    lock_id: LockId,
+    event: Events,
+    /// Seconds since the Unix Epoch
+    timestamp: f64,
+}
+
+/// A line of a JSON log
+#[derive(Deserialize)]
+#[serde(untagged)]
+enum Line {
+    Event(Event),
+    Deadlock { deadlock: DeadlockInfo },
+}
+
+/// A cycle in the lock order implied by the log
+#[derive(Debug, Clone, PartialEq)]
+pub struct LockOrderInversion {
+    /// Locks of the cycle, starting and ending with the same lock
+    pub cycle: Vec<LockId>,
+    /// Thread whose acquisition closed the cycle
+    pub thread_id: ThreadId,
+    /// Sequence number of the attempt that closed the cycle
+    pub sequence: u64,
+}
+
+/// How a lock was used over the log
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct LockUsage {
+    /// ID of the lock
+    pub lock_id: LockId,
+    /// Number of acquisitions
+    pub acquisitions: u64,
+    /// Number of acquisitions attempted while another thread held the lock
+    pub contended: u64,
+    /// Total time contended acquisitions waited
+    pub total_wait: Duration,
+    /// Longest single wait
+    pub max_wait: Duration,
+    /// Total time the lock was held
+    pub total_hold: Duration,
+    /// Longest single hold
+    pub max_hold: Duration,
+    /// Number of distinct threads that acquired the lock
+    pub threads: usize,
+}
+
+/// Result of [`analyze_log`]
+#[derive(Debug, Clone, Default)]
+pub struct LogAnalysis {
+    /// Number of events in the log
+    pub events: u64,
+    /// Number of distinct threads that appear in the log
+    pub threads: usize,
+    /// Deadlock recorded in the log, if the program deadlocked
+    pub deadlock: Option<DeadlockInfo>,
+    /// Lock order cycles, in the order they were closed
+    pub inversions: Vec<LockOrderInversion>,
+    /// Usage of every lock that was acquired, most contended first
+    pub locks: Vec<LockUsage>,
+}
+
+/// Analyze a log for lock order inversions and lock contention
+///
+/// Reads JSON and binary logs. The lock order is checked per lock, like the
+/// detector's default mode; an inversion is reported once, where its cycle
+/// was first closed.
+///
+/// # Arguments
+/// * `log_path` - Path to the log file
+/// * `jobs` - Number of threads to use (at least 1)
+///
+/// # Errors
+/// Returns an error if the log cannot be read or a binary log is malformed
+///
+/// # Example
+///
+/// ```no_run
+/// let analysis = deloxide::analyze_log("deadlock.log", 4).unwrap();
+/// for inversion in &analysis.inversions {
+///     println!("Potential deadlock between locks {:?}", inversion.cycle);
+/// }
+/// print!("{}", analysis.report(10));
+/// ```
+pub fn analyze_log<P: AsRef<Path>>(log_path: P, jobs: usize) -> Result<LogAnalysis> {
+    let bytes = std::fs::read(log_path).context("Failed to open log file")?;
+    let jobs = jobs.max(1);
+
+    let (mut events, deadlock) = if binary::is_binary_log(&bytes) {
+        decode_binary(&bytes)?
+    } else {
+        parse_json(&bytes, jobs)
+    };
+    events.sort_unstable_by_key(|event| event.sequence);
+
+    let by_thread = partition(&events, jobs, |event| event.thread_id);
+    let by_lock = partition(&events, jobs, |event| event.lock_id);
+    let (edges, usages) = thread::scope(|scope| {
+        let edges: Vec<_> = by_thread
+            .iter()
+            .map(|events| scope.spawn(|| order_edges(events)))
+            .collect();
+        let usages: Vec<_> = by_lock
+            .iter()
+            .map(|events| scope.spawn(|| lock_usage(events)))
+            .collect();
+        (
+            edges
+                .into_iter()
+                .map(|handle| handle.join().unwrap())
+                .collect::<Vec<_>>(),
+            usages
+                .into_iter()
+                .map(|handle| handle.join().unwrap())
+                .collect::<Vec<_>>(),
+        )
+    });
+
+    let mut locks: Vec<LockUsage> = usages.into_iter().flatten().collect();
+    locks.sort_by(|a, b| {
+        b.total_wait
+            .cmp(&a.total_wait)
+            .then(b.contended.cmp(&a.contended))
+            .then(b.acquisitions.cmp(&a.acquisitions))
+            .then(a.lock_id.cmp(&b.lock_id))
+    });
+
+    let threads: FxHashSet<ThreadId> = events
+        .iter()
+        .map(|event| event.thread_id)
+        .filter(|&thread_id| thread_id != 0)
+        .collect();
+    Ok(LogAnalysis {
+        events: events.len() as u64,
+        threads: threads.len(),
+        deadlock,
+        inversions: find_inversions(edges.into_iter().flatten().collect(), &events),
+        locks,
+    })
+}
+
+/// Decode the events of a binary log
+///
+/// Records are delta encoded, so this part is sequential.
+fn decode_binary(bytes: &[u8]) -> Result<(Vec<Event>, Option<DeadlockInfo>)> {
+    let mut events = Vec::new();
+    let mut deadlock = None;
+    for record in binary::decode(bytes).context("Failed to decode binary log")? {
+        match record {
+            BinaryRecord::Event(e) => events.push(Event {
+                sequence: e.sequence,
+                thread_id: e.thread_id as ThreadId,
+                lock_id: e.lock_id as LockId,
+                event: e.event,
+                timestamp: e.timestamp,
+            }),
+            BinaryRecord::Deadlock(info) => deadlock = Some(*info),
+        }
+    }
+    Ok((events, deadlock))
+}
+
+/// Parse the lines of a JSON log, `jobs` ranges of lines in parallel
+///
+/// Lines that are neither an event nor a deadlock record are skipped.
+fn parse_json(bytes: &[u8], jobs: usize) -> (Vec<Event>, Option<DeadlockInfo>) {
+    // Cut the file into ranges of whole lines
+    let mut ranges = Vec::with_capacity(jobs);
+    let mut start = 0;
+    for job in 1..=jobs {
+        let mut end = (bytes.len() * job / jobs).max(start);
+        while end > 0 && end < bytes.len() && bytes[end - 1] != b'\n' {
+            end += 1;
+        }
+        ranges.push(&bytes[start..end]);
+        start = end;
+    }
+
+    let parsed: Vec<_> = thread::scope(|scope| {
+        let handles: Vec<_> = ranges
+            .into_iter()
+            .map(|range| {
+                scope.spawn(move || {
+                    let mut events = Vec::new();
+                    let mut deadlock = None;
+                    for line in range.split(|&byte| byte == b'\n') {
+                        match serde_json::from_slice::<Line>(line) {
+                            Ok(Line::Event(event)) => events.push(event),
+                            Ok(Line::Deadlock { deadlock: info }) => deadlock = Some(info),
+                            Err(_) => {}
+                        }
+                    }
+                    (events, deadlock)
+                })
+            })
+            .collect();
+        handles
+            .into_iter()
+            .map(|handle| handle.join().unwrap())
+            .collect()
+    });
+
+    let mut events = Vec::new();
+    let mut deadlock = None;
+    for (range_events, range_deadlock) in parsed {
+        events.extend(range_events);
+        deadlock = range_deadlock.or(deadlock);
+    }
+    (events, deadlock)
+}
+
+/// Split events into `parts` groups by `key`, keeping their order
+fn partition(events: &[Event], parts: usize, key: impl Fn(&Event) -> usize) -> Vec<Vec<&Event>> {
+    let mut groups = vec![Vec::new(); parts];
+    for event in events {
+        groups[fxhash::hash(&key(event)) % parts].push(event);
+    }
+    groups
+}
+
+/// A lock order edge `(before, after)` and where a thread first took it
+type OrderEdges = FxHashMap<(LockId, LockId), (u64, ThreadId)>;
+
+/// Lock order edges of the threads of one partition
+///
+/// Every attempt to acquire a lock while holding others orders the held
+/// locks before it, as in the detector's lock order check.
+fn order_edges(events: &[&Event]) -> OrderEdges {
+    let mut held: FxHashMap<ThreadId, Vec<LockId>> = FxHashMap::default();
+    let mut edges = OrderEdges::default();
+    for event in events {
+        match event.event {
+            Events::MutexAttempt | Events::RwReadAttempt | Events::RwWriteAttempt => {
+                if let Some(held) = held.get(&event.thread_id) {
+                    for &before in held {
+                        if before != event.lock_id {
+                            edges
+                                .entry((before, event.lock_id))
+                                .or_insert((event.sequence, event.thread_id));
+                        }
+                    }
+                }
+            }
+            Events::MutexAcquired | Events::RwReadAcquired | Events::RwWriteAcquired => {
+                held.entry(event.thread_id).or_default().push(event.lock_id);
+            }
+            Events::MutexReleased | Events::RwReadReleased | Events::RwWriteReleased => {
+                if let Some(held) = held.get_mut(&event.thread_id)
+                    && let Some(index) = held.iter().rposition(|&lock| lock == event.lock_id)
+                {
+                    held.remove(index);
+                }
+            }
+            Events::ThreadExit => {
+                held.remove(&event.thread_id);
+            }
+            _ => {}
+        }
+    }
+    edges
+}
+
+/// Replay the lock order edges through a lock order graph in log order
+///
+/// Destroyed locks leave the graph when they are destroyed, as they do in
+/// the detector, so only orders among locks alive at the same time count.
+fn find_inversions(edges: OrderEdges, events: &[Event]) -> Vec<LockOrderInversion> {
+    enum Step {
+        Edge(LockId, LockId, ThreadId),
+        Destroyed(LockId),
+    }
+    let mut steps: Vec<(u64, Step)> = edges
+        .into_iter()
+        .map(|((before, after), (sequence, thread_id))| {
+            (sequence, Step::Edge(before, after, thread_id))
+        })
+        .collect();
+    steps.extend(
+        events
+            .iter()
+            .filter(|event| {
+                matches!(
+                    event.event,
+                    Events::MutexExit | Events::RwExit | Events::CondvarExit
+                )
+            })
+            .map(|event| (event.sequence, Step::Destroyed(event.lock_id))),
+    );
+    // Edges taken at the same attempt keep a stable order
+    steps.sort_by_key(|&(sequence, _)| sequence);
+
+    let mut graph = LockOrderGraph::new();
+    let mut inversions = Vec::new();
+    for (sequence, step) in steps {
+        match step {
+            Step::Edge(before, after, thread_id) => {
+                if let Some(cycle) = graph.add_edge(before, after) {
+                    inversions.push(LockOrderInversion {
+                        cycle,
+                        thread_id,
+                        sequence,
+                    });
+                }
+            }
+            Step::Destroyed(lock_id) => graph.remove_lock(lock_id),
+        }
+    }
+    inversions
+}
+
+/// Ownership of one lock while replaying its events
+#[derive(Default)]
+struct LockReplay {
+    usage: LockUsage,
+    writer: Option<ThreadId>,
+    readers: FxHashMap<ThreadId, usize>,
+    /// Pending attempts: when they started and whether another thread held the lock
+    attempts: FxHashMap<ThreadId, (f64, bool)>,
+    /// Acquisition times of the holds of each thread, most recent last
+    holds: FxHashMap<ThreadId, Vec<f64>>,
+    threads: FxHashSet<ThreadId>,
+}
+
+impl LockReplay {
+    fn held_by_others(&self, thread_id: ThreadId, shared: bool) -> bool {
+        self.writer.is_some_and(|writer| writer != thread_id)
+            || (!shared && self.readers.keys().any(|&reader| reader != thread_id))
+    }
+}
+
+fn seconds(from: f64, to: f64) -> Duration {
+    Duration::try_from_secs_f64(to - from).unwrap_or_default()
+}
+
+/// Usage of the locks of one partition
+fn lock_usage(events: &[&Event]) -> Vec<LockUsage> {
+    let mut locks: FxHashMap<LockId, LockReplay> = FxHashMap::default();
+    for event in events {
+        let thread_id = event.thread_id;
+        let (shared, exclusive) = match event.event {
+            Events::MutexAttempt | Events::RwWriteAttempt => {
+                let lock = locks.entry(event.lock_id).or_default();
+                let contended = lock.held_by_others(thread_id, false);
+                lock.attempts
+                    .insert(thread_id, (event.timestamp, contended));
+                continue;
+            }
+            Events::RwReadAttempt => {
+                let lock = locks.entry(event.lock_id).or_default();
+                let contended = lock.held_by_others(thread_id, true);
+                lock.attempts
+                    .insert(thread_id, (event.timestamp, contended));
+                continue;
+            }
+            Events::MutexAcquired | Events::RwWriteAcquired => (false, true),
+            Events::RwReadAcquired => (true, true),
+            Events::MutexReleased | Events::RwWriteReleased => (false, false),
+            Events::RwReadReleased => (true, false),
+            _ => continue,
+        };
+        let lock = locks.entry(event.lock_id).or_default();
+
+        if exclusive {
+            // Acquired
+            lock.usage.acquisitions += 1;
+            lock.threads.insert(thread_id);
+            if let Some((started, contended)) = lock.attempts.remove(&thread_id)
+                && contended
+            {
+                let waited = seconds(started, event.timestamp);
+                lock.usage.contended += 1;
+                lock.usage.total_wait += waited;
+                lock.usage.max_wait = lock.usage.max_wait.max(waited);
+            }
+            if shared {
+                *lock.readers.entry(thread_id).or_default() += 1;
+            } else {
+                lock.writer = Some(thread_id);
+            }
+            lock.holds
+                .entry(thread_id)
+                .or_default()
+                .push(event.timestamp);
+        } else {
+            // Released
+            if shared {
+                if let Some(count) = lock.readers.get_mut(&thread_id) {
+                    *count -= 1;
+                    if *count == 0 {
+                        lock.readers.remove(&thread_id);
+                    }
+                }
+            } else if lock.writer == Some(thread_id) {
+                lock.writer = None;
+            }
+            if let Some(acquired) = lock.holds.get_mut(&thread_id).and_then(Vec::pop) {
+                let held = seconds(acquired, event.timestamp);
+                lock.usage.total_hold += held;
+                lock.usage.max_hold = lock.usage.max_hold.max(held);
+            }
+        }
+    }
+
+    locks
+        .into_iter()
+        .filter(|(_, lock)| lock.usage.acquisitions > 0)
+        .map(|(lock_id, lock)| LockUsage {
+            lock_id,
+            threads: lock.threads.len(),
+            ..lock.usage
+        })
+        .collect()
+}
+
+impl LogAnalysis {
+    /// Render the inversions and the `top` most contended locks as text
+    pub fn report(&self, top: usize) -> String {
+        let mut report = format!(
+            "{} events from {} threads on {} locks\n",
+            self.events,
+            self.threads,
+            self.locks.len()
+        );
+        if let Some(deadlock) = &self.deadlock {
+            let _ = writeln!(
+                report,
+                "Deadlock recorded at {} between threads {:?}",
+                deadlock.timestamp, deadlock.thread_cycle
+            );
+        }
+
+        if self.inversions.is_empty() {
+            report.push_str("\nNo lock order inversions\n");
+        } else {
+            let _ = writeln!(
+                report,
+                "\nLock order inversions ({}):",
+                self.inversions.len()
+            );
+            for inversion in &self.inversions {
+                let cycle: Vec<String> = inversion
+                    .cycle
+                    .iter()
+                    .map(|lock| format!("lock {lock}"))
+                    .collect();
+                let _ = writeln!(
+                    report,
+                    "  {}  (closed by thread {} at event #{})",
+                    cycle.join(" -> "),
+                    inversion.thread_id,
+                    inversion.sequence
+                );
+            }
+        }
+
+        let _ = writeln!(
+            report,
+            "\n{:>8}  {:>12}  {:>10}  {:>12}  {:>12}  {:>12}  {:>12}  {:>7}",
+            "lock",
+            "acquisitions",
+            "contended",
+            "total wait",
+            "max wait",
+            "total hold",
+            "max hold",
+            "threads"
+        );
+        for lock in self.locks.iter().take(top) {
+            let _ = writeln!(
+                report,
+                "{:>8}  {:>12}  {:>10}  {:>12}  {:>12}  {:>12}  {:>12}  {:>7}",
+                lock.lock_id,
+                lock.acquisitions,
+                lock.contended,
+                format!("{:.1?}", lock.total_wait),
+                format!("{:.1?}", lock.max_wait),
+                format!("{:.1?}", lock.total_hold),
+                format!("{:.1?}", lock.max_hold),
+                lock.threads,
+            );
+        }
+        report
+    }
+}
+
+impl fmt::Display for LogAnalysis {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.write_str(&self.report(self.locks.len()))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+
+    #[test]
+    fn test_inversions_and_contention_from_a_json_log() {
+        let mut log = tempfile::NamedTempFile::new().unwrap();
+        let mut sequence = 0;
+        let mut event = |thread_id: usize, lock_id: usize, event: &str, timestamp: f64| {
+            sequence += 1;
+            writeln!(
+                log,
+                r#"{{"sequence":{sequence},"thread_id":{thread_id},"lock_id":{lock_id},"event":"{event}","timestamp":{timestamp},"parent_id":null}}"#
+            )
+            .unwrap();
+        };
+        // Thread 1 takes 1 then 2, thread 2 later takes 2 then 1: never
+        // deadlocked, but the order is inverted
+        event(1, 1, "MutexAttempt", 0.0);
+        event(1, 1, "MutexAcquired", 0.0);
+        event(1, 2, "MutexAttempt", 0.0);
+        event(1, 2, "MutexAcquired", 0.0);
+        // Thread 2 waits half a second for lock 2
+        event(2, 2, "MutexAttempt", 1.0);
+        event(1, 2, "MutexReleased", 1.5);
+        event(1, 1, "MutexReleased", 1.5);
+        event(2, 2, "MutexAcquired", 1.5);
+        event(2, 1, "MutexAttempt", 1.5);
+        event(2, 1, "MutexAcquired", 1.5);
+        event(2, 1, "MutexReleased", 2.0);
+        event(2, 2, "MutexReleased", 2.0);
+        // Readers do not contend with each other
+        event(1, 3, "RwReadAttempt", 3.0);
+        event(1, 3, "RwReadAcquired", 3.0);
+        event(2, 3, "RwReadAttempt", 3.0);
+        event(2, 3, "RwReadAcquired", 3.5);
+        log.flush().unwrap();
+
+        for jobs in [1, 3, 64] {
+            let analysis = analyze_log(log.path(), jobs).unwrap();
+            assert_eq!(analysis.events, 16);
+            assert_eq!(analysis.threads, 2);
+            assert_eq!(
+                analysis.inversions,
+                [LockOrderInversion {
+                    cycle: vec![1, 2, 1],
+                    thread_id: 2,
+                    sequence: 9,
+                }]
+            );
+
+            let lock_2 = &analysis.locks[0];
+            assert_eq!(lock_2.lock_id, 2);
+            assert_eq!((lock_2.acquisitions, lock_2.contended), (2, 1));
+            assert_eq!(lock_2.max_wait, Duration::from_millis(500));
+            assert_eq!(lock_2.total_hold, Duration::from_millis(2000));
+            assert_eq!(lock_2.threads, 2);
+            let lock_3 = analysis
+                .locks
+                .iter()
+                .find(|lock| lock.lock_id == 3)
+                .unwrap();
+            assert_eq!((lock_3.acquisitions, lock_3.contended), (2, 0));
+        }
+    }
+}
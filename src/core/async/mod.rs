@@ -0,0 +1,212 @@
+//! Tracked locks for async code
+//!
+//! [`Mutex`] and [`RwLock`] are the async counterparts of the tracked locks:
+//! awaiting a contended lock returns `Poll::Pending` and wakes the task once
+//! the lock is released, instead of parking the thread the executor runs on.
+//! They only use `std::task::Waker`, so they work with any executor.
+//!
+//! On an executor many tasks share a thread, so the detector has to tell
+//! them apart. Wrap each task in [`track`] before spawning it: the task then
+//! gets an ID of its own, from the same space as thread IDs, and shows up in
+//! the wait-for graph, the logs and `DeadlockInfo::thread_cycle` like a
+//! thread would. Two tasks that deadlock on one worker thread are reported
+//! just like two deadlocked threads. Outside a tracked task, the locks use
+//! the ID of the current thread.
+//!
+//! Async locks are always tracked: sampling does not apply to them, and
+//! their acquisitions are not counted by lock statistics.
+//!
+//! # Example
+//!
+//! ```rust
+//! use deloxide::r#async::{Mutex, track};
+//! use std::sync::Arc;
+//!
+//! let counter = Arc::new(Mutex::new(0));
+//! let task = {
+//!     let counter = Arc::clone(&counter);
+//!     track(async move {
+//!         *counter.lock().await += 1;
+//!     })
+//! };
+//! // Hand `task` to the executor, e.g. `tokio::spawn(task)`
+//! # drop(task);
+//! ```
+
+mod mutex;
+mod rwlock;
+
+pub use mutex::{Mutex, MutexGuard, MutexLockFuture};
+pub use rwlock::{RwLock, RwLockReadFuture, RwLockReadGuard, RwLockWriteFuture, RwLockWriteGuard};
+
+use crate::core::detector;
+use crate::core::types::{ThreadId, get_current_thread_id, next_task_id};
+use std::cell::Cell;
+use std::collections::VecDeque;
+use std::future::Future;
+use std::mem::ManuallyDrop;
+use std::pin::Pin;
+use std::task::{Context, Poll, Waker};
+
+thread_local! {
+    // Task being polled on this thread, if it is tracked
+    static CURRENT_TASK: Cell<Option<ThreadId>> = const { Cell::new(None) };
+}
+
+/// Get the ID the detector knows the current task by
+///
+/// # Returns
+/// The ID of the tracked task being polled on this thread, or the ID of the
+/// thread outside of one
+pub fn current_task_id() -> ThreadId {
+    CURRENT_TASK
+        .with(Cell::get)
+        .unwrap_or_else(get_current_thread_id)
+}
+
+/// Give a future a task identity of its own
+///
+/// The task is registered with the detector as spawned by the current task
+/// (or thread), and as exited once the returned future is dropped, whether it
+/// completed or not.
+///
+/// # Arguments
+/// * `future` - The future of the task
+///
+/// # Returns
+/// A future that polls `future` as the new task
+pub fn track<F: Future>(future: F) -> Tracked<F> {
+    let task_id = next_task_id();
+    detector::thread::spawn_thread(task_id, Some(current_task_id()));
+    Tracked {
+        task_id,
+        future: ManuallyDrop::new(future),
+    }
+}
+
+/// Future returned by [`track`]
+pub struct Tracked<F: Future> {
+    /// ID of the task
+    task_id: ThreadId,
+    /// The future of the task, dropped before the task exits
+    future: ManuallyDrop<F>,
+}
+
+impl<F: Future> Tracked<F> {
+    /// Get the ID of this task
+    ///
+    /// # Returns
+    /// The ID the detector knows the task by
+    pub fn task_id(&self) -> ThreadId {
+        self.task_id
+    }
+}
+
+impl<F: Future> Future for Tracked<F> {
+    type Output = F::Output;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<F::Output> {
+        let _enter = Enter::new(self.task_id);
+        // Safety: the future is pinned along with `self` and is only ever
+        // dropped in place, in `drop`
+        unsafe { self.map_unchecked_mut(|tracked| &mut *tracked.future) }.poll(cx)
+    }
+}
+
+impl<F: Future> Drop for Tracked<F> {
+    fn drop(&mut self) {
+        {
+            let _enter = Enter::new(self.task_id);
+            // Safety: the future is never used again
+            unsafe { ManuallyDrop::drop(&mut self.future) };
+        }
+        detector::thread::exit_thread(self.task_id);
+    }
+}
+
+/// Makes a task the current one until dropped, even if polling panics
+struct Enter {
+    previous: Option<ThreadId>,
+}
+
+impl Enter {
+    fn new(task_id: ThreadId) -> Self {
+        Enter {
+            previous: CURRENT_TASK.with(|current| current.replace(Some(task_id))),
+        }
+    }
+}
+
+impl Drop for Enter {
+    fn drop(&mut self) {
+        CURRENT_TASK.with(|current| current.set(self.previous));
+    }
+}
+
+/// Tasks waiting for an async lock, in arrival order
+///
+/// An entry stays in the queue until its future acquires the lock or is
+/// dropped. Waking it takes its waker, which tells the future on its next
+/// poll that the lock was released in the meantime.
+#[derive(Default)]
+struct Waiters {
+    /// Key of the next entry
+    next_key: usize,
+    /// Key of each waiting future and its waker, `None` once woken
+    queue: VecDeque<(usize, Option<Waker>)>,
+}
+
+impl Waiters {
+    /// Add or refresh the entry of a waiting future
+    ///
+    /// # Arguments
+    /// * `key` - Key of the future's entry, assigned on its first wait
+    /// * `waker` - Waker of the task
+    ///
+    /// # Returns
+    /// Whether the entry was woken since it last waited
+    fn register(&mut self, key: &mut Option<usize>, waker: &Waker) -> bool {
+        if let Some(entry) = key.and_then(|key| self.queue.iter_mut().find(|(k, _)| *k == key)) {
+            let woken = entry.1.is_none();
+            match &mut entry.1 {
+                Some(registered) => registered.clone_from(waker),
+                None => entry.1 = Some(waker.clone()),
+            }
+            return woken;
+        }
+
+        let new_key = self.next_key;
+        self.next_key = self.next_key.wrapping_add(1);
+        self.queue.push_back((new_key, Some(waker.clone())));
+        *key = Some(new_key);
+        false
+    }
+
+    /// Remove the entry of a future that stopped waiting
+    ///
+    /// # Returns
+    /// Whether the entry was woken, in which case the wake-up has to be
+    /// passed on to another waiter
+    fn remove(&mut self, key: usize) -> bool {
+        match self.queue.iter().position(|(k, _)| *k == key) {
+            Some(index) => self
+                .queue
+                .remove(index)
+                .is_some_and(|(_, waker)| waker.is_none()),
+            None => false,
+        }
+    }
+
+    /// Take the waker of the first waiter not woken yet
+    fn wake_one(&mut self) -> Option<Waker> {
+        self.queue.iter_mut().find_map(|(_, waker)| waker.take())
+    }
+
+    /// Take the wakers of all waiters not woken yet
+    fn wake_all(&mut self) -> Vec<Waker> {
+        self.queue
+            .iter_mut()
+            .filter_map(|(_, waker)| waker.take())
+            .collect()
+    }
+}
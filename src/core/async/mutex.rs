@@ -0,0 +1,320 @@
+use super::{Waiters, current_task_id};
+use crate::core::Events;
+use crate::core::detector;
+use crate::core::locks::next_lock_id;
+use crate::core::logger;
+use crate::core::types::{LockId, ThreadId};
+use parking_lot::Mutex as ParkingLotMutex;
+use std::cell::UnsafeCell;
+use std::future::Future;
+use std::ops::{Deref, DerefMut};
+#[cfg(feature = "lock-order-graph")]
+use std::panic::Location;
+use std::pin::Pin;
+use std::task::{Context, Poll};
+
+/// An async mutex that tracks lock operations for deadlock detection
+///
+/// Awaiting [`Mutex::lock`] yields to the executor while another task holds
+/// the lock. Waits and acquisitions are reported to the detector under the
+/// ID of the current task (see [`track`](super::track)), so the guard may be
+/// held across await points and moved between threads along with its task.
+///
+/// # Example
+///
+/// ```rust
+/// use deloxide::r#async::Mutex;
+///
+/// async fn increment(counter: &Mutex<u32>) {
+///     let mut value = counter.lock().await;
+///     *value += 1;
+/// }
+/// ```
+pub struct Mutex<T> {
+    /// Unique identifier for this mutex
+    id: LockId,
+    /// Thread that created this mutex
+    creator_thread_id: ThreadId,
+    /// Owner and waiting tasks
+    state: ParkingLotMutex<State>,
+    /// The protected value
+    data: UnsafeCell<T>,
+}
+
+/// Owner and waiting tasks of an async Mutex
+struct State {
+    /// Task holding the lock
+    owner: Option<ThreadId>,
+    /// Tasks waiting for the lock
+    waiters: Waiters,
+}
+
+// Safety: access to `data` is serialized by `state.owner`
+unsafe impl<T: Send> Send for Mutex<T> {}
+unsafe impl<T: Send> Sync for Mutex<T> {}
+
+/// Guard for an async Mutex, reports lock release when dropped
+pub struct MutexGuard<'a, T> {
+    /// The locked mutex
+    mutex: &'a Mutex<T>,
+    /// Task that owns this guard
+    task_id: ThreadId,
+}
+
+// Safety: the guard only hands out references to the value
+unsafe impl<T: Sync> Sync for MutexGuard<'_, T> {}
+
+/// Future returned by [`Mutex::lock`]
+///
+/// Dropping it before it completes withdraws the wait from the detector.
+pub struct MutexLockFuture<'a, T> {
+    /// The mutex to lock
+    mutex: &'a Mutex<T>,
+    /// Task that polls this future, known from the first poll
+    task_id: Option<ThreadId>,
+    /// Entry of this future among the waiters
+    key: Option<usize>,
+    /// Whether the wait was reported to the detector
+    reported: bool,
+}
+
+impl<T> Mutex<T> {
+    /// Create a new async Mutex with an automatically assigned ID
+    ///
+    /// The caller's source location becomes the lock's class when lock order
+    /// checking is keyed by class (see `Deloxide::with_lock_class_ordering`).
+    ///
+    /// # Arguments
+    /// * `value` - The initial value to store in the mutex
+    ///
+    /// # Returns
+    /// A new Mutex containing the provided value
+    #[track_caller]
+    pub fn new(value: T) -> Self {
+        let id = next_lock_id();
+        let creator_thread_id = current_task_id();
+
+        detector::mutex::create_mutex(id, Some(creator_thread_id));
+
+        // Locks created at the same call site share a lock order class
+        #[cfg(feature = "lock-order-graph")]
+        detector::set_lock_class(
+            id,
+            detector::lock_class::LockClass::Site(Location::caller()),
+        );
+
+        Mutex {
+            id,
+            creator_thread_id,
+            state: ParkingLotMutex::new(State {
+                owner: None,
+                waiters: Waiters::default(),
+            }),
+            data: UnsafeCell::new(value),
+        }
+    }
+
+    /// Get the ID of this mutex
+    ///
+    /// # Returns
+    /// The unique identifier assigned to this mutex
+    pub fn id(&self) -> LockId {
+        self.id
+    }
+
+    /// Get the ID of the task or thread that created this mutex
+    ///
+    /// # Returns
+    /// The ID of the creator
+    pub fn creator_thread_id(&self) -> ThreadId {
+        self.creator_thread_id
+    }
+
+    /// Acquire the lock, yielding to the executor while it is held
+    ///
+    /// While the task waits, the detector has an edge from it to the owner of
+    /// the lock, so a cycle of tasks (or tasks and threads) waiting for each
+    /// other is reported as a deadlock.
+    ///
+    /// # Returns
+    /// A future that resolves to the guard
+    pub fn lock(&self) -> MutexLockFuture<'_, T> {
+        MutexLockFuture {
+            mutex: self,
+            task_id: None,
+            key: None,
+            reported: false,
+        }
+    }
+
+    /// Try to acquire the lock without waiting
+    ///
+    /// A failed attempt leaves no trace in the detector, since the task does
+    /// not wait.
+    ///
+    /// # Returns
+    /// Some(guard) if successful, None if the lock is held
+    pub fn try_lock(&self) -> Option<MutexGuard<'_, T>> {
+        let task_id = current_task_id();
+        let mut state = self.state.lock();
+        if state.owner.is_some() {
+            return None;
+        }
+        state.owner = Some(task_id);
+        logger::log_interaction_event(task_id, self.id, Events::MutexAttempt);
+        detector::mutex::complete_acquire(task_id, self.id);
+        drop(state);
+
+        Some(MutexGuard {
+            mutex: self,
+            task_id,
+        })
+    }
+
+    /// Consumes this mutex, returning the underlying data
+    pub fn into_inner(self) -> T {
+        detector::mutex::destroy_mutex(self.id);
+
+        // Use ManuallyDrop to prevent the automatic Drop implementation
+        let mutex = std::mem::ManuallyDrop::new(self);
+
+        // Safety: We're taking ownership and preventing double-drop
+        unsafe {
+            drop(std::ptr::read(&mutex.state));
+            std::ptr::read(&mutex.data).into_inner()
+        }
+    }
+
+    /// Returns a mutable reference to the underlying data
+    ///
+    /// Since this call borrows the Mutex mutably, no actual locking needs to
+    /// take place – the mutable borrow statically guarantees no locks exist.
+    pub fn get_mut(&mut self) -> &mut T {
+        self.data.get_mut()
+    }
+}
+
+impl<'a, T> Future for MutexLockFuture<'a, T> {
+    type Output = MutexGuard<'a, T>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<MutexGuard<'a, T>> {
+        let this = self.get_mut();
+        let mutex = this.mutex;
+        let task_id = *this.task_id.get_or_insert_with(current_task_id);
+
+        let mut state = mutex.state.lock();
+        if state.owner.is_none() {
+            state.owner = Some(task_id);
+            if let Some(key) = this.key.take() {
+                state.waiters.remove(key);
+            }
+            if !this.reported {
+                logger::log_interaction_event(task_id, mutex.id, Events::MutexAttempt);
+            }
+            this.reported = false;
+            detector::mutex::complete_acquire(task_id, mutex.id);
+            drop(state);
+
+            return Poll::Ready(MutexGuard { mutex, task_id });
+        }
+
+        // The release that woke this future cleared its wait-for edge, and
+        // the lock has a new owner by now
+        let woken = state.waiters.register(&mut this.key, cx.waker());
+        let deadlock_info = if !this.reported || woken {
+            this.reported = true;
+            detector::mutex::acquire_slow(task_id, mutex.id, state.owner)
+        } else {
+            None
+        };
+        drop(state);
+
+        if let Some(info) = deadlock_info {
+            detector::deadlock_handling::process_deadlock(info);
+        }
+        Poll::Pending
+    }
+}
+
+impl<T> Drop for MutexLockFuture<'_, T> {
+    fn drop(&mut self) {
+        let Some(key) = self.key else {
+            return;
+        };
+
+        let waker = {
+            let mut state = self.mutex.state.lock();
+            let woken = state.waiters.remove(key);
+            if self.reported
+                && let Some(task_id) = self.task_id
+            {
+                detector::mutex::cancel_wait(task_id, self.mutex.id);
+            }
+            // Pass on a wake-up this future will not use
+            if woken && state.owner.is_none() {
+                state.waiters.wake_one()
+            } else {
+                None
+            }
+        };
+
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
+impl<T> Drop for Mutex<T> {
+    fn drop(&mut self) {
+        // Register the lock destruction with the detector
+        detector::mutex::destroy_mutex(self.id);
+    }
+}
+
+impl<T> Deref for MutexGuard<'_, T> {
+    type Target = T;
+
+    fn deref(&self) -> &T {
+        // Safety: the guard owns the lock
+        unsafe { &*self.mutex.data.get() }
+    }
+}
+
+impl<T> DerefMut for MutexGuard<'_, T> {
+    fn deref_mut(&mut self) -> &mut T {
+        // Safety: the guard owns the lock
+        unsafe { &mut *self.mutex.data.get() }
+    }
+}
+
+impl<T> Drop for MutexGuard<'_, T> {
+    fn drop(&mut self) {
+        let waker = {
+            let mut state = self.mutex.state.lock();
+            state.owner = None;
+            detector::mutex::release_mutex(self.task_id, self.mutex.id);
+            state.waiters.wake_one()
+        };
+
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
+impl<T: Default> Default for Mutex<T> {
+    /// Creates a `Mutex<T>`, with the Default value for T
+    #[track_caller]
+    fn default() -> Mutex<T> {
+        Mutex::new(Default::default())
+    }
+}
+
+impl<T> From<T> for Mutex<T> {
+    /// Creates a new mutex in an unlocked state ready for use
+    /// This is equivalent to Mutex::new
+    #[track_caller]
+    fn from(t: T) -> Self {
+        Mutex::new(t)
+    }
+}
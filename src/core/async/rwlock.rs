@@ -0,0 +1,480 @@
+use super::{Waiters, current_task_id};
+use crate::core::Events;
+use crate::core::detector;
+use crate::core::locks::next_lock_id;
+use crate::core::logger;
+use crate::core::types::{LockId, ThreadId};
+use parking_lot::Mutex as ParkingLotMutex;
+use std::cell::UnsafeCell;
+use std::future::Future;
+use std::ops::{Deref, DerefMut};
+#[cfg(feature = "lock-order-graph")]
+use std::panic::Location;
+use std::pin::Pin;
+use std::task::{Context, Poll, Waker};
+
+/// An async reader-writer lock that tracks operations for deadlock detection
+///
+/// Awaiting [`RwLock::read`] or [`RwLock::write`] yields to the executor
+/// while the lock is held in a conflicting mode. Writers are preferred: once
+/// a writer waits, new readers wait behind it, so a stream of readers cannot
+/// starve it. As with [`Mutex`](super::Mutex), everything is reported under
+/// the ID of the current task.
+///
+/// # Example
+///
+/// ```rust
+/// use deloxide::r#async::RwLock;
+///
+/// async fn update(config: &RwLock<String>) {
+///     if config.read().await.is_empty() {
+///         *config.write().await = "default".to_string();
+///     }
+/// }
+/// ```
+pub struct RwLock<T> {
+    /// Unique identifier for this lock
+    id: LockId,
+    /// Thread that created this lock
+    creator_thread_id: ThreadId,
+    /// Holders and waiting tasks
+    state: ParkingLotMutex<State>,
+    /// The protected value
+    data: UnsafeCell<T>,
+}
+
+/// Holders and waiting tasks of an async RwLock
+#[derive(Default)]
+struct State {
+    /// Task holding the write lock
+    writer: Option<ThreadId>,
+    /// Number of read guards
+    readers: usize,
+    /// Number of writers waiting, which keep new readers out
+    queued_writers: usize,
+    /// Tasks waiting for the lock
+    waiters: Waiters,
+}
+
+// Safety: access to `data` is serialized by `state`, like a std RwLock
+unsafe impl<T: Send> Send for RwLock<T> {}
+unsafe impl<T: Send + Sync> Sync for RwLock<T> {}
+
+/// Guard for a read lock on an async RwLock, reports release when dropped
+pub struct RwLockReadGuard<'a, T> {
+    /// The locked RwLock
+    lock: &'a RwLock<T>,
+    /// Task that owns this guard
+    task_id: ThreadId,
+}
+
+/// Guard for a write lock on an async RwLock, reports release when dropped
+pub struct RwLockWriteGuard<'a, T> {
+    /// The locked RwLock
+    lock: &'a RwLock<T>,
+    /// Task that owns this guard
+    task_id: ThreadId,
+}
+
+// Safety: the guards only hand out references to the value
+unsafe impl<T: Sync> Sync for RwLockReadGuard<'_, T> {}
+unsafe impl<T: Sync> Sync for RwLockWriteGuard<'_, T> {}
+
+/// Future returned by [`RwLock::read`]
+///
+/// Dropping it before it completes withdraws the wait from the detector.
+pub struct RwLockReadFuture<'a, T> {
+    /// The lock to acquire
+    lock: &'a RwLock<T>,
+    /// Task that polls this future, known from the first poll
+    task_id: Option<ThreadId>,
+    /// Entry of this future among the waiters
+    key: Option<usize>,
+    /// Whether the wait was reported to the detector
+    reported: bool,
+}
+
+/// Future returned by [`RwLock::write`]
+///
+/// Dropping it before it completes withdraws the wait from the detector.
+pub struct RwLockWriteFuture<'a, T> {
+    /// The lock to acquire
+    lock: &'a RwLock<T>,
+    /// Task that polls this future, known from the first poll
+    task_id: Option<ThreadId>,
+    /// Entry of this future among the waiters
+    key: Option<usize>,
+    /// Whether the wait was reported to the detector
+    reported: bool,
+    /// Whether this writer counts among `queued_writers`
+    queued: bool,
+}
+
+impl<T> RwLock<T> {
+    /// Create a new async RwLock with an automatically assigned ID
+    ///
+    /// The caller's source location becomes the lock's class when lock order
+    /// checking is keyed by class (see `Deloxide::with_lock_class_ordering`).
+    ///
+    /// # Arguments
+    /// * `value` - The initial value to store in the lock
+    ///
+    /// # Returns
+    /// A new RwLock containing the provided value
+    #[track_caller]
+    pub fn new(value: T) -> Self {
+        let id = next_lock_id();
+        let creator_thread_id = current_task_id();
+
+        detector::rwlock::create_rwlock(id, Some(creator_thread_id));
+
+        // Locks created at the same call site share a lock order class
+        #[cfg(feature = "lock-order-graph")]
+        detector::set_lock_class(
+            id,
+            detector::lock_class::LockClass::Site(Location::caller()),
+        );
+
+        RwLock {
+            id,
+            creator_thread_id,
+            state: ParkingLotMutex::new(State::default()),
+            data: UnsafeCell::new(value),
+        }
+    }
+
+    /// Get the ID of this lock
+    ///
+    /// # Returns
+    /// The unique identifier assigned to this lock
+    pub fn id(&self) -> LockId {
+        self.id
+    }
+
+    /// Get the ID of the task or thread that created this lock
+    ///
+    /// # Returns
+    /// The ID of the creator
+    pub fn creator_thread_id(&self) -> ThreadId {
+        self.creator_thread_id
+    }
+
+    /// Acquire a read lock, yielding to the executor while it is unavailable
+    ///
+    /// While a writer holds the lock, the detector has an edge from the task
+    /// to the writer. Waiting only behind a queued writer adds no edge, as
+    /// with the blocking RwLock.
+    ///
+    /// # Returns
+    /// A future that resolves to the read guard
+    pub fn read(&self) -> RwLockReadFuture<'_, T> {
+        RwLockReadFuture {
+            lock: self,
+            task_id: None,
+            key: None,
+            reported: false,
+        }
+    }
+
+    /// Acquire the write lock, yielding to the executor while it is held
+    ///
+    /// While the task waits, the detector has edges from it to the writer or
+    /// to every reader holding the lock.
+    ///
+    /// # Returns
+    /// A future that resolves to the write guard
+    pub fn write(&self) -> RwLockWriteFuture<'_, T> {
+        RwLockWriteFuture {
+            lock: self,
+            task_id: None,
+            key: None,
+            reported: false,
+            queued: false,
+        }
+    }
+
+    /// Try to acquire a read lock without waiting
+    ///
+    /// # Returns
+    /// Some(guard) if successful, None if a writer holds or waits for the lock
+    pub fn try_read(&self) -> Option<RwLockReadGuard<'_, T>> {
+        let task_id = current_task_id();
+        let mut state = self.state.lock();
+        if state.writer.is_some() || state.queued_writers > 0 {
+            return None;
+        }
+        state.readers += 1;
+        logger::log_interaction_event(task_id, self.id, Events::RwReadAttempt);
+        detector::rwlock::complete_read(task_id, self.id);
+        drop(state);
+
+        Some(RwLockReadGuard {
+            lock: self,
+            task_id,
+        })
+    }
+
+    /// Try to acquire the write lock without waiting
+    ///
+    /// # Returns
+    /// Some(guard) if successful, None if the lock is held
+    pub fn try_write(&self) -> Option<RwLockWriteGuard<'_, T>> {
+        let task_id = current_task_id();
+        let mut state = self.state.lock();
+        if state.writer.is_some() || state.readers > 0 {
+            return None;
+        }
+        state.writer = Some(task_id);
+        logger::log_interaction_event(task_id, self.id, Events::RwWriteAttempt);
+        detector::rwlock::complete_write(task_id, self.id);
+        drop(state);
+
+        Some(RwLockWriteGuard {
+            lock: self,
+            task_id,
+        })
+    }
+
+    /// Consumes this lock, returning the underlying data
+    pub fn into_inner(self) -> T {
+        detector::rwlock::destroy_rwlock(self.id);
+
+        // Use ManuallyDrop to prevent the automatic Drop implementation
+        let lock = std::mem::ManuallyDrop::new(self);
+
+        // Safety: We're taking ownership and preventing double-drop
+        unsafe {
+            drop(std::ptr::read(&lock.state));
+            std::ptr::read(&lock.data).into_inner()
+        }
+    }
+
+    /// Returns a mutable reference to the underlying data
+    ///
+    /// Since this call borrows the RwLock mutably, no actual locking needs to
+    /// take place – the mutable borrow statically guarantees no locks exist.
+    pub fn get_mut(&mut self) -> &mut T {
+        self.data.get_mut()
+    }
+}
+
+impl<'a, T> Future for RwLockReadFuture<'a, T> {
+    type Output = RwLockReadGuard<'a, T>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<RwLockReadGuard<'a, T>> {
+        let this = self.get_mut();
+        let lock = this.lock;
+        let task_id = *this.task_id.get_or_insert_with(current_task_id);
+
+        let mut state = lock.state.lock();
+        if state.writer.is_none() && state.queued_writers == 0 {
+            state.readers += 1;
+            if let Some(key) = this.key.take() {
+                state.waiters.remove(key);
+            }
+            if !this.reported {
+                logger::log_interaction_event(task_id, lock.id, Events::RwReadAttempt);
+            }
+            this.reported = false;
+            detector::rwlock::complete_read(task_id, lock.id);
+            drop(state);
+
+            return Poll::Ready(RwLockReadGuard { lock, task_id });
+        }
+
+        let woken = state.waiters.register(&mut this.key, cx.waker());
+        if state.writer.is_some() && (!this.reported || woken) {
+            // Adds the edge to the writer, which the detector knows about
+            this.reported = true;
+            detector::rwlock::attempt_read(task_id, lock.id, || None::<()>);
+        }
+        Poll::Pending
+    }
+}
+
+impl<'a, T> Future for RwLockWriteFuture<'a, T> {
+    type Output = RwLockWriteGuard<'a, T>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<RwLockWriteGuard<'a, T>> {
+        let this = self.get_mut();
+        let lock = this.lock;
+        let task_id = *this.task_id.get_or_insert_with(current_task_id);
+
+        let mut state = lock.state.lock();
+        if state.writer.is_none() && state.readers == 0 {
+            state.writer = Some(task_id);
+            if std::mem::take(&mut this.queued) {
+                state.queued_writers -= 1;
+            }
+            if let Some(key) = this.key.take() {
+                state.waiters.remove(key);
+            }
+            if !this.reported {
+                logger::log_interaction_event(task_id, lock.id, Events::RwWriteAttempt);
+            }
+            this.reported = false;
+            detector::rwlock::complete_write(task_id, lock.id);
+            drop(state);
+
+            return Poll::Ready(RwLockWriteGuard { lock, task_id });
+        }
+
+        let woken = state.waiters.register(&mut this.key, cx.waker());
+        if !this.queued {
+            this.queued = true;
+            state.queued_writers += 1;
+        }
+        // The readers are known to the detector, the writer is passed along
+        let deadlock_info = if !this.reported || woken {
+            this.reported = true;
+            detector::rwlock::acquire_write_slow(task_id, lock.id, state.writer, std::iter::empty)
+        } else {
+            None
+        };
+        drop(state);
+
+        if let Some(info) = deadlock_info {
+            detector::deadlock_handling::process_deadlock(info);
+        }
+        Poll::Pending
+    }
+}
+
+impl<T> RwLock<T> {
+    /// Withdraw a future that stopped waiting and collect the wake-ups it
+    /// leaves behind
+    fn abandon_wait(
+        &self,
+        state: &mut State,
+        task_id: Option<ThreadId>,
+        key: usize,
+        reported: bool,
+    ) -> Vec<Waker> {
+        let woken = state.waiters.remove(key);
+        // Withdrawn the same way as a mutex wait
+        if reported && let Some(task_id) = task_id {
+            detector::mutex::cancel_wait(task_id, self.id);
+        }
+        if woken {
+            state.waiters.wake_all()
+        } else {
+            Vec::new()
+        }
+    }
+}
+
+impl<T> Drop for RwLockReadFuture<'_, T> {
+    fn drop(&mut self) {
+        let Some(key) = self.key else {
+            return;
+        };
+
+        let wakers = {
+            let mut state = self.lock.state.lock();
+            self.lock
+                .abandon_wait(&mut state, self.task_id, key, self.reported)
+        };
+        wakers.into_iter().for_each(Waker::wake);
+    }
+}
+
+impl<T> Drop for RwLockWriteFuture<'_, T> {
+    fn drop(&mut self) {
+        let Some(key) = self.key else {
+            return;
+        };
+
+        let wakers = {
+            let mut state = self.lock.state.lock();
+            let mut wakers = self
+                .lock
+                .abandon_wait(&mut state, self.task_id, key, self.reported);
+            // Readers held back by this writer may go ahead
+            if self.queued {
+                state.queued_writers -= 1;
+                if state.queued_writers == 0 && state.writer.is_none() {
+                    wakers.extend(state.waiters.wake_all());
+                }
+            }
+            wakers
+        };
+        wakers.into_iter().for_each(Waker::wake);
+    }
+}
+
+impl<T> Drop for RwLock<T> {
+    fn drop(&mut self) {
+        // Register the lock destruction with the detector
+        detector::rwlock::destroy_rwlock(self.id);
+    }
+}
+
+impl<T> Deref for RwLockReadGuard<'_, T> {
+    type Target = T;
+
+    fn deref(&self) -> &T {
+        // Safety: the guard holds a read lock
+        unsafe { &*self.lock.data.get() }
+    }
+}
+
+impl<T> Deref for RwLockWriteGuard<'_, T> {
+    type Target = T;
+
+    fn deref(&self) -> &T {
+        // Safety: the guard holds the write lock
+        unsafe { &*self.lock.data.get() }
+    }
+}
+
+impl<T> DerefMut for RwLockWriteGuard<'_, T> {
+    fn deref_mut(&mut self) -> &mut T {
+        // Safety: the guard holds the write lock
+        unsafe { &mut *self.lock.data.get() }
+    }
+}
+
+impl<T> Drop for RwLockReadGuard<'_, T> {
+    fn drop(&mut self) {
+        let wakers = {
+            let mut state = self.lock.state.lock();
+            state.readers -= 1;
+            detector::rwlock::release_read(self.task_id, self.lock.id);
+            if state.readers == 0 {
+                state.waiters.wake_all()
+            } else {
+                Vec::new()
+            }
+        };
+        wakers.into_iter().for_each(Waker::wake);
+    }
+}
+
+impl<T> Drop for RwLockWriteGuard<'_, T> {
+    fn drop(&mut self) {
+        let wakers = {
+            let mut state = self.lock.state.lock();
+            state.writer = None;
+            detector::rwlock::release_write(self.task_id, self.lock.id);
+            state.waiters.wake_all()
+        };
+        wakers.into_iter().for_each(Waker::wake);
+    }
+}
+
+impl<T: Default> Default for RwLock<T> {
+    /// Creates a `RwLock<T>`, with the Default value for T
+    #[track_caller]
+    fn default() -> RwLock<T> {
+        RwLock::new(Default::default())
+    }
+}
+
+impl<T> From<T> for RwLock<T> {
+    /// Creates a new lock in an unlocked state ready for use
+    /// This is equivalent to RwLock::new
+    #[track_caller]
+    fn from(t: T) -> Self {
+        RwLock::new(t)
+    }
+}
@@ -6,6 +6,7 @@
 
 use crate::core::detector::GLOBAL_DETECTOR;
 use crate::core::detector::deadlock_handling;
+use crate::core::detector::state;
 use crate::core::logger;
 use crate::core::types::{CondvarId, DeadlockInfo, LockId, ThreadId};
 use crate::core::{Detector, Events, get_current_thread_id};
@@ -16,9 +17,11 @@ impl Detector {
     ///
     /// # Arguments
     /// * `condvar_id` - ID of the created condition variable
-    pub fn create_condvar(&mut self, condvar_id: CondvarId) {
+    pub fn create_condvar(&self, condvar_id: CondvarId) {
         // Initialize the wait queue for this condvar
-        self.cv_waiters.insert(condvar_id, VecDeque::new());
+        self.cv_waiters
+            .shard(condvar_id)
+            .insert(condvar_id, VecDeque::new());
 
         logger::log_lock_event(
             condvar_id,
@@ -31,13 +34,19 @@ impl Detector {
     ///
     /// # Arguments
     /// * `condvar_id` - ID of the condition variable being destroyed
-    pub fn destroy_condvar(&mut self, condvar_id: CondvarId) {
+    pub fn destroy_condvar(&self, condvar_id: CondvarId) {
         // Clear wait queue
-        self.cv_waiters.remove(&condvar_id);
+        self.cv_waiters.shard(condvar_id).remove(&condvar_id);
 
         // Clear any thread wait mappings for this condvar
-        self.thread_wait_cv
-            .retain(|_, &mut (cv_id, _)| cv_id != condvar_id);
+        for shard in self.threads.shards() {
+            shard.lock().retain(|_, thread| {
+                if thread.wait_cv.is_some_and(|(cv_id, _)| cv_id == condvar_id) {
+                    thread.wait_cv = None;
+                }
+                !thread.is_idle()
+            });
+        }
 
         logger::log_lock_event(condvar_id, None, Events::CondvarExit);
     }
@@ -52,18 +61,20 @@ impl Detector {
     /// * `thread_id` - ID of the thread beginning to wait
     /// * `condvar_id` - ID of the condition variable being waited on
     /// * `mutex_id` - ID of the mutex that will be reacquired after the wait
-    pub fn begin_wait(&mut self, thread_id: ThreadId, condvar_id: CondvarId, mutex_id: LockId) {
+    pub fn begin_wait(&self, thread_id: ThreadId, condvar_id: CondvarId, mutex_id: LockId) {
         // Add thread to the wait queue for this condvar
-        if let Some(queue) = self.cv_waiters.get_mut(&condvar_id) {
-            queue.push_back((thread_id, mutex_id));
-        } else {
-            self.cv_waiters
-                .insert(condvar_id, VecDeque::from([(thread_id, mutex_id)]));
-        }
+        self.cv_waiters
+            .shard(condvar_id)
+            .entry(condvar_id)
+            .or_default()
+            .push_back((thread_id, mutex_id));
 
         // Track what this thread is waiting for
-        self.thread_wait_cv
-            .insert(thread_id, (condvar_id, mutex_id));
+        self.threads
+            .shard(thread_id)
+            .entry(thread_id)
+            .or_default()
+            .wait_cv = Some((condvar_id, mutex_id));
 
         logger::log_interaction_event(thread_id, condvar_id, Events::CondvarWaitBegin);
     }
@@ -75,18 +86,17 @@ impl Detector {
     /// # Arguments
     /// * `condvar_id` - ID of the condition variable being notified
     /// * `notifier_id` - ID of the thread performing the notification
-    pub fn notify_one(
-        &mut self,
-        condvar_id: CondvarId,
-        notifier_id: ThreadId,
-    ) -> Vec<DeadlockInfo> {
+    pub fn notify_one(&self, condvar_id: CondvarId, notifier_id: ThreadId) -> Vec<DeadlockInfo> {
         // Wake one waiter if any exist
-        let (woken_thread_info, deadlocks) = if let Some(queue) =
-            self.cv_waiters.get_mut(&condvar_id)
-            && let Some((waiter_thread, mutex_id)) = queue.pop_front()
-        {
+        let waiter = self
+            .cv_waiters
+            .shard(condvar_id)
+            .get_mut(&condvar_id)
+            .and_then(|queue| queue.pop_front());
+
+        let (woken_thread_info, deadlocks) = if let Some((waiter_thread, mutex_id)) = waiter {
             // Mark as woken (for diagnostics)
-            self.cv_woken.insert(waiter_thread);
+            self.mark_woken(waiter_thread);
             let deadlocks = self.on_mutex_attempt_synthetic_immediate(waiter_thread, mutex_id);
             (Some((waiter_thread, mutex_id)), deadlocks)
         } else {
@@ -118,14 +128,10 @@ impl Detector {
     /// # Arguments
     /// * `condvar_id` - ID of the condition variable being notified
     /// * `notifier_id` - ID of the thread performing the notification
-    pub fn notify_all(
-        &mut self,
-        condvar_id: CondvarId,
-        notifier_id: ThreadId,
-    ) -> Vec<DeadlockInfo> {
+    pub fn notify_all(&self, condvar_id: CondvarId, notifier_id: ThreadId) -> Vec<DeadlockInfo> {
         // Wake all waiters and collect their IDs
         let waiters_to_wake: Vec<(ThreadId, LockId)> =
-            if let Some(queue) = self.cv_waiters.get_mut(&condvar_id) {
+            if let Some(queue) = self.cv_waiters.shard(condvar_id).get_mut(&condvar_id) {
                 queue.drain(..).collect()
             } else {
                 Vec::new()
@@ -136,7 +142,7 @@ impl Detector {
 
         for (waiter_thread, mutex_id) in &waiters_to_wake {
             // Mark as woken (for diagnostics)
-            self.cv_woken.insert(*waiter_thread);
+            self.mark_woken(*waiter_thread);
             let deadlocks = self.on_mutex_attempt_synthetic_immediate(*waiter_thread, *mutex_id);
             all_deadlocks.extend(deadlocks);
         }
@@ -167,16 +173,36 @@ impl Detector {
     /// * `thread_id` - ID of the thread whose wait is ending
     /// * `condvar_id` - ID of the condition variable that was waited on
     /// * `mutex_id` - ID of the mutex that was reacquired
-    pub fn end_wait(&mut self, thread_id: ThreadId, _condvar_id: CondvarId, _mutex_id: LockId) {
-        // Remove from thread wait tracking
-        self.thread_wait_cv.remove(&thread_id);
+    pub fn end_wait(&self, thread_id: ThreadId, condvar_id: CondvarId, _mutex_id: LockId) {
+        // A wait that timed out or woke spuriously is still queued; a later
+        // notify must not wake it
+        if let Some(queue) = self.cv_waiters.shard(condvar_id).get_mut(&condvar_id) {
+            queue.retain(|&(waiter, _)| waiter != thread_id);
+        }
+
+        let mut shard = self.threads.shard(thread_id);
+        if let Some(thread) = shard.get_mut(&thread_id) {
+            // Remove from thread wait tracking
+            thread.wait_cv = None;
 
-        // Remove from woken set if present
-        self.cv_woken.remove(&thread_id);
+            // Remove from woken set if present
+            thread.cv_woken = false;
+
+            state::prune_thread(&mut shard, thread_id);
+        }
 
         // Note: CondvarWaitEnd is now logged at a higher level after MutexAcquired
     }
 
+    /// Mark a thread as woken from its condvar wait (for diagnostics)
+    fn mark_woken(&self, thread_id: ThreadId) {
+        self.threads
+            .shard(thread_id)
+            .entry(thread_id)
+            .or_default()
+            .cv_woken = true;
+    }
+
     /// Synthetic mutex attempt for condvar operations (immediate processing)
     ///
     /// # Arguments
@@ -188,7 +214,7 @@ impl Detector {
     /// wait-for edges and performs cycle detection. The actual acquisition will
     /// happen when the woken thread calls the mutex wrapper's lock() method.
     fn on_mutex_attempt_synthetic_immediate(
-        &mut self,
+        &self,
         thread_id: ThreadId,
         lock_id: LockId,
     ) -> Vec<DeadlockInfo> {
@@ -196,39 +222,23 @@ impl Detector {
 
         // Check for lock order violations (only if graph exists and holding other locks)
         #[cfg(feature = "lock-order-graph")]
-        let lock_order_violation = if self.lock_order_graph.is_some()
-            && self.thread_holds.get(&thread_id).map_or(0, |h| h.len()) >= 1
-        {
-            self.check_lock_order_violation(thread_id, lock_id)
-        } else {
-            None
+        let lock_order_violation = self.check_lock_order_violation(thread_id, lock_id);
+
+        // Mutex is owned (by its recorded owner, or else the notifier that
+        // is about to release it) - set up wait-for edge
+        let cycle = {
+            let mut shard = self.locks.shard(lock_id);
+            let state = shard.entry(lock_id).or_default();
+            let owner = state.owner.unwrap_or_else(get_current_thread_id);
+            self.add_wait_edge(state, thread_id, lock_id, owner)
         };
-        #[cfg(not(feature = "lock-order-graph"))]
-        let _lock_order_violation: Option<Vec<LockId>> = None;
-
-        let effective_owner = self
-            .mutex_owners
-            .get(&lock_id)
-            .copied()
-            .or_else(|| Some(get_current_thread_id()));
-
-        if let Some(owner) = effective_owner {
-            // Mutex is owned - set up wait-for edge
-            self.thread_waits_for.insert(thread_id, lock_id);
-            self.lock_waiters
-                .entry(lock_id)
-                .or_default()
-                .insert(thread_id);
-
-            if let Some(cycle) = self.wait_for_graph.add_edge(thread_id, owner) {
-                // Apply common lock filter
-                let filtered_cycle = self.filter_cycle_by_common_locks(&cycle);
-
-                if !filtered_cycle.is_empty() {
-                    let info = self.extract_deadlock_info(cycle);
-                    deadlocks.push(info);
-                }
-            }
+
+        // Apply common lock filter
+        if let Some(cycle) = cycle
+            && !self.filter_cycle_by_common_locks(&cycle).is_empty()
+        {
+            let info = self.extract_deadlock_info(cycle);
+            deadlocks.push(info);
         }
 
         // Report lock order violation if detected
@@ -247,8 +257,7 @@ impl Detector {
 /// # Arguments
 /// * `condvar_id` - ID of the created condition variable
 pub fn create_condvar(condvar_id: CondvarId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.create_condvar(condvar_id);
+    GLOBAL_DETECTOR.create_condvar(condvar_id);
 }
 
 /// Register condvar destruction with the global detector
@@ -256,8 +265,7 @@ pub fn create_condvar(condvar_id: CondvarId) {
 /// # Arguments
 /// * `condvar_id` - ID of the condition variable being destroyed
 pub fn destroy_condvar(condvar_id: CondvarId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.destroy_condvar(condvar_id);
+    GLOBAL_DETECTOR.destroy_condvar(condvar_id);
 }
 
 /// Register the beginning of a condvar wait with the global detector
@@ -267,8 +275,7 @@ pub fn destroy_condvar(condvar_id: CondvarId) {
 /// * `condvar_id` - ID of the condition variable being waited on
 /// * `mutex_id` - ID of the mutex that will be reacquired after the wait
 pub fn begin_wait(thread_id: ThreadId, condvar_id: CondvarId, mutex_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.begin_wait(thread_id, condvar_id, mutex_id);
+    GLOBAL_DETECTOR.begin_wait(thread_id, condvar_id, mutex_id);
 }
 
 /// Register a condvar notify_one with the global detector
@@ -277,10 +284,7 @@ pub fn begin_wait(thread_id: ThreadId, condvar_id: CondvarId, mutex_id: LockId)
 /// * `condvar_id` - ID of the condition variable being notified
 /// * `notifier_id` - ID of the thread performing the notification
 pub fn notify_one(condvar_id: CondvarId, notifier_id: ThreadId) {
-    let deadlocks = {
-        let mut detector = GLOBAL_DETECTOR.lock();
-        detector.notify_one(condvar_id, notifier_id)
-    };
+    let deadlocks = GLOBAL_DETECTOR.notify_one(condvar_id, notifier_id);
 
     for info in deadlocks {
         deadlock_handling::process_deadlock(info);
@@ -293,10 +297,7 @@ pub fn notify_one(condvar_id: CondvarId, notifier_id: ThreadId) {
 /// * `condvar_id` - ID of the condition variable being notified
 /// * `notifier_id` - ID of the thread performing the notification
 pub fn notify_all(condvar_id: CondvarId, notifier_id: ThreadId) {
-    let deadlocks = {
-        let mut detector = GLOBAL_DETECTOR.lock();
-        detector.notify_all(condvar_id, notifier_id)
-    };
+    let deadlocks = GLOBAL_DETECTOR.notify_all(condvar_id, notifier_id);
 
     for info in deadlocks {
         deadlock_handling::process_deadlock(info);
@@ -310,6 +311,5 @@ pub fn notify_all(condvar_id: CondvarId, notifier_id: ThreadId) {
 /// * `condvar_id` - ID of the condition variable that was waited on
 /// * `mutex_id` - ID of the mutex that was reacquired
 pub fn end_wait(thread_id: ThreadId, condvar_id: CondvarId, mutex_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.end_wait(thread_id, condvar_id, mutex_id);
+    GLOBAL_DETECTOR.end_wait(thread_id, condvar_id, mutex_id);
 }
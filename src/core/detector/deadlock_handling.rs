@@ -1,7 +1,9 @@
 use crate::DeadlockInfo;
 use crate::LockId;
 use crate::ThreadId;
-use crate::core::detector::DISPATCHER;
+#[cfg(feature = "lock-order-graph")]
+use crate::core::detector::lock_class;
+use crate::core::detector::{DISPATCHER, Dispatch};
 use crate::core::logger;
 use crate::core::{DeadlockSource, Detector};
 use chrono::Utc;
@@ -35,20 +37,27 @@ impl Detector {
             return Vec::new();
         }
 
-        // Get locks held by the first thread in the cycle
+        // Get locks held by the first thread in the cycle. The copy stays
+        // inline, so the whole check allocates nothing in the common case.
         let mut iter = cycle.iter();
         let first = *iter.next().unwrap();
-        let mut intersection = self.thread_holds.get(&first).cloned().unwrap_or_default();
+        let mut intersection = self
+            .threads
+            .shard(first)
+            .get(&first)
+            .map(|thread| thread.holds.clone())
+            .unwrap_or_default();
 
         // Find intersection with all other threads' held locks
         for &thread_id in iter {
-            if let Some(holds) = self.thread_holds.get(&thread_id) {
-                intersection = intersection.intersection(holds).copied().collect();
-            } else {
-                // Thread holds no locks, intersection is empty
-                intersection.clear();
+            if intersection.is_empty() {
                 break;
             }
+            match self.threads.shard(thread_id).get(&thread_id) {
+                Some(thread) => intersection.retain(|lock_id| thread.holds.contains(lock_id)),
+                // Thread holds no locks, intersection is empty
+                None => intersection.clear(),
+            }
         }
 
         // If intersection is empty, it's a real cycle (no common locks)
@@ -65,7 +74,13 @@ impl Detector {
         // This reduces the size of the info struct and speeds up verification.
         let thread_waiting_for_locks = cycle
             .iter()
-            .filter_map(|&t| self.thread_waits_for.get(&t).map(|&l| (t, l)))
+            .filter_map(|&t| {
+                let shard = self.threads.shard(t);
+                shard
+                    .get(&t)
+                    .and_then(|thread| thread.waits_for)
+                    .map(|l| (t, l))
+            })
             .collect();
 
         DeadlockInfo {
@@ -73,6 +88,7 @@ impl Detector {
             thread_cycle: cycle,
             thread_waiting_for_locks,
             lock_order_cycle: None,
+            lock_order_classes: None,
             timestamp: Utc::now().to_rfc3339(),
             verification_request: None,
         }
@@ -86,11 +102,19 @@ impl Detector {
         lock_id: LockId,
         lock_cycle: Vec<LockId>,
     ) -> DeadlockInfo {
+        let lock_order_classes = self.orders_by_class().then(|| {
+            lock_cycle
+                .iter()
+                .map(|&class| lock_class::class_name(class).unwrap_or_default())
+                .collect()
+        });
+
         DeadlockInfo {
             source: DeadlockSource::LockOrderViolation,
             thread_cycle: vec![thread_id],
             thread_waiting_for_locks: vec![(thread_id, lock_id)],
             lock_order_cycle: Some(lock_cycle),
+            lock_order_classes,
             timestamp: Utc::now().to_rfc3339(),
             verification_request: None,
         }
@@ -101,9 +125,14 @@ impl Detector {
 ///
 /// This function should be called OUTSIDE the global detector lock
 /// to avoid holding the lock while formatting messages or waiting for callbacks.
+///
+/// Repeats of a report that was already delivered are only counted, and are
+/// neither passed to the callback nor logged again.
 pub fn process_deadlock(info: DeadlockInfo) {
     // Dispatch callback asynchronously
-    DISPATCHER.send(info.clone());
+    if DISPATCHER.send(info.clone()) == Dispatch::Coalesced {
+        return;
+    }
 
     // Also write terminal deadlock record to the log if enabled
     logger::log_deadlock(info);
@@ -0,0 +1,91 @@
+//! Deferred cycle detection
+//!
+//! By default every contended acquisition searches the wait-for graph for a
+//! cycle before it blocks. Most contention resolves quickly, so in deferred
+//! mode the edge is only recorded, and the lock wrappers block with a timeout
+//! instead. A thread still blocked when the threshold runs out searches for a
+//! cycle through itself and verifies it against the lock's owner, the same way
+//! an immediate detection is verified. Reports still go through the dispatcher.
+
+use crate::core::Detector;
+use crate::core::detector::GLOBAL_DETECTOR;
+use crate::core::types::{DeadlockInfo, LockId, ThreadId};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Duration;
+
+/// How long a thread blocks before it checks for a cycle, in microseconds
+/// (0 while detection is immediate)
+static THRESHOLD_US: AtomicU64 = AtomicU64::new(0);
+
+/// Enable deferred detection with the given threshold
+pub(crate) fn configure(threshold: Duration) {
+    let micros = threshold.as_micros().clamp(1, u64::MAX as u128) as u64;
+    THRESHOLD_US.store(micros, Ordering::Relaxed);
+}
+
+/// How long a blocked thread waits before checking for a deadlock
+///
+/// # Returns
+/// * `Some(Duration)` - If detection is deferred
+/// * `None` - If contended acquisitions check for cycles immediately
+#[inline]
+pub fn threshold() -> Option<Duration> {
+    match THRESHOLD_US.load(Ordering::Relaxed) {
+        0 => None,
+        micros => Some(Duration::from_micros(micros)),
+    }
+}
+
+impl Detector {
+    /// Look for a deadlock through a thread that stayed blocked on `lock_id`
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the blocked thread
+    /// * `lock_id` - ID of the lock it is blocked on
+    /// * `holder` - The thread now observed holding an exclusively held lock,
+    ///   if known. The edge recorded when the wait began is moved to it (or
+    ///   to the owner the detector knows of). Pass `None` to keep the edges,
+    ///   e.g. towards the readers of an RwLock.
+    ///
+    /// # Returns
+    /// The deadlock, unless there is none or it was already returned to
+    /// another thread of the same cycle
+    pub fn check_blocked(
+        &self,
+        thread_id: ThreadId,
+        lock_id: LockId,
+        holder: Option<ThreadId>,
+    ) -> Option<DeadlockInfo> {
+        let cycle = {
+            // Hold the lock's shard so a concurrent release cannot miss the edge
+            let shard = self.locks.shard(lock_id);
+            let owner = shard.get(&lock_id).and_then(|state| state.owner);
+            let holder = holder.map(|hint| owner.unwrap_or(hint));
+            let mut graph = self.wait_for_graph.lock();
+            if let Some(holder) = holder.filter(|&holder| holder != thread_id) {
+                graph.retarget_edges(thread_id, holder);
+            }
+            graph.find_unreported_cycle(thread_id)
+        }?;
+
+        if self.filter_cycle_by_common_locks(&cycle).is_empty() {
+            None
+        } else {
+            Some(self.extract_deadlock_info(cycle))
+        }
+    }
+}
+
+/// Look for a deadlock through a thread that stayed blocked, using the global detector
+///
+/// # Arguments
+/// * `thread_id` - ID of the blocked thread
+/// * `lock_id` - ID of the lock it is blocked on
+/// * `holder` - The thread now observed holding the lock, if known
+pub fn check_blocked(
+    thread_id: ThreadId,
+    lock_id: LockId,
+    holder: Option<ThreadId>,
+) -> Option<DeadlockInfo> {
+    GLOBAL_DETECTOR.check_blocked(thread_id, lock_id, holder)
+}
@@ -0,0 +1,153 @@
+//! Lock classes for lock order checking and lock statistics
+//!
+//! By default the lock order graph has one node per lock object, so the
+//! graph grows with every lock ever created and an ordering learned for one
+//! pair of objects says nothing about another pair created by the same code.
+//! In class mode (see [`DetectorConfig::lock_order_by_class`]) locks are
+//! grouped into *classes*, the way lockdep does it in the Linux kernel: every
+//! lock constructed at the same source location shares one class, and C code
+//! can name classes explicitly. The graph then grows with the size of the
+//! code rather than with the number of lock objects.
+//!
+//! Class IDs are allocated from their own counter and are never reused, so
+//! class edges stay valid for the lifetime of the process. This lets every
+//! thread cache the class edges it has already recorded and skip the graph
+//! entirely when it nests the same classes again.
+//!
+//! Lock statistics (the "lock-stats" feature) reuse the same classes to
+//! aggregate contention over all locks created by the same code.
+//!
+//! [`DetectorConfig::lock_order_by_class`]: crate::core::detector::DetectorConfig
+
+use fxhash::FxHashMap;
+#[cfg(feature = "lock-order-graph")]
+use fxhash::FxHashSet;
+use parking_lot::Mutex;
+#[cfg(feature = "lock-order-graph")]
+use std::cell::RefCell;
+use std::panic::Location;
+
+/// Identifier of a lock class
+pub type LockClassId = usize;
+
+/// How the class of a lock is determined
+pub enum LockClass {
+    /// The source location that constructed the lock
+    Site(&'static Location<'static>),
+    /// A class name chosen by the user
+    Named(String),
+    /// A fresh class shared with no other lock
+    Unique,
+}
+
+/// Interning key of a class
+#[derive(PartialEq, Eq, Hash)]
+enum ClassKey {
+    Site(&'static str, u32, u32),
+    Named(String),
+}
+
+/// Interned classes and their human-readable names
+#[derive(Default)]
+struct ClassRegistry {
+    ids: FxHashMap<ClassKey, LockClassId>,
+    /// Name of each class, indexed by class ID
+    names: Vec<String>,
+}
+
+lazy_static::lazy_static! {
+    static ref CLASSES: Mutex<ClassRegistry> = Mutex::new(ClassRegistry::default());
+}
+
+#[cfg(feature = "lock-order-graph")]
+thread_local! {
+    /// Class edges (`before`, `after`) this thread already recorded in the graph
+    static KNOWN_EDGES: RefCell<FxHashSet<(LockClassId, LockClassId)>> =
+        RefCell::new(FxHashSet::default());
+}
+
+/// Look up the ID of a class, allocating one the first time it is seen
+///
+/// # Arguments
+/// * `class` - The class to intern
+///
+/// # Returns
+/// The ID of the class
+pub fn intern(class: LockClass) -> LockClassId {
+    let mut registry = CLASSES.lock();
+    let (key, name) = match class {
+        LockClass::Site(location) => (
+            ClassKey::Site(location.file(), location.line(), location.column()),
+            location.to_string(),
+        ),
+        LockClass::Named(name) => (ClassKey::Named(name.clone()), name),
+        LockClass::Unique => {
+            let id = registry.names.len();
+            registry.names.push(format!("<unique class {id}>"));
+            return id;
+        }
+    };
+
+    if let Some(&id) = registry.ids.get(&key) {
+        return id;
+    }
+    let id = registry.names.len();
+    registry.names.push(name);
+    registry.ids.insert(key, id);
+    id
+}
+
+/// Get the human-readable name of a class
+///
+/// Site classes are named `file:line:column`, named classes keep their name.
+///
+/// # Arguments
+/// * `class_id` - ID of the class
+///
+/// # Returns
+/// The name of the class, or `None` if no such class exists
+pub fn class_name(class_id: LockClassId) -> Option<String> {
+    CLASSES.lock().names.get(class_id).cloned()
+}
+
+/// Whether the current thread already recorded the class edge `before -> after`
+#[cfg(feature = "lock-order-graph")]
+pub fn is_known_edge(before: LockClassId, after: LockClassId) -> bool {
+    KNOWN_EDGES
+        .try_with(|edges| edges.borrow().contains(&(before, after)))
+        .unwrap_or(false)
+}
+
+/// Remember that the class edge `before -> after` is present in the graph
+#[cfg(feature = "lock-order-graph")]
+pub fn remember_edge(before: LockClassId, after: LockClassId) {
+    let _ = KNOWN_EDGES.try_with(|edges| edges.borrow_mut().insert((before, after)));
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_same_site_shares_a_class() {
+        let sites: Vec<_> = (0..3).map(|_| Location::caller()).collect();
+        let ids: Vec<_> = sites
+            .into_iter()
+            .map(|s| intern(LockClass::Site(s)))
+            .collect();
+        assert!(ids.windows(2).all(|w| w[0] == w[1]));
+        assert_ne!(ids[0], intern(LockClass::Site(Location::caller())));
+    }
+
+    #[test]
+    fn test_named_and_unique_classes() {
+        let a = intern(LockClass::Named("accounts".to_string()));
+        assert_eq!(a, intern(LockClass::Named("accounts".to_string())));
+        assert_eq!(class_name(a).as_deref(), Some("accounts"));
+
+        let u1 = intern(LockClass::Unique);
+        let u2 = intern(LockClass::Unique);
+        assert_ne!(u1, u2);
+        assert_ne!(u1, a);
+    }
+}
@@ -1,7 +1,11 @@
 pub mod condvar;
 pub mod deadlock_handling;
+pub mod deferred;
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+pub mod lock_class;
 pub mod mutex;
 pub mod rwlock;
+mod state;
 mod stress;
 pub mod thread;
 
@@ -9,20 +13,38 @@ pub mod thread;
 use crate::core::StressConfig;
 #[cfg(feature = "stress-test")]
 use crate::core::StressMode;
+#[cfg(feature = "stress-test")]
+use crate::core::StressSchedule;
 #[cfg(feature = "lock-order-graph")]
 use crate::core::graph::LockOrderGraph;
 use crate::core::graph::WaitForGraph;
 #[cfg(feature = "logging-and-visualization")]
 use crate::core::logger::{self, EventLogger};
+use crate::core::sampling::{self, Sampling};
+#[cfg(feature = "lock-stats")]
+use crate::core::stats;
 
-use crate::core::types::{CondvarId, DeadlockInfo, LockId, ThreadId};
+use crate::core::types::{DeadlockInfo, LockId, ThreadId};
 #[cfg(feature = "logging-and-visualization")]
 use anyhow::Result;
-use fxhash::{FxHashMap, FxHashSet};
+use fxhash::FxHashMap;
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+use lock_class::{LockClass, LockClassId};
 use parking_lot::Mutex;
+#[cfg(feature = "stress-test")]
+use parking_lot::RwLock;
+#[cfg(feature = "lock-order-graph")]
+use smallvec::SmallVec;
+#[cfg(feature = "lock-order-graph")]
+use state::HeldLocks;
+use state::{LockState, ShardedMap, ThreadState};
 use std::collections::VecDeque;
-use std::sync::mpsc::{Sender, channel};
+#[cfg(feature = "lock-order-graph")]
+use std::sync::atomic::AtomicBool;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::mpsc::{SyncSender, TrySendError, sync_channel};
 use std::sync::{Arc, OnceLock};
+use std::time::Duration;
 
 /// Configuration for the deadlock detector
 pub struct DetectorConfig {
@@ -31,12 +53,29 @@ pub struct DetectorConfig {
     /// Enable lock order checking
     #[cfg(feature = "lock-order-graph")]
     pub check_lock_order: bool,
+    /// Key the lock order graph by lock class instead of lock instance
+    #[cfg(feature = "lock-order-graph")]
+    pub lock_order_by_class: bool,
+    /// Which acquisitions are tracked, or None to track all of them
+    pub sampling: Option<Sampling>,
+    /// How long a thread blocks before checking for a deadlock, or None to
+    /// check every contended acquisition immediately
+    pub deferred_detection: Option<Duration>,
+    /// Whether detection is switched on once the detector starts (the
+    /// `DELOXIDE_DETECTION` environment variable takes precedence)
+    pub detection: bool,
+    /// Count acquisitions, contention and wait times per lock
+    #[cfg(feature = "lock-stats")]
+    pub lock_stats: bool,
     /// Stress testing mode
     #[cfg(feature = "stress-test")]
     pub stress_mode: StressMode,
     /// Stress testing configuration
     #[cfg(feature = "stress-test")]
     pub stress_config: Option<StressConfig>,
+    /// Schedule of an earlier stress run to repeat
+    #[cfg(feature = "stress-test")]
+    pub stress_replay: Option<StressSchedule>,
     /// Logger for recording events
     #[cfg(feature = "logging-and-visualization")]
     pub logger: Option<EventLogger>,
@@ -54,22 +93,108 @@ lazy_static::lazy_static! {
 /// Stores the user-provided callback as `Arc<dyn Fn>` for thread-safe access.
 static CALLBACK: OnceLock<Arc<dyn Fn(DeadlockInfo) + Send + Sync>> = OnceLock::new();
 
+/// Number of reports that can wait for the callback before new ones are dropped
+const REPORT_QUEUE_CAPACITY: usize = 64;
+
+/// Number of distinct report fingerprints remembered for coalescing
+const MAX_FINGERPRINTS: usize = 4096;
+
+/// Fingerprints of delivered reports and how often each was repeated
+///
+/// Holds at most `MAX_FINGERPRINTS` entries. Remembering a new fingerprint
+/// beyond that evicts the one seen least recently, so new reports keep
+/// being coalesced during an incident wider than the table.
+#[derive(Default)]
+struct Fingerprints {
+    /// Number of repeats of each fingerprint, and when it was last seen
+    entries: FxHashMap<u64, (u64, u64)>,
+    /// Number of reports seen, used to order entries by recency
+    clock: u64,
+    /// Number of repeats counted in total, including evicted fingerprints
+    coalesced: u64,
+}
+
+impl Fingerprints {
+    /// Count a repeat of `fingerprint` if it is remembered
+    ///
+    /// # Returns
+    /// `true` if the report is a repeat and must not be delivered
+    fn repeat(&mut self, fingerprint: u64) -> bool {
+        self.clock += 1;
+        let Some((repeats, seen)) = self.entries.get_mut(&fingerprint) else {
+            return false;
+        };
+        *repeats += 1;
+        *seen = self.clock;
+        self.coalesced += 1;
+        true
+    }
+
+    /// Remember the fingerprint of a delivered report
+    fn insert(&mut self, fingerprint: u64) {
+        if self.entries.len() >= MAX_FINGERPRINTS {
+            // Only a report with a new fingerprint gets here, so the scan is
+            // as rare as delivered reports
+            let oldest = self
+                .entries
+                .iter()
+                .min_by_key(|&(_, &(_, seen))| seen)
+                .map(|(&oldest, _)| oldest);
+            if let Some(oldest) = oldest {
+                self.entries.remove(&oldest);
+            }
+        }
+        self.entries.insert(fingerprint, (0, self.clock));
+    }
+
+    /// Number of repeats of `fingerprint`, 0 if it is not remembered
+    fn repeats(&self, fingerprint: u64) -> u64 {
+        self.entries
+            .get(&fingerprint)
+            .map_or(0, |&(repeats, _)| repeats)
+    }
+}
+
 /// Background dispatcher for asynchronous callback execution
 ///
 /// Runs a dedicated thread that receives deadlock events through a channel
 /// and executes the registered callback. This prevents deadlocks from
 /// blocking callback execution.
+///
+/// Only the first report of each fingerprint (see
+/// [`DeadlockInfo::fingerprint`]) is delivered; repeats are counted instead.
+/// Fingerprints that were not seen for a long time are forgotten once too
+/// many are remembered, so a later repeat of one is delivered again.
+/// The channel is bounded, so a callback that cannot keep up makes the
+/// detector drop reports rather than queue them without limit.
 struct Dispatcher {
     /// Channel sender for transmitting deadlock events
-    sender: Sender<DeadlockInfo>,
+    sender: SyncSender<DeadlockInfo>,
+    /// Delivered fingerprints and their repeats
+    fingerprints: Mutex<Fingerprints>,
+    /// Number of reports handed to the callback thread
+    delivered: AtomicU64,
+    /// Number of reports dropped because the channel was full
+    dropped: AtomicU64,
     /// Background thread handle
     _thread_handle: std::thread::JoinHandle<()>,
 }
 
+/// Outcome of handing a report to the dispatcher
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) enum Dispatch {
+    /// Queued for the callback
+    Queued,
+    /// Repeat of a report already delivered
+    Coalesced,
+    /// Dropped because too many reports wait for the callback
+    Dropped,
+}
+
 impl Dispatcher {
     /// Create a new dispatcher with a background thread and channel
     fn new() -> Self {
-        let (tx, rx) = channel::<DeadlockInfo>();
+        let (tx, rx) = sync_channel::<DeadlockInfo>(REPORT_QUEUE_CAPACITY);
 
         // Background thread listens for events and executes callbacks
         let thread_handle = std::thread::spawn(move || {
@@ -82,17 +207,77 @@ impl Dispatcher {
 
         Dispatcher {
             sender: tx,
+            fingerprints: Mutex::new(Fingerprints::default()),
+            delivered: AtomicU64::new(0),
+            dropped: AtomicU64::new(0),
             _thread_handle: thread_handle,
         }
     }
 
     /// Send deadlock info to background thread for callback execution
-    fn send(&self, info: DeadlockInfo) {
-        // Non-blocking send; events dropped if channel is full/closed
-        let _ = self.sender.send(info);
+    ///
+    /// Never blocks: repeats are only counted, and reports that find the
+    /// channel full are dropped. A dropped report is not remembered, so a
+    /// later repeat of it can still be delivered.
+    fn send(&self, info: DeadlockInfo) -> Dispatch {
+        let fingerprint = info.fingerprint();
+        let mut fingerprints = self.fingerprints.lock();
+        if fingerprints.repeat(fingerprint) {
+            return Dispatch::Coalesced;
+        }
+
+        match self.sender.try_send(info) {
+            Ok(()) => {
+                self.delivered.fetch_add(1, Ordering::Relaxed);
+                fingerprints.insert(fingerprint);
+                Dispatch::Queued
+            }
+            Err(TrySendError::Full(_)) => {
+                self.dropped.fetch_add(1, Ordering::Relaxed);
+                Dispatch::Dropped
+            }
+            // The callback thread is gone, nothing will see the report
+            Err(TrySendError::Disconnected(_)) => Dispatch::Dropped,
+        }
+    }
+}
+
+/// Counters of the reports the detector produced
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ReportStats {
+    /// Reports handed to the deadlock callback
+    pub delivered: u64,
+    /// Repeats of delivered reports that were counted instead
+    pub coalesced: u64,
+    /// Reports dropped because the callback fell behind
+    pub dropped: u64,
+}
+
+/// Get the counters of delivered, coalesced and dropped deadlock reports
+///
+/// # Returns
+/// The counters since the detector started
+pub fn report_stats() -> ReportStats {
+    let coalesced = DISPATCHER.fingerprints.lock().coalesced;
+    ReportStats {
+        delivered: DISPATCHER.delivered.load(Ordering::Relaxed),
+        coalesced,
+        dropped: DISPATCHER.dropped.load(Ordering::Relaxed),
     }
 }
 
+/// Get the number of times a delivered report was repeated
+///
+/// # Arguments
+/// * `fingerprint` - Fingerprint of the report (see [`DeadlockInfo::fingerprint`])
+///
+/// # Returns
+/// The number of coalesced repeats, or 0 if no report with this
+/// fingerprint was delivered or it has since been forgotten
+pub fn report_repeats(fingerprint: u64) -> u64 {
+    DISPATCHER.fingerprints.lock().repeats(fingerprint)
+}
+
 /// Main deadlock detector that maintains thread-lock relationships
 ///
 /// The Detector is the heart of Deloxide. It tracks which threads own which locks,
@@ -106,36 +291,38 @@ impl Dispatcher {
 /// 3. When a lock is acquired or released, the graph is updated
 /// 4. Cycle detection is performed to identify potential deadlocks
 /// 5. When a cycle is detected, the deadlock callback is invoked
+///
+/// Per-lock and per-thread state is sharded (see the `state` module), so
+/// operations on unrelated locks do not contend with each other. Only the
+/// wait-for graph is shared, and it is locked only while edges change.
 pub struct Detector {
     /// Graph representing which threads are waiting for which other threads
-    wait_for_graph: WaitForGraph,
+    wait_for_graph: Mutex<WaitForGraph>,
     /// Lock order graph for detecting lock ordering violations (only created if enabled)
     #[cfg(feature = "lock-order-graph")]
-    lock_order_graph: Option<LockOrderGraph>,
-    /// Maps threads to the locks they're attempting to acquire
-    thread_waits_for: FxHashMap<ThreadId, LockId>,
-    /// Tracks, for each thread, which locks it currently holds
-    thread_holds: FxHashMap<ThreadId, FxHashSet<LockId>>,
-    /// Maps Mutexes to the threads that currently own them
-    mutex_owners: FxHashMap<LockId, ThreadId>,
-    /// Maps RwLock IDs to the set of readers (shared lock holders)
-    rwlock_readers: FxHashMap<LockId, FxHashSet<ThreadId>>,
-    /// Maps RwLock IDs to the current writer (if any)
-    rwlock_writer: FxHashMap<LockId, ThreadId>,
+    lock_order_graph: OnceLock<Mutex<LockOrderGraph>>,
+    /// Whether the lock order graph holds lock classes rather than locks
+    #[cfg(feature = "lock-order-graph")]
+    order_by_class: AtomicBool,
+    /// Class of each live lock (only populated in class mode or while lock
+    /// statistics are enabled)
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    lock_classes: ShardedMap<LockClassId>,
+    /// Owner, readers and waiters of each lock
+    locks: ShardedMap<LockState>,
+    /// Held locks and wait targets of each thread
+    threads: ShardedMap<ThreadState>,
     /// Maps condvar IDs to queues of waiting threads and their associated mutex IDs
-    cv_waiters: FxHashMap<CondvarId, VecDeque<(ThreadId, LockId)>>,
-    /// Maps threads to the condvar and mutex they're waiting on
-    thread_wait_cv: FxHashMap<ThreadId, (CondvarId, LockId)>,
-    /// Set of threads that have been woken from condvar waits (for diagnostics)
-    cv_woken: FxHashSet<ThreadId>,
-    /// Maps locks to the set of threads waiting for them (for stale edge removal)
-    lock_waiters: FxHashMap<LockId, FxHashSet<ThreadId>>,
+    cv_waiters: ShardedMap<VecDeque<(ThreadId, LockId)>>,
+    /// Creator of each live mutex, recorded while logging is enabled
+    #[cfg(feature = "compact-locks")]
+    creators: ShardedMap<ThreadId>,
     #[cfg(feature = "stress-test")]
     /// Stress testing mode
-    stress_mode: StressMode,
+    stress_mode: RwLock<StressMode>,
     #[cfg(feature = "stress-test")]
     /// Stress testing configuration
-    stress_config: Option<StressConfig>,
+    stress_config: RwLock<Option<StressConfig>>,
 }
 
 impl Default for Detector {
@@ -150,22 +337,22 @@ impl Detector {
     /// By default, lock order checking is disabled.
     pub fn new() -> Self {
         Detector {
-            wait_for_graph: WaitForGraph::new(),
+            wait_for_graph: Mutex::new(WaitForGraph::new()),
+            #[cfg(feature = "lock-order-graph")]
+            lock_order_graph: OnceLock::new(), // Not created by default
             #[cfg(feature = "lock-order-graph")]
-            lock_order_graph: None, // Not created by default
-            thread_waits_for: FxHashMap::default(),
-            thread_holds: FxHashMap::default(),
-            mutex_owners: FxHashMap::default(),
-            rwlock_readers: FxHashMap::default(),
-            rwlock_writer: FxHashMap::default(),
-            cv_waiters: FxHashMap::default(),
-            thread_wait_cv: FxHashMap::default(),
-            cv_woken: FxHashSet::default(),
-            lock_waiters: FxHashMap::default(),
+            order_by_class: AtomicBool::new(false),
+            #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+            lock_classes: ShardedMap::new(),
+            locks: ShardedMap::new(),
+            threads: ShardedMap::new(),
+            cv_waiters: ShardedMap::new(),
+            #[cfg(feature = "compact-locks")]
+            creators: ShardedMap::new(),
             #[cfg(feature = "stress-test")]
-            stress_mode: StressMode::None,
+            stress_mode: RwLock::new(StressMode::None),
             #[cfg(feature = "stress-test")]
-            stress_config: None,
+            stress_config: RwLock::new(None),
         }
     }
 
@@ -173,7 +360,7 @@ impl Detector {
     ///
     /// # Arguments
     /// * `callback` - Function to call when a deadlock is detected
-    pub fn set_deadlock_callback<F>(&mut self, callback: F)
+    pub fn set_deadlock_callback<F>(&self, callback: F)
     where
         F: Fn(DeadlockInfo) + Send + Sync + 'static,
     {
@@ -181,30 +368,281 @@ impl Detector {
         CALLBACK.set(cb).ok();
     }
 
+    /// Record that `thread_id` waits for `lock_id`, currently held by `holder`
+    ///
+    /// Must be called with the shard of `lock_id` locked (`state` borrowed from
+    /// it), so that a concurrent release of the same lock cannot miss the edge.
+    ///
+    /// # Returns
+    /// The cycle through the new edge, if adding it closes one. Always `None`
+    /// when detection is deferred (see the `deferred` module).
+    fn add_wait_edge(
+        &self,
+        state: &mut LockState,
+        thread_id: ThreadId,
+        lock_id: LockId,
+        holder: ThreadId,
+    ) -> Option<Vec<ThreadId>> {
+        state.waiters.insert(thread_id);
+        self.threads
+            .shard(thread_id)
+            .entry(thread_id)
+            .or_default()
+            .waits_for = Some(lock_id);
+        self.link_waiter(&mut self.wait_for_graph.lock(), thread_id, holder)
+    }
+
+    /// Add the edge `thread_id -> holder`, searching for a cycle through it
+    /// unless detection is deferred
+    fn link_waiter(
+        &self,
+        graph: &mut WaitForGraph,
+        thread_id: ThreadId,
+        holder: ThreadId,
+    ) -> Option<Vec<ThreadId>> {
+        if deferred::threshold().is_some() {
+            graph.insert_edge(thread_id, holder);
+            None
+        } else {
+            graph.add_edge(thread_id, holder)
+        }
+    }
+
+    /// Remove the edges of all threads waiting on a lock towards `holder`
+    ///
+    /// Called when `holder` gives up the lock described by `state`.
+    fn remove_wait_edges_to(&self, state: &LockState, holder: ThreadId) {
+        if state.waiters.is_empty() {
+            return;
+        }
+        let mut graph = self.wait_for_graph.lock();
+        for &waiter in &state.waiters {
+            graph.remove_edge(waiter, holder);
+        }
+    }
+
+    /// Add `lock_id` to the set of locks held by `thread_id`
+    fn add_held_lock(&self, thread_id: ThreadId, lock_id: LockId) {
+        self.threads
+            .shard(thread_id)
+            .entry(thread_id)
+            .or_default()
+            .holds
+            .insert(lock_id);
+    }
+
+    /// Remove `lock_id` from the set of locks held by `thread_id`
+    fn remove_held_lock(&self, thread_id: ThreadId, lock_id: LockId) {
+        let mut shard = self.threads.shard(thread_id);
+        if let Some(thread) = shard.get_mut(&thread_id) {
+            thread.holds.remove(lock_id);
+            state::prune_thread(&mut shard, thread_id);
+        }
+    }
+
+    /// Clear the lock `thread_id` was waiting for
+    fn clear_waits_for(&self, thread_id: ThreadId) {
+        let mut shard = self.threads.shard(thread_id);
+        if let Some(thread) = shard.get_mut(&thread_id) {
+            thread.waits_for = None;
+            state::prune_thread(&mut shard, thread_id);
+        }
+    }
+
+    /// Purge `lock_id` from every thread that still refers to it
+    ///
+    /// `state` is the lock's entry, already taken out of `locks`. Its owner,
+    /// readers and waiters are the only threads whose state can mention the
+    /// lock, so destroying a lock costs O(holders + waiters) rather than a
+    /// scan over every thread.
+    fn forget_lock(&self, lock_id: LockId, state: Option<LockState>) {
+        // Statistics of the lock live on in its class
+        #[cfg(feature = "lock-stats")]
+        if stats::is_enabled() {
+            let class = self.lock_classes.shard(lock_id).remove(&lock_id);
+            stats::forget_lock(lock_id, class);
+        }
+
+        if let Some(state) = state {
+            let threads = state
+                .owner
+                .into_iter()
+                .chain(state.readers)
+                .chain(state.waiters);
+            for thread_id in threads {
+                let mut shard = self.threads.shard(thread_id);
+                if let Some(thread) = shard.get_mut(&thread_id) {
+                    thread.holds.remove(lock_id);
+                    if thread.waits_for == Some(lock_id) {
+                        thread.waits_for = None;
+                    }
+                    state::prune_thread(&mut shard, thread_id);
+                }
+            }
+        }
+
+        // Remove from lock order graph if it exists. Class nodes outlive the
+        // locks of their class, so only the class assignment goes away.
+        #[cfg(feature = "lock-order-graph")]
+        if self.order_by_class.load(Ordering::Relaxed) {
+            self.lock_classes.shard(lock_id).remove(&lock_id);
+        } else if let Some(graph) = self.lock_order_graph.get() {
+            graph.lock().remove_lock(lock_id);
+        }
+    }
+
+    /// Assign a lock to a class for lock order checking and lock statistics
+    ///
+    /// Does nothing unless the lock order graph is keyed by class or lock
+    /// statistics are enabled. Statistics ignore unique classes.
+    ///
+    /// # Arguments
+    /// * `lock_id` - ID of the lock
+    /// * `class` - Class the lock belongs to
+    ///
+    /// # Returns
+    /// Whether the class was assigned
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    pub fn set_lock_class(&self, lock_id: LockId, class: LockClass) -> bool {
+        #[cfg(feature = "lock-order-graph")]
+        let by_class = self.order_by_class.load(Ordering::Relaxed);
+        #[cfg(not(feature = "lock-order-graph"))]
+        let by_class = false;
+
+        #[cfg(feature = "lock-stats")]
+        let by_class = by_class || (stats::is_enabled() && !matches!(class, LockClass::Unique));
+
+        if !by_class {
+            return false;
+        }
+        let class_id = lock_class::intern(class);
+        self.lock_classes.shard(lock_id).insert(lock_id, class_id);
+        true
+    }
+
+    /// Class assigned to a lock, if any
+    #[cfg(feature = "lock-stats")]
+    pub fn assigned_lock_class(&self, lock_id: LockId) -> Option<LockClassId> {
+        self.lock_classes.shard(lock_id).get(&lock_id).copied()
+    }
+
+    /// Class of a lock, assigning a unique one to locks created before class
+    /// mode was enabled
+    #[cfg(feature = "lock-order-graph")]
+    fn lock_class_of(&self, lock_id: LockId) -> LockClassId {
+        *self
+            .lock_classes
+            .shard(lock_id)
+            .entry(lock_id)
+            .or_insert_with(|| lock_class::intern(LockClass::Unique))
+    }
+
     /// Check for lock order violations when a thread attempts to acquire a lock
     #[cfg(feature = "lock-order-graph")]
     fn check_lock_order_violation(
-        &mut self,
+        &self,
         thread_id: ThreadId,
         lock_id: LockId,
     ) -> Option<Vec<LockId>> {
+        self.check_batch_order_violation(thread_id, &[lock_id], None)
+            .map(|(_, lock_cycle)| lock_cycle)
+    }
+
+    /// Check for lock order violations when a thread acquires several locks at once
+    ///
+    /// A batch is acquired without holding part of it while waiting for the
+    /// rest (see `lock_many`), so its locks impose no order on each other and
+    /// only the edges from the locks held before the batch are recorded.
+    /// `blocked_on` is the lock of the batch the thread blocked on and already
+    /// holds, if any.
+    ///
+    /// # Returns
+    /// The lock of the batch that closes a cycle, and the cycle
+    #[cfg(feature = "lock-order-graph")]
+    fn check_batch_order_violation(
+        &self,
+        thread_id: ThreadId,
+        lock_ids: &[LockId],
+        blocked_on: Option<LockId>,
+    ) -> Option<(LockId, Vec<LockId>)> {
         // Only check if lock order graph is enabled
-        let graph = self.lock_order_graph.as_mut()?;
+        let graph = self.lock_order_graph.get()?;
+
+        // Copied out because the graph is a leaf lock like the thread shard;
+        // the copy stays inline for the usual handful of held locks
+        let mut held_locks: HeldLocks = {
+            let shard = self.threads.shard(thread_id);
+            shard.get(&thread_id)?.holds.clone()
+        };
+        if let Some(blocked_on) = blocked_on {
+            held_locks.remove(blocked_on);
+        }
+
+        if self.order_by_class.load(Ordering::Relaxed) {
+            return lock_ids.iter().find_map(|&lock_id| {
+                self.check_class_order_violation(graph, &held_locks, lock_id)
+                    .map(|class_cycle| (lock_id, class_cycle))
+            });
+        }
 
-        if let Some(held_locks) = self.thread_holds.get(&thread_id) {
-            for &held_lock in held_locks {
+        let mut graph = graph.lock();
+        for &lock_id in lock_ids {
+            for &held_lock in held_locks.iter() {
                 if let Some(lock_cycle) = graph.add_edge(held_lock, lock_id) {
-                    return Some(lock_cycle);
+                    return Some((lock_id, lock_cycle));
                 }
             }
         }
         None
     }
+
+    /// Class mode variant of [`Self::check_lock_order_violation`]
+    ///
+    /// Nesting two locks of the same class is not an ordering edge, and class
+    /// edges this thread has recorded before are skipped without touching the
+    /// graph, so the steady state takes no shared lock at all.
+    ///
+    /// # Returns
+    /// The cycle of class IDs, if the acquisition violates the class order
+    #[cfg(feature = "lock-order-graph")]
+    fn check_class_order_violation(
+        &self,
+        graph: &Mutex<LockOrderGraph>,
+        held_locks: &[LockId],
+        lock_id: LockId,
+    ) -> Option<Vec<LockClassId>> {
+        let class = self.lock_class_of(lock_id);
+        let new_edges: SmallVec<[LockClassId; 4]> = held_locks
+            .iter()
+            .map(|&held_lock| self.lock_class_of(held_lock))
+            .filter(|&held_class| {
+                held_class != class && !lock_class::is_known_edge(held_class, class)
+            })
+            .collect();
+        if new_edges.is_empty() {
+            return None;
+        }
+
+        let mut graph = graph.lock();
+        for held_class in new_edges {
+            if let Some(class_cycle) = graph.add_edge(held_class, class) {
+                return Some(class_cycle);
+            }
+            lock_class::remember_edge(held_class, class);
+        }
+        None
+    }
+
+    /// Whether lock order cycles are reported as lock classes
+    #[cfg(feature = "lock-order-graph")]
+    fn orders_by_class(&self) -> bool {
+        self.order_by_class.load(Ordering::Relaxed)
+    }
 }
 
 // Global detector instance and logging info for ffi
 lazy_static::lazy_static! {
-    static ref GLOBAL_DETECTOR: Mutex<Detector> = Mutex::new(Detector::new());
+    static ref GLOBAL_DETECTOR: Detector = Detector::new();
 }
 
 /// Initialize the global detector with the provided configuration
@@ -215,7 +653,7 @@ lazy_static::lazy_static! {
 /// # Arguments
 /// * `config` - The configuration object for the detector
 pub fn init_detector(config: DetectorConfig) {
-    let mut detector = GLOBAL_DETECTOR.lock();
+    let detector = &*GLOBAL_DETECTOR;
     detector.set_deadlock_callback(config.callback);
 
     #[cfg(feature = "logging-and-visualization")]
@@ -226,34 +664,114 @@ pub fn init_detector(config: DetectorConfig) {
     // Create lock order graph if enabled
     #[cfg(feature = "lock-order-graph")]
     if config.check_lock_order {
-        detector.lock_order_graph = Some(LockOrderGraph::new());
+        let _ = detector
+            .lock_order_graph
+            .set(Mutex::new(LockOrderGraph::new()));
+        detector
+            .order_by_class
+            .store(config.lock_order_by_class, Ordering::Relaxed);
     }
     #[cfg(not(feature = "lock-order-graph"))]
     #[cfg(feature = "lock-order-graph")]
     // Only warn if the field exists in config but feature is off? No, field doesn't exist.
     {} // No-op if feature is off
 
+    if let Some(sampling) = config.sampling {
+        sampling::configure(sampling);
+    }
+    if sampling::detection_from_env().unwrap_or(config.detection) {
+        sampling::enable_detection();
+    } else {
+        sampling::disable_detection();
+    }
+    if let Some(threshold) = config.deferred_detection {
+        deferred::configure(threshold);
+    }
+    #[cfg(feature = "lock-stats")]
+    if config.lock_stats {
+        stats::enable();
+    }
+
     #[cfg(feature = "stress-test")]
     {
-        detector.stress_mode = config.stress_mode;
-        detector.stress_config = config.stress_config;
+        let mut stress_mode = config.stress_mode;
+        let mut stress_config = config.stress_config;
+        crate::core::stress::apply_env_overrides(&mut stress_mode, &mut stress_config);
+        if stress_mode != StressMode::None
+            && let Some(stress_config) = &stress_config
+        {
+            crate::core::stress::begin_run(
+                stress_mode,
+                stress_config,
+                config.stress_replay.as_ref(),
+            );
+        }
+        *detector.stress_mode.write() = stress_mode;
+        *detector.stress_config.write() = stress_config;
     }
 }
 
+/// Assign a lock to a class in the global detector
+///
+/// Only has an effect when lock order checking is keyed by lock class or
+/// lock statistics are enabled.
+///
+/// # Arguments
+/// * `lock_id` - ID of the lock
+/// * `class` - Class the lock belongs to
+///
+/// # Returns
+/// Whether the class was assigned
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+pub fn set_lock_class(lock_id: LockId, class: LockClass) -> bool {
+    GLOBAL_DETECTOR.set_lock_class(lock_id, class)
+}
+
+/// Class assigned to a lock in the global detector, if any
+#[cfg(feature = "lock-stats")]
+pub fn assigned_lock_class(lock_id: LockId) -> Option<LockClassId> {
+    GLOBAL_DETECTOR.assigned_lock_class(lock_id)
+}
+
 /// Flush all pending log entries from the global detector to disk
 ///
-/// This function accesses the global detector instance and attempts to
-/// flush its logger. Unlike the method version, this requires first
-/// acquiring the global detector lock.
+/// This function flushes the logger installed by the global detector.
 ///
 /// # Returns
 /// `Ok(())` if the flush succeeded
 ///
 /// # Errors
-/// Returns an error if:
-/// - The global detector lock cannot be acquired
-/// - The logger flush operation fails
+/// Returns an error if the logger flush operation fails
 #[cfg(feature = "logging-and-visualization")]
 pub fn flush_global_detector_logs() -> Result<()> {
     logger::flush_logs()
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_fingerprints_past_capacity_evict_least_recently_seen() {
+        let mut fingerprints = Fingerprints::default();
+        for fingerprint in 0..MAX_FINGERPRINTS as u64 {
+            assert!(!fingerprints.repeat(fingerprint));
+            fingerprints.insert(fingerprint);
+        }
+        // Fingerprint 0 is the oldest, but its repeat keeps it
+        assert!(fingerprints.repeat(0));
+
+        let new = MAX_FINGERPRINTS as u64;
+        assert!(!fingerprints.repeat(new));
+        fingerprints.insert(new);
+        assert_eq!(fingerprints.entries.len(), MAX_FINGERPRINTS);
+
+        // New fingerprints are still remembered, and fingerprint 1 was evicted
+        assert!(fingerprints.repeat(new));
+        assert!(fingerprints.repeat(0));
+        assert!(!fingerprints.repeat(1));
+        assert_eq!(fingerprints.repeats(0), 2);
+        assert_eq!(fingerprints.repeats(new), 1);
+        assert_eq!(fingerprints.coalesced, 3);
+    }
+}
@@ -5,6 +5,7 @@
 
 use crate::core::detector::GLOBAL_DETECTOR;
 use crate::core::detector::deadlock_handling;
+use crate::core::detector::state;
 use crate::core::logger;
 use crate::core::types::DeadlockInfo;
 use crate::core::{Detector, Events, get_current_thread_id};
@@ -18,41 +19,37 @@ impl Detector {
     /// # Arguments
     /// * `lock_id` - ID of the created mutex
     /// * `creator_id` - Optional ID of the thread that created this mutex
-    pub fn create_mutex(&mut self, lock_id: LockId, creator_id: Option<ThreadId>) {
+    pub fn create_mutex(&self, lock_id: LockId, creator_id: Option<ThreadId>) {
         let creator = creator_id.unwrap_or_else(get_current_thread_id);
         logger::log_lock_event(lock_id, Some(creator), Events::MutexSpawn);
+
+        // Compact mutexes do not store their creator
+        #[cfg(feature = "compact-locks")]
+        if logger::is_enabled() {
+            self.creators.shard(lock_id).insert(lock_id, creator);
+        }
+    }
+
+    /// Creator of a mutex, as recorded by `create_mutex`
+    #[cfg(feature = "compact-locks")]
+    pub fn mutex_creator(&self, lock_id: LockId) -> Option<ThreadId> {
+        self.creators.shard(lock_id).get(&lock_id).copied()
     }
 
     /// Register mutex destruction
     ///
     /// # Arguments
     /// * `lock_id` - ID of the mutex being destroyed
-    pub fn destroy_mutex(&mut self, lock_id: LockId) {
-        // remove ownership
-        self.mutex_owners.remove(&lock_id);
-        // clear any pending wait-for for this lock
-        for attempts in self.thread_waits_for.values_mut() {
-            if *attempts == lock_id {
-                *attempts = 0;
-            }
-        }
-        self.thread_waits_for.retain(|_, &mut l| l != 0);
+    pub fn destroy_mutex(&self, lock_id: LockId) {
+        // remove ownership and waiters
+        let state = self.locks.shard(lock_id).remove(&lock_id);
+        #[cfg(feature = "compact-locks")]
+        self.creators.shard(lock_id).remove(&lock_id);
 
         logger::log_lock_event(lock_id, None, Events::MutexExit);
 
-        // purge from all held-lock sets
-        for holds in self.thread_holds.values_mut() {
-            holds.remove(&lock_id);
-        }
-
-        // Remove from lock order graph if it exists
-        #[cfg(feature = "lock-order-graph")]
-        if let Some(graph) = &mut self.lock_order_graph {
-            graph.remove_lock(lock_id);
-        }
-
-        // Remove from lock waiters
-        self.lock_waiters.remove(&lock_id);
+        // purge from the held-lock sets and pending wait-fors of those threads
+        self.forget_lock(lock_id, state);
     }
 
     /// Register a slow-path mutex acquisition attempt (Optimized)
@@ -67,7 +64,7 @@ impl Detector {
     /// * `lock_id` - ID of the mutex being attempted
     /// * `potential_owner` - The thread ID observed holding the lock (if any)
     pub fn acquire_slow(
-        &mut self,
+        &self,
         thread_id: ThreadId,
         lock_id: LockId,
         potential_owner: Option<ThreadId>,
@@ -75,79 +72,124 @@ impl Detector {
         // Log the attempt
         logger::log_interaction_event(thread_id, lock_id, Events::MutexAttempt);
 
-        // Apply stress testing
-
-        // Determine the effective owner.
-        // Priority: Global state > Atomic hint (if validated or waking from Condvar).
-        let effective_owner = self.mutex_owners.get(&lock_id).copied().or_else(|| {
-            if let Some(owner) = potential_owner {
-                // Trust the atomic hint from the wrapper.
-                // We rely on the wrapper to verify this edge if a deadlock is detected,
-                // to filter out stale edges from Fast Path releases.
-                return Some(owner);
-            }
+        let cycle = {
+            let mut shard = self.locks.shard(lock_id);
+            let state = shard.entry(lock_id).or_default();
+
+            // Determine the effective owner.
+            // Priority: Global state > Atomic hint (if validated or waking from Condvar).
+            // We rely on the wrapper to verify an edge built from the atomic hint
+            // if a deadlock is detected, to filter out stale edges from Fast Path releases.
+            let owner = state.owner.or(potential_owner);
+            let cycle =
+                owner.and_then(|owner| self.add_wait_edge(state, thread_id, lock_id, owner));
+            state::prune_lock(&mut shard, lock_id);
+            cycle
+        }?;
+
+        let filtered_cycle = self.filter_cycle_by_common_locks(&cycle);
+        if filtered_cycle.is_empty() {
             None
-        });
-
-        if let Some(owner) = effective_owner {
-            // We are waiting for this owner
-            self.thread_waits_for.insert(thread_id, lock_id);
-            self.lock_waiters
-                .entry(lock_id)
-                .or_default()
-                .insert(thread_id);
-
-            if let Some(cycle) = self.wait_for_graph.add_edge(thread_id, owner) {
-                let filtered_cycle = self.filter_cycle_by_common_locks(&cycle);
-
-                if !filtered_cycle.is_empty() {
-                    return Some(cycle);
-                }
-            }
+        } else {
+            Some(cycle)
         }
-        None
     }
 
     /// Complete mutex acquisition after blocking
     ///
     /// Updates detector state after a blocking lock acquisition.
     /// Call this after attempt_acquire() returns None and you use a blocking lock().
-    pub fn complete_acquire(
-        &mut self,
-        thread_id: ThreadId,
-        lock_id: LockId,
-    ) -> Option<DeadlockInfo> {
-        self.mutex_owners.insert(lock_id, thread_id);
+    pub fn complete_acquire(&self, thread_id: ThreadId, lock_id: LockId) -> Option<DeadlockInfo> {
+        {
+            let mut shard = self.locks.shard(lock_id);
+            let state = shard.entry(lock_id).or_default();
+            state.owner = Some(thread_id);
+            state.waiters.remove(&thread_id);
+            self.wait_for_graph.lock().clear_wait_edges(thread_id);
+        }
+        self.clear_waits_for(thread_id);
+
+        #[allow(unused_mut)]
+        let mut deadlock_info = None;
 
-        // Remove from lock waiters
-        if let Some(waiters) = self.lock_waiters.get_mut(&lock_id) {
-            waiters.remove(&thread_id);
-            if waiters.is_empty() {
-                self.lock_waiters.remove(&lock_id);
+        #[cfg(feature = "lock-order-graph")]
+        if let Some(lock_cycle) = self.check_lock_order_violation(thread_id, lock_id) {
+            deadlock_info =
+                Some(self.extract_lock_order_violation_info(thread_id, lock_id, lock_cycle));
+        }
+
+        self.add_held_lock(thread_id, lock_id);
+
+        logger::log_interaction_event(thread_id, lock_id, Events::MutexAcquired);
+
+        deadlock_info
+    }
+
+    /// Withdraw a wait that gave up before acquiring the mutex
+    ///
+    /// Removes the thread from the mutex's waiters and drops its wait-for
+    /// edges, so an acquisition that timed out leaves no stale edge behind.
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the thread that stopped waiting
+    /// * `lock_id` - ID of the mutex it waited for
+    pub fn cancel_wait(&self, thread_id: ThreadId, lock_id: LockId) {
+        {
+            let mut shard = self.locks.shard(lock_id);
+            if let Some(state) = shard.get_mut(&lock_id) {
+                state.waiters.remove(&thread_id);
+                state::prune_lock(&mut shard, lock_id);
             }
+            self.wait_for_graph.lock().clear_wait_edges(thread_id);
         }
+        self.clear_waits_for(thread_id);
+    }
 
-        self.thread_waits_for.remove(&thread_id);
-        self.wait_for_graph.clear_wait_edges(thread_id);
+    /// Register the acquisition of a batch of mutexes taken without blocking
+    ///
+    /// Records the whole batch in one pass: each lock's owner, a single update
+    /// of the thread's held locks, and the lock order edges from the locks held
+    /// before the batch. No edges are added between the locks of the batch.
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the thread that acquired the mutexes
+    /// * `lock_ids` - IDs of the mutexes that were acquired
+    /// * `blocked_on` - Mutex of the same batch that was acquired first by
+    ///   blocking, and is already registered as held
+    #[cfg_attr(not(feature = "lock-order-graph"), allow(unused_variables))]
+    pub fn complete_acquire_many(
+        &self,
+        thread_id: ThreadId,
+        lock_ids: &[LockId],
+        blocked_on: Option<LockId>,
+    ) -> Option<DeadlockInfo> {
+        for &lock_id in lock_ids {
+            logger::log_interaction_event(thread_id, lock_id, Events::MutexAttempt);
+            self.locks.shard(lock_id).entry(lock_id).or_default().owner = Some(thread_id);
+        }
 
         #[allow(unused_mut)]
         let mut deadlock_info = None;
 
         #[cfg(feature = "lock-order-graph")]
-        if self.lock_order_graph.is_some()
-            && self.thread_holds.get(&thread_id).map_or(0, |h| h.len()) >= 1
-            && let Some(lock_cycle) = self.check_lock_order_violation(thread_id, lock_id)
+        if let Some((lock_id, lock_cycle)) =
+            self.check_batch_order_violation(thread_id, lock_ids, blocked_on)
         {
             deadlock_info =
                 Some(self.extract_lock_order_violation_info(thread_id, lock_id, lock_cycle));
         }
 
-        self.thread_holds
-            .entry(thread_id)
-            .or_default()
-            .insert(lock_id);
+        {
+            let mut shard = self.threads.shard(thread_id);
+            let thread = shard.entry(thread_id).or_default();
+            for &lock_id in lock_ids {
+                thread.holds.insert(lock_id);
+            }
+        }
 
-        logger::log_interaction_event(thread_id, lock_id, Events::MutexAcquired);
+        for &lock_id in lock_ids {
+            logger::log_interaction_event(thread_id, lock_id, Events::MutexAcquired);
+        }
 
         deadlock_info
     }
@@ -157,27 +199,25 @@ impl Detector {
     /// # Arguments
     /// * `thread_id` - ID of the thread releasing the mutex
     /// * `lock_id` - ID of the mutex being released
-    pub fn release_mutex(&mut self, thread_id: ThreadId, lock_id: LockId) {
+    pub fn release_mutex(&self, thread_id: ThreadId, lock_id: LockId) {
         logger::log_interaction_event(thread_id, lock_id, Events::MutexReleased);
-        if self.mutex_owners.get(&lock_id) == Some(&thread_id) {
-            self.mutex_owners.remove(&lock_id);
-        }
+
         // remove from held-locks
-        if let Some(holds) = self.thread_holds.get_mut(&thread_id) {
-            holds.remove(&lock_id);
-            if holds.is_empty() {
-                self.thread_holds.remove(&thread_id);
-            }
-        }
+        self.remove_held_lock(thread_id, lock_id);
+
+        {
+            let mut shard = self.locks.shard(lock_id);
+            if let Some(state) = shard.get_mut(&lock_id) {
+                if state.owner == Some(thread_id) {
+                    state.owner = None;
+                }
 
-        // Remove stale edges for all threads waiting on this lock
-        if let Some(waiters) = self.lock_waiters.get(&lock_id) {
-            for &waiter in waiters {
                 // Each waiter currently has an edge to 'thread_id' (the current owner)
                 // We must remove it because 'thread_id' no longer owns the lock.
                 // The waiter is now waiting for "no one" (or the next owner).
                 // We don't know the next owner yet, so we just clear the edge.
-                self.wait_for_graph.remove_edge(waiter, thread_id);
+                self.remove_wait_edges_to(state, thread_id);
+                state::prune_lock(&mut shard, lock_id);
             }
         }
 
@@ -193,8 +233,19 @@ impl Detector {
 /// * `lock_id` - ID of the created mutex
 /// * `creator_id` - Optional ID of the thread that created this mutex
 pub fn create_mutex(lock_id: LockId, creator_id: Option<ThreadId>) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.create_mutex(lock_id, creator_id);
+    GLOBAL_DETECTOR.create_mutex(lock_id, creator_id);
+}
+
+/// Get the creator of a mutex from the global detector
+///
+/// # Arguments
+/// * `lock_id` - ID of the mutex
+///
+/// # Returns
+/// The creator, if it was recorded while logging was enabled
+#[cfg(feature = "compact-locks")]
+pub fn creator(lock_id: LockId) -> Option<ThreadId> {
+    GLOBAL_DETECTOR.mutex_creator(lock_id)
 }
 
 /// Register mutex destruction with the global detector
@@ -202,8 +253,7 @@ pub fn create_mutex(lock_id: LockId, creator_id: Option<ThreadId>) {
 /// # Arguments
 /// * `lock_id` - ID of the mutex being destroyed
 pub fn destroy_mutex(lock_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.destroy_mutex(lock_id);
+    GLOBAL_DETECTOR.destroy_mutex(lock_id);
 }
 
 /// Register a mutex release with the global detector
@@ -212,8 +262,7 @@ pub fn destroy_mutex(lock_id: LockId) {
 /// * `thread_id` - ID of the thread releasing the mutex
 /// * `lock_id` - ID of the mutex being released
 pub fn release_mutex(thread_id: ThreadId, lock_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.release_mutex(thread_id, lock_id);
+    GLOBAL_DETECTOR.release_mutex(thread_id, lock_id);
 }
 
 /// Complete mutex acquisition after blocking
@@ -224,10 +273,30 @@ pub fn release_mutex(thread_id: ThreadId, lock_id: LockId) {
 /// * `thread_id` - ID of the thread that acquired the mutex
 /// * `lock_id` - ID of the mutex that was acquired
 pub fn complete_acquire(thread_id: ThreadId, lock_id: LockId) {
-    let deadlock_info = {
-        let mut detector = GLOBAL_DETECTOR.lock();
-        detector.complete_acquire(thread_id, lock_id)
-    };
+    let deadlock_info = GLOBAL_DETECTOR.complete_acquire(thread_id, lock_id);
+
+    if let Some(info) = deadlock_info {
+        deadlock_handling::process_deadlock(info);
+    }
+}
+
+/// Withdraw a timed out mutex wait from the global detector
+///
+/// # Arguments
+/// * `thread_id` - ID of the thread that stopped waiting
+/// * `lock_id` - ID of the mutex it waited for
+pub fn cancel_wait(thread_id: ThreadId, lock_id: LockId) {
+    GLOBAL_DETECTOR.cancel_wait(thread_id, lock_id);
+}
+
+/// Register the acquisition of a batch of mutexes with the global detector
+///
+/// # Arguments
+/// * `thread_id` - ID of the thread that acquired the mutexes
+/// * `lock_ids` - IDs of the mutexes that were acquired
+/// * `blocked_on` - Mutex of the same batch that was acquired first by blocking
+pub fn complete_acquire_many(thread_id: ThreadId, lock_ids: &[LockId], blocked_on: Option<LockId>) {
+    let deadlock_info = GLOBAL_DETECTOR.complete_acquire_many(thread_id, lock_ids, blocked_on);
 
     if let Some(info) = deadlock_info {
         deadlock_handling::process_deadlock(info);
@@ -245,23 +314,18 @@ pub fn acquire_slow(
     lock_id: LockId,
     potential_owner: Option<ThreadId>,
 ) -> Option<DeadlockInfo> {
-    // 1. Calculate stress delay (holding lock)
+    // 1. Calculate stress delay
     #[cfg(feature = "stress-test")]
-    let delay = {
-        let detector = GLOBAL_DETECTOR.lock();
-        detector.calculate_stress_delay(thread_id, lock_id)
-    };
+    let delay = GLOBAL_DETECTOR.calculate_stress_delay(thread_id, lock_id);
 
-    // 2. Apply delay (without lock)
+    // 2. Apply delay (without holding any detector state)
     #[cfg(feature = "stress-test")]
     if let Some(duration) = delay {
         thread::sleep(duration);
     }
 
-    // 3. Proceed with detection (re-acquiring lock)
-    {
-        let mut detector = GLOBAL_DETECTOR.lock();
-        let cycle = detector.acquire_slow(thread_id, lock_id, potential_owner);
-        cycle.map(|cycle| detector.extract_deadlock_info(cycle))
-    }
+    // 3. Proceed with detection
+    let detector = &*GLOBAL_DETECTOR;
+    let cycle = detector.acquire_slow(thread_id, lock_id, potential_owner);
+    cycle.map(|cycle| detector.extract_deadlock_info(cycle))
 }
@@ -5,19 +5,22 @@
 
 use crate::core::detector::GLOBAL_DETECTOR;
 use crate::core::detector::deadlock_handling;
+use crate::core::detector::state::{self, LockState};
 use crate::core::logger;
 use crate::core::types::DeadlockInfo;
 use crate::core::{Detector, Events, get_current_thread_id};
 use crate::{LockId, ThreadId};
+use smallvec::SmallVec;
 #[cfg(feature = "stress-test")]
 use std::thread;
+
 impl Detector {
     /// Register an RwLock creation
     ///
     /// # Arguments
     /// * `lock_id` - ID of the created RwLock
     /// * `creator_id` - Optional ID of the thread that created this RwLock
-    pub fn create_rwlock(&mut self, lock_id: LockId, creator_id: Option<ThreadId>) {
+    pub fn create_rwlock(&self, lock_id: LockId, creator_id: Option<ThreadId>) {
         let creator = creator_id.unwrap_or_else(get_current_thread_id);
         logger::log_lock_event(lock_id, Some(creator), Events::RwSpawn);
     }
@@ -26,24 +29,13 @@ impl Detector {
     ///
     /// # Arguments
     /// * `lock_id` - ID of the RwLock being destroyed
-    pub fn destroy_rwlock(&mut self, lock_id: LockId) {
-        // Remove ownership (both read and write)
-        self.rwlock_writer.remove(&lock_id);
-        self.rwlock_readers.remove(&lock_id);
-
-        // Remove from all held-lock sets
-        for holds in self.thread_holds.values_mut() {
-            holds.remove(&lock_id);
-        }
+    pub fn destroy_rwlock(&self, lock_id: LockId) {
+        // Remove ownership (both read and write) and waiters
+        let state = self.locks.shard(lock_id).remove(&lock_id);
 
-        // Remove from lock order graph if it exists
-        #[cfg(feature = "lock-order-graph")]
-        if let Some(graph) = &mut self.lock_order_graph {
-            graph.remove_lock(lock_id);
-        }
+        // Remove from the held-lock sets of those threads
+        self.forget_lock(lock_id, state);
 
-        // Remove from lock waiters
-        self.lock_waiters.remove(&lock_id);
         logger::log_lock_event(lock_id, None, Events::RwExit);
     }
 
@@ -58,7 +50,7 @@ impl Detector {
     /// * `Some(T)` - Read lock was acquired successfully
     /// * `None` - Lock is busy (writer exists), deadlock detected, or acquisition failed
     pub fn attempt_read<T, F>(
-        &mut self,
+        &self,
         thread_id: ThreadId,
         lock_id: LockId,
         potential_writer: Option<ThreadId>,
@@ -70,78 +62,93 @@ impl Detector {
         // Log the attempt
         logger::log_interaction_event(thread_id, lock_id, Events::RwReadAttempt);
 
-        // Apply stress testing while holding detector lock
-
-        // Check if there's a writer (Global State OR Atomic Hint)
-        let effective_writer = self
-            .rwlock_writer
-            .get(&lock_id)
-            .copied()
-            .or(potential_writer);
-
-        if let Some(writer) = effective_writer {
-            self.thread_waits_for.insert(thread_id, lock_id);
-            self.lock_waiters
-                .entry(lock_id)
-                .or_default()
-                .insert(thread_id);
-
-            if let Some(cycle) = self.wait_for_graph.add_edge(thread_id, writer) {
-                // Apply common lock filter
-                let filtered_cycle = self.filter_cycle_by_common_locks(&cycle);
-
-                if !filtered_cycle.is_empty() {
-                    // Real deadlock detected!
-                    return Err(cycle);
-                }
+        let cycle = {
+            let mut shard = self.locks.shard(lock_id);
+            let state = shard.entry(lock_id).or_default();
+
+            // Check if there's a writer (Global State OR Atomic Hint)
+            let cycle = if let Some(writer) = state.owner.or(potential_writer) {
+                // Writer exists - will need to block
+                self.add_wait_edge(state, thread_id, lock_id, writer)
+            } else if let Some(guard) = try_acquire_fn() {
+                // No writer and the read lock was taken while the lock's shard
+                // was held, so no writer can register in between
+                state.readers.insert(thread_id);
+                drop(shard);
+                self.register_read(thread_id, lock_id);
+                return Ok(Some(guard));
+            } else {
+                // try_read failed - a writer acquired it but has not registered
+                // yet, the blocking read() that follows will wait for it
+                None
+            };
+            state::prune_lock(&mut shard, lock_id);
+            cycle
+        };
+
+        match cycle {
+            // Apply common lock filter
+            Some(cycle) if !self.filter_cycle_by_common_locks(&cycle).is_empty() => {
+                // Real deadlock detected!
+                Err(cycle)
             }
-
-            // Writer exists but no deadlock - will need to block
-            return Ok(None);
+            _ => Ok(None),
         }
+    }
 
-        // No writer - try to acquire read lock while still holding GLOBAL_DETECTOR
-        if let Some(guard) = try_acquire_fn() {
-            // Success! Update detector state immediately
-            self.rwlock_readers
-                .entry(lock_id)
-                .or_default()
-                .insert(thread_id);
-            #[cfg(feature = "lock-order-graph")]
-            self.thread_holds
-                .entry(thread_id)
-                .or_default()
-                .insert(lock_id);
-
-            // NOTE: Read locks do NOT clear wait edges!
-            // Multiple readers can coexist, so the thread stays in the graph
-            // for potential upgrade deadlock detection.
-            self.thread_waits_for.remove(&thread_id);
-
-            // Log acquisition
-            logger::log_interaction_event(thread_id, lock_id, Events::RwReadAcquired);
-
-            Ok(Some(guard))
-        } else {
-            // try_read failed - a writer must have acquired it
-            // Set up wait-for edges for the blocking read() that will follow
-            if let Some(&writer) = self.rwlock_writer.get(&lock_id) {
-                self.thread_waits_for.insert(thread_id, lock_id);
-                self.lock_waiters
-                    .entry(lock_id)
-                    .or_default()
-                    .insert(thread_id);
-
-                if let Some(cycle) = self.wait_for_graph.add_edge(thread_id, writer) {
-                    let filtered_cycle = self.filter_cycle_by_common_locks(&cycle);
-                    if !filtered_cycle.is_empty() {
-                        return Err(cycle);
-                    }
-                }
+    /// Non-blocking read lock attempt
+    ///
+    /// Unlike [`Self::attempt_read`], a lock held by a writer is not waited
+    /// for: a failed attempt logs nothing and adds no wait-for edge.
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the thread attempting to acquire the read lock
+    /// * `lock_id` - ID of the RwLock being attempted
+    /// * `try_acquire_fn` - Closure that attempts non-blocking read lock acquisition
+    ///
+    /// # Returns
+    /// * `Some(T)` - Read lock was acquired successfully
+    /// * `None` - Lock is busy
+    pub fn try_read<T, F>(
+        &self,
+        thread_id: ThreadId,
+        lock_id: LockId,
+        try_acquire_fn: F,
+    ) -> Option<T>
+    where
+        F: FnOnce() -> Option<T>,
+    {
+        let guard = {
+            let mut shard = self.locks.shard(lock_id);
+            if shard
+                .get(&lock_id)
+                .is_some_and(|state| state.owner.is_some())
+            {
+                return None;
             }
+            // Taken with the shard held, as in `attempt_read`
+            let guard = try_acquire_fn()?;
+            shard.entry(lock_id).or_default().readers.insert(thread_id);
+            guard
+        };
 
-            Ok(None)
-        }
+        logger::log_interaction_event(thread_id, lock_id, Events::RwReadAttempt);
+        self.register_read(thread_id, lock_id);
+        Some(guard)
+    }
+
+    /// Record a read lock acquired without blocking, after its reader was added
+    fn register_read(&self, thread_id: ThreadId, lock_id: LockId) {
+        #[cfg(feature = "lock-order-graph")]
+        self.add_held_lock(thread_id, lock_id);
+
+        // NOTE: Read locks do NOT clear wait edges!
+        // Multiple readers can coexist, so the thread stays in the graph
+        // for potential upgrade deadlock detection.
+        self.clear_waits_for(thread_id);
+
+        // Log acquisition
+        logger::log_interaction_event(thread_id, lock_id, Events::RwReadAcquired);
     }
 
     /// Update detector state after blocking read lock acquisition
@@ -149,25 +156,19 @@ impl Detector {
     /// # Arguments
     /// * `thread_id` - ID of the thread that acquired the read lock
     /// * `lock_id` - ID of the RwLock
-    pub fn complete_read(&mut self, thread_id: ThreadId, lock_id: LockId) {
-        self.rwlock_readers
-            .entry(lock_id)
-            .or_default()
-            .insert(thread_id);
-        #[cfg(feature = "lock-order-graph")]
-        self.thread_holds
-            .entry(thread_id)
-            .or_default()
-            .insert(lock_id);
-
-        self.thread_waits_for.remove(&thread_id);
-        if let Some(waiters) = self.lock_waiters.get_mut(&lock_id) {
-            waiters.remove(&thread_id);
-            if waiters.is_empty() {
-                self.lock_waiters.remove(&lock_id);
-            }
+    pub fn complete_read(&self, thread_id: ThreadId, lock_id: LockId) {
+        {
+            let mut shard = self.locks.shard(lock_id);
+            let state = shard.entry(lock_id).or_default();
+            state.readers.insert(thread_id);
+            state.waiters.remove(&thread_id);
         }
 
+        #[cfg(feature = "lock-order-graph")]
+        self.add_held_lock(thread_id, lock_id);
+
+        self.clear_waits_for(thread_id);
+
         // Log acquisition
         logger::log_interaction_event(thread_id, lock_id, Events::RwReadAcquired);
     }
@@ -177,56 +178,64 @@ impl Detector {
     /// # Arguments
     /// * `thread_id` - ID of the thread releasing the read lock
     /// * `lock_id` - ID of the RwLock being released
-    pub fn release_read(&mut self, thread_id: ThreadId, lock_id: LockId) {
+    pub fn release_read(&self, thread_id: ThreadId, lock_id: LockId) {
         logger::log_interaction_event(thread_id, lock_id, Events::RwReadReleased);
-        if let Some(readers) = self.rwlock_readers.get_mut(&lock_id) {
-            readers.remove(&thread_id);
-            if readers.is_empty() {
-                self.rwlock_readers.remove(&lock_id);
-            }
-        }
 
-        #[cfg(feature = "lock-order-graph")]
-        if let Some(holds) = self.thread_holds.get_mut(&thread_id) {
-            holds.remove(&lock_id);
-            if holds.is_empty() {
-                self.thread_holds.remove(&thread_id);
+        {
+            let mut shard = self.locks.shard(lock_id);
+            if let Some(state) = shard.get_mut(&lock_id) {
+                state.readers.remove(&thread_id);
+
+                // Remove stale edges for all threads waiting on this lock
+                // (e.g. writers waiting for this reader)
+                self.remove_wait_edges_to(state, thread_id);
+                state::prune_lock(&mut shard, lock_id);
             }
         }
 
-        // Remove stale edges for all threads waiting on this lock
-        // (e.g. writers waiting for this reader)
-        if let Some(waiters) = self.lock_waiters.get(&lock_id) {
-            for &waiter in waiters {
-                self.wait_for_graph.remove_edge(waiter, thread_id);
-            }
-        }
+        #[cfg(feature = "lock-order-graph")]
+        self.remove_held_lock(thread_id, lock_id);
 
         #[cfg(feature = "stress-test")]
         self.stress_on_lock_release(thread_id, lock_id);
     }
 
+    /// Drop the wait-for edges towards a fast-path reader that gave up
+    ///
+    /// A reader that published itself and then backed off without taking the
+    /// lock may already have been linked by a waiting writer.
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the reader
+    /// * `lock_id` - ID of the RwLock
+    pub fn unlink_reader(&self, thread_id: ThreadId, lock_id: LockId) {
+        let mut shard = self.locks.shard(lock_id);
+        if let Some(state) = shard.get_mut(&lock_id) {
+            self.remove_wait_edges_to(state, thread_id);
+            state::prune_lock(&mut shard, lock_id);
+        }
+    }
+
     /// Register a write lock release by a thread
     ///
     /// # Arguments
     /// * `thread_id` - ID of the thread releasing the write lock
     /// * `lock_id` - ID of the RwLock being released
-    pub fn release_write(&mut self, thread_id: ThreadId, lock_id: LockId) {
+    pub fn release_write(&self, thread_id: ThreadId, lock_id: LockId) {
         logger::log_interaction_event(thread_id, lock_id, Events::RwWriteReleased);
-        if self.rwlock_writer.get(&lock_id) == Some(&thread_id) {
-            self.rwlock_writer.remove(&lock_id);
-        }
-        if let Some(holds) = self.thread_holds.get_mut(&thread_id) {
-            holds.remove(&lock_id);
-            if holds.is_empty() {
-                self.thread_holds.remove(&thread_id);
-            }
-        }
 
-        // Remove stale edges for all threads waiting on this lock
-        if let Some(waiters) = self.lock_waiters.get(&lock_id) {
-            for &waiter in waiters {
-                self.wait_for_graph.remove_edge(waiter, thread_id);
+        self.remove_held_lock(thread_id, lock_id);
+
+        {
+            let mut shard = self.locks.shard(lock_id);
+            if let Some(state) = shard.get_mut(&lock_id) {
+                if state.owner == Some(thread_id) {
+                    state.owner = None;
+                }
+
+                // Remove stale edges for all threads waiting on this lock
+                self.remove_wait_edges_to(state, thread_id);
+                state::prune_lock(&mut shard, lock_id);
             }
         }
 
@@ -244,63 +253,71 @@ impl Detector {
     /// * `thread_id` - ID of the thread attempting to acquire the write lock
     /// * `lock_id` - ID of the RwLock being attempted
     /// * `potential_writer` - The thread ID observed holding the write lock (if any)
-    pub fn acquire_write_slow(
-        &mut self,
+    /// * `link_fast_readers` - Collects the readers that acquired the lock
+    ///   without the detector, called while the lock's state is held
+    pub fn acquire_write_slow<R>(
+        &self,
         thread_id: ThreadId,
         lock_id: LockId,
         potential_writer: Option<ThreadId>,
-    ) -> Option<DeadlockInfo> {
+        link_fast_readers: impl FnOnce() -> R,
+    ) -> Option<DeadlockInfo>
+    where
+        R: IntoIterator<Item = ThreadId>,
+    {
         // Log the attempt
         logger::log_interaction_event(thread_id, lock_id, Events::RwWriteAttempt);
 
         #[cfg(feature = "lock-order-graph")]
-        if self.lock_order_graph.is_some()
-            && self.thread_holds.get(&thread_id).map_or(0, |h| h.len()) >= 1
-            && let Some(lock_cycle) = self.check_lock_order_violation(thread_id, lock_id)
-        {
+        if let Some(lock_cycle) = self.check_lock_order_violation(thread_id, lock_id) {
             return Some(self.extract_lock_order_violation_info(thread_id, lock_id, lock_cycle));
         }
 
-        // Check for conflicting readers (Global State)
-        if let Some(readers) = self.rwlock_readers.get(&lock_id) {
-            for &reader in readers {
-                if reader != thread_id {
-                    self.thread_waits_for.insert(thread_id, lock_id);
-                    self.lock_waiters
-                        .entry(lock_id)
-                        .or_default()
-                        .insert(thread_id);
-                    if let Some(cycle) = self.wait_for_graph.add_edge(thread_id, reader) {
-                        // No common lock filtering for upgrades (Reader->Writer deps)
-                        return Some(self.extract_deadlock_info(cycle));
+        let cycle = {
+            let mut shard = self.locks.shard(lock_id);
+            let LockState {
+                owner,
+                readers,
+                waiters,
+            } = shard.entry(lock_id).or_default();
+
+            // Conflicting readers (Global State), then the conflicting writer
+            // (Global State or Atomic Hint). We rely on the wrapper to verify
+            // an edge built from the atomic hint if a deadlock is detected.
+            let writer = owner.or(potential_writer).filter(|&w| w != thread_id);
+            let holders: SmallVec<[ThreadId; 8]> = readers
+                .iter()
+                .copied()
+                .chain(link_fast_readers())
+                .filter(|&r| r != thread_id)
+                .chain(writer)
+                .collect();
+
+            let mut cycle = None;
+            if !holders.is_empty() {
+                waiters.insert(thread_id);
+                self.threads
+                    .shard(thread_id)
+                    .entry(thread_id)
+                    .or_default()
+                    .waits_for = Some(lock_id);
+
+                // No common lock filtering for upgrades (Reader->Writer deps).
+                // Every holder is linked even after a cycle is found, since
+                // the wrapper may drop that cycle as stale and keep waiting.
+                let mut graph = self.wait_for_graph.lock();
+                for holder in holders {
+                    let found = self.link_waiter(&mut graph, thread_id, holder);
+                    if cycle.is_none() {
+                        cycle = found;
                     }
                 }
             }
-        }
-
-        // Check for conflicting writer (Global State or Atomic Hint)
-        let effective_writer = self.rwlock_writer.get(&lock_id).copied().or_else(|| {
-            if let Some(writer) = potential_writer {
-                // Trust the atomic hint from the wrapper.
-                // We rely on the wrapper to verify this edge if a deadlock is detected.
-                return Some(writer);
-            }
-            None
-        });
+            state::prune_lock(&mut shard, lock_id);
+            cycle
+        };
 
-        if let Some(writer) = effective_writer
-            && writer != thread_id
-        {
-            self.thread_waits_for.insert(thread_id, lock_id);
-            self.lock_waiters
-                .entry(lock_id)
-                .or_default()
-                .insert(thread_id);
-            if let Some(cycle) = self.wait_for_graph.add_edge(thread_id, writer) {
-                return Some(self.extract_deadlock_info(cycle));
-            }
-        }
-        None
+        cycle.map(|cycle| self.extract_deadlock_info(cycle))
     }
 
     /// Update detector state after blocking write lock acquisition
@@ -308,35 +325,27 @@ impl Detector {
     /// # Arguments
     /// * `thread_id` - ID of the thread that acquired the write lock
     /// * `lock_id` - ID of the RwLock
-    pub fn complete_write(&mut self, thread_id: ThreadId, lock_id: LockId) -> Option<DeadlockInfo> {
-        self.rwlock_writer.insert(lock_id, thread_id);
+    pub fn complete_write(&self, thread_id: ThreadId, lock_id: LockId) -> Option<DeadlockInfo> {
+        // Record the writer and clear wait-for edges
+        {
+            let mut shard = self.locks.shard(lock_id);
+            let state = shard.entry(lock_id).or_default();
+            state.owner = Some(thread_id);
+            state.waiters.remove(&thread_id);
+            self.wait_for_graph.lock().clear_wait_edges(thread_id);
+        }
 
         #[allow(unused_mut)]
         let mut deadlock_info = None;
 
         #[cfg(feature = "lock-order-graph")]
-        if self.lock_order_graph.is_some()
-            && self.thread_holds.get(&thread_id).map_or(0, |h| h.len()) >= 1
-            && let Some(lock_cycle) = self.check_lock_order_violation(thread_id, lock_id)
-        {
+        if let Some(lock_cycle) = self.check_lock_order_violation(thread_id, lock_id) {
             deadlock_info =
                 Some(self.extract_lock_order_violation_info(thread_id, lock_id, lock_cycle));
         }
 
-        self.thread_holds
-            .entry(thread_id)
-            .or_default()
-            .insert(lock_id);
-
-        // Clear wait-for edges
-        self.thread_waits_for.remove(&thread_id);
-        if let Some(waiters) = self.lock_waiters.get_mut(&lock_id) {
-            waiters.remove(&thread_id);
-            if waiters.is_empty() {
-                self.lock_waiters.remove(&lock_id);
-            }
-        }
-        self.wait_for_graph.clear_wait_edges(thread_id);
+        self.add_held_lock(thread_id, lock_id);
+        self.clear_waits_for(thread_id);
 
         // Log acquisition
         logger::log_interaction_event(thread_id, lock_id, Events::RwWriteAcquired);
@@ -347,26 +356,28 @@ impl Detector {
 
 /// Register an RwLock creation with the global detector
 pub fn create_rwlock(lock_id: LockId, creator_id: Option<ThreadId>) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.create_rwlock(lock_id, creator_id);
+    GLOBAL_DETECTOR.create_rwlock(lock_id, creator_id);
 }
 
 /// Register RwLock destruction with the global detector
 pub fn destroy_rwlock(lock_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.destroy_rwlock(lock_id);
+    GLOBAL_DETECTOR.destroy_rwlock(lock_id);
 }
 
 /// Register an RwLock read release with the global detector
 pub fn release_read(thread_id: ThreadId, lock_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.release_read(thread_id, lock_id);
+    GLOBAL_DETECTOR.release_read(thread_id, lock_id);
+}
+
+/// Drop the wait-for edges towards a fast-path reader that gave up
+#[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+pub fn unlink_reader(thread_id: ThreadId, lock_id: LockId) {
+    GLOBAL_DETECTOR.unlink_reader(thread_id, lock_id);
 }
 
 /// Register a RwLock write release with the global detector
 pub fn release_write(thread_id: ThreadId, lock_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.release_write(thread_id, lock_id);
+    GLOBAL_DETECTOR.release_write(thread_id, lock_id);
 }
 
 /// Read lock attempt and try-acquire with the global detector
@@ -383,27 +394,23 @@ pub fn attempt_read<T, F>(thread_id: ThreadId, lock_id: LockId, try_acquire_fn:
 where
     F: FnOnce() -> Option<T>,
 {
-    // 1. Calculate stress delay (holding lock)
+    // 1. Calculate stress delay
     #[cfg(feature = "stress-test")]
-    let delay = {
-        let detector = GLOBAL_DETECTOR.lock();
-        detector.calculate_stress_delay(thread_id, lock_id)
-    };
+    let delay = GLOBAL_DETECTOR.calculate_stress_delay(thread_id, lock_id);
 
-    // 2. Apply delay (without lock)
+    // 2. Apply delay (without holding any detector state)
     #[cfg(feature = "stress-test")]
     if let Some(duration) = delay {
         thread::sleep(duration);
     }
 
-    // 3. Proceed with detection (re-acquiring lock)
-    let (result, deadlock_info) = {
-        let mut detector = GLOBAL_DETECTOR.lock();
+    // 3. Proceed with detection
+    let detector = &*GLOBAL_DETECTOR;
+    let (result, deadlock_info) =
         match detector.attempt_read(thread_id, lock_id, None, try_acquire_fn) {
             Ok(val) => (val, None),
             Err(cycle) => (None, Some(detector.extract_deadlock_info(cycle))),
-        }
-    };
+        };
 
     if let Some(info) = deadlock_info {
         deadlock_handling::process_deadlock(info);
@@ -412,14 +419,36 @@ where
     result
 }
 
+/// Non-blocking read lock attempt with the global detector
+///
+/// # Arguments
+/// * `thread_id` - ID of the thread attempting to acquire the read lock
+/// * `lock_id` - ID of the RwLock being attempted
+/// * `try_acquire_fn` - Closure that attempts non-blocking read lock acquisition
+///
+/// # Returns
+/// * `Some(T)` - Read lock was acquired successfully
+/// * `None` - Lock is busy
+pub fn try_read<T, F>(thread_id: ThreadId, lock_id: LockId, try_acquire_fn: F) -> Option<T>
+where
+    F: FnOnce() -> Option<T>,
+{
+    // Still a decision point for stress testing
+    #[cfg(feature = "stress-test")]
+    if let Some(duration) = GLOBAL_DETECTOR.calculate_stress_delay(thread_id, lock_id) {
+        thread::sleep(duration);
+    }
+
+    GLOBAL_DETECTOR.try_read(thread_id, lock_id, try_acquire_fn)
+}
+
 /// Complete read lock acquisition after blocking
 ///
 /// # Arguments
 /// * `thread_id` - ID of the thread that acquired the read lock
 /// * `lock_id` - ID of the RwLock
 pub fn complete_read(thread_id: ThreadId, lock_id: LockId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.complete_read(thread_id, lock_id);
+    GLOBAL_DETECTOR.complete_read(thread_id, lock_id);
 }
 
 /// Register a slow-path write lock acquisition attempt with the global detector
@@ -428,29 +457,29 @@ pub fn complete_read(thread_id: ThreadId, lock_id: LockId) {
 /// * `thread_id` - ID of the thread attempting to acquire the write lock
 /// * `lock_id` - ID of the RwLock being attempted
 /// * `potential_writer` - The thread ID observed holding the write lock
-pub fn acquire_write_slow(
+/// * `link_fast_readers` - Collects the readers that acquired the lock
+///   without the detector, called while the lock's state is held
+pub fn acquire_write_slow<R>(
     thread_id: ThreadId,
     lock_id: LockId,
     potential_writer: Option<ThreadId>,
-) -> Option<DeadlockInfo> {
-    // 1. Calculate stress delay (holding lock)
+    link_fast_readers: impl FnOnce() -> R,
+) -> Option<DeadlockInfo>
+where
+    R: IntoIterator<Item = ThreadId>,
+{
+    // 1. Calculate stress delay
     #[cfg(feature = "stress-test")]
-    let delay = {
-        let detector = GLOBAL_DETECTOR.lock();
-        detector.calculate_stress_delay(thread_id, lock_id)
-    };
+    let delay = GLOBAL_DETECTOR.calculate_stress_delay(thread_id, lock_id);
 
-    // 2. Apply delay (without lock)
+    // 2. Apply delay (without holding any detector state)
     #[cfg(feature = "stress-test")]
     if let Some(duration) = delay {
         thread::sleep(duration);
     }
 
-    // 3. Proceed with detection (re-acquiring lock)
-    {
-        let mut detector = GLOBAL_DETECTOR.lock();
-        detector.acquire_write_slow(thread_id, lock_id, potential_writer)
-    }
+    // 3. Proceed with detection
+    GLOBAL_DETECTOR.acquire_write_slow(thread_id, lock_id, potential_writer, link_fast_readers)
 }
 
 /// Complete write lock acquisition after blocking
@@ -459,10 +488,7 @@ pub fn acquire_write_slow(
 /// * `thread_id` - ID of the thread that acquired the write lock
 /// * `lock_id` - ID of the RwLock
 pub fn complete_write(thread_id: ThreadId, lock_id: LockId) {
-    let deadlock_info = {
-        let mut detector = GLOBAL_DETECTOR.lock();
-        detector.complete_write(thread_id, lock_id)
-    };
+    let deadlock_info = GLOBAL_DETECTOR.complete_write(thread_id, lock_id);
 
     if let Some(info) = deadlock_info {
         deadlock_handling::process_deadlock(info);
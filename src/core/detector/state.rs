@@ -0,0 +1,229 @@
+//! Sharded per-lock and per-thread detector state
+//!
+//! The detector used to keep every ownership map behind one global mutex, so
+//! uncontended lock operations on unrelated locks still serialized on it. The
+//! bookkeeping is now split by key: everything about a single lock lives in a
+//! [`LockState`] and everything about a single thread lives in a
+//! [`ThreadState`], each stored in a [`ShardedMap`] whose shard is picked from
+//! the ID. Only the wait-for graph remains a single shared structure.
+//!
+//! # Lock ordering
+//!
+//! To stay deadlock-free internally, detector code takes its locks in this order:
+//! 1. At most one lock shard (`Detector::locks`)
+//! 2. The wait-for graph
+//! 3. Thread shards, condvar shards and the lock order graph, as leaves
+//!
+//! A leaf lock is never held while acquiring any other detector lock.
+
+use crate::core::types::{CondvarId, LockId, ThreadId};
+use fxhash::{FxHashMap, FxHashSet};
+use parking_lot::{Mutex, MutexGuard};
+use smallvec::SmallVec;
+
+/// Number of shards per map (must be a power of two)
+///
+/// IDs are handed out sequentially, so the low bits alone spread them evenly.
+const SHARD_COUNT: usize = 64;
+
+/// A map from IDs to values split across independently locked shards
+pub struct ShardedMap<V> {
+    shards: Box<[Mutex<FxHashMap<usize, V>>]>,
+}
+
+impl<V> Default for ShardedMap<V> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<V> ShardedMap<V> {
+    /// Create an empty sharded map
+    pub fn new() -> Self {
+        ShardedMap {
+            shards: (0..SHARD_COUNT)
+                .map(|_| Mutex::new(FxHashMap::default()))
+                .collect(),
+        }
+    }
+
+    /// Lock and return the shard responsible for `key`
+    ///
+    /// # Arguments
+    /// * `key` - Lock, thread or condvar ID
+    pub fn shard(&self, key: usize) -> MutexGuard<'_, FxHashMap<usize, V>> {
+        self.shards[key & (SHARD_COUNT - 1)].lock()
+    }
+
+    /// Iterate over all shards, locking them one at a time
+    pub fn shards(&self) -> impl Iterator<Item = &Mutex<FxHashMap<usize, V>>> {
+        self.shards.iter()
+    }
+}
+
+/// Number of held locks stored inline before [`HeldLocks`] spills to the heap
+const HELD_LOCKS_INLINE: usize = 4;
+
+/// The set of locks a thread holds
+///
+/// Threads rarely hold more than a handful of locks at once, so the set is a
+/// small inline array searched linearly. Copying it or intersecting it with
+/// another set allocates nothing until a thread holds more than
+/// `HELD_LOCKS_INLINE` locks.
+#[derive(Clone, Default)]
+pub struct HeldLocks(SmallVec<[LockId; HELD_LOCKS_INLINE]>);
+
+impl HeldLocks {
+    /// Add a lock, returning whether it was not held before
+    pub fn insert(&mut self, lock_id: LockId) -> bool {
+        if self.contains(lock_id) {
+            return false;
+        }
+        self.0.push(lock_id);
+        true
+    }
+
+    /// Remove a lock, returning whether it was held
+    pub fn remove(&mut self, lock_id: LockId) -> bool {
+        match self.0.iter().position(|&held| held == lock_id) {
+            Some(index) => {
+                self.0.swap_remove(index);
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Whether the lock is held
+    pub fn contains(&self, lock_id: LockId) -> bool {
+        self.0.contains(&lock_id)
+    }
+
+    /// Keep only the locks for which `keep` returns true
+    pub fn retain(&mut self, mut keep: impl FnMut(LockId) -> bool) {
+        self.0.retain(|held| keep(*held));
+    }
+
+    /// Remove all locks
+    pub fn clear(&mut self) {
+        self.0.clear();
+    }
+}
+
+/// The held locks, in no particular order
+impl std::ops::Deref for HeldLocks {
+    type Target = [LockId];
+
+    fn deref(&self) -> &[LockId] {
+        &self.0
+    }
+}
+
+/// Detector bookkeeping for a single Mutex or RwLock
+#[derive(Default)]
+pub struct LockState {
+    /// Thread that owns the mutex or holds the RwLock for writing
+    pub owner: Option<ThreadId>,
+    /// Threads currently holding the RwLock for reading
+    pub readers: FxHashSet<ThreadId>,
+    /// Threads waiting for this lock (for stale edge removal)
+    pub waiters: FxHashSet<ThreadId>,
+}
+
+impl LockState {
+    /// Whether this entry carries no information and can be dropped
+    pub fn is_idle(&self) -> bool {
+        self.owner.is_none() && self.readers.is_empty() && self.waiters.is_empty()
+    }
+}
+
+/// Detector bookkeeping for a single thread
+#[derive(Default)]
+pub struct ThreadState {
+    /// Locks this thread currently holds
+    pub holds: HeldLocks,
+    /// Lock this thread is attempting to acquire
+    pub waits_for: Option<LockId>,
+    /// Condvar and mutex this thread is waiting on
+    pub wait_cv: Option<(CondvarId, LockId)>,
+    /// Whether this thread has been woken from a condvar wait (for diagnostics)
+    pub cv_woken: bool,
+}
+
+impl ThreadState {
+    /// Whether this entry carries no information and can be dropped
+    pub fn is_idle(&self) -> bool {
+        self.holds.is_empty()
+            && self.waits_for.is_none()
+            && self.wait_cv.is_none()
+            && !self.cv_woken
+    }
+}
+
+/// Remove the entry for `key` from a shard if it no longer carries state
+pub fn prune_lock(shard: &mut FxHashMap<LockId, LockState>, key: LockId) {
+    if shard.get(&key).is_some_and(LockState::is_idle) {
+        shard.remove(&key);
+    }
+}
+
+/// Remove the entry for `key` from a shard if it no longer carries state
+pub fn prune_thread(shard: &mut FxHashMap<ThreadId, ThreadState>, key: ThreadId) {
+    if shard.get(&key).is_some_and(ThreadState::is_idle) {
+        shard.remove(&key);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_sequential_ids_spread_across_shards() {
+        let map: ShardedMap<u32> = ShardedMap::new();
+        for id in 0..SHARD_COUNT * 2 {
+            map.shard(id).insert(id, id as u32);
+        }
+        for shard in map.shards() {
+            assert_eq!(shard.lock().len(), 2);
+        }
+    }
+
+    #[test]
+    fn test_prune_idle_entries() {
+        let mut locks: FxHashMap<LockId, LockState> = FxHashMap::default();
+        locks.entry(1).or_default().owner = Some(7);
+        locks.entry(2).or_default();
+        prune_lock(&mut locks, 1);
+        prune_lock(&mut locks, 2);
+        assert!(locks.contains_key(&1));
+        assert!(!locks.contains_key(&2));
+
+        let mut threads: FxHashMap<ThreadId, ThreadState> = FxHashMap::default();
+        threads.entry(1).or_default().holds.insert(3);
+        threads.entry(2).or_default();
+        prune_thread(&mut threads, 1);
+        prune_thread(&mut threads, 2);
+        assert!(threads.contains_key(&1));
+        assert!(!threads.contains_key(&2));
+    }
+
+    #[test]
+    fn test_held_locks_behave_as_a_set() {
+        let mut held = HeldLocks::default();
+        for lock_id in 1..=HELD_LOCKS_INLINE + 2 {
+            assert!(held.insert(lock_id));
+        }
+        assert!(!held.insert(1));
+        assert_eq!(held.len(), HELD_LOCKS_INLINE + 2);
+
+        assert!(held.remove(2));
+        assert!(!held.remove(2));
+        assert!(held.contains(1) && !held.contains(2));
+
+        held.retain(|lock_id| lock_id % 2 == 1);
+        let mut remaining = held.to_vec();
+        remaining.sort_unstable();
+        assert_eq!(remaining, vec![1, 3, 5]);
+    }
+}
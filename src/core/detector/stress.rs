@@ -8,15 +8,17 @@ impl crate::core::Detector {
         thread_id: crate::core::ThreadId,
         lock_id: crate::core::LockId,
     ) -> Option<std::time::Duration> {
-        if self.stress_mode != crate::core::stress::StressMode::None {
-            if let Some(config) = &self.stress_config {
+        let stress_mode = *self.stress_mode.read();
+        if stress_mode != crate::core::stress::StressMode::None {
+            if let Some(config) = &*self.stress_config.read() {
                 let held_locks = self
-                    .thread_holds
+                    .threads
+                    .shard(thread_id)
                     .get(&thread_id)
-                    .map(|set| set.iter().copied().collect::<Vec<_>>())
+                    .map(|thread| thread.holds.clone())
                     .unwrap_or_default();
 
-                calculate_stress_delay(self.stress_mode, thread_id, lock_id, &held_locks, config)
+                calculate_stress_delay(stress_mode, thread_id, lock_id, &held_locks, config)
                     .map(std::time::Duration::from_micros)
             } else {
                 None
@@ -31,8 +33,8 @@ impl crate::core::Detector {
         _thread_id: crate::core::ThreadId,
         _lock_id: crate::core::LockId,
     ) {
-        if self.stress_mode != crate::core::stress::StressMode::None
-            && let Some(config) = &self.stress_config
+        if *self.stress_mode.read() != crate::core::stress::StressMode::None
+            && let Some(config) = &*self.stress_config.read()
             && config.preempt_after_release
         {
             std::thread::yield_now();
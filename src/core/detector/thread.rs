@@ -1,5 +1,6 @@
 use crate::ThreadId;
 use crate::core::detector::GLOBAL_DETECTOR;
+use crate::core::detector::state;
 use crate::core::logger;
 use crate::core::{Detector, Events};
 
@@ -13,11 +14,11 @@ impl Detector {
     /// # Arguments
     /// * `thread_id` - ID of the newly spawned thread
     /// * `parent_id` - Optional ID of the parent thread that created this thread
-    pub fn spawn_thread(&mut self, thread_id: ThreadId, parent_id: Option<ThreadId>) {
+    pub fn spawn_thread(&self, thread_id: ThreadId, parent_id: Option<ThreadId>) {
         logger::log_thread_event(thread_id, parent_id, Events::ThreadSpawn);
 
         // Ensure node exists in the wait-for graph
-        self.wait_for_graph.edges.entry(thread_id).or_default();
+        self.wait_for_graph.lock().add_thread(thread_id);
     }
 
     /// Register a thread exit
@@ -27,13 +28,17 @@ impl Detector {
     ///
     /// # Arguments
     /// * `thread_id` - ID of the exiting thread
-    pub fn exit_thread(&mut self, thread_id: ThreadId) {
+    pub fn exit_thread(&self, thread_id: ThreadId) {
         logger::log_thread_event(thread_id, None, Events::ThreadExit);
 
         // remove thread and its edges from the wait-for graph
-        self.wait_for_graph.remove_thread(thread_id);
+        self.wait_for_graph.lock().remove_thread(thread_id);
         // no more held locks
-        self.thread_holds.remove(&thread_id);
+        let mut shard = self.threads.shard(thread_id);
+        if let Some(thread) = shard.get_mut(&thread_id) {
+            thread.holds.clear();
+            state::prune_thread(&mut shard, thread_id);
+        }
 
         // Note: We don't clean up cv_woken, thread_wait_cv, or thread_waits_for here
         // because these might be needed for deadlock detection even after thread exit.
@@ -47,8 +52,7 @@ impl Detector {
 /// * `thread_id` - ID of the spawned thread
 /// * `parent_id` - Optional ID of the parent thread that created this thread
 pub fn spawn_thread(thread_id: ThreadId, parent_id: Option<ThreadId>) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.spawn_thread(thread_id, parent_id);
+    GLOBAL_DETECTOR.spawn_thread(thread_id, parent_id);
 }
 
 /// Register a thread exit with the global detector
@@ -56,6 +60,5 @@ pub fn spawn_thread(thread_id: ThreadId, parent_id: Option<ThreadId>) {
 /// # Arguments
 /// * `thread_id` - ID of the exiting thread
 pub fn exit_thread(thread_id: ThreadId) {
-    let mut detector = GLOBAL_DETECTOR.lock();
-    detector.exit_thread(thread_id);
+    GLOBAL_DETECTOR.exit_thread(thread_id);
 }
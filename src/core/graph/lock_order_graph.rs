@@ -9,19 +9,18 @@
 //! When a thread holds lock A and then acquires lock B, we record that A < B.
 //! If later we see an attempt to acquire A while holding B (B < A), this creates
 //! a cycle in the lock order and indicates a potential deadlock.
+//!
+//! # Incremental cycle detection
+//!
+//! The graph maintains a topological order of its locks (Pearce–Kelly dynamic
+//! topological sort). Inserting an edge that agrees with the current order cannot
+//! close a cycle and costs O(1). Only when the new edge points backwards in the
+//! order do we search, and then only the region between the two endpoints: a
+//! forward search from `after` that either reaches `before` (a cycle) or
+//! collects the locks that must move, followed by a local reordering.
 
 use crate::core::types::LockId;
 use fxhash::{FxHashMap, FxHashSet};
-use std::collections::VecDeque;
-
-/// Cache entry for cycle detection results
-#[derive(Debug, Clone)]
-struct CacheEntry {
-    /// Generation when this entry was created
-    generation: u64,
-    /// The cycle found, or None if no cycle
-    result: Option<Vec<LockId>>,
-}
 
 /// Represents a directed edge in the lock order graph
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
@@ -50,18 +49,20 @@ pub struct LockOrderGraph {
     /// All recorded edges for debugging and reporting
     all_edges: FxHashSet<LockOrderEdge>,
 
-    /// Optimization 2: Cache for cycle detection results
-    /// Key: (before, after), Value: cached result with generation
-    cycle_cache: FxHashMap<(LockId, LockId), CacheEntry>,
+    /// Position of each lock in a topological order of the graph
+    /// Invariant: for every edge A -> B, `order[A] < order[B]`
+    order: FxHashMap<LockId, u64>,
 
-    /// Generation counter, incremented on each edge addition
-    /// Used to invalidate stale cache entries
-    generation: u64,
+    /// Position handed to the next lock seen for the first time
+    next_order: u64,
 
-    // Cached buffers for BFS to avoid repeated allocations
-    bfs_queue: VecDeque<LockId>,
-    bfs_visited: FxHashSet<LockId>,
-    bfs_parent: FxHashMap<LockId, LockId>,
+    // Cached buffers for the affected-region searches to avoid repeated allocations
+    search_stack: Vec<LockId>,
+    visited: FxHashSet<LockId>,
+    parent: FxHashMap<LockId, LockId>,
+    delta_forward: Vec<LockId>,
+    delta_backward: Vec<LockId>,
+    free_positions: Vec<u64>,
 }
 
 impl LockOrderGraph {
@@ -71,11 +72,14 @@ impl LockOrderGraph {
             edges: FxHashMap::default(),
             reverse_edges: FxHashMap::default(),
             all_edges: FxHashSet::default(),
-            cycle_cache: FxHashMap::default(),
-            generation: 0,
-            bfs_queue: VecDeque::with_capacity(64),
-            bfs_visited: FxHashSet::default(),
-            bfs_parent: FxHashMap::default(),
+            order: FxHashMap::default(),
+            next_order: 0,
+            search_stack: Vec::with_capacity(64),
+            visited: FxHashSet::default(),
+            parent: FxHashMap::default(),
+            delta_forward: Vec::new(),
+            delta_backward: Vec::new(),
+            free_positions: Vec::new(),
         }
     }
 
@@ -94,127 +98,160 @@ impl LockOrderGraph {
             return None;
         }
 
-        // Optimization 2: Check cache first
-        let cache_key = (before, after);
-        if let Some(cached) = self.cycle_cache.get(&cache_key) {
-            // Cache hit! Check if still valid (same generation means no new edges since)
-            if cached.generation == self.generation {
-                return cached.result.clone();
-            }
+        // Known edges were checked when they were first recorded
+        let edge = LockOrderEdge { before, after };
+        if self.all_edges.contains(&edge) {
+            return None;
         }
 
-        // Check if adding this edge would create a cycle (i.e., if there's already a path from `after` to `before`)
-        let cycle_result = if let Some(cycle) = self.find_path(after, before) {
-            // Found a cycle: there's already a path after -> ... -> before
-            // Adding before -> after would complete the cycle
-            let mut full_cycle = cycle;
-            full_cycle.push(after); // Close the cycle
-            Some(full_cycle)
-        } else {
-            None
-        };
-
-        // Cache the result before modifying the graph
-        self.cycle_cache.insert(
-            cache_key,
-            CacheEntry {
-                generation: self.generation,
-                result: cycle_result.clone(),
-            },
-        );
-
-        // If no cycle, record the edge
-        if cycle_result.is_none() {
-            let edge = LockOrderEdge { before, after };
-            if self.all_edges.insert(edge) {
-                // This is a new edge, add it to the adjacency lists
-                self.edges.entry(before).or_default().insert(after);
-                self.reverse_edges.entry(after).or_default().insert(before);
-
-                // Increment generation to invalidate cache entries
-                // (they're based on the old graph state)
-                self.generation = self.generation.wrapping_add(1);
-
-                // Optimization 3: Incremental cache invalidation
-                // Only invalidate cache entries that might be affected
-                // For now, we invalidate all (future: only invalidate paths through new edge)
-                if self.cycle_cache.len() > 1000 {
-                    // Clear cache if it gets too large
-                    self.cycle_cache.clear();
-                }
+        // Locks seen for the first time go to the end of the order, so a
+        // fresh `before -> after` pair never needs a search
+        let upper = self.position(before);
+        let lower = self.position(after);
+
+        if upper > lower {
+            // The edge points backwards in the current order. A cycle exists iff
+            // there is already a path after -> ... -> before
+            if let Some(mut cycle) = self.discover_forward(after, before, upper) {
+                // Adding before -> after would complete the cycle
+                cycle.push(after); // Close the cycle
+                return Some(cycle);
             }
+            self.discover_backward(before, lower);
+            self.reorder();
         }
 
-        cycle_result
+        // No cycle, record the edge
+        self.all_edges.insert(edge);
+        self.edges.entry(before).or_default().insert(after);
+        self.reverse_edges.entry(after).or_default().insert(before);
+
+        None
     }
 
-    /// Find a path from `start` to `end` in the lock order graph using BFS
-    ///
-    /// Optimization 3: Early termination and edge existence check
-    /// - Returns immediately if start has no outgoing edges
-    /// - Stops as soon as end is found (no need to explore further)
+    /// Get the topological position of a lock, appending it if unseen
+    fn position(&mut self, lock_id: LockId) -> u64 {
+        let next = &mut self.next_order;
+        *self.order.entry(lock_id).or_insert_with(|| {
+            let position = *next;
+            *next += 1;
+            position
+        })
+    }
+
+    /// Search forward from `start` through locks positioned at most `upper`
     ///
-    /// # Arguments
-    /// * `start` - Starting lock
-    /// * `end` - Target lock
+    /// Collects the visited locks in `delta_forward`.
     ///
     /// # Returns
-    /// `Some(Vec<LockId>)` containing the path from start to end if one exists,
-    /// `None` if no path exists
-    fn find_path(&mut self, start: LockId, end: LockId) -> Option<Vec<LockId>> {
-        if start == end {
-            return Some(vec![start]);
-        }
+    /// The path from `start` to `target` if one exists
+    fn discover_forward(
+        &mut self,
+        start: LockId,
+        target: LockId,
+        upper: u64,
+    ) -> Option<Vec<LockId>> {
+        self.delta_forward.clear();
+        self.visited.clear();
+        self.parent.clear();
+        self.search_stack.clear();
+
+        self.search_stack.push(start);
+        self.visited.insert(start);
+
+        while let Some(current) = self.search_stack.pop() {
+            self.delta_forward.push(current);
+
+            let Some(successors) = self.edges.get(&current) else {
+                continue;
+            };
+            for &next in successors {
+                if next == target {
+                    // Reconstruct path
+                    let mut path = vec![target, current];
+                    let mut node = current;
+                    while let Some(&prev) = self.parent.get(&node) {
+                        path.push(prev);
+                        node = prev;
+                    }
+                    path.reverse();
+                    return Some(path);
+                }
 
-        // Optimization 3a: Early termination - check if there are any edges from start
-        if !self.edges.contains_key(&start) {
-            return None;
+                // Locks past `upper` cannot lead back to `target`
+                if self.order[&next] < upper && self.visited.insert(next) {
+                    self.parent.insert(next, current);
+                    self.search_stack.push(next);
+                }
+            }
         }
 
-        // Standard BFS with early termination, reusing cached buffers
-        self.bfs_queue.clear();
-        self.bfs_visited.clear();
-        self.bfs_parent.clear();
-
-        self.bfs_queue.push_back(start);
-        self.bfs_visited.insert(start);
-
-        while let Some(current) = self.bfs_queue.pop_front() {
-            if let Some(neighbors) = self.edges.get(&current) {
-                for &neighbor in neighbors {
-                    if !self.bfs_visited.contains(&neighbor) {
-                        self.bfs_visited.insert(neighbor);
-                        self.bfs_parent.insert(neighbor, current);
-
-                        // Optimization 3b: Early termination - found the target
-                        if neighbor == end {
-                            // Reconstruct path immediately
-                            let mut path = vec![end];
-                            let mut node = end;
-                            while let Some(&prev) = self.bfs_parent.get(&node) {
-                                path.push(prev);
-                                node = prev;
-                            }
-                            path.reverse();
-                            return Some(path);
-                        }
-
-                        self.bfs_queue.push_back(neighbor);
-                    }
+        None
+    }
+
+    /// Search backward from `start` through locks positioned above `lower`
+    ///
+    /// Collects the visited locks in `delta_backward`.
+    fn discover_backward(&mut self, start: LockId, lower: u64) {
+        self.delta_backward.clear();
+        self.visited.clear();
+        self.search_stack.clear();
+
+        self.search_stack.push(start);
+        self.visited.insert(start);
+
+        while let Some(current) = self.search_stack.pop() {
+            self.delta_backward.push(current);
+
+            let Some(predecessors) = self.reverse_edges.get(&current) else {
+                continue;
+            };
+            for &prev in predecessors {
+                if self.order[&prev] > lower && self.visited.insert(prev) {
+                    self.search_stack.push(prev);
                 }
             }
         }
+    }
 
-        None
+    /// Reassign the positions of the affected region
+    ///
+    /// Everything that reaches `before` is moved ahead of everything reachable
+    /// from `after`, reusing the positions the two sets occupied.
+    fn reorder(&mut self) {
+        let order = &self.order;
+        self.delta_backward.sort_unstable_by_key(|lock| order[lock]);
+        self.delta_forward.sort_unstable_by_key(|lock| order[lock]);
+
+        self.free_positions.clear();
+        self.free_positions.extend(
+            self.delta_backward
+                .iter()
+                .chain(&self.delta_forward)
+                .map(|lock| order[lock]),
+        );
+        self.free_positions.sort_unstable();
+
+        for (lock, &position) in self
+            .delta_backward
+            .iter()
+            .chain(&self.delta_forward)
+            .zip(&self.free_positions)
+        {
+            self.order.insert(*lock, position);
+        }
     }
 
     /// Remove all edges involving a specific lock
     ///
-    /// This is called when a lock is destroyed.
+    /// This is called when a lock is destroyed. Removing a lock keeps the
+    /// remaining order valid, so this is proportional to the lock's degree.
     ///
     /// # Arguments
     /// * `lock_id` - ID of the lock to remove
     pub fn remove_lock(&mut self, lock_id: LockId) {
+        self.order.remove(&lock_id);
+
         // Remove outgoing edges
         if let Some(successors) = self.edges.remove(&lock_id) {
             for successor in successors {
@@ -293,16 +330,62 @@ mod tests {
     fn test_cache_behavior() {
         let mut graph = LockOrderGraph::new();
 
-        // First check should miss cache and do BFS
+        // First check records the edge
         assert!(graph.add_edge(1, 2).is_none());
 
-        // Same check should hit cache
+        // Same check hits the known-edge fast path
         assert!(graph.add_edge(1, 2).is_none());
 
-        // Adding new edge should invalidate cache
+        // Adding an unrelated edge
         assert!(graph.add_edge(3, 4).is_none());
 
-        // Cache should work for new queries
+        // Known edges stay valid
         assert!(graph.add_edge(3, 4).is_none());
     }
+
+    /// Check that every edge agrees with the maintained topological order
+    fn assert_order_valid(graph: &LockOrderGraph) {
+        for edge in &graph.all_edges {
+            assert!(
+                graph.order[&edge.before] < graph.order[&edge.after],
+                "edge {} -> {} violates the order",
+                edge.before,
+                edge.after
+            );
+        }
+    }
+
+    #[test]
+    fn test_backward_insertions_reorder() {
+        let mut graph = LockOrderGraph::new();
+
+        // Build the chain 5 -> 4 -> 3 -> 2 -> 1 from the end, so every
+        // insertion points backwards in the initial order
+        for lock in 1..=5 {
+            graph.position(lock);
+        }
+        for lock in (1..5).rev() {
+            assert!(graph.add_edge(lock + 1, lock).is_none());
+            assert_order_valid(&graph);
+        }
+
+        // Closing the chain reports the whole cycle
+        assert_eq!(graph.add_edge(1, 5), Some(vec![5, 4, 3, 2, 1, 5]));
+        assert_order_valid(&graph);
+    }
+
+    #[test]
+    fn test_remove_lock_breaks_cycle() {
+        let mut graph = LockOrderGraph::new();
+        assert!(graph.add_edge(1, 2).is_none());
+        assert!(graph.add_edge(2, 3).is_none());
+
+        graph.remove_lock(2);
+        assert!(graph.add_edge(3, 1).is_none());
+        assert_order_valid(&graph);
+
+        // A recreated lock starts without any ordering constraints
+        assert!(graph.add_edge(2, 3).is_none());
+        assert!(graph.add_edge(1, 2).is_some());
+    }
 }
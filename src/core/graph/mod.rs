@@ -2,12 +2,13 @@
 //!
 //! This module contains graph implementations used for deadlock detection:
 //! - Wait-for graph: tracks which threads are waiting for which other threads
-//! - Lock order graph: tracks the order in which locks are acquired (optional feature)
+//! - Lock order graph: tracks the order in which locks are acquired (optional
+//!   feature, also used by the offline log analysis)
 
-#[cfg(feature = "lock-order-graph")]
+#[cfg(any(feature = "lock-order-graph", feature = "logging-and-visualization"))]
 pub mod lock_order_graph;
 pub mod wait_for_graph;
 
-#[cfg(feature = "lock-order-graph")]
+#[cfg(any(feature = "lock-order-graph", feature = "logging-and-visualization"))]
 pub use lock_order_graph::LockOrderGraph;
 pub use wait_for_graph::WaitForGraph;
@@ -6,34 +6,61 @@
 //!
 //! # How it works
 //!
-//! The graph maintains two internal mappings to ensure O(1) performance for both
-//! edge addition and thread removal:
-//! 1. *Forward Graph (⁠ edges ⁠)*: Maps ⁠ Thread A -> {Thread B} ⁠. Used to detect cycles (BFS).
-//! 2. *Reverse Graph (⁠ incoming_edges ⁠)*: Maps ⁠ Thread B -> {Thread A} ⁠. Used to efficiently
+//! Thread IDs grow monotonically, so the graph maps each live thread to a dense
+//! *slot* index and works on slots internally. Slots are recycled when a thread
+//! exits, which keeps every per-thread array as small as the number of live threads.
+//!
+//! The graph maintains two adjacency arrays indexed by slot, each entry a small
+//! inline vector, so adding an edge does not allocate in the common case:
+//! 1. *Forward Graph (`edges`)*: Maps `Thread A -> {Thread B}`. Used to detect cycles (BFS).
+//! 2. *Reverse Graph (`incoming_edges`)*: Maps `Thread B -> {Thread A}`. Used to efficiently
 //!    clean up dependencies when a thread exits without iterating the entire graph.
 //!
 //! When a thread (Thread A) attempts to acquire a resource held by another thread
-//! (Thread B), we propose a directed edge ⁠ A -> B ⁠. Before adding this edge,
+//! (Thread B), we propose a directed edge `A -> B`. Before adding this edge,
 //! the graph checks if a path already exists from B to A (cycle detection).
+//! The search runs over the contiguous slot arrays with a bitset of visited slots.
+//!
+//! With deferred detection, edges are inserted without the search and a thread
+//! that stays blocked looks for a cycle through itself later. Threads of a cycle
+//! found that way are marked as reported until their outgoing edges change, so
+//! the cycle is returned only once.
 
 use crate::core::types::ThreadId;
-use fxhash::{FxHashMap, FxHashSet};
-use std::collections::VecDeque;
+use fxhash::FxHashMap;
+use smallvec::SmallVec;
+
+/// Dense index of a live thread inside the graph
+type Slot = u32;
+
+/// Neighbors of a slot; threads rarely wait for more than a few others
+type Neighbors = SmallVec<[Slot; 4]>;
 
 /// Represents a directed graph of thread wait relationships
 pub struct WaitForGraph {
-    /// Maps a thread to all the threads it is waiting for (outgoing edges).
+    /// Maps a live thread to its slot
+    slots: FxHashMap<ThreadId, Slot>,
+    /// Maps a slot back to the thread occupying it
+    threads: Vec<ThreadId>,
+    /// Slots released by exited threads, reused before the arrays grow
+    free_slots: Vec<Slot>,
+
+    /// Slot-indexed list of the threads each thread is waiting for (outgoing edges).
     /// Primary source for cycle detection.
-    pub(crate) edges: FxHashMap<ThreadId, FxHashSet<ThreadId>>,
+    edges: Vec<Neighbors>,
+
+    /// Slot-indexed list of the threads waiting for each thread (incoming edges).
+    /// Used for cleanup proportional to neighbors when a thread exits.
+    incoming_edges: Vec<Neighbors>,
 
-    /// Maps a thread to all threads that are waiting for it (incoming edges).
-    /// Used for O(1) cleanup when a thread exits.
-    pub(crate) incoming_edges: FxHashMap<ThreadId, FxHashSet<ThreadId>>,
+    /// Slot-indexed flags of threads that are part of an already returned
+    /// deferred cycle. Cleared when the thread's outgoing edges are.
+    reported: Vec<bool>,
 
     // Cached buffers for BFS to avoid repeated allocations
-    bfs_queue: VecDeque<ThreadId>,
-    bfs_visited: FxHashSet<ThreadId>,
-    bfs_parent: FxHashMap<ThreadId, ThreadId>,
+    bfs_queue: Vec<Slot>,
+    bfs_visited: Vec<u64>,
+    bfs_parent: Vec<Slot>,
 }
 
 impl Default for WaitForGraph {
@@ -49,92 +76,186 @@ impl WaitForGraph {
     /// A new initialized WaitForGraph instance
     pub fn new() -> Self {
         Self {
-            edges: FxHashMap::default(),
-            incoming_edges: FxHashMap::default(),
-            bfs_queue: VecDeque::with_capacity(64),
-            bfs_visited: FxHashSet::default(),
-            bfs_parent: FxHashMap::default(),
+            slots: FxHashMap::default(),
+            threads: Vec::new(),
+            free_slots: Vec::new(),
+            edges: Vec::new(),
+            incoming_edges: Vec::new(),
+            reported: Vec::new(),
+            bfs_queue: Vec::with_capacity(64),
+            bfs_visited: Vec::new(),
+            bfs_parent: Vec::new(),
         }
     }
 
-    /// Add a directed edge: ⁠ from ⁠ thread waits for ⁠ to ⁠ thread
+    /// Register a thread so that it owns a slot before it takes part in any edge
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the thread
+    pub fn add_thread(&mut self, thread_id: ThreadId) {
+        self.slot_for(thread_id);
+    }
+
+    /// Number of live threads known to the graph
+    pub fn thread_count(&self) -> usize {
+        self.slots.len()
+    }
+
+    /// Look up the slot of a thread, assigning one if needed
+    fn slot_for(&mut self, thread_id: ThreadId) -> Slot {
+        if let Some(&slot) = self.slots.get(&thread_id) {
+            return slot;
+        }
+
+        let slot = match self.free_slots.pop() {
+            Some(slot) => {
+                self.threads[slot as usize] = thread_id;
+                slot
+            }
+            None => {
+                let slot = self.threads.len() as Slot;
+                self.threads.push(thread_id);
+                self.edges.push(Neighbors::new());
+                self.incoming_edges.push(Neighbors::new());
+                self.reported.push(false);
+                self.bfs_parent.push(0);
+                if self.bfs_visited.len() * 64 < self.threads.len() {
+                    self.bfs_visited.push(0);
+                }
+                slot
+            }
+        };
+        self.slots.insert(thread_id, slot);
+        slot
+    }
+
+    /// Add a directed edge: `from` thread waits for `to` thread
     ///
     /// Adds the edge and detects if it would create a deadlock cycle.
     ///
     /// # Arguments
-    /// * ⁠ from ⁠ - The thread ID that is waiting
-    /// * ⁠ to ⁠ - The thread ID that holds the resource
+    /// * `from` - The thread ID that is waiting
+    /// * `to` - The thread ID that holds the resource
     ///
     /// # Returns
-    /// * ⁠ Some(Vec<ThreadId>) ⁠ - The cycle if adding this edge would create one
-    /// * ⁠ None ⁠ - If no cycle would be created
+    /// * `Some(Vec<ThreadId>)` - The cycle if adding this edge would create one
+    /// * `None` - If no cycle would be created
     pub fn add_edge(&mut self, from: ThreadId, to: ThreadId) -> Option<Vec<ThreadId>> {
+        let from_slot = self.slot_for(from);
+        let to_slot = self.slot_for(to);
+
         // Optimization: Do not perform BFS if the edge already exists
-        if let Some(targets) = self.edges.get(&from)
-            && targets.contains(&to)
-        {
+        if self.edges[from_slot as usize].contains(&to_slot) {
             return None;
         }
 
         // Check if adding this edge would create a cycle
         // A cycle is created if there is already a path from 'to' to 'from'.
-        if let Some(path) = self.find_path(to, from) {
+        if let Some(path) = self.find_path(to_slot, from_slot) {
             return Some(path);
         }
 
         // No cycle - add the Forward Edge
-        self.edges.entry(from).or_default().insert(to);
+        self.edges[from_slot as usize].push(to_slot);
 
         // Add the Reverse Edge (for efficient cleanup)
-        self.incoming_edges.entry(to).or_default().insert(from);
+        self.incoming_edges[to_slot as usize].push(from_slot);
 
         None
     }
 
+    /// Add a directed edge without checking whether it closes a cycle
+    ///
+    /// Used when cycle detection is deferred; see [`Self::find_unreported_cycle`].
+    ///
+    /// # Arguments
+    /// * `from` - The thread ID that is waiting
+    /// * `to` - The thread ID that holds the resource
+    pub fn insert_edge(&mut self, from: ThreadId, to: ThreadId) {
+        let from_slot = self.slot_for(from);
+        let to_slot = self.slot_for(to);
+
+        if !self.edges[from_slot as usize].contains(&to_slot) {
+            self.edges[from_slot as usize].push(to_slot);
+            self.incoming_edges[to_slot as usize].push(from_slot);
+        }
+    }
+
+    /// Make `to` the only thread `from` waits for
+    ///
+    /// Does nothing if that is already the case, so a thread that keeps
+    /// checking an unchanged wait stays marked as reported.
+    ///
+    /// # Arguments
+    /// * `from` - The thread ID that is waiting
+    /// * `to` - The thread ID that now holds the resource
+    pub fn retarget_edges(&mut self, from: ThreadId, to: ThreadId) {
+        let from_slot = self.slot_for(from);
+        let to_slot = self.slot_for(to);
+
+        if self.edges[from_slot as usize].as_slice() != [to_slot] {
+            self.clear_outgoing(from_slot);
+            self.insert_edge(from, to);
+        }
+    }
+
+    /// Find a cycle through `thread_id` that has not been returned before
+    ///
+    /// Every thread of the returned cycle is marked as reported, and a cycle
+    /// made only of reported threads is not returned again. A deadlocked
+    /// thread can therefore check repeatedly while the deadlock is reported
+    /// once.
+    ///
+    /// # Arguments
+    /// * `thread_id` - The thread that stayed blocked
+    ///
+    /// # Returns
+    /// * `Some(Vec<ThreadId>)` - A new cycle, starting with a thread `thread_id` waits for
+    /// * `None` - If there is no cycle through `thread_id`, or it was already returned
+    pub fn find_unreported_cycle(&mut self, thread_id: ThreadId) -> Option<Vec<ThreadId>> {
+        let slot = *self.slots.get(&thread_id)?;
+        let targets = self.edges[slot as usize].clone();
+        let cycle = targets
+            .into_iter()
+            .find_map(|target| self.find_path(target, slot))?;
+
+        let slots: Vec<Slot> = cycle.iter().map(|thread| self.slots[thread]).collect();
+        if slots.iter().all(|&slot| self.reported[slot as usize]) {
+            return None;
+        }
+        for slot in slots {
+            self.reported[slot as usize] = true;
+        }
+        Some(cycle)
+    }
+
     /// Clear the wait edges for a thread (what it's waiting for)
     ///
     /// This is typically called when a thread successfully acquires a lock
     /// and is no longer waiting.
     ///
     /// # Arguments
-    /// * ⁠ thread_id ⁠ - The thread that stopped waiting
+    /// * `thread_id` - The thread that stopped waiting
     pub fn clear_wait_edges(&mut self, thread_id: ThreadId) {
-        // Remove the forward edges
-        if let Some(targets) = self.edges.remove(&thread_id) {
-            // Update the reverse mapping for every thread we were waiting on
-            for target in targets {
-                if let Some(waiters) = self.incoming_edges.get_mut(&target) {
-                    waiters.remove(&thread_id);
-                    // Cleanup empty sets to save memory
-                    if waiters.is_empty() {
-                        self.incoming_edges.remove(&target);
-                    }
-                }
-            }
+        if let Some(&slot) = self.slots.get(&thread_id) {
+            self.clear_outgoing(slot);
         }
     }
 
-    /// Remove a specific directed edge: ⁠ from ⁠ thread waits for ⁠ to ⁠ thread
+    /// Remove a specific directed edge: `from` thread waits for `to` thread
     ///
     /// # Arguments
-    /// * ⁠ from ⁠ - The waiting thread
-    /// * ⁠ to ⁠ - The target thread
+    /// * `from` - The waiting thread
+    /// * `to` - The target thread
     pub fn remove_edge(&mut self, from: ThreadId, to: ThreadId) {
-        // Remove from forward graph
-        if let Some(neighbors) = self.edges.get_mut(&from)
-            && neighbors.remove(&to)
-        {
-            if neighbors.is_empty() {
-                self.edges.remove(&from);
-            }
+        let (Some(&from_slot), Some(&to_slot)) = (self.slots.get(&from), self.slots.get(&to))
+        else {
+            return;
+        };
 
-            // Remove from reverse graph
-            if let Some(waiters) = self.incoming_edges.get_mut(&to) {
-                waiters.remove(&from);
-                if waiters.is_empty() {
-                    self.incoming_edges.remove(&to);
-                }
-            }
+        // Remove from forward graph, then from reverse graph
+        if remove_slot(&mut self.edges[from_slot as usize], to_slot) {
+            remove_slot(&mut self.incoming_edges[to_slot as usize], from_slot);
         }
     }
 
@@ -142,65 +263,79 @@ impl WaitForGraph {
     ///
     /// This is called when a thread exits. Unlike the naive implementation,
     /// this operation is efficient (proportional to neighbors, not total threads)
-    /// thanks to the reverse graph.
+    /// thanks to the reverse graph. The thread's slot is recycled afterwards.
     ///
     /// # Arguments
-    /// * ⁠ thread_id ⁠ - ID of the thread being removed
+    /// * `thread_id` - ID of the thread being removed
     pub fn remove_thread(&mut self, thread_id: ThreadId) {
+        let Some(slot) = self.slots.remove(&thread_id) else {
+            return;
+        };
+
         // 1. Remove outgoing edges (Who was this thread waiting for?)
-        self.clear_wait_edges(thread_id);
+        self.clear_outgoing(slot);
 
         // 2. Remove incoming edges (Who was waiting for this thread?)
-        if let Some(waiters) = self.incoming_edges.remove(&thread_id) {
-            for waiter in waiters {
-                // For every thread that was waiting on the exiting thread,
-                // remove the forward edge pointing to the exiting thread.
-                if let Some(forward_set) = self.edges.get_mut(&waiter) {
-                    forward_set.remove(&thread_id);
-                    if forward_set.is_empty() {
-                        self.edges.remove(&waiter);
-                    }
-                }
-            }
+        // For every thread that was waiting on the exiting thread,
+        // remove the forward edge pointing to the exiting thread.
+        let waiters = std::mem::take(&mut self.incoming_edges[slot as usize]);
+        for waiter in waiters {
+            remove_slot(&mut self.edges[waiter as usize], slot);
+        }
+
+        self.free_slots.push(slot);
+    }
+
+    /// Remove the outgoing edges of a slot and their reverse entries
+    fn clear_outgoing(&mut self, slot: Slot) {
+        let targets = std::mem::take(&mut self.edges[slot as usize]);
+        // Update the reverse mapping for every thread we were waiting on
+        for &target in &targets {
+            remove_slot(&mut self.incoming_edges[target as usize], slot);
         }
+        // Hand the (possibly spilled) buffer back to avoid reallocating it
+        self.edges[slot as usize] = targets;
+        self.edges[slot as usize].clear();
+        self.reported[slot as usize] = false;
     }
 
     /// Find a path from start to target using BFS
     ///
     /// Used internally for cycle detection.
-    fn find_path(&mut self, start: ThreadId, target: ThreadId) -> Option<Vec<ThreadId>> {
+    fn find_path(&mut self, start: Slot, target: Slot) -> Option<Vec<ThreadId>> {
         if start == target {
-            return Some(vec![start]);
+            return Some(vec![self.threads[start as usize]]);
         }
 
         // Reuse cached buffers
         self.bfs_queue.clear();
-        self.bfs_visited.clear();
-        self.bfs_parent.clear();
+        self.bfs_visited.fill(0);
 
-        self.bfs_queue.push_back(start);
-        self.bfs_visited.insert(start);
+        self.bfs_queue.push(start);
+        mark_visited(&mut self.bfs_visited, start);
+
+        let mut head = 0;
+        while head < self.bfs_queue.len() {
+            let current = self.bfs_queue[head];
+            head += 1;
 
-        while let Some(current) = self.bfs_queue.pop_front() {
             if current == target {
                 // Reconstruct path
-                let mut path = Vec::with_capacity(self.bfs_parent.len() + 1);
+                let mut path = Vec::new();
                 let mut curr = target;
-                path.push(curr);
-                while let Some(&p) = self.bfs_parent.get(&curr) {
-                    path.push(p);
-                    curr = p;
+                path.push(self.threads[curr as usize]);
+                while curr != start {
+                    curr = self.bfs_parent[curr as usize];
+                    path.push(self.threads[curr as usize]);
                 }
                 path.reverse();
                 return Some(path);
             }
 
-            if let Some(neighbors) = self.edges.get(&current) {
-                for &neighbor in neighbors {
-                    if self.bfs_visited.insert(neighbor) {
-                        self.bfs_parent.insert(neighbor, current);
-                        self.bfs_queue.push_back(neighbor);
-                    }
+            for &neighbor in &self.edges[current as usize] {
+                if mark_visited(&mut self.bfs_visited, neighbor) {
+                    self.bfs_parent[neighbor as usize] = current;
+                    self.bfs_queue.push(neighbor);
                 }
             }
         }
@@ -208,3 +343,98 @@ impl WaitForGraph {
         None
     }
 }
+
+/// Remove one occurrence of `slot`, returning whether it was present
+fn remove_slot(neighbors: &mut Neighbors, slot: Slot) -> bool {
+    match neighbors.iter().position(|&s| s == slot) {
+        Some(pos) => {
+            neighbors.swap_remove(pos);
+            true
+        }
+        None => false,
+    }
+}
+
+/// Set the visited bit of `slot`, returning whether it was newly set
+fn mark_visited(visited: &mut [u64], slot: Slot) -> bool {
+    let word = &mut visited[slot as usize / 64];
+    let bit = 1u64 << (slot % 64);
+    let newly = *word & bit == 0;
+    *word |= bit;
+    newly
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cycle_detection() {
+        let mut graph = WaitForGraph::new();
+        assert!(graph.add_edge(1, 2).is_none());
+        assert!(graph.add_edge(2, 3).is_none());
+        assert_eq!(graph.add_edge(3, 1), Some(vec![1, 2, 3]));
+    }
+
+    #[test]
+    fn test_removed_edges_break_cycles() {
+        let mut graph = WaitForGraph::new();
+        graph.add_edge(1, 2);
+        graph.add_edge(2, 3);
+        graph.remove_edge(2, 3);
+        assert!(graph.add_edge(3, 1).is_none());
+
+        graph.clear_wait_edges(3);
+        graph.add_edge(2, 3);
+        graph.clear_wait_edges(1);
+        assert!(graph.add_edge(3, 1).is_none());
+    }
+
+    #[test]
+    fn test_slots_are_recycled_on_thread_exit() {
+        let mut graph = WaitForGraph::new();
+        graph.add_edge(1, 2);
+        graph.add_edge(3, 2);
+        assert_eq!(graph.thread_count(), 3);
+
+        graph.remove_thread(2);
+        assert_eq!(graph.thread_count(), 2);
+
+        // The new thread takes over the slot of thread 2 without its edges
+        graph.add_thread(4);
+        assert_eq!(graph.threads.len(), 3);
+        assert!(graph.add_edge(4, 1).is_none());
+        assert!(graph.add_edge(4, 3).is_none());
+        assert_eq!(graph.add_edge(1, 4), Some(vec![4, 1]));
+    }
+
+    #[test]
+    fn test_deferred_cycle_is_found_once() {
+        let mut graph = WaitForGraph::new();
+        graph.insert_edge(1, 2);
+        graph.insert_edge(2, 3);
+        assert!(graph.find_unreported_cycle(1).is_none());
+
+        graph.insert_edge(3, 1);
+        assert_eq!(graph.find_unreported_cycle(1), Some(vec![2, 3, 1]));
+        assert!(graph.find_unreported_cycle(1).is_none());
+        assert!(graph.find_unreported_cycle(3).is_none());
+
+        // An unchanged wait keeps the mark, a new one clears it
+        graph.retarget_edges(3, 1);
+        assert!(graph.find_unreported_cycle(2).is_none());
+        graph.retarget_edges(3, 4);
+        graph.insert_edge(4, 1);
+        assert_eq!(graph.find_unreported_cycle(3), Some(vec![4, 1, 2, 3]));
+    }
+
+    #[test]
+    fn test_large_graph_path() {
+        let mut graph = WaitForGraph::new();
+        for t in 1..200 {
+            assert!(graph.add_edge(t, t + 1).is_none());
+        }
+        let cycle = graph.add_edge(200, 1).unwrap();
+        assert_eq!(cycle, (1..=200).collect::<Vec<_>>());
+    }
+}
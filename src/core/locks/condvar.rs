@@ -1,9 +1,9 @@
 use crate::core::detector;
-use crate::core::locks::{NEXT_LOCK_ID, mutex::MutexGuard};
+use crate::core::locks::{mutex::MutexGuard, next_lock_id};
+use crate::core::sampling;
 use crate::core::types::{CondvarId, get_current_thread_id};
 use parking_lot::Condvar as ParkingLotCondvar;
 use std::ops::DerefMut;
-use std::sync::atomic::Ordering;
 use std::time::Duration;
 
 /// A wrapper around a condition variable that tracks operations for deadlock detection
@@ -58,7 +58,7 @@ impl Condvar {
     /// let condvar = Condvar::new();
     /// ```
     pub fn new() -> Self {
-        let id = NEXT_LOCK_ID.fetch_add(1, Ordering::SeqCst);
+        let id = next_lock_id();
 
         // Register the condvar with the detector
         detector::condvar::create_condvar(id);
@@ -107,6 +107,14 @@ impl Condvar {
         let thread_id = get_current_thread_id();
         let mutex_id = guard.lock_id();
 
+        // A wait on an unsampled acquisition stays invisible to the detector
+        if !guard.is_sampled() {
+            guard.clear_ownership();
+            self.inner.wait(guard.inner_guard());
+            guard.restore_ownership();
+            return;
+        }
+
         // Report wait begin
         crate::core::detector::condvar::begin_wait(thread_id, self.id, mutex_id);
 
@@ -172,6 +180,16 @@ impl Condvar {
         let thread_id = get_current_thread_id();
         let mutex_id = guard.lock_id();
 
+        if !guard.is_sampled() {
+            guard.clear_ownership();
+            let timed_out = self
+                .inner
+                .wait_for(guard.inner_guard(), timeout)
+                .timed_out();
+            guard.restore_ownership();
+            return timed_out;
+        }
+
         crate::core::detector::condvar::begin_wait(thread_id, self.id, mutex_id);
 
         // 1. CLEAR OWNERSHIP
@@ -307,7 +325,9 @@ impl Condvar {
         let thread_id = get_current_thread_id();
 
         // Report the notify operation to the detector first (for synthetic mutex attempts)
-        detector::condvar::notify_one(self.id, thread_id);
+        if sampling::is_detection_enabled() {
+            detector::condvar::notify_one(self.id, thread_id);
+        }
 
         // Perform the actual notification
         self.inner.notify_one();
@@ -338,7 +358,9 @@ impl Condvar {
         let thread_id = get_current_thread_id();
 
         // Report the notify operation to the detector first (for synthetic mutex attempts)
-        detector::condvar::notify_all(self.id, thread_id);
+        if sampling::is_detection_enabled() {
+            detector::condvar::notify_all(self.id, thread_id);
+        }
 
         // Perform the actual notification
         self.inner.notify_all();
@@ -1,7 +1,45 @@
 pub mod condvar;
 pub mod mutex;
+#[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+pub(crate) mod read_tracking;
 pub mod rwlock;
+mod tracking;
 
-use std::sync::atomic::AtomicUsize;
+use crate::core::types::LockId;
+use std::cell::Cell;
+use std::sync::atomic::{AtomicUsize, Ordering};
 
-pub(crate) static NEXT_LOCK_ID: AtomicUsize = AtomicUsize::new(1);
+/// Number of lock IDs a thread takes from `NEXT_LOCK_ID` the first time
+const FIRST_LOCK_ID_BLOCK: usize = 4;
+/// Largest number of lock IDs a thread takes at a time
+const MAX_LOCK_ID_BLOCK: usize = 256;
+
+static NEXT_LOCK_ID: AtomicUsize = AtomicUsize::new(1);
+
+thread_local! {
+    // Next free ID of this thread's block, the end of the block, and the
+    // size of the next block
+    static LOCK_IDS: Cell<(LockId, LockId, usize)> =
+        const { Cell::new((0, 0, FIRST_LOCK_ID_BLOCK)) };
+}
+
+/// Allocate the ID of a new lock
+///
+/// Threads take IDs from the global counter in blocks, so creating locks
+/// does not contend on a shared cache line. A thread's blocks start small
+/// and double up to `MAX_LOCK_ID_BLOCK`, so a thread that creates only a
+/// few locks leaves only a few IDs unused: every thread claims fewer than
+/// twice the IDs it uses, plus four. IDs are unique, and increase in
+/// creation order within each thread.
+pub(crate) fn next_lock_id() -> LockId {
+    LOCK_IDS.with(|ids| {
+        let (mut next, mut end, mut block) = ids.get();
+        if next == end {
+            next = NEXT_LOCK_ID.fetch_add(block, Ordering::Relaxed);
+            end = next + block;
+            block = (block * 2).min(MAX_LOCK_ID_BLOCK);
+        }
+        ids.set((next + 1, end, block));
+        next
+    })
+}
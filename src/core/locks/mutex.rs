@@ -1,12 +1,20 @@
 use crate::core::detector;
-use crate::core::locks::NEXT_LOCK_ID;
+use crate::core::locks::next_lock_id;
+use crate::core::locks::tracking::Tracking;
+use crate::core::sampling;
+#[cfg(feature = "lock-stats")]
+use crate::core::stats;
 
 use crate::core::types::{LockId, ThreadId, get_current_thread_id};
 #[cfg(feature = "logging-and-visualization")]
 use crate::core::{Events, logger};
 use parking_lot::{Mutex as ParkingLotMutex, MutexGuard as ParkingLotMutexGuard};
+use smallvec::SmallVec;
 use std::ops::{Deref, DerefMut};
-use std::sync::atomic::{AtomicUsize, Ordering};
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+use std::panic::Location;
+use std::sync::atomic::Ordering;
+use std::time::{Duration, Instant};
 
 /// A wrapper around a mutex that tracks lock operations for deadlock detection
 ///
@@ -38,15 +46,10 @@ use std::sync::atomic::{AtomicUsize, Ordering};
 /// *data += 10;
 /// ```
 pub struct Mutex<T> {
-    /// Unique identifier for this mutex
-    id: LockId,
+    /// ID, creator and current owner of this mutex
+    tracking: Tracking,
     /// The wrapped mutex
     inner: ParkingLotMutex<T>,
-    /// Thread that created this mutex
-    creator_thread_id: ThreadId,
-    /// Stores the ThreadId of the current owner (0 if unlocked).
-    /// This allows us to skip the global detector on the fast path.
-    owner: AtomicUsize,
 }
 
 /// Guard for a Mutex, reports lock release when dropped
@@ -61,15 +64,21 @@ pub struct MutexGuard<'a, T> {
     lock_id: LockId,
     /// The inner MutexGuard
     guard: ParkingLotMutexGuard<'a, T>,
-    /// Reference to the owner atomic to clear it on drop
-    owner_atomic: &'a AtomicUsize,
+    /// Tracking of the mutex, to clear its owner on drop
+    tracking: &'a Tracking,
     /// Whether this lock acquisition was tracked by the global detector
     tracked_globally: bool,
+    /// Whether this lock acquisition was sampled (see `Sampling`)
+    sampled: bool,
 }
 
 impl<T> Mutex<T> {
     /// Create a new Mutex with an automatically assigned ID
     ///
+    /// The caller's source location becomes the lock's class when lock order
+    /// checking is keyed by class (see `Deloxide::with_lock_class_ordering`)
+    /// and for per-class lock statistics.
+    ///
     /// # Arguments
     /// * `value` - The initial value to store in the mutex
     ///
@@ -83,18 +92,23 @@ impl<T> Mutex<T> {
     ///
     /// let mutex = Mutex::new(42);
     /// ```
+    #[track_caller]
     pub fn new(value: T) -> Self {
-        let id = NEXT_LOCK_ID.fetch_add(1, Ordering::SeqCst);
-        let creator_thread_id = get_current_thread_id();
-
-        // Register the lock with the detector, including creator thread info
-        detector::mutex::create_mutex(id, Some(creator_thread_id));
+        // Registers the lock with the detector, including creator thread info
+        let tracking = Tracking::new(next_lock_id(), get_current_thread_id());
+
+        // Locks created at the same call site share a lock order class
+        #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+        if detector::set_lock_class(
+            tracking.id(),
+            detector::lock_class::LockClass::Site(Location::caller()),
+        ) {
+            tracking.register();
+        }
 
         Mutex {
-            id,
+            tracking,
             inner: ParkingLotMutex::new(value),
-            creator_thread_id,
-            owner: AtomicUsize::new(0),
         }
     }
 
@@ -103,15 +117,23 @@ impl<T> Mutex<T> {
     /// # Returns
     /// The unique identifier assigned to this mutex
     pub fn id(&self) -> LockId {
-        self.id
+        self.tracking.id()
     }
 
     /// Get the ID of the thread that created this mutex
     ///
+    /// With the `compact-locks` feature the creator is only recorded while
+    /// logging is enabled.
+    ///
     /// # Returns
-    /// The thread ID of the creator thread
+    /// The thread ID of the creator thread, or 0 if it was not recorded
     pub fn creator_thread_id(&self) -> ThreadId {
-        self.creator_thread_id
+        self.tracking.creator_thread_id()
+    }
+
+    /// Whether the lock is currently held by `thread_id`
+    pub(crate) fn is_held_by(&self, thread_id: ThreadId) -> bool {
+        self.tracking.owner(Ordering::Acquire) == thread_id
     }
 
     /// Acquire the lock, blocking if necessary
@@ -134,42 +156,81 @@ impl<T> Mutex<T> {
     /// ```
     pub fn lock(&self) -> MutexGuard<'_, T> {
         let thread_id = get_current_thread_id();
-        let tid_usize = thread_id;
+
+        // Unsampled acquisitions bypass the detector and the logger
+        if !sampling::is_sampled(thread_id, self.id()) {
+            return self.unsampled_guard(thread_id, self.inner.lock());
+        }
 
         // Optimistic Fast Path (Disabled during stress testing to ensure full detector coverage)
         #[cfg(not(feature = "stress-test"))]
         if let Some(guard) = self.inner.try_lock() {
-            self.owner.store(tid_usize, Ordering::Release);
+            self.tracking.set_owner(thread_id, Ordering::Release);
 
             #[cfg(feature = "logging-and-visualization")]
             {
                 if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
-                    logger::log_interaction_event(thread_id, self.id, Events::MutexAttempt);
+                    logger::log_interaction_event(thread_id, self.id(), Events::MutexAttempt);
                 }
             }
 
             #[cfg(feature = "lock-order-graph")]
-            detector::mutex::complete_acquire(thread_id, self.id);
+            {
+                self.tracking.register();
+                detector::mutex::complete_acquire(thread_id, self.id());
+            }
 
             #[cfg(feature = "logging-and-visualization")]
             {
                 if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
-                    logger::log_interaction_event(thread_id, self.id, Events::MutexAcquired);
+                    logger::log_interaction_event(thread_id, self.id(), Events::MutexAcquired);
                 }
             }
 
+            #[cfg(feature = "lock-stats")]
+            stats::acquired(self.id(), None);
+
             return MutexGuard {
                 thread_id,
-                lock_id: self.id,
+                lock_id: self.id(),
                 guard,
-                owner_atomic: &self.owner,
+                tracking: &self.tracking,
                 tracked_globally: cfg!(feature = "lock-order-graph"),
+                sampled: true,
             };
         }
 
-        // Slow Path (Contention)
+        self.lock_slow(thread_id)
+    }
+
+    /// Slow path of `lock`: report the wait to the detector and block
+    ///
+    /// The acquisition is always tracked, so its release clears the wait-for
+    /// edges of the threads that queued up behind it.
+    fn lock_slow(&self, thread_id: ThreadId) -> MutexGuard<'_, T> {
+        match self.lock_slow_until(thread_id, None) {
+            Some(guard) => guard,
+            None => unreachable!("a wait without a deadline never gives up"),
+        }
+    }
+
+    /// Slow path of `lock` and `try_lock_until`
+    ///
+    /// # Returns
+    /// `None` if `deadline` passed first, after withdrawing the wait from the
+    /// detector
+    fn lock_slow_until(
+        &self,
+        thread_id: ThreadId,
+        deadline: Option<Instant>,
+    ) -> Option<MutexGuard<'_, T>> {
+        #[cfg(feature = "lock-stats")]
+        let wait_start = stats::wait_start();
+
+        self.tracking.register();
+
         // Read the current owner to report the dependency.
-        let mut current_owner_val = self.owner.load(Ordering::Acquire);
+        let mut current_owner_val = self.tracking.owner(Ordering::Acquire);
 
         // Adaptive Backoff:
         // If the lock is physically held but we don't see an owner yet, it means
@@ -184,7 +245,7 @@ impl<T> Mutex<T> {
                 }
 
                 // Use Relaxed loading during the spin loop for performance
-                current_owner_val = self.owner.load(Ordering::Relaxed);
+                current_owner_val = self.tracking.owner(Ordering::Relaxed);
                 spin_count += 1;
 
                 // Optimization: Only check lock state occasionally to reduce cache traffic
@@ -203,16 +264,16 @@ impl<T> Mutex<T> {
             Some(current_owner_val as ThreadId)
         };
 
-        let deadlock_info = detector::mutex::acquire_slow(thread_id, self.id, current_owner);
+        let deadlock_info = detector::mutex::acquire_slow(thread_id, self.id(), current_owner);
 
         if let Some(info) = deadlock_info {
             // Verify the edge is still valid (it might be stale if the owner released the lock).
             let is_stale = if let Some(expected_owner) = current_owner {
-                let actual_owner = self.owner.load(Ordering::Relaxed);
+                let actual_owner = self.tracking.owner(Ordering::Relaxed);
                 !detector::deadlock_handling::verify_deadlock_edges(
                     &info,
                     thread_id,
-                    self.id,
+                    self.id(),
                     expected_owner,
                     actual_owner,
                 )
@@ -226,19 +287,26 @@ impl<T> Mutex<T> {
         }
 
         // Block until we get the lock
-        let guard = self.inner.lock();
+        let Some(guard) = self.block(thread_id, deadline) else {
+            detector::mutex::cancel_wait(thread_id, self.id());
+            return None;
+        };
 
         // Update state
-        detector::mutex::complete_acquire(thread_id, self.id);
-        self.owner.store(tid_usize, Ordering::Release);
+        detector::mutex::complete_acquire(thread_id, self.id());
+        self.tracking.set_owner(thread_id, Ordering::Release);
 
-        MutexGuard {
+        #[cfg(feature = "lock-stats")]
+        stats::acquired(self.id(), wait_start);
+
+        Some(MutexGuard {
             thread_id,
-            lock_id: self.id,
+            lock_id: self.id(),
             guard,
-            owner_atomic: &self.owner,
+            tracking: &self.tracking,
             tracked_globally: true,
-        }
+            sampled: true,
+        })
     }
 
     /// Try to acquire the lock without blocking
@@ -263,40 +331,183 @@ impl<T> Mutex<T> {
     /// ```
     pub fn try_lock(&self) -> Option<MutexGuard<'_, T>> {
         let thread_id = get_current_thread_id();
-        let tid_usize = thread_id;
 
+        if !sampling::is_sampled(thread_id, self.id()) {
+            return self
+                .inner
+                .try_lock()
+                .map(|guard| self.unsampled_guard(thread_id, guard));
+        }
+
+        self.try_lock_fast(thread_id)
+    }
+
+    /// Try to acquire the lock, blocking for at most `timeout`
+    ///
+    /// While it blocks the thread waits for the owner like in `lock`, so a
+    /// deadlock is still detected. If the timeout runs out first, the wait is
+    /// withdrawn from the detector and `None` is returned. A thread that
+    /// already holds the mutex never waits for itself: the attempt just
+    /// times out, without a wait-for edge.
+    ///
+    /// # Example
+    ///
+    /// ```rust
+    /// use deloxide::Mutex;
+    /// use std::sync::Arc;
+    /// use std::thread;
+    /// use std::time::Duration;
+    ///
+    /// let mutex = Arc::new(Mutex::new(42));
+    /// let guard = mutex.lock();
+    ///
+    /// // Held by this thread, so the other thread gives up
+    /// let other = Arc::clone(&mutex);
+    /// let gave_up = thread::spawn(move || other.try_lock_for(Duration::from_millis(10)).is_none());
+    /// assert!(gave_up.join().unwrap());
+    ///
+    /// drop(guard);
+    /// assert!(mutex.try_lock_for(Duration::from_millis(10)).is_some());
+    /// ```
+    pub fn try_lock_for(&self, timeout: Duration) -> Option<MutexGuard<'_, T>> {
+        match Instant::now().checked_add(timeout) {
+            Some(deadline) => self.try_lock_until(deadline),
+            None => Some(self.lock()),
+        }
+    }
+
+    /// Try to acquire the lock, blocking until `deadline` at the latest
+    ///
+    /// See [`Mutex::try_lock_for`].
+    pub fn try_lock_until(&self, deadline: Instant) -> Option<MutexGuard<'_, T>> {
+        let thread_id = get_current_thread_id();
+
+        if !sampling::is_sampled(thread_id, self.id()) {
+            return self
+                .inner
+                .try_lock_until(deadline)
+                .map(|guard| self.unsampled_guard(thread_id, guard));
+        }
+
+        // Held by this thread, so the attempt can only time out
+        if self.tracking.owner(Ordering::Relaxed) == thread_id {
+            drop(self.inner.try_lock_until(deadline));
+            return None;
+        }
+
+        self.try_lock_fast(thread_id)
+            .or_else(|| self.lock_slow_until(thread_id, Some(deadline)))
+    }
+
+    /// Take the lock if it is free, without telling the detector otherwise
+    ///
+    /// A failed attempt leaves no trace: nothing is logged and no wait-for
+    /// edge is added, since the thread does not wait.
+    fn try_lock_fast(&self, thread_id: ThreadId) -> Option<MutexGuard<'_, T>> {
         if let Some(guard) = self.inner.try_lock() {
-            self.owner.store(tid_usize, Ordering::Release);
+            self.tracking.set_owner(thread_id, Ordering::Release);
 
             #[cfg(feature = "logging-and-visualization")]
             {
                 if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
-                    logger::log_interaction_event(thread_id, self.id, Events::MutexAttempt);
+                    logger::log_interaction_event(thread_id, self.id(), Events::MutexAttempt);
                 }
             }
 
             #[cfg(feature = "lock-order-graph")]
-            detector::mutex::complete_acquire(thread_id, self.id);
+            {
+                self.tracking.register();
+                detector::mutex::complete_acquire(thread_id, self.id());
+            }
 
             #[cfg(feature = "logging-and-visualization")]
             {
                 if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
-                    logger::log_interaction_event(thread_id, self.id, Events::MutexAcquired);
+                    logger::log_interaction_event(thread_id, self.id(), Events::MutexAcquired);
                 }
             }
 
+            #[cfg(feature = "lock-stats")]
+            stats::acquired(self.id(), None);
+
             Some(MutexGuard {
                 thread_id,
-                lock_id: self.id,
+                lock_id: self.id(),
                 guard,
-                owner_atomic: &self.owner,
+                tracking: &self.tracking,
                 tracked_globally: cfg!(feature = "lock-order-graph"),
+                sampled: true,
             })
         } else {
             None
         }
     }
 
+    /// Block until the lock is acquired or `deadline` passes
+    ///
+    /// With deferred detection, checks for a deadlock each time the threshold
+    /// runs out while the lock is still held by someone else.
+    fn block(
+        &self,
+        thread_id: ThreadId,
+        deadline: Option<Instant>,
+    ) -> Option<ParkingLotMutexGuard<'_, T>> {
+        let Some(threshold) = detector::deferred::threshold() else {
+            return match deadline {
+                Some(deadline) => self.inner.try_lock_until(deadline),
+                None => Some(self.inner.lock()),
+            };
+        };
+
+        loop {
+            let check_at = Instant::now() + threshold;
+            let until = deadline.map_or(check_at, |deadline| deadline.min(check_at));
+            if let Some(guard) = self.inner.try_lock_until(until) {
+                return Some(guard);
+            }
+            if deadline.is_some_and(|deadline| Instant::now() >= deadline) {
+                return None;
+            }
+
+            let owner = self.tracking.owner(Ordering::Acquire);
+            let holder = (owner != 0).then_some(owner as ThreadId);
+            if let Some(info) = detector::deferred::check_blocked(thread_id, self.id(), holder) {
+                // Same verification as an immediate detection
+                let is_stale = holder.is_some_and(|expected_owner| {
+                    !detector::deadlock_handling::verify_deadlock_edges(
+                        &info,
+                        thread_id,
+                        self.id(),
+                        expected_owner,
+                        self.tracking.owner(Ordering::Relaxed),
+                    )
+                });
+                if !is_stale {
+                    detector::deadlock_handling::process_deadlock(info);
+                }
+            }
+        }
+    }
+
+    /// Wrap an acquisition the detector is never told about
+    fn unsampled_guard<'a>(
+        &'a self,
+        thread_id: ThreadId,
+        guard: ParkingLotMutexGuard<'a, T>,
+    ) -> MutexGuard<'a, T> {
+        // Sampled waiters still need the owner to report their wait-for edge
+        self.tracking.set_owner(thread_id, Ordering::Release);
+
+        MutexGuard {
+            thread_id,
+            lock_id: self.id(),
+            guard,
+            tracking: &self.tracking,
+            tracked_globally: false,
+            sampled: false,
+        }
+    }
+
     /// Consumes this mutex, returning the underlying data
     ///
     /// # Example
@@ -314,7 +525,9 @@ impl<T> Mutex<T> {
     {
         // We need to prevent Drop from running since we're manually extracting the value
         // First, manually drop the detector tracking
-        detector::mutex::destroy_mutex(self.id);
+        if self.tracking.is_registered() {
+            detector::mutex::destroy_mutex(self.id());
+        }
 
         // Use ManuallyDrop to prevent the automatic Drop implementation
         let mutex = std::mem::ManuallyDrop::new(self);
@@ -342,10 +555,153 @@ impl<T> Mutex<T> {
     }
 }
 
+/// Acquire several mutexes at once, returning their guards in the given order
+///
+/// The mutexes are tried in the order of their IDs, and if one of them is
+/// contended every lock taken so far is released before blocking on it, the
+/// way `std::lock` works in C++. A thread therefore never holds part of the
+/// batch while waiting for the rest: two batches over the same mutexes cannot
+/// deadlock, whatever order they list them in, and the lock order graph
+/// records no edges between them. Once it has all of them, the thread reports
+/// the batch to the detector in one transaction instead of one per mutex.
+///
+/// # Arguments
+/// * `mutexes` - The mutexes to acquire
+///
+/// # Returns
+/// The guards, in the same order as `mutexes`
+///
+/// # Panics
+/// If the same mutex appears twice.
+///
+/// # Example
+///
+/// ```rust
+/// use deloxide::{Mutex, lock_many};
+///
+/// let from = Mutex::new(100);
+/// let to = Mutex::new(0);
+///
+/// // Another thread may lock [&to, &from] at the same time
+/// let mut guards = lock_many(&[&from, &to]);
+/// *guards[0] -= 30;
+/// *guards[1] += 30;
+/// ```
+pub fn lock_many<'a, T>(mutexes: &[&'a Mutex<T>]) -> Vec<MutexGuard<'a, T>> {
+    lock_distinct(mutexes).expect("lock_many: the same mutex was passed twice")
+}
+
+/// [`lock_many`] that returns `None` instead of panicking on a repeated mutex
+pub(crate) fn lock_distinct<'a, T>(mutexes: &[&'a Mutex<T>]) -> Option<Vec<MutexGuard<'a, T>>> {
+    let mut order: Vec<usize> = (0..mutexes.len()).collect();
+    order.sort_unstable_by_key(|&index| mutexes[index].id());
+    if order
+        .windows(2)
+        .any(|pair| mutexes[pair[0]].id() == mutexes[pair[1]].id())
+    {
+        return None;
+    }
+
+    let thread_id = get_current_thread_id();
+    // Position in `order` of the mutex to block on, after a contended attempt
+    let mut blocked_on = None;
+    loop {
+        // Blocking goes through the tracked slow path, so a wait on a lock
+        // held elsewhere is still a wait-for edge and backing off below
+        // clears the edges of the threads waiting for us
+        let first = blocked_on.map(|position: usize| {
+            let mutex = mutexes[order[position]];
+            if sampling::is_sampled(thread_id, mutex.id()) {
+                mutex.lock_slow(thread_id)
+            } else {
+                mutex.unsampled_guard(thread_id, mutex.inner.lock())
+            }
+        });
+
+        let mut acquired = Vec::with_capacity(order.len());
+        let mut contended = None;
+        for (position, &index) in order.iter().enumerate() {
+            if blocked_on == Some(position) {
+                continue;
+            }
+            match mutexes[index].inner.try_lock() {
+                Some(guard) => acquired.push((index, guard)),
+                None => {
+                    contended = Some(position);
+                    break;
+                }
+            }
+        }
+
+        if contended.is_none() {
+            let mut guards: Vec<_> = mutexes.iter().map(|_| None).collect();
+            if let (Some(position), Some(first)) = (blocked_on, first) {
+                guards[order[position]] = Some(first);
+            }
+            let blocked_on = blocked_on.map(|position| mutexes[order[position]].id());
+            for (index, guard) in complete_batch(mutexes, thread_id, acquired, blocked_on) {
+                guards[index] = Some(guard);
+            }
+            return Some(guards.into_iter().flatten().collect());
+        }
+
+        // Back off completely. Only the blocking acquisition was reported,
+        // and so is its release.
+        drop(acquired);
+        drop(first);
+        blocked_on = contended;
+    }
+}
+
+/// Turn the guards of a batch taken without blocking into tracked guards
+///
+/// Unlike the fast path of `Mutex::lock`, the batch is always reported: its
+/// locks are usually contended, and an unreported release would leave stale
+/// wait-for edges behind for every retry of a waiting batch.
+fn complete_batch<'a, T>(
+    mutexes: &[&'a Mutex<T>],
+    thread_id: ThreadId,
+    acquired: Vec<(usize, ParkingLotMutexGuard<'a, T>)>,
+    blocked_on: Option<LockId>,
+) -> Vec<(usize, MutexGuard<'a, T>)> {
+    let mut batch: SmallVec<[LockId; 8]> = SmallVec::new();
+    let guards: Vec<_> = acquired
+        .into_iter()
+        .map(|(index, guard)| {
+            let mutex = mutexes[index];
+            if !sampling::is_sampled(thread_id, mutex.id()) {
+                return (index, mutex.unsampled_guard(thread_id, guard));
+            }
+            mutex.tracking.set_owner(thread_id, Ordering::Release);
+            mutex.tracking.register();
+            batch.push(mutex.id());
+
+            #[cfg(feature = "lock-stats")]
+            stats::acquired(mutex.id(), None);
+
+            let guard = MutexGuard {
+                thread_id,
+                lock_id: mutex.id(),
+                guard,
+                tracking: &mutex.tracking,
+                tracked_globally: true,
+                sampled: true,
+            };
+            (index, guard)
+        })
+        .collect();
+
+    detector::mutex::complete_acquire_many(thread_id, &batch, blocked_on);
+
+    guards
+}
+
 impl<T> Drop for Mutex<T> {
     fn drop(&mut self) {
         // Register the lock destruction with the detector
-        detector::mutex::destroy_mutex(self.id);
+        if self.tracking.is_registered() {
+            detector::mutex::destroy_mutex(self.id());
+        }
     }
 }
 
@@ -381,24 +737,51 @@ impl<'a, T> MutexGuard<'a, T> {
 
     /// Clear local ownership tracking (used internally by Condvar)
     pub(crate) fn clear_ownership(&self) {
-        self.owner_atomic.store(0, Ordering::Release);
+        self.tracking.set_owner(0, Ordering::Release);
+        // The condvar wait and wakeup involve the mutex in the detector
+        self.tracking.register();
+
+        // The time spent waiting on the condvar does not count as holding
+        #[cfg(feature = "lock-stats")]
+        if self.sampled {
+            stats::released(self.lock_id);
+        }
     }
 
     /// Restore local ownership tracking (used internally by Condvar)
-    pub(crate) fn restore_ownership(&self) {
-        self.owner_atomic.store(self.thread_id, Ordering::Release);
+    ///
+    /// The reacquisition after a sampled wait is always reported to the
+    /// detector, so the release has to be as well.
+    pub(crate) fn restore_ownership(&mut self) {
+        self.tracking.set_owner(self.thread_id, Ordering::Release);
+        self.tracked_globally = self.sampled;
+
+        #[cfg(feature = "lock-stats")]
+        if self.sampled {
+            stats::resumed(self.lock_id);
+        }
+    }
+
+    /// Whether the acquisition behind this guard was sampled
+    pub(crate) fn is_sampled(&self) -> bool {
+        self.sampled
     }
 }
 
 impl<T> Drop for MutexGuard<'_, T> {
     fn drop(&mut self) {
         // 1. Clear local ownership first
-        self.owner_atomic.store(0, Ordering::Release);
+        self.tracking.set_owner(0, Ordering::Release);
+
+        #[cfg(feature = "lock-stats")]
+        if self.sampled {
+            stats::released(self.lock_id);
+        }
 
         // 2. Report lock release (detector and/or logger)
         if self.tracked_globally {
             detector::mutex::release_mutex(self.thread_id, self.lock_id);
-        } else {
+        } else if self.sampled {
             #[cfg(feature = "logging-and-visualization")]
             if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
                 logger::log_interaction_event(self.thread_id, self.lock_id, Events::MutexReleased);
@@ -411,6 +794,7 @@ impl<T> Drop for MutexGuard<'_, T> {
 
 impl<T: Default> Default for Mutex<T> {
     /// Creates a `Mutex<T>`, with the Default value for T
+    #[track_caller]
     fn default() -> Mutex<T> {
         Mutex::new(Default::default())
     }
@@ -419,6 +803,7 @@ impl<T: Default> Default for Mutex<T> {
 impl<T> From<T> for Mutex<T> {
     /// Creates a new mutex in an unlocked state ready for use
     /// This is equivalent to Mutex::new
+    #[track_caller]
     fn from(t: T) -> Self {
         Mutex::new(t)
     }
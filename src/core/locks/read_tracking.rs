@@ -0,0 +1,188 @@
+//! Per-lock tracking of read locks taken on the fast path
+//!
+//! Uncontended `RwLock::read` calls skip the detector entirely. To still let a
+//! writer find the readers it is about to wait for, every RwLock has a few
+//! reader slots. A fast-path reader publishes its thread ID in a free slot
+//! before it checks for waiting writers, and a writer on the slow path scans
+//! the slots of that one lock after announcing itself, so one of the two
+//! always sees the other. Readers that find every slot taken go through the
+//! detector instead.
+//!
+//! A writer marks each slot it adds a wait-for edge for, while holding the
+//! detector's state for the lock. The reader learns from the mark whether its
+//! release has to be reported to remove that edge.
+
+use crate::core::types::ThreadId;
+use smallvec::SmallVec;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+/// Number of fast-path readers each RwLock can track
+pub(crate) const READER_SLOTS: usize = 4;
+
+/// Set in a slot once a writer added a wait-for edge towards its reader
+const LINKED: usize = 1 << (usize::BITS - 1);
+
+/// Readers holding one RwLock through the fast path
+pub(crate) struct FastReaders {
+    /// Thread ID of each reader (0 for a free slot), `LINKED` once a writer
+    /// waits for it
+    slots: [AtomicUsize; READER_SLOTS],
+}
+
+impl FastReaders {
+    pub(crate) const fn new() -> Self {
+        FastReaders {
+            slots: [const { AtomicUsize::new(0) }; READER_SLOTS],
+        }
+    }
+
+    /// Publish `thread_id` as a reader, unless a writer is waiting
+    ///
+    /// The slot is claimed before `writers_waiting` is read, both sequentially
+    /// consistent like the writer's increment, so a writer that this check
+    /// misses finds the slot when it scans.
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the reader
+    /// * `writers_waiting` - Number of writers on the slow path
+    ///
+    /// # Returns
+    /// * `Ok(slot)` - The reader's slot, to pass to [`FastReaders::release`]
+    /// * `Err(linked)` - No slot is free or a writer is waiting; `linked` is
+    ///   `true` if the writer already added an edge towards the reader
+    pub(crate) fn enter(
+        &self,
+        thread_id: ThreadId,
+        writers_waiting: &AtomicUsize,
+    ) -> Result<&AtomicUsize, bool> {
+        // Start at a different slot for each thread to spread the claims
+        let start = thread_id % READER_SLOTS;
+        let slot = (0..READER_SLOTS)
+            .map(|i| &self.slots[(start + i) % READER_SLOTS])
+            .find(|slot| {
+                slot.compare_exchange(0, thread_id, Ordering::SeqCst, Ordering::Relaxed)
+                    .is_ok()
+            })
+            .ok_or(false)?;
+
+        if writers_waiting.load(Ordering::SeqCst) != 0 {
+            return Err(Self::release(slot));
+        }
+        Ok(slot)
+    }
+
+    /// Free the slot of a reader
+    ///
+    /// # Returns
+    /// `true` if a writer added a wait-for edge towards the reader, which
+    /// the detector then has to drop
+    pub(crate) fn release(slot: &AtomicUsize) -> bool {
+        slot.swap(0, Ordering::AcqRel) & LINKED != 0
+    }
+
+    /// Free the slot of a reader known only by its thread, as the pthread shim
+    /// has no guard to keep the slot in
+    ///
+    /// # Returns
+    /// `None` if `thread_id` holds no slot, otherwise whether a writer added
+    /// a wait-for edge towards it
+    #[cfg(all(feature = "preload", target_os = "linux"))]
+    pub(crate) fn release_thread(&self, thread_id: ThreadId) -> Option<bool> {
+        for slot in &self.slots {
+            let mut value = slot.load(Ordering::Acquire);
+            while value & !LINKED == thread_id {
+                match slot.compare_exchange(value, 0, Ordering::AcqRel, Ordering::Acquire) {
+                    Ok(_) => return Some(value & LINKED != 0),
+                    Err(current) => value = current,
+                }
+            }
+        }
+        None
+    }
+
+    /// Mark all current readers as waited for and collect them
+    ///
+    /// Must be called while holding the detector's state for the lock, so a
+    /// reader that sees the mark reports its release only after the edges
+    /// towards it were added.
+    ///
+    /// # Arguments
+    /// * `exclude` - Thread to leave out (the waiting writer)
+    pub(crate) fn link(&self, exclude: ThreadId) -> SmallVec<[ThreadId; READER_SLOTS]> {
+        let mut readers = SmallVec::new();
+        for slot in &self.slots {
+            let mut value = slot.load(Ordering::SeqCst);
+            while value != 0 && value & !LINKED != exclude {
+                match slot.compare_exchange(
+                    value,
+                    value | LINKED,
+                    Ordering::SeqCst,
+                    Ordering::SeqCst,
+                ) {
+                    Ok(_) => {
+                        readers.push(value & !LINKED);
+                        break;
+                    }
+                    Err(current) => value = current,
+                }
+            }
+        }
+        readers
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Barrier;
+
+    #[test]
+    fn test_writer_between_announce_and_scan_turns_reader_away() {
+        let readers = FastReaders::new();
+        let writers_waiting = AtomicUsize::new(0);
+        let announced = Barrier::new(2);
+        let entered = Barrier::new(2);
+
+        std::thread::scope(|s| {
+            s.spawn(|| {
+                writers_waiting.fetch_add(1, Ordering::SeqCst);
+                announced.wait();
+                // The reader runs here, before the scan
+                entered.wait();
+                assert!(readers.link(1).is_empty());
+            });
+            announced.wait();
+            assert!(matches!(readers.enter(7, &writers_waiting), Err(false)));
+            entered.wait();
+        });
+    }
+
+    #[test]
+    fn test_reader_published_before_announce_is_linked() {
+        let readers = FastReaders::new();
+        let writers_waiting = AtomicUsize::new(0);
+
+        let slot = readers.enter(7, &writers_waiting).unwrap();
+        writers_waiting.fetch_add(1, Ordering::SeqCst);
+        assert_eq!(readers.link(1).as_slice(), [7]);
+        // A second writer links the same reader again
+        assert_eq!(readers.link(2).as_slice(), [7]);
+        assert!(FastReaders::release(slot));
+        assert!(readers.link(1).is_empty());
+    }
+
+    #[test]
+    fn test_unlinked_release_and_full_slots() {
+        let readers = FastReaders::new();
+        let writers_waiting = AtomicUsize::new(0);
+
+        let slots: Vec<_> = (1..=READER_SLOTS)
+            .map(|tid| readers.enter(tid, &writers_waiting).unwrap())
+            .collect();
+        assert!(matches!(readers.enter(99, &writers_waiting), Err(false)));
+        // The writer itself is never linked
+        assert_eq!(readers.link(1).len(), READER_SLOTS - 1);
+        assert!(!FastReaders::release(slots[0]));
+        assert!(slots[1..].iter().all(|slot| FastReaders::release(slot)));
+    }
+}
@@ -23,7 +23,12 @@
 //! ```
 
 use crate::core::detector;
-use crate::core::locks::NEXT_LOCK_ID;
+use crate::core::locks::next_lock_id;
+#[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+use crate::core::locks::read_tracking::FastReaders;
+use crate::core::sampling;
+#[cfg(feature = "lock-stats")]
+use crate::core::stats;
 
 use crate::core::types::{LockId, ThreadId, get_current_thread_id};
 #[cfg(feature = "logging-and-visualization")]
@@ -33,8 +38,13 @@ use parking_lot::{
     RwLockWriteGuard as ParkingLotWriteGuard,
 };
 use std::ops::{Deref, DerefMut};
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+use std::panic::Location;
 use std::sync::atomic::{AtomicUsize, Ordering};
 
+/// Maximum iterations spent waiting for an exclusive holder to publish its ID
+const WRITER_SPIN_LIMIT: usize = 1000;
+
 /// A wrapper around a reader-writer lock that tracks operations for deadlock detection
 ///
 /// The RwLock provides the same API as a standard reader-writer lock
@@ -49,6 +59,11 @@ pub struct RwLock<T> {
     creator_thread_id: ThreadId,
     /// Tracks the thread ID of a WRITER using AtomicUsize. 0 if no writer.
     writer_owner: AtomicUsize,
+    /// Number of writers on the slow path. Readers skip the detector while 0.
+    writers_waiting: AtomicUsize,
+    /// Readers that took the fast path, found by writers on the slow path
+    #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+    fast_readers: FastReaders,
 }
 
 /// Guard for a shared (read) lock, reports release when dropped
@@ -56,6 +71,13 @@ pub struct RwLockReadGuard<'a, T> {
     thread_id: ThreadId,
     lock_id: LockId,
     guard: ParkingLotReadGuard<'a, T>,
+    /// Slot of a fast-path reader, which tells whether a writer waits for it
+    #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+    fast_slot: Option<&'a AtomicUsize>,
+    /// Whether this lock acquisition was tracked by the global detector
+    tracked_globally: bool,
+    /// Whether this lock acquisition was sampled (see `Sampling`)
+    sampled: bool,
 }
 
 /// Guard for an exclusive (write) lock, reports release when dropped
@@ -67,11 +89,16 @@ pub struct RwLockWriteGuard<'a, T> {
     owner_atomic: &'a AtomicUsize,
     /// Whether this lock acquisition was tracked by the global detector
     tracked_globally: bool,
+    /// Whether this lock acquisition was sampled (see `Sampling`)
+    sampled: bool,
 }
 
 impl<T> RwLock<T> {
     /// Create a new tracked RwLock with a unique ID
     ///
+    /// The caller's source location becomes the lock's class when lock order
+    /// checking is keyed by class.
+    ///
     /// # Arguments
     /// * `value` - The initial value to store in the lock
     ///
@@ -84,15 +111,26 @@ impl<T> RwLock<T> {
     /// use deloxide::RwLock;
     /// let lock = RwLock::new(42);
     /// ```
+    #[track_caller]
     pub fn new(value: T) -> Self {
-        let id = NEXT_LOCK_ID.fetch_add(1, Ordering::SeqCst);
+        let id = next_lock_id();
         let creator_thread_id = get_current_thread_id();
         detector::rwlock::create_rwlock(id, Some(creator_thread_id));
+
+        // Locks created at the same call site share a lock order class
+        #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+        detector::set_lock_class(
+            id,
+            detector::lock_class::LockClass::Site(Location::caller()),
+        );
         RwLock {
             id,
             inner: ParkingLotRwLock::new(value),
             creator_thread_id,
             writer_owner: AtomicUsize::new(0),
+            writers_waiting: AtomicUsize::new(0),
+            #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+            fast_readers: FastReaders::new(),
         }
     }
 
@@ -106,6 +144,11 @@ impl<T> RwLock<T> {
         self.creator_thread_id
     }
 
+    /// Whether the lock is currently held for writing by `thread_id`
+    pub(crate) fn is_write_held_by(&self, thread_id: ThreadId) -> bool {
+        self.writer_owner.load(Ordering::Acquire) == thread_id
+    }
+
     /// Acquire a shared (read) lock, tracking the attempt and acquisition
     ///
     /// Uses two-phase locking protocol to eliminate race conditions between
@@ -116,6 +159,17 @@ impl<T> RwLock<T> {
     pub fn read(&self) -> RwLockReadGuard<'_, T> {
         let thread_id = get_current_thread_id();
 
+        // Unsampled acquisitions bypass the detector and the logger
+        if !sampling::is_sampled(thread_id, self.id) {
+            return self.unsampled_read(thread_id, self.inner.read());
+        }
+
+        // Optimistic Fast Path (Reader) - Disabled during stress testing
+        #[cfg(not(feature = "stress-test"))]
+        if let Some(guard) = self.try_read_fast(thread_id) {
+            return guard;
+        }
+
         // Phase 1: Atomic detection and try-acquire
         let guard = crate::core::detector::rwlock::attempt_read(thread_id, self.id, || {
             self.inner.try_read()
@@ -123,10 +177,18 @@ impl<T> RwLock<T> {
 
         // Phase 2: If try-acquire failed, use blocking read
         let guard = match guard {
-            Some(g) => g,
+            Some(g) => {
+                #[cfg(feature = "lock-stats")]
+                stats::acquired(self.id, None);
+                g
+            }
             None => {
-                let g = self.inner.read();
+                #[cfg(feature = "lock-stats")]
+                let wait_start = stats::wait_start();
+                let g = self.block_read(thread_id);
                 detector::rwlock::complete_read(thread_id, self.id);
+                #[cfg(feature = "lock-stats")]
+                stats::acquired(self.id, wait_start);
                 g
             }
         };
@@ -135,6 +197,77 @@ impl<T> RwLock<T> {
             thread_id,
             lock_id: self.id,
             guard,
+            #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+            fast_slot: None,
+            tracked_globally: true,
+            sampled: true,
+        }
+    }
+
+    /// Take a read lock without consulting the detector
+    ///
+    /// Succeeds only while no writer is waiting. The reader is published in one
+    /// of the lock's reader slots instead of the detector, before checking for
+    /// writers, so a writer that later blocks on it can still add the wait-for
+    /// edge. With lock order checking the read is recorded in the detector,
+    /// together with its acquisition.
+    #[cfg(not(feature = "stress-test"))]
+    fn try_read_fast(&self, thread_id: ThreadId) -> Option<RwLockReadGuard<'_, T>> {
+        // Lock order checking needs every held lock in the detector
+        #[cfg(feature = "lock-order-graph")]
+        {
+            if self.writers_waiting.load(Ordering::Acquire) != 0 {
+                return None;
+            }
+            let guard = detector::rwlock::try_read(thread_id, self.id, || self.inner.try_read())?;
+
+            #[cfg(feature = "lock-stats")]
+            stats::acquired(self.id, None);
+
+            Some(RwLockReadGuard {
+                thread_id,
+                lock_id: self.id,
+                guard,
+                tracked_globally: true,
+                sampled: true,
+            })
+        }
+
+        #[cfg(not(feature = "lock-order-graph"))]
+        {
+            let slot = match self.fast_readers.enter(thread_id, &self.writers_waiting) {
+                Ok(slot) => slot,
+                Err(linked) => {
+                    if linked {
+                        detector::rwlock::unlink_reader(thread_id, self.id);
+                    }
+                    return None;
+                }
+            };
+            let Some(guard) = self.inner.try_read() else {
+                if FastReaders::release(slot) {
+                    detector::rwlock::unlink_reader(thread_id, self.id);
+                }
+                return None;
+            };
+
+            #[cfg(feature = "logging-and-visualization")]
+            if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+                logger::log_interaction_event(thread_id, self.id, Events::RwReadAttempt);
+                logger::log_interaction_event(thread_id, self.id, Events::RwReadAcquired);
+            }
+
+            #[cfg(feature = "lock-stats")]
+            stats::acquired(self.id, None);
+
+            Some(RwLockReadGuard {
+                thread_id,
+                lock_id: self.id,
+                guard,
+                fast_slot: Some(slot),
+                tracked_globally: false,
+                sampled: true,
+            })
         }
     }
 
@@ -149,6 +282,11 @@ impl<T> RwLock<T> {
         let thread_id = get_current_thread_id();
         let tid_usize = thread_id as usize;
 
+        // Unsampled acquisitions bypass the detector and the logger
+        if !sampling::is_sampled(thread_id, self.id) {
+            return self.unsampled_write(thread_id, self.inner.write());
+        }
+
         // Optimistic Fast Path (Writer) - Disabled during stress testing
         #[cfg(not(feature = "stress-test"))]
         if let Some(guard) = self.inner.try_write() {
@@ -171,16 +309,26 @@ impl<T> RwLock<T> {
                 }
             }
 
+            #[cfg(feature = "lock-stats")]
+            stats::acquired(self.id, None);
+
             return RwLockWriteGuard {
                 thread_id,
                 lock_id: self.id,
                 guard,
                 owner_atomic: &self.writer_owner,
                 tracked_globally: cfg!(feature = "lock-order-graph"),
+                sampled: true,
             };
         }
 
         // Slow Path
+        #[cfg(feature = "lock-stats")]
+        let wait_start = stats::wait_start();
+
+        // From here on, new readers report to the detector
+        self.writers_waiting.fetch_add(1, Ordering::SeqCst);
+
         // Check if a writer holds it locally
         let mut current_writer_val = self.writer_owner.load(Ordering::Acquire);
 
@@ -204,6 +352,13 @@ impl<T> RwLock<T> {
                 if spin_count % 16 == 0 && !self.inner.is_locked_exclusive() {
                     break;
                 }
+
+                // A blocked writer also sets the exclusive bit while it waits for
+                // readers to leave (e.g. a competing upgrade), and never publishes
+                // an owner. Give up and let the detector use the reader set.
+                if spin_count >= WRITER_SPIN_LIMIT {
+                    break;
+                }
             }
             std::sync::atomic::fence(Ordering::Acquire);
         }
@@ -214,8 +369,18 @@ impl<T> RwLock<T> {
             Some(current_writer_val as ThreadId)
         };
 
-        let deadlock_info =
-            detector::rwlock::acquire_write_slow(thread_id, self.id, current_writer);
+        // Readers that took the fast path are only known to the lock itself
+        #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+        let link_fast_readers = || self.fast_readers.link(thread_id);
+        #[cfg(any(feature = "lock-order-graph", feature = "stress-test"))]
+        let link_fast_readers = std::iter::empty;
+
+        let deadlock_info = detector::rwlock::acquire_write_slow(
+            thread_id,
+            self.id,
+            current_writer,
+            link_fast_readers,
+        );
 
         if let Some(info) = deadlock_info {
             // Verify the edge is still valid (it might be stale if the writer released the lock).
@@ -237,44 +402,75 @@ impl<T> RwLock<T> {
             }
         }
 
-        let guard = self.inner.write();
+        let guard = self.block_write(thread_id, current_writer);
+        self.writers_waiting.fetch_sub(1, Ordering::Release);
 
         detector::rwlock::complete_write(thread_id, self.id);
         self.writer_owner.store(tid_usize, Ordering::Release);
 
+        #[cfg(feature = "lock-stats")]
+        stats::acquired(self.id, wait_start);
+
         RwLockWriteGuard {
             thread_id,
             lock_id: self.id,
             guard,
             owner_atomic: &self.writer_owner,
             tracked_globally: true,
+            sampled: true,
         }
     }
 
-    /// Try to acquire a shared (read) lock, tracking the attempt
+    /// Try to acquire a shared (read) lock without blocking
     ///
-    /// Uses atomic detection to ensure deadlock detection and acquisition
-    /// happen together.
+    /// A failed attempt leaves no trace in the detector or the log.
     pub fn try_read(&self) -> Option<RwLockReadGuard<'_, T>> {
         let thread_id = get_current_thread_id();
 
-        // Use atomic detection and try-acquire
-        let guard = detector::rwlock::attempt_read(thread_id, self.id, || self.inner.try_read());
+        if !sampling::is_sampled(thread_id, self.id) {
+            return self
+                .inner
+                .try_read()
+                .map(|guard| self.unsampled_read(thread_id, guard));
+        }
+
+        #[cfg(not(feature = "stress-test"))]
+        if let Some(guard) = self.try_read_fast(thread_id) {
+            return Some(guard);
+        }
+
+        // Registered atomically with the detector, but never as a wait
+        let guard = detector::rwlock::try_read(thread_id, self.id, || self.inner.try_read());
+
+        #[cfg(feature = "lock-stats")]
+        if guard.is_some() {
+            stats::acquired(self.id, None);
+        }
 
         guard.map(|g| RwLockReadGuard {
             thread_id,
             lock_id: self.id,
             guard: g,
+            #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+            fast_slot: None,
+            tracked_globally: true,
+            sampled: true,
         })
     }
 
-    /// Try to acquire an exclusive (write) lock, tracking the attempt
+    /// Try to acquire an exclusive (write) lock without blocking
     ///
-    /// Uses atomic detection to ensure deadlock detection and acquisition
-    /// happen together.
+    /// A failed attempt leaves no trace in the detector or the log.
     pub fn try_write(&self) -> Option<RwLockWriteGuard<'_, T>> {
         let thread_id = get_current_thread_id();
 
+        if !sampling::is_sampled(thread_id, self.id) {
+            return self
+                .inner
+                .try_write()
+                .map(|guard| self.unsampled_write(thread_id, guard));
+        }
+
         if let Some(guard) = self.inner.try_write() {
             self.writer_owner
                 .store(thread_id as usize, Ordering::Release);
@@ -296,18 +492,116 @@ impl<T> RwLock<T> {
                 }
             }
 
+            #[cfg(feature = "lock-stats")]
+            stats::acquired(self.id, None);
+
             Some(RwLockWriteGuard {
                 thread_id,
                 lock_id: self.id,
                 guard,
                 owner_atomic: &self.writer_owner,
                 tracked_globally: cfg!(feature = "lock-order-graph"),
+                sampled: true,
             })
         } else {
             None
         }
     }
 
+    /// Block until the read lock is acquired
+    ///
+    /// With deferred detection, checks for a deadlock each time the threshold
+    /// runs out while the lock is still held by a writer.
+    fn block_read(&self, thread_id: ThreadId) -> ParkingLotReadGuard<'_, T> {
+        let Some(threshold) = detector::deferred::threshold() else {
+            return self.inner.read();
+        };
+
+        loop {
+            if let Some(guard) = self.inner.try_read_for(threshold) {
+                return guard;
+            }
+            if let Some(info) = detector::deferred::check_blocked(thread_id, self.id, None) {
+                detector::deadlock_handling::process_deadlock(info);
+            }
+        }
+    }
+
+    /// Block until the write lock is acquired
+    ///
+    /// With deferred detection, checks for a deadlock each time the threshold
+    /// runs out while the lock is still held.
+    ///
+    /// # Arguments
+    /// * `thread_id` - ID of the waiting thread
+    /// * `expected_writer` - The writer the wait-for edges were built from, if any
+    fn block_write(
+        &self,
+        thread_id: ThreadId,
+        expected_writer: Option<ThreadId>,
+    ) -> ParkingLotWriteGuard<'_, T> {
+        let Some(threshold) = detector::deferred::threshold() else {
+            return self.inner.write();
+        };
+
+        loop {
+            if let Some(guard) = self.inner.try_write_for(threshold) {
+                return guard;
+            }
+            if let Some(info) = detector::deferred::check_blocked(thread_id, self.id, None) {
+                // Same verification as an immediate detection
+                let is_stale = expected_writer.is_some_and(|expected_writer| {
+                    !detector::deadlock_handling::verify_deadlock_edges(
+                        &info,
+                        thread_id,
+                        self.id,
+                        expected_writer,
+                        self.writer_owner.load(Ordering::Relaxed),
+                    )
+                });
+                if !is_stale {
+                    detector::deadlock_handling::process_deadlock(info);
+                }
+            }
+        }
+    }
+
+    /// Wrap a shared acquisition the detector is never told about
+    fn unsampled_read<'a>(
+        &'a self,
+        thread_id: ThreadId,
+        guard: ParkingLotReadGuard<'a, T>,
+    ) -> RwLockReadGuard<'a, T> {
+        RwLockReadGuard {
+            thread_id,
+            lock_id: self.id,
+            guard,
+            #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+            fast_slot: None,
+            tracked_globally: false,
+            sampled: false,
+        }
+    }
+
+    /// Wrap an exclusive acquisition the detector is never told about
+    fn unsampled_write<'a>(
+        &'a self,
+        thread_id: ThreadId,
+        guard: ParkingLotWriteGuard<'a, T>,
+    ) -> RwLockWriteGuard<'a, T> {
+        // Sampled waiters still need the writer to report their wait-for edge
+        self.writer_owner.store(thread_id, Ordering::Release);
+
+        RwLockWriteGuard {
+            thread_id,
+            lock_id: self.id,
+            guard,
+            owner_atomic: &self.writer_owner,
+            tracked_globally: false,
+            sampled: false,
+        }
+    }
+
     /// Consumes this RwLock, returning the underlying data
     ///
     /// # Example
@@ -369,7 +663,26 @@ impl<'a, T> Deref for RwLockReadGuard<'a, T> {
 }
 impl<'a, T> Drop for RwLockReadGuard<'a, T> {
     fn drop(&mut self) {
-        detector::rwlock::release_read(self.thread_id, self.lock_id);
+        #[cfg(feature = "lock-stats")]
+        if self.sampled {
+            stats::released(self.lock_id);
+        }
+
+        // Only a writer that linked a fast-path reader added a wait-for edge
+        // towards it
+        #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+        let linked = self.fast_slot.is_some_and(FastReaders::release);
+        #[cfg(any(feature = "lock-order-graph", feature = "stress-test"))]
+        let linked = false;
+
+        if self.tracked_globally || linked {
+            detector::rwlock::release_read(self.thread_id, self.lock_id);
+        } else if self.sampled {
+            #[cfg(feature = "logging-and-visualization")]
+            if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+                logger::log_interaction_event(self.thread_id, self.lock_id, Events::RwReadReleased);
+            }
+        }
     }
 }
 
@@ -389,10 +702,15 @@ impl<'a, T> Drop for RwLockWriteGuard<'a, T> {
         // 1. Clear local ownership
         self.owner_atomic.store(0, Ordering::Release);
 
+        #[cfg(feature = "lock-stats")]
+        if self.sampled {
+            stats::released(self.lock_id);
+        }
+
         // 2. Report release (detector and/or logger)
         if self.tracked_globally {
             detector::rwlock::release_write(self.thread_id, self.lock_id);
-        } else {
+        } else if self.sampled {
             #[cfg(feature = "logging-and-visualization")]
             if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
                 logger::log_interaction_event(
@@ -409,6 +727,7 @@ impl<'a, T> Drop for RwLockWriteGuard<'a, T> {
 
 impl<T: Default> Default for RwLock<T> {
     /// Creates a new `RwLock<T>`, with the Default value for T
+    #[track_caller]
     fn default() -> RwLock<T> {
         RwLock::new(Default::default())
     }
@@ -417,6 +736,7 @@ impl<T: Default> Default for RwLock<T> {
 impl<T> From<T> for RwLock<T> {
     /// Creates a new instance of an `RwLock<T>` which is unlocked
     /// This is equivalent to RwLock::new
+    #[track_caller]
     fn from(t: T) -> Self {
         RwLock::new(t)
     }
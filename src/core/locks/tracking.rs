@@ -0,0 +1,173 @@
+//! Identity and owner of a tracked Mutex, as stored in the lock itself
+//!
+//! By default a Mutex keeps its ID, its creator and its current owner in
+//! full words, and registers with the detector when it is created. With the
+//! `compact-locks` feature the ID and the owner take 32 bits each, and the
+//! detector only hears of a lock once it has to: when logging is enabled at
+//! creation, when the lock gets a class or statistics, or on its first
+//! contended or globally tracked acquisition. Only registered locks are
+//! destroyed in the detector. The creator is then kept in a side table of
+//! the detector, and only while logging is enabled, since that is the only
+//! place it is reported.
+//!
+//! Compact tracking needs every lock ID to fit in 31 bits. Threads claim
+//! IDs in blocks (see `next_lock_id`), each fewer than twice the IDs it
+//! uses plus four, so this holds while twice the number of locks plus four
+//! per lock-creating thread stays below 2^31 over the life of the process,
+//! e.g. for 2^29 locks created by up to 2^27 threads. Creating a lock
+//! beyond that panics. Owners are stored in 32 bits as well, and async
+//! tasks take their IDs from the thread counter, so locking a mutex panics
+//! once more than 2^32 threads and async tasks have been created.
+
+use crate::core::detector;
+use crate::core::types::{LockId, ThreadId};
+#[cfg(feature = "compact-locks")]
+use std::sync::atomic::AtomicU32;
+#[cfg(not(feature = "compact-locks"))]
+use std::sync::atomic::AtomicUsize;
+use std::sync::atomic::Ordering;
+
+/// Identity and owner of a tracked Mutex
+#[cfg(not(feature = "compact-locks"))]
+pub(crate) struct Tracking {
+    /// Unique identifier of the mutex
+    id: LockId,
+    /// Thread that created the mutex
+    creator_thread_id: ThreadId,
+    /// Stores the ThreadId of the current owner (0 if unlocked).
+    /// This allows us to skip the global detector on the fast path.
+    owner: AtomicUsize,
+}
+
+#[cfg(not(feature = "compact-locks"))]
+impl Tracking {
+    /// Register a new mutex with the detector
+    pub(crate) fn new(id: LockId, creator_thread_id: ThreadId) -> Self {
+        detector::mutex::create_mutex(id, Some(creator_thread_id));
+        Tracking {
+            id,
+            creator_thread_id,
+            owner: AtomicUsize::new(0),
+        }
+    }
+
+    /// ID of the mutex
+    pub(crate) fn id(&self) -> LockId {
+        self.id
+    }
+
+    /// Thread that created the mutex
+    pub(crate) fn creator_thread_id(&self) -> ThreadId {
+        self.creator_thread_id
+    }
+
+    /// Current owner, 0 if unlocked
+    pub(crate) fn owner(&self, order: Ordering) -> ThreadId {
+        self.owner.load(order)
+    }
+
+    /// Record the current owner, 0 when unlocking
+    pub(crate) fn set_owner(&self, thread_id: ThreadId, order: Ordering) {
+        self.owner.store(thread_id, order);
+    }
+
+    /// Make sure the detector knows the mutex (always the case here)
+    #[inline(always)]
+    pub(crate) fn register(&self) {}
+
+    /// Whether the mutex has to be destroyed in the detector
+    pub(crate) fn is_registered(&self) -> bool {
+        true
+    }
+}
+
+/// Bit of the stored ID that tells whether the detector knows the mutex
+#[cfg(feature = "compact-locks")]
+const REGISTERED: u32 = 1 << 31;
+
+/// Identity and owner of a tracked Mutex, in 32 bits each
+#[cfg(feature = "compact-locks")]
+pub(crate) struct Tracking {
+    /// Unique identifier of the mutex, with `REGISTERED` once the detector
+    /// knows it
+    id: AtomicU32,
+    /// Stores the ThreadId of the current owner (0 if unlocked).
+    /// This allows us to skip the global detector on the fast path.
+    owner: AtomicU32,
+}
+
+#[cfg(feature = "compact-locks")]
+impl Tracking {
+    /// Track a new mutex, registering it with the detector only if the
+    /// creation is logged
+    ///
+    /// # Panics
+    /// If `id` does not fit in 31 bits, i.e. once the lock IDs described in
+    /// the module documentation run out.
+    pub(crate) fn new(id: LockId, creator_thread_id: ThreadId) -> Self {
+        let id = u32::try_from(id)
+            .ok()
+            .filter(|id| id & REGISTERED == 0)
+            .expect("compact-locks: lock IDs exhausted");
+        let tracking = Tracking {
+            id: AtomicU32::new(id),
+            owner: AtomicU32::new(0),
+        };
+        if crate::core::logger::is_enabled() {
+            detector::mutex::create_mutex(id as LockId, Some(creator_thread_id));
+            tracking.register();
+        }
+        tracking
+    }
+
+    /// ID of the mutex
+    pub(crate) fn id(&self) -> LockId {
+        (self.id.load(Ordering::Relaxed) & !REGISTERED) as LockId
+    }
+
+    /// Creator of the mutex, or 0 unless it was recorded while logging
+    pub(crate) fn creator_thread_id(&self) -> ThreadId {
+        detector::mutex::creator(self.id()).unwrap_or(0)
+    }
+
+    /// Current owner, 0 if unlocked
+    pub(crate) fn owner(&self, order: Ordering) -> ThreadId {
+        self.owner.load(order) as ThreadId
+    }
+
+    /// Record the current owner, 0 when unlocking
+    ///
+    /// # Panics
+    /// If `thread_id` does not fit in 32 bits, as a truncated owner would
+    /// be mistaken for another thread or for an unlocked mutex.
+    pub(crate) fn set_owner(&self, thread_id: ThreadId, order: Ordering) {
+        let owner = u32::try_from(thread_id).expect("compact-locks: thread IDs exhausted");
+        self.owner.store(owner, order);
+    }
+
+    /// Mark the mutex as known to the detector, before telling the detector
+    /// anything about it
+    #[inline]
+    pub(crate) fn register(&self) {
+        if self.id.load(Ordering::Relaxed) & REGISTERED == 0 {
+            self.id.fetch_or(REGISTERED, Ordering::Relaxed);
+        }
+    }
+
+    /// Whether the mutex has to be destroyed in the detector
+    pub(crate) fn is_registered(&self) -> bool {
+        self.id.load(Ordering::Relaxed) & REGISTERED != 0
+    }
+}
+
+#[cfg(all(test, feature = "compact-locks", target_pointer_width = "64"))]
+mod tests {
+    use super::*;
+
+    #[test]
+    #[should_panic(expected = "compact-locks: thread IDs exhausted")]
+    fn test_owner_beyond_32_bits_panics() {
+        let tracking = Tracking::new(1, 1);
+        tracking.set_owner(1 << 32, Ordering::Release);
+    }
+}
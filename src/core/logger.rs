@@ -6,6 +6,16 @@
 //! before being processed for visualization.
 //!
 //! The logger only records events - graph state is reconstructed in the frontend for better performance.
+//!
+//! Logging threads never contend with each other: each one appends to its own
+//! ring buffer (see the `ring` module) with a per-thread sequence number and a
+//! monotonic timestamp. The writer thread periodically drains every ring,
+//! merges the events by time, and only then assigns the global sequence
+//! numbers and wall clock timestamps that end up in the file.
+//!
+//! In flight-recorder mode (see the `recorder` module) the merged events are
+//! kept in a bounded in-memory window instead, and the file is only written
+//! when a deadlock is reported or the logs are flushed.
 
 use crate::core::types::{DeadlockInfo, Events, LockId, ThreadId};
 #[cfg(feature = "logging-and-visualization")]
@@ -18,22 +28,70 @@ use std::sync::atomic::AtomicBool;
 #[cfg(feature = "logging-and-visualization")]
 pub static LOGGING_ENABLED: AtomicBool = AtomicBool::new(false);
 
+#[cfg(feature = "logging-and-visualization")]
+pub mod binary;
+#[cfg(feature = "logging-and-visualization")]
+mod recorder;
+#[cfg(feature = "logging-and-visualization")]
+mod ring;
+
 #[cfg(feature = "logging-and-visualization")]
 mod enabled {
+    use super::binary::BinaryEncoder;
+    use super::recorder::FlightRecorder;
+    pub use super::recorder::RecorderCapacity;
+    use super::ring::{EventRing, RawEvent};
     use super::*;
     use chrono::Utc;
-    use crossbeam_channel::{Receiver, Sender, bounded, unbounded};
+    use crossbeam_channel::{Receiver, RecvTimeoutError, Sender, bounded, unbounded};
     use serde::Serialize;
+    use std::cell::RefCell;
     use std::fs::{File, OpenOptions};
-    use std::io::{BufWriter, Write};
+    use std::io::{BufWriter, Seek, SeekFrom, Write};
     use std::path::{Path, PathBuf};
     use std::sync::atomic::{AtomicU64, Ordering};
-    use std::sync::{Mutex, OnceLock};
+    use std::sync::{Arc, Mutex, OnceLock};
     use std::thread;
-    use std::time::Duration;
+    use std::time::{Duration, Instant};
 
     const DEFAULT_LOG_PATH: &str = "deadlock_detection_{timestamp}.log";
 
+    /// How often the writer thread drains the per-thread rings
+    const DRAIN_INTERVAL: Duration = Duration::from_millis(5);
+
+    /// How long drained events are held back before being written
+    ///
+    /// A thread can be preempted between taking an event's timestamp and
+    /// publishing it, so events are only written once they are older than
+    /// this. Events delayed for longer still get written, just with a later
+    /// sequence number than their timestamp suggests.
+    const HOLDBACK: Duration = Duration::from_millis(20);
+
+    /// Source of unique logger IDs, used to find a thread's ring for a logger
+    static NEXT_LOGGER_ID: AtomicU64 = AtomicU64::new(0);
+
+    /// A thread's ring for one logger
+    struct Producer {
+        logger_id: u64,
+        ring: Arc<EventRing>,
+        next_sequence: u64,
+    }
+
+    thread_local! {
+        /// Rings of the current thread, one per logger it has logged to
+        static PRODUCERS: RefCell<Vec<Producer>> = const { RefCell::new(Vec::new()) };
+    }
+
+    /// On-disk format of a log file
+    #[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+    pub enum LogFormat {
+        /// One JSON object per line (the default)
+        #[default]
+        Json,
+        /// Compact binary records, see the `binary` module for the layout
+        Binary,
+    }
+
     /// Structure for a single log entry representing a thread or lock event
     #[derive(Debug, Serialize, Clone)]
     pub struct LogEntry {
@@ -58,8 +116,10 @@ mod enabled {
     /// Commands for controlling the async logger thread
     #[derive(Debug, Clone)]
     pub enum LoggerCommand {
-        /// Write a log entry to the file
-        LogEntry(LogEntry),
+        /// An event from a thread whose ring is unavailable (during thread teardown)
+        Event(RawEvent),
+        /// A producer found its ring full and waits for it to be drained
+        Wake,
         /// Write a terminal deadlock record
         Deadlock(DeadlockInfo),
         /// Flush all pending entries to disk and signal completion
@@ -71,10 +131,14 @@ mod enabled {
     /// The EventLogger provides asynchronous file I/O with batching capabilities
     /// to minimize performance overhead and uses a background thread to handle file writes.
     pub struct EventLogger {
+        /// Unique ID of this logger
+        id: u64,
         /// Channel sender for async communication with logger thread
         sender: Sender<LoggerCommand>,
-        /// Sequence number for log entries
-        sequence: AtomicU64,
+        /// Rings of all threads that logged to this logger (shared with the writer)
+        rings: Arc<Mutex<Vec<Arc<EventRing>>>>,
+        /// Whether events are kept in memory until a deadlock or an explicit flush
+        flight_recorder: bool,
     }
 
     impl Default for EventLogger {
@@ -86,8 +150,11 @@ mod enabled {
     impl Drop for EventLogger {
         fn drop(&mut self) {
             // Attempt to flush remaining logs when the logger is dropped
-            // This is important to ensure logs aren't lost if the program exits
-            if let Err(e) = self.flush() {
+            // This is important to ensure logs aren't lost if the program exits.
+            // A flight recorder only writes on demand.
+            if !self.flight_recorder
+                && let Err(e) = self.flush()
+            {
                 eprintln!("Warning: Failed to flush logs during EventLogger drop: {e:?}");
             }
         }
@@ -124,28 +191,37 @@ mod enabled {
             // Update the global registry
             CURRENT_LOG_FILE.lock().unwrap().replace(path_buf.clone());
 
-            // Create async logger thread
-            let (tx, rx) = unbounded::<LoggerCommand>();
             let file = OpenOptions::new()
                 .create(true)
                 .write(true)
                 .truncate(true)
                 .open(&path_buf)?;
 
-            // Spawn async writer thread
-            thread::spawn(move || async_logger_thread(file, rx));
+            Ok(Self::start(file, LogFormat::Json, None))
+        }
 
-            Ok(EventLogger {
+        /// Spawn the async writer thread for `file`
+        fn start(file: File, format: LogFormat, recorder: Option<RecorderCapacity>) -> Self {
+            let (tx, rx) = unbounded::<LoggerCommand>();
+            let rings = Arc::new(Mutex::new(Vec::new()));
+
+            let writer_rings = Arc::clone(&rings);
+            let merger = EventMerger::new(format, recorder);
+            thread::spawn(move || async_logger_thread(file, merger, rx, writer_rings));
+
+            EventLogger {
+                id: NEXT_LOGGER_ID.fetch_add(1, Ordering::Relaxed),
                 sender: tx,
-                sequence: AtomicU64::new(0),
-            })
+                rings,
+                flight_recorder: recorder.is_some(),
+            }
         }
 
         /// Create a new logger that writes to the specified file asynchronously
         ///
         /// This function sets up an asynchronous logging system with a background
-        /// writer thread that handles file I/O operations. Log entries are sent
-        /// to the writer thread via a channel for batched writing.
+        /// writer thread that handles file I/O operations. Log entries are
+        /// buffered per thread and drained by the writer thread in batches.
         ///
         /// # Arguments
         /// * `path` - Path to the log file. If the filename contains "{timestamp}",
@@ -160,54 +236,62 @@ mod enabled {
         /// - The log file could not be opened for writing
         /// - The async logger thread could not be spawned
         pub fn with_file<P: AsRef<Path>>(path: P) -> Result<Self> {
-            let path_buf = path.as_ref().to_path_buf();
-
-            // Create directory if needed
-            if let Some(parent) = path_buf.parent()
-                && parent.to_string_lossy() != ""
-                && !parent.exists()
-            {
-                std::fs::create_dir_all(parent)?;
-            }
-
-            // Replace timestamp placeholder if present
-            #[allow(clippy::literal_string_with_formatting_args)]
-            let file_path = if path_buf.to_string_lossy().contains("{timestamp}") {
-                let timestamp = Utc::now().format("%Y%m%d_%H%M%S");
-                PathBuf::from(
-                    path_buf
-                        .to_string_lossy()
-                        .replace("{timestamp}", &timestamp.to_string()),
-                )
-            } else {
-                path_buf
-            };
-
-            // Update the global registry
-            CURRENT_LOG_FILE.lock().unwrap().replace(file_path.clone());
-
-            // Create async logger thread
-            let (tx, rx) = unbounded::<LoggerCommand>();
-            let file = OpenOptions::new()
-                .create(true)
-                .write(true)
-                .truncate(true)
-                .open(&file_path)?;
+            Self::with_file_and_format(path, LogFormat::Json)
+        }
 
-            // Spawn async writer thread
-            thread::spawn(move || async_logger_thread(file, rx));
+        /// Create a new logger that writes to the specified file in the given format
+        ///
+        /// Behaves like [`EventLogger::with_file`], but lets the caller choose
+        /// between JSON lines and the compact binary format.
+        ///
+        /// # Arguments
+        /// * `path` - Path to the log file. If the filename contains "{timestamp}",
+        ///   it will be replaced with the current timestamp.
+        /// * `format` - On-disk format of the log
+        ///
+        /// # Returns
+        /// A Result containing the configured EventLogger or an error if setup fails
+        ///
+        /// # Errors
+        /// Returns an error if the directory or the log file could not be created
+        pub fn with_file_and_format<P: AsRef<Path>>(path: P, format: LogFormat) -> Result<Self> {
+            let file = open_log_file(path)?;
+            Ok(Self::start(file, format, None))
+        }
 
-            Ok(EventLogger {
-                sender: tx,
-                sequence: AtomicU64::new(0),
-            })
+        /// Create a flight recorder that keeps recent events in memory
+        ///
+        /// Events are merged as usual but only the most recent ones are kept,
+        /// in a window preallocated according to `capacity`. The file is
+        /// written only when a deadlock is logged or [`EventLogger::flush`] is
+        /// called, and each write replaces the previous contents with the
+        /// current window, so the file always holds one self-contained log.
+        ///
+        /// # Arguments
+        /// * `path` - Path to the log file. If the filename contains "{timestamp}",
+        ///   it will be replaced with the current timestamp.
+        /// * `format` - On-disk format of the log
+        /// * `capacity` - How many recent events to keep
+        ///
+        /// # Returns
+        /// A Result containing the configured EventLogger or an error if setup fails
+        ///
+        /// # Errors
+        /// Returns an error if the directory or the log file could not be created
+        pub fn with_flight_recorder<P: AsRef<Path>>(
+            path: P,
+            format: LogFormat,
+            capacity: RecorderCapacity,
+        ) -> Result<Self> {
+            let file = open_log_file(path)?;
+            Ok(Self::start(file, format, Some(capacity)))
         }
 
         /// Log any event
         ///
         /// This method handles thread events, lock events, and lock-thread interactions
-        /// by sending them to the async logger thread for processing. The operation is
-        /// non-blocking and will not fail if the channel is full or closed.
+        /// by appending them to the calling thread's ring buffer. The operation only
+        /// waits if the ring is full, until the writer thread has drained it.
         ///
         /// # Arguments
         /// * `thread_id` - ID of the thread involved in the event (0 for lock-only events)
@@ -223,27 +307,62 @@ mod enabled {
             parent_id: Option<ThreadId>,
             woken_thread: Option<ThreadId>,
         ) {
-            let now = Utc::now();
-            let timestamp =
-                now.timestamp() as f64 + now.timestamp_subsec_micros() as f64 / 1_000_000.0;
-
-            let entry = LogEntry {
-                sequence: self.sequence.fetch_add(1, Ordering::Relaxed),
+            let mut raw = RawEvent {
+                instant: Instant::now(),
+                thread_sequence: u64::MAX,
                 thread_id,
                 lock_id,
                 event,
-                timestamp,
                 parent_id,
                 woken_thread,
             };
 
-            self.log_entry(entry);
+            let buffered = PRODUCERS.try_with(|producers| {
+                let mut producers = producers.borrow_mut();
+                let producer = self.producer(&mut producers);
+                raw.thread_sequence = producer.next_sequence;
+                producer.next_sequence += 1;
+                self.push(&producer.ring, raw);
+            });
+
+            // The thread-local ring is gone while the thread is being torn down
+            if buffered.is_err() {
+                let _ = self.sender.send(LoggerCommand::Event(raw));
+            }
         }
 
-        /// Enqueue a pre-built log entry (used by the global logging facade)
-        pub(crate) fn log_entry(&self, entry: LogEntry) {
-            if let Err(e) = self.sender.send(LoggerCommand::LogEntry(entry)) {
-                eprintln!("Failed to send log entry: {e:?}");
+        /// Find the current thread's ring for this logger, registering one if needed
+        fn producer<'a>(&self, producers: &'a mut Vec<Producer>) -> &'a mut Producer {
+            if let Some(pos) = producers.iter().position(|p| p.logger_id == self.id) {
+                return &mut producers[pos];
+            }
+
+            // Forget rings of loggers that no longer exist
+            producers.retain(|p| !p.ring.is_closed());
+
+            let ring = Arc::new(EventRing::new());
+            self.rings.lock().unwrap().push(Arc::clone(&ring));
+            producers.push(Producer {
+                logger_id: self.id,
+                ring,
+                next_sequence: 0,
+            });
+            producers.last_mut().unwrap()
+        }
+
+        /// Append an event to a ring, waiting for the writer if it is full
+        fn push(&self, ring: &EventRing, mut raw: RawEvent) {
+            let mut woken = false;
+            while let Err(back) = ring.push(raw) {
+                if ring.is_closed() {
+                    return;
+                }
+                if !woken {
+                    let _ = self.sender.send(LoggerCommand::Wake);
+                    woken = true;
+                }
+                raw = back;
+                thread::yield_now();
             }
         }
 
@@ -332,59 +451,236 @@ mod enabled {
         }
     }
 
+    /// Merges drained events and writes them in timestamp order
+    struct EventMerger {
+        /// Drained events that have not been written yet
+        pending: Vec<RawEvent>,
+        /// Global sequence number of the next written event
+        next_sequence: u64,
+        /// Monotonic time corresponding to `epoch_wall`
+        epoch_instant: Instant,
+        /// Wall clock time at logger start (seconds since Unix Epoch)
+        epoch_wall: f64,
+        /// Encoder state when writing the binary format, `None` for JSON
+        binary: Option<BinaryEncoder>,
+        /// Window of recent events in flight-recorder mode, `None` when streaming
+        recorder: Option<FlightRecorder>,
+    }
+
+    impl EventMerger {
+        fn new(format: LogFormat, recorder: Option<RecorderCapacity>) -> Self {
+            let now = Utc::now();
+            EventMerger {
+                pending: Vec::new(),
+                next_sequence: 0,
+                epoch_instant: Instant::now(),
+                epoch_wall: now.timestamp() as f64
+                    + now.timestamp_subsec_micros() as f64 / 1_000_000.0,
+                binary: (format == LogFormat::Binary).then(BinaryEncoder::default),
+                recorder: recorder.map(FlightRecorder::new),
+            }
+        }
+
+        /// Write the file header, if the format has one
+        fn write_header<W: Write>(&mut self, writer: &mut W) {
+            if let Some(encoder) = &mut self.binary
+                && let Err(e) = encoder.write_header(writer, self.epoch_wall)
+            {
+                eprintln!("Logger write error (header): {e:?}");
+            }
+        }
+
+        /// Drain every ring, dropping rings whose thread has exited
+        fn collect(&mut self, rings: &Mutex<Vec<Arc<EventRing>>>) {
+            let mut rings = rings.lock().unwrap();
+            rings.retain(|ring| {
+                ring.drain_into(&mut self.pending);
+                // The thread-local handle is gone, so nothing can be pushed anymore
+                Arc::strong_count(ring) > 1 || !ring.is_empty()
+            });
+        }
+
+        /// Write the pending events recorded no later than `cutoff`
+        ///
+        /// `None` writes all pending events. A flight recorder keeps the
+        /// events in its window instead of writing them.
+        fn write_until<W: Write>(&mut self, writer: &mut W, cutoff: Option<Instant>) {
+            if self.pending.is_empty() {
+                return;
+            }
+            self.pending.sort_unstable_by_key(RawEvent::merge_key);
+            let ready = match cutoff {
+                Some(cutoff) => self.pending.partition_point(|e| e.instant <= cutoff),
+                None => self.pending.len(),
+            };
+
+            let mut pending = std::mem::take(&mut self.pending);
+            for raw in pending.drain(..ready) {
+                let sequence = self.next_sequence;
+                self.next_sequence += 1;
+                match &mut self.recorder {
+                    Some(recorder) => recorder.record(sequence, raw),
+                    None => self.write_event(writer, sequence, &raw),
+                }
+            }
+            self.pending = pending;
+        }
+
+        /// Write one merged event
+        fn write_event<W: Write>(&mut self, writer: &mut W, sequence: u64, raw: &RawEvent) {
+            let since_epoch = raw.instant.saturating_duration_since(self.epoch_instant);
+
+            let result = if let Some(encoder) = &mut self.binary {
+                encoder.write_event(writer, sequence, raw, since_epoch.as_nanos() as u64)
+            } else {
+                let entry = LogEntry {
+                    sequence,
+                    thread_id: raw.thread_id,
+                    lock_id: raw.lock_id,
+                    event: raw.event,
+                    timestamp: self.epoch_wall + since_epoch.as_secs_f64(),
+                    parent_id: raw.parent_id,
+                    woken_thread: raw.woken_thread,
+                };
+                serde_json::to_string(&entry)
+                    .map_err(std::io::Error::from)
+                    .and_then(|json| writeln!(writer, "{json}"))
+            };
+            if let Err(e) = result {
+                eprintln!("Logger write error: {e:?}");
+            }
+        }
+
+        /// Replace the contents of the file with the flight recorder's window
+        ///
+        /// Does nothing when streaming.
+        fn dump(&mut self, writer: &mut BufWriter<File>) {
+            let Some(recorder) = &self.recorder else {
+                return;
+            };
+            let events = recorder.snapshot();
+            let deadlock = recorder.deadlock.clone();
+
+            let rewind = writer.flush().and_then(|_| {
+                let file = writer.get_mut();
+                file.set_len(0)?;
+                file.seek(SeekFrom::Start(0)).map(|_| ())
+            });
+            if let Err(e) = rewind {
+                eprintln!("Logger write error (flight recorder): {e:?}");
+                return;
+            }
+
+            // Every dump is a complete file, so delta encoding starts over
+            if let Some(encoder) = &mut self.binary {
+                *encoder = BinaryEncoder::default();
+            }
+            self.write_header(writer);
+            for (sequence, raw) in &events {
+                self.write_event(writer, *sequence, raw);
+            }
+            if let Some(info) = &deadlock {
+                self.write_deadlock(writer, info);
+            }
+        }
+
+        /// Write a terminal deadlock record
+        fn write_deadlock<W: Write>(&mut self, writer: &mut W, info: &DeadlockInfo) {
+            let result = if let Some(encoder) = &mut self.binary {
+                encoder.write_deadlock(writer, info)
+            } else {
+                // Wrap as a distinct terminal record
+                #[derive(serde::Serialize)]
+                struct DeadlockRecord<'a> {
+                    deadlock: &'a DeadlockInfo,
+                    timestamp: f64,
+                }
+                let now = chrono::Utc::now();
+                let ts =
+                    now.timestamp() as f64 + now.timestamp_subsec_micros() as f64 / 1_000_000.0;
+                let record = DeadlockRecord {
+                    deadlock: info,
+                    timestamp: ts,
+                };
+                serde_json::to_string(&record)
+                    .map_err(std::io::Error::from)
+                    .and_then(|json| writeln!(writer, "{json}"))
+            };
+            if let Err(e) = result.and_then(|_| writer.flush()) {
+                eprintln!("Logger write error (deadlock): {e:?}");
+            }
+        }
+    }
+
     /// Async logger thread that batches writes to improve performance
     ///
     /// This function runs in a dedicated thread and handles all file I/O operations.
-    /// It receives log entries through a channel and writes them to disk in batches,
+    /// It drains the per-thread rings every `DRAIN_INTERVAL` (or when woken by a
+    /// command), merges their events and writes them to disk in batches,
     /// reducing the overhead of frequent disk writes.
     ///
     /// # Arguments
     /// * `file` - The file to write log entries to
+    /// * `merger` - Merger configured with the format and flight recorder
     /// * `rx` - Channel receiver for incoming logger commands
-    /// * `flushing` - Atomic flag indicating flush status
-    fn async_logger_thread(file: File, rx: Receiver<LoggerCommand>) {
+    /// * `rings` - Rings of the threads logging to this logger
+    fn async_logger_thread(
+        file: File,
+        mut merger: EventMerger,
+        rx: Receiver<LoggerCommand>,
+        rings: Arc<Mutex<Vec<Arc<EventRing>>>>,
+    ) {
         let mut writer = BufWriter::new(file);
+        if merger.recorder.is_none() {
+            merger.write_header(&mut writer);
+        }
 
         // Loop until the channel is closed
-        while let Ok(cmd) = rx.recv() {
-            match cmd {
-                LoggerCommand::LogEntry(entry) => {
-                    if let Ok(json) = serde_json::to_string(&entry)
-                        && let Err(e) = writeln!(writer, "{json}")
-                    {
-                        eprintln!("Logger write error: {e:?}");
-                    }
-                }
-                LoggerCommand::Deadlock(info) => {
-                    // Wrap as a distinct terminal record
-                    #[derive(serde::Serialize)]
-                    struct DeadlockRecord<'a> {
-                        deadlock: &'a DeadlockInfo,
-                        timestamp: f64,
-                    }
-                    let now = chrono::Utc::now();
-                    let ts =
-                        now.timestamp() as f64 + now.timestamp_subsec_micros() as f64 / 1_000_000.0;
-                    let record = DeadlockRecord {
-                        deadlock: &info,
-                        timestamp: ts,
-                    };
-                    if let Ok(json) = serde_json::to_string(&record)
-                        && let Err(e) = writeln!(writer, "{json}").and_then(|_| writer.flush())
-                    {
-                        eprintln!("Logger write error (deadlock): {e:?}");
+        loop {
+            match rx.recv_timeout(DRAIN_INTERVAL) {
+                Ok(LoggerCommand::Event(raw)) => merger.pending.push(raw),
+                Ok(LoggerCommand::Wake) | Err(RecvTimeoutError::Timeout) => {}
+                Ok(LoggerCommand::Deadlock(info)) => {
+                    // Everything that led up to the deadlock goes first
+                    merger.collect(&rings);
+                    merger.write_until(&mut writer, None);
+                    match &mut merger.recorder {
+                        Some(recorder) => {
+                            recorder.deadlock = Some(info);
+                            merger.dump(&mut writer);
+                        }
+                        None => merger.write_deadlock(&mut writer, &info),
                     }
                 }
-                LoggerCommand::Flush(responder) => {
+                Ok(LoggerCommand::Flush(responder)) => {
+                    merger.collect(&rings);
+                    merger.write_until(&mut writer, None);
+                    merger.dump(&mut writer);
                     if let Err(e) = writer.flush() {
                         eprintln!("Logger flush error: {e:?}");
                     }
                     let _ = responder.send(());
                 }
+                Err(RecvTimeoutError::Disconnected) => break,
+            }
+
+            let cutoff = Instant::now().checked_sub(HOLDBACK);
+            merger.collect(&rings);
+            if let Some(cutoff) = cutoff {
+                merger.write_until(&mut writer, Some(cutoff));
             }
         }
 
-        // Channel closed - perform final flush before thread exits
+        // Channel closed - write what is left and perform final flush before thread exits.
+        // A flight recorder keeps the file as of its last dump.
+        for ring in rings.lock().unwrap().iter() {
+            ring.close();
+        }
+        if merger.recorder.is_some() {
+            return;
+        }
+        merger.collect(&rings);
+        merger.write_until(&mut writer, None);
         if let Err(e) = writer.flush() {
             eprintln!("Logger final flush error: {e:?}");
         }
@@ -395,6 +691,45 @@ mod enabled {
         static ref CURRENT_LOG_FILE: Mutex<Option<PathBuf>> = Mutex::new(None);
     }
 
+    /// Resolve the log path, register it as the current log and open the file
+    ///
+    /// Creates the parent directory if needed and replaces a "{timestamp}"
+    /// placeholder in the filename with the current timestamp.
+    fn open_log_file<P: AsRef<Path>>(path: P) -> Result<File> {
+        let path_buf = path.as_ref().to_path_buf();
+
+        // Create directory if needed
+        if let Some(parent) = path_buf.parent()
+            && parent.to_string_lossy() != ""
+            && !parent.exists()
+        {
+            std::fs::create_dir_all(parent)?;
+        }
+
+        // Replace timestamp placeholder if present
+        #[allow(clippy::literal_string_with_formatting_args)]
+        let file_path = if path_buf.to_string_lossy().contains("{timestamp}") {
+            let timestamp = Utc::now().format("%Y%m%d_%H%M%S");
+            PathBuf::from(
+                path_buf
+                    .to_string_lossy()
+                    .replace("{timestamp}", &timestamp.to_string()),
+            )
+        } else {
+            path_buf
+        };
+
+        // Update the global registry
+        CURRENT_LOG_FILE.lock().unwrap().replace(file_path.clone());
+
+        let file = OpenOptions::new()
+            .create(true)
+            .write(true)
+            .truncate(true)
+            .open(&file_path)?;
+        Ok(file)
+    }
+
     /// Get current log file path
     pub fn get_current_log_file() -> Option<PathBuf> {
         CURRENT_LOG_FILE
@@ -435,6 +770,12 @@ mod enabled {
         }
     }
 
+    /// Whether a logger is installed
+    #[cfg(feature = "compact-locks")]
+    pub fn is_enabled() -> bool {
+        LOGGING_ENABLED.load(Ordering::Relaxed)
+    }
+
     pub fn log_thread_event(thread_id: ThreadId, parent_id: Option<ThreadId>, event: Events) {
         with_logger(|logger| {
             logger.log_thread_event(thread_id, parent_id, event);
@@ -529,6 +870,84 @@ mod enabled {
             assert_eq!(lines.len(), 10);
         }
 
+        #[test]
+        fn test_binary_log_round_trip() {
+            let temp_dir = TempDir::new().unwrap();
+            let log_path = temp_dir.path().join("binary.dlxb");
+
+            let logger = EventLogger::with_file_and_format(&log_path, LogFormat::Binary).unwrap();
+            logger.log_event(1, 0, Events::ThreadSpawn, Some(7), None);
+            logger.log_event(1, 10, Events::MutexAttempt, None, None);
+            logger.log_event(1, 10, Events::MutexAcquired, None, None);
+            logger.flush().unwrap();
+
+            let bytes = std::fs::read(&log_path).unwrap();
+            let records = binary::decode(&bytes).unwrap();
+            let events: Vec<_> = records
+                .into_iter()
+                .map(|record| match record {
+                    binary::BinaryRecord::Event(event) => event,
+                    binary::BinaryRecord::Deadlock(_) => panic!("unexpected deadlock record"),
+                })
+                .collect();
+
+            assert_eq!(events.len(), 3);
+            assert_eq!(events[0].event, Events::ThreadSpawn);
+            assert_eq!(events[0].parent_id, 7);
+            assert_eq!(events[2].lock_id, 10);
+            assert!(events.windows(2).all(|w| w[0].sequence < w[1].sequence));
+        }
+
+        #[test]
+        fn test_flight_recorder_writes_only_on_demand() {
+            let temp_dir = TempDir::new().unwrap();
+            let log_path = temp_dir.path().join("recorder.log");
+
+            let logger = EventLogger::with_flight_recorder(
+                &log_path,
+                LogFormat::Json,
+                RecorderCapacity::Total(5),
+            )
+            .unwrap();
+            logger.log_thread_event(1, None, Events::ThreadSpawn);
+            logger.log_lock_event(10, Some(1), Events::MutexSpawn);
+            for _ in 0..100 {
+                logger.log_interaction_event(1, 10, Events::MutexAcquired);
+                logger.log_interaction_event(1, 10, Events::MutexReleased);
+            }
+
+            // Nothing reaches the disk in the steady state
+            thread::sleep(DRAIN_INTERVAL + HOLDBACK * 2);
+            assert!(std::fs::read(&log_path).unwrap().is_empty());
+
+            logger.flush().unwrap();
+            let contents = std::fs::read_to_string(&log_path).unwrap();
+            let lines: Vec<&str> = contents.lines().collect();
+            // The live thread and lock spawns, then the last five events
+            assert_eq!(lines.len(), 7);
+            assert!(lines[0].contains("\"ThreadSpawn\""));
+            assert!(lines[1].contains("\"MutexSpawn\""));
+            assert!(lines[6].contains("\"sequence\":201"));
+
+            // A deadlock replaces the file with the current window plus the record
+            logger.log_interaction_event(1, 10, Events::MutexAttempt);
+            logger.log_deadlock(DeadlockInfo {
+                source: crate::core::types::DeadlockSource::WaitForGraph,
+                thread_cycle: vec![1],
+                thread_waiting_for_locks: vec![(1, 10)],
+                lock_order_cycle: None,
+                lock_order_classes: None,
+                timestamp: String::new(),
+                verification_request: None,
+            });
+            logger.flush().unwrap();
+            let contents = std::fs::read_to_string(&log_path).unwrap();
+            let lines: Vec<&str> = contents.lines().collect();
+            assert_eq!(lines.len(), 8);
+            assert!(lines[6].contains("\"MutexAttempt\""));
+            assert!(lines[7].starts_with("{\"deadlock\""));
+        }
+
         #[test]
         fn test_graph_state_per_instance() {
             let temp_dir = TempDir::new().unwrap();
@@ -564,6 +983,52 @@ mod enabled {
             assert!(!content2.contains("\"lock_id\":10"));
         }
 
+        #[test]
+        fn test_events_from_many_threads_are_merged() {
+            let temp_dir = TempDir::new().unwrap();
+            let log_path = temp_dir.path().join("merge.log");
+
+            let logger = Arc::new(EventLogger::with_file(&log_path).unwrap());
+            let handles: Vec<_> = (1..=4)
+                .map(|thread_id| {
+                    let logger = Arc::clone(&logger);
+                    thread::spawn(move || {
+                        // More events than one ring holds, so producers wait on the writer
+                        for lock_id in 0..2000 {
+                            logger.log_interaction_event(thread_id, lock_id, Events::MutexAttempt);
+                        }
+                    })
+                })
+                .collect();
+            for handle in handles {
+                handle.join().unwrap();
+            }
+            logger.flush().unwrap();
+
+            let contents = std::fs::read_to_string(&log_path).unwrap();
+            let entries: Vec<serde_json::Value> = contents
+                .lines()
+                .map(|line| serde_json::from_str(line).unwrap())
+                .collect();
+            assert_eq!(entries.len(), 8000);
+
+            let mut last_lock = [None; 5];
+            let mut last_timestamp = 0.0;
+            for (i, entry) in entries.iter().enumerate() {
+                // Global sequence numbers are dense and follow the timestamps
+                assert_eq!(entry["sequence"].as_u64(), Some(i as u64));
+                let timestamp = entry["timestamp"].as_f64().unwrap();
+                assert!(timestamp >= last_timestamp);
+                last_timestamp = timestamp;
+
+                // Events of each thread stay in program order
+                let thread_id = entry["thread_id"].as_u64().unwrap() as usize;
+                let lock_id = entry["lock_id"].as_u64().unwrap();
+                assert!(last_lock[thread_id].is_none_or(|last| last < lock_id));
+                last_lock[thread_id] = Some(lock_id);
+            }
+        }
+
         #[test]
         fn test_logger_drop_flushes() {
             let temp_dir = TempDir::new().unwrap();
@@ -595,6 +1060,10 @@ mod enabled {
 mod disabled {
     use super::*;
 
+    #[cfg(feature = "compact-locks")]
+    pub fn is_enabled() -> bool {
+        false
+    }
     pub fn log_thread_event(_: ThreadId, _: Option<ThreadId>, _: Events) {}
     pub fn log_lock_event(_: LockId, _: Option<ThreadId>, _: Events) {}
     pub fn log_interaction_event(_: ThreadId, _: LockId, _: Events) {}
@@ -0,0 +1,417 @@
+//! Compact binary log format
+//!
+//! The JSON-lines log spends most of the writer thread's time in
+//! `serde_json`, and a typical event takes over a hundred bytes. The binary
+//! format stores the same information in about ten bytes per event.
+//!
+//! # Layout
+//!
+//! The file starts with a header: the magic bytes [`MAGIC`], a version byte,
+//! and the wall clock time of the logger start as a little-endian `f64`
+//! (seconds since the Unix Epoch). Records follow back to back. Each one
+//! starts with a tag byte:
+//!
+//! * An event code (see [`Events::code`]), followed by LEB128 varints for the
+//!   sequence number delta, thread ID, lock ID, the zigzag-encoded delta of
+//!   the nanoseconds since the logger start, the parent ID and the woken
+//!   thread (0 for `None` in both cases).
+//! * [`DEADLOCK_TAG`], followed by a varint length and the deadlock
+//!   information as JSON. Deadlocks are rare, so they keep the flexible form.
+
+use super::ring::RawEvent;
+use crate::core::types::{DeadlockInfo, Events};
+use anyhow::{Context, Result, anyhow, bail};
+use std::io::{self, Write};
+
+/// Magic bytes at the start of every binary log
+pub const MAGIC: &[u8; 4] = b"DLXB";
+
+/// Version of the record layout
+const VERSION: u8 = 1;
+
+/// Tag byte of a deadlock record
+const DEADLOCK_TAG: u8 = 0xFF;
+
+/// Length of the file header in bytes
+const HEADER_LEN: usize = MAGIC.len() + 1 + 8;
+
+/// Stateful writer of binary log records
+///
+/// Sequence numbers and timestamps are stored as deltas from the previous
+/// event, so one encoder must write a whole file.
+#[derive(Default)]
+pub struct BinaryEncoder {
+    last_sequence: u64,
+    last_nanos: u64,
+    buf: Vec<u8>,
+}
+
+impl BinaryEncoder {
+    /// Write the file header
+    ///
+    /// # Arguments
+    /// * `writer` - Destination of the log
+    /// * `epoch_wall` - Wall clock time of the logger start (seconds since Unix Epoch)
+    pub fn write_header<W: Write>(&mut self, writer: &mut W, epoch_wall: f64) -> io::Result<()> {
+        writer.write_all(MAGIC)?;
+        writer.write_all(&[VERSION])?;
+        writer.write_all(&epoch_wall.to_le_bytes())
+    }
+
+    /// Write one event record
+    ///
+    /// # Arguments
+    /// * `writer` - Destination of the log
+    /// * `sequence` - Global sequence number of the event
+    /// * `raw` - The event as recorded by its thread
+    /// * `nanos` - Nanoseconds between the logger start and the event
+    pub fn write_event<W: Write>(
+        &mut self,
+        writer: &mut W,
+        sequence: u64,
+        raw: &RawEvent,
+        nanos: u64,
+    ) -> io::Result<()> {
+        self.buf.clear();
+        self.buf.push(raw.event.code());
+        put_varint(&mut self.buf, sequence.wrapping_sub(self.last_sequence));
+        put_varint(&mut self.buf, raw.thread_id as u64);
+        put_varint(&mut self.buf, raw.lock_id as u64);
+        put_varint(
+            &mut self.buf,
+            zigzag(nanos.wrapping_sub(self.last_nanos) as i64),
+        );
+        put_varint(&mut self.buf, raw.parent_id.unwrap_or(0) as u64);
+        put_varint(&mut self.buf, raw.woken_thread.unwrap_or(0) as u64);
+        self.last_sequence = sequence;
+        self.last_nanos = nanos;
+        writer.write_all(&self.buf)
+    }
+
+    /// Write a deadlock record
+    pub fn write_deadlock<W: Write>(
+        &mut self,
+        writer: &mut W,
+        info: &DeadlockInfo,
+    ) -> io::Result<()> {
+        let json = serde_json::to_vec(info)?;
+        self.buf.clear();
+        self.buf.push(DEADLOCK_TAG);
+        put_varint(&mut self.buf, json.len() as u64);
+        writer.write_all(&self.buf)?;
+        writer.write_all(&json)
+    }
+}
+
+/// A decoded event record
+#[derive(Debug, Clone, PartialEq)]
+pub struct BinaryEvent {
+    pub sequence: u64,
+    pub thread_id: u64,
+    pub lock_id: u64,
+    pub event: Events,
+    /// Seconds since the Unix Epoch
+    pub timestamp: f64,
+    /// Parent/creator thread, 0 for none
+    pub parent_id: u64,
+    /// Thread woken by a notify, 0 for none
+    pub woken_thread: u64,
+}
+
+/// A decoded record of a binary log
+#[derive(Debug, Clone)]
+pub enum BinaryRecord {
+    Event(BinaryEvent),
+    Deadlock(Box<DeadlockInfo>),
+}
+
+/// Whether `bytes` start like a binary log
+pub fn is_binary_log(bytes: &[u8]) -> bool {
+    bytes.starts_with(MAGIC)
+}
+
+/// Decode a complete binary log
+///
+/// # Arguments
+/// * `bytes` - Contents of the log file
+///
+/// # Returns
+/// The records in file order
+///
+/// # Errors
+/// Returns an error if the header is missing or of an unknown version, or if
+/// a record is malformed. A record cut off at the end of the file (a log that
+/// is still being written) is ignored.
+pub fn decode(bytes: &[u8]) -> Result<Vec<BinaryRecord>> {
+    let mut decoder = BinaryDecoder::new(bytes)?;
+    let mut records = Vec::new();
+    decoder.decode(&bytes[HEADER_LEN..], &mut records)?;
+    Ok(records)
+}
+
+/// Decoder of a binary log that is read piece by piece
+///
+/// Records store deltas from the previous event, so decoding can only
+/// resume where it stopped. The decoder carries those running values and
+/// can be rebuilt from them with [`Self::resume`], which lets a reader that
+/// follows a growing log keep its position outside of the decoder.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct BinaryDecoder {
+    /// Wall clock time of the logger start (seconds since Unix Epoch)
+    pub epoch_wall: f64,
+    /// Sequence number of the last decoded event
+    pub sequence: u64,
+    /// Nanoseconds since the logger start of the last decoded event
+    pub nanos: u64,
+}
+
+impl BinaryDecoder {
+    /// Length of the file header, after which the first record starts
+    pub const HEADER_LEN: usize = HEADER_LEN;
+
+    /// Create a decoder from the start of a log
+    ///
+    /// # Errors
+    /// Returns an error if the header is missing or of an unknown version.
+    pub fn new(header: &[u8]) -> Result<Self> {
+        if header.len() < HEADER_LEN || !is_binary_log(header) {
+            bail!("Not a binary deloxide log");
+        }
+        if header[MAGIC.len()] != VERSION {
+            bail!("Unsupported binary log version {}", header[MAGIC.len()]);
+        }
+        let epoch_wall = f64::from_le_bytes(header[MAGIC.len() + 1..HEADER_LEN].try_into()?);
+        Ok(Self::resume(epoch_wall, 0, 0))
+    }
+
+    /// Rebuild a decoder from the running values of an earlier one
+    pub fn resume(epoch_wall: f64, sequence: u64, nanos: u64) -> Self {
+        BinaryDecoder {
+            epoch_wall,
+            sequence,
+            nanos,
+        }
+    }
+
+    /// Decode the complete records at the start of `bytes`
+    ///
+    /// # Arguments
+    /// * `bytes` - Log contents following the previously decoded records
+    /// * `records` - Receives the decoded records in file order
+    ///
+    /// # Returns
+    /// The number of bytes consumed, which stops short of a record cut off
+    /// at the end of `bytes`
+    ///
+    /// # Errors
+    /// Returns an error if a record is malformed.
+    pub fn decode(&mut self, bytes: &[u8], records: &mut Vec<BinaryRecord>) -> Result<usize> {
+        let mut reader = Reader { bytes, pos: 0 };
+
+        while reader.pos < bytes.len() {
+            let start = reader.pos;
+            let record = (|| -> Option<Result<BinaryRecord>> {
+                let tag = reader.byte()?;
+                if tag == DEADLOCK_TAG {
+                    let len = reader.varint()? as usize;
+                    let json = reader.take(len)?;
+                    return Some(
+                        serde_json::from_slice(json)
+                            .map(|info| BinaryRecord::Deadlock(Box::new(info)))
+                            .context("Malformed deadlock record"),
+                    );
+                }
+
+                let Some(event) = Events::from_code(tag) else {
+                    return Some(Err(anyhow!("Invalid event code {tag} at offset {start}")));
+                };
+                let sequence_delta = reader.varint()?;
+                let thread_id = reader.varint()?;
+                let lock_id = reader.varint()?;
+                let nanos_delta = unzigzag(reader.varint()?);
+                let parent_id = reader.varint()?;
+                let woken_thread = reader.varint()?;
+
+                self.sequence = self.sequence.wrapping_add(sequence_delta);
+                self.nanos = self.nanos.wrapping_add(nanos_delta as u64);
+                Some(Ok(BinaryRecord::Event(BinaryEvent {
+                    sequence: self.sequence,
+                    thread_id,
+                    lock_id,
+                    event,
+                    timestamp: self.epoch_wall + self.nanos as f64 / 1_000_000_000.0,
+                    parent_id,
+                    woken_thread,
+                })))
+            })();
+
+            match record {
+                Some(record) => records.push(record?),
+                // Truncated trailing record
+                None => return Ok(start),
+            }
+        }
+
+        Ok(reader.pos)
+    }
+}
+
+/// Cursor over the bytes of a log
+struct Reader<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn byte(&mut self) -> Option<u8> {
+        let byte = *self.bytes.get(self.pos)?;
+        self.pos += 1;
+        Some(byte)
+    }
+
+    fn take(&mut self, len: usize) -> Option<&'a [u8]> {
+        let slice = self.bytes.get(self.pos..self.pos.checked_add(len)?)?;
+        self.pos += len;
+        Some(slice)
+    }
+
+    fn varint(&mut self) -> Option<u64> {
+        let mut value = 0u64;
+        for shift in (0..64).step_by(7) {
+            let byte = self.byte()?;
+            value |= u64::from(byte & 0x7F) << shift;
+            if byte & 0x80 == 0 {
+                return Some(value);
+            }
+        }
+        None
+    }
+}
+
+/// Append `value` as an LEB128 varint
+fn put_varint(buf: &mut Vec<u8>, mut value: u64) {
+    while value >= 0x80 {
+        buf.push((value as u8) | 0x80);
+        value >>= 7;
+    }
+    buf.push(value as u8);
+}
+
+fn zigzag(value: i64) -> u64 {
+    ((value << 1) ^ (value >> 63)) as u64
+}
+
+fn unzigzag(value: u64) -> i64 {
+    ((value >> 1) as i64) ^ -((value & 1) as i64)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Instant;
+
+    fn raw(thread_id: usize, lock_id: usize, event: Events) -> RawEvent {
+        RawEvent {
+            instant: Instant::now(),
+            thread_sequence: 0,
+            thread_id,
+            lock_id,
+            event,
+            parent_id: None,
+            woken_thread: Some(9),
+        }
+    }
+
+    #[test]
+    fn test_round_trip() {
+        let mut encoder = BinaryEncoder::default();
+        let mut out = Vec::new();
+        encoder.write_header(&mut out, 1_700_000_000.5).unwrap();
+        encoder
+            .write_event(&mut out, 0, &raw(1, 2, Events::MutexAttempt), 1_000)
+            .unwrap();
+        // Late events may carry an earlier timestamp than their predecessor
+        encoder
+            .write_event(&mut out, 1, &raw(3, 300, Events::CondvarNotifyOne), 500)
+            .unwrap();
+        let event_bytes = out.len() - HEADER_LEN;
+
+        let records = decode(&out).unwrap();
+        assert_eq!(records.len(), 2);
+        let BinaryRecord::Event(second) = &records[1] else {
+            panic!("expected an event");
+        };
+        assert_eq!(second.sequence, 1);
+        assert_eq!((second.thread_id, second.lock_id), (3, 300));
+        assert_eq!(second.event, Events::CondvarNotifyOne);
+        assert_eq!((second.parent_id, second.woken_thread), (0, 9));
+        assert!((second.timestamp - 1_700_000_000.5000005).abs() < 1e-6);
+        assert!(event_bytes < 24, "two events took {event_bytes} bytes");
+    }
+
+    #[test]
+    fn test_truncated_tail_is_ignored() {
+        let mut encoder = BinaryEncoder::default();
+        let mut out = Vec::new();
+        encoder.write_header(&mut out, 0.0).unwrap();
+        encoder
+            .write_event(&mut out, 0, &raw(1, 2, Events::MutexAcquired), 10)
+            .unwrap();
+        encoder
+            .write_event(&mut out, 1, &raw(1, 2, Events::MutexReleased), 20)
+            .unwrap();
+        out.pop();
+
+        assert_eq!(decode(&out).unwrap().len(), 1);
+        assert!(decode(b"{\"sequence\":0}").is_err());
+    }
+
+    #[test]
+    fn test_decoding_resumes_after_a_cut_record() {
+        let mut encoder = BinaryEncoder::default();
+        let mut out = Vec::new();
+        encoder.write_header(&mut out, 0.0).unwrap();
+        for (sequence, nanos) in [(0, 10), (1, 20), (2, 30)] {
+            encoder
+                .write_event(&mut out, sequence, &raw(1, 2, Events::MutexAcquired), nanos)
+                .unwrap();
+        }
+
+        // Stop in the middle of the second record, as when a log is still growing
+        let mut decoder = BinaryDecoder::new(&out).unwrap();
+        let mut records = Vec::new();
+        let cut = HEADER_LEN + 10;
+        let consumed = decoder.decode(&out[HEADER_LEN..cut], &mut records).unwrap();
+        assert_eq!(records.len(), 1);
+
+        let mut decoder =
+            BinaryDecoder::resume(decoder.epoch_wall, decoder.sequence, decoder.nanos);
+        decoder
+            .decode(&out[HEADER_LEN + consumed..], &mut records)
+            .unwrap();
+        let sequences: Vec<u64> = records
+            .iter()
+            .map(|record| match record {
+                BinaryRecord::Event(event) => event.sequence,
+                BinaryRecord::Deadlock(_) => panic!("expected an event"),
+            })
+            .collect();
+        assert_eq!(sequences, [0, 1, 2]);
+    }
+
+    #[test]
+    fn test_varint_edges() {
+        for value in [0, 1, 127, 128, 16_383, 16_384, u64::MAX] {
+            let mut buf = Vec::new();
+            put_varint(&mut buf, value);
+            let mut reader = Reader {
+                bytes: &buf,
+                pos: 0,
+            };
+            assert_eq!(reader.varint(), Some(value));
+        }
+        for value in [0, 1, -1, i64::MIN, i64::MAX] {
+            assert_eq!(unzigzag(zigzag(value)), value);
+        }
+    }
+}
@@ -0,0 +1,179 @@
+//! In-memory flight recorder for the logger
+//!
+//! Streaming every event to disk is too expensive to leave on in production.
+//! In flight-recorder mode the writer thread still drains the per-thread
+//! rings, but instead of writing the merged events it keeps only the most
+//! recent ones in a preallocated window. The window is serialized only when a
+//! deadlock is reported or the logs are flushed explicitly, so the steady
+//! state costs no I/O at all.
+//!
+//! Besides the window, the recorder remembers the spawn event of every thread
+//! and lock that is still alive. A dump always starts with those, so the
+//! visualization knows every object the recent events refer to even if its
+//! creation happened long before the window.
+
+use super::ring::RawEvent;
+use crate::core::types::{DeadlockInfo, Events, LockId, ThreadId};
+use fxhash::FxHashMap;
+use std::collections::VecDeque;
+
+/// How many recent events a flight recorder keeps
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RecorderCapacity {
+    /// The last N events across all threads
+    Total(usize),
+    /// The last N events of each live thread
+    ///
+    /// A thread that logs rarely keeps its history even while other threads
+    /// are busy. The window of a thread is discarded when it exits.
+    PerThread(usize),
+}
+
+/// An event together with its global sequence number
+type Recorded = (u64, RawEvent);
+
+/// Bounded window of recent events
+pub struct FlightRecorder {
+    capacity: RecorderCapacity,
+    /// Window for [`RecorderCapacity::Total`]
+    recent: VecDeque<Recorded>,
+    /// Windows for [`RecorderCapacity::PerThread`]
+    recent_by_thread: FxHashMap<ThreadId, VecDeque<Recorded>>,
+    /// Spawn events of live threads
+    live_threads: FxHashMap<ThreadId, Recorded>,
+    /// Spawn events of live locks and condvars
+    live_locks: FxHashMap<LockId, Recorded>,
+    /// The most recently reported deadlock
+    pub deadlock: Option<DeadlockInfo>,
+}
+
+impl FlightRecorder {
+    /// Create a recorder with its window preallocated
+    pub fn new(capacity: RecorderCapacity) -> Self {
+        let recent = match capacity {
+            RecorderCapacity::Total(n) => VecDeque::with_capacity(n),
+            RecorderCapacity::PerThread(_) => VecDeque::new(),
+        };
+        FlightRecorder {
+            capacity,
+            recent,
+            recent_by_thread: FxHashMap::default(),
+            live_threads: FxHashMap::default(),
+            live_locks: FxHashMap::default(),
+            deadlock: None,
+        }
+    }
+
+    /// Record a merged event, evicting the oldest one of its window if full
+    pub fn record(&mut self, sequence: u64, raw: RawEvent) {
+        match raw.event {
+            Events::ThreadSpawn => {
+                self.live_threads.insert(raw.thread_id, (sequence, raw));
+            }
+            Events::ThreadExit => {
+                self.live_threads.remove(&raw.thread_id);
+                self.recent_by_thread.remove(&raw.thread_id);
+            }
+            Events::MutexSpawn | Events::RwSpawn | Events::CondvarSpawn => {
+                self.live_locks.insert(raw.lock_id, (sequence, raw));
+            }
+            Events::MutexExit | Events::RwExit | Events::CondvarExit => {
+                self.live_locks.remove(&raw.lock_id);
+            }
+            _ => {}
+        }
+
+        match self.capacity {
+            RecorderCapacity::Total(n) => push_bounded(&mut self.recent, n, (sequence, raw)),
+            RecorderCapacity::PerThread(n) => {
+                if raw.event == Events::ThreadExit {
+                    return;
+                }
+                let window = self
+                    .recent_by_thread
+                    .entry(raw.thread_id)
+                    .or_insert_with(|| VecDeque::with_capacity(n));
+                push_bounded(window, n, (sequence, raw));
+            }
+        }
+    }
+
+    /// The recorded events in sequence order, starting with live spawn events
+    pub fn snapshot(&self) -> Vec<Recorded> {
+        let mut events: Vec<Recorded> = self
+            .live_threads
+            .values()
+            .chain(self.live_locks.values())
+            .chain(self.recent.iter())
+            .chain(self.recent_by_thread.values().flatten())
+            .copied()
+            .collect();
+        events.sort_unstable_by_key(|(sequence, _)| *sequence);
+        // Spawn events that are still inside a window appear twice
+        events.dedup_by_key(|(sequence, _)| *sequence);
+        events
+    }
+}
+
+/// Append to a window of at most `capacity` events, dropping the oldest
+fn push_bounded(window: &mut VecDeque<Recorded>, capacity: usize, event: Recorded) {
+    if capacity == 0 {
+        return;
+    }
+    if window.len() == capacity {
+        window.pop_front();
+    }
+    window.push_back(event);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Instant;
+
+    fn raw(thread_id: ThreadId, lock_id: LockId, event: Events) -> RawEvent {
+        RawEvent {
+            instant: Instant::now(),
+            thread_sequence: 0,
+            thread_id,
+            lock_id,
+            event,
+            parent_id: None,
+            woken_thread: None,
+        }
+    }
+
+    fn sequences(recorder: &FlightRecorder) -> Vec<u64> {
+        recorder.snapshot().iter().map(|(s, _)| *s).collect()
+    }
+
+    #[test]
+    fn test_total_window_keeps_live_spawns() {
+        let mut recorder = FlightRecorder::new(RecorderCapacity::Total(3));
+        recorder.record(0, raw(1, 0, Events::ThreadSpawn));
+        recorder.record(1, raw(0, 10, Events::MutexSpawn));
+        recorder.record(2, raw(0, 11, Events::MutexSpawn));
+        recorder.record(3, raw(0, 11, Events::MutexExit));
+        for sequence in 4..10 {
+            recorder.record(sequence, raw(1, 10, Events::MutexAttempt));
+        }
+
+        // Lock 11 is gone, the others keep their spawn events
+        assert_eq!(sequences(&recorder), vec![0, 1, 7, 8, 9]);
+    }
+
+    #[test]
+    fn test_per_thread_windows() {
+        let mut recorder = FlightRecorder::new(RecorderCapacity::PerThread(2));
+        recorder.record(0, raw(1, 10, Events::MutexAttempt));
+        for sequence in 1..5 {
+            recorder.record(sequence, raw(2, 10, Events::MutexAttempt));
+        }
+        recorder.record(5, raw(3, 10, Events::MutexAttempt));
+        assert_eq!(sequences(&recorder), vec![0, 3, 4, 5]);
+
+        // An exited thread takes its window with it
+        recorder.record(6, raw(2, 0, Events::ThreadExit));
+        assert_eq!(sequences(&recorder), vec![0, 5]);
+    }
+}
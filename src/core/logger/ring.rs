@@ -0,0 +1,193 @@
+//! Per-thread event buffers for the logger
+//!
+//! Every thread that logs owns an [`EventRing`], a bounded single-producer,
+//! single-consumer ring. The owning thread is the only producer and the
+//! logger's writer thread is the only consumer, so pushing an event is a
+//! couple of uncontended atomic operations on a cache line private to the
+//! thread. The writer drains all rings in batches and merges them.
+
+use crate::core::types::{Events, LockId, ThreadId};
+use std::cell::UnsafeCell;
+use std::mem::MaybeUninit;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::time::Instant;
+
+/// Number of events a ring holds before the producer has to wait for the writer
+pub const RING_CAPACITY: usize = 1024;
+
+/// An event as recorded by the producing thread
+///
+/// The global sequence number and the wall clock timestamp are derived by
+/// the writer thread when the event is merged.
+#[derive(Debug, Clone, Copy)]
+pub struct RawEvent {
+    /// Monotonic time at which the event was recorded
+    pub instant: Instant,
+    /// Position of the event among the events of its producing thread
+    pub thread_sequence: u64,
+    pub thread_id: ThreadId,
+    pub lock_id: LockId,
+    pub event: Events,
+    pub parent_id: Option<ThreadId>,
+    pub woken_thread: Option<ThreadId>,
+}
+
+impl RawEvent {
+    /// Key that orders events by time, and events of one thread by sequence
+    pub fn merge_key(&self) -> (Instant, ThreadId, u64) {
+        (self.instant, self.thread_id, self.thread_sequence)
+    }
+}
+
+/// Bounded SPSC ring of [`RawEvent`]s
+pub struct EventRing {
+    slots: Box<[UnsafeCell<MaybeUninit<RawEvent>>]>,
+    /// Total number of events consumed (only written by the consumer)
+    head: AtomicUsize,
+    /// Total number of events produced (only written by the producer)
+    tail: AtomicUsize,
+    /// Set once the consumer has gone away and will never drain again
+    closed: AtomicBool,
+}
+
+// Safety: slot `i` is written by the producer only while `i` is outside
+// `head..tail`, and read by the consumer only while it is inside, with the
+// Release/Acquire pairs on `head` and `tail` ordering those accesses.
+unsafe impl Sync for EventRing {}
+unsafe impl Send for EventRing {}
+
+impl Default for EventRing {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl EventRing {
+    /// Create an empty ring with [`RING_CAPACITY`] slots
+    pub fn new() -> Self {
+        EventRing {
+            slots: (0..RING_CAPACITY)
+                .map(|_| UnsafeCell::new(MaybeUninit::uninit()))
+                .collect(),
+            head: AtomicUsize::new(0),
+            tail: AtomicUsize::new(0),
+            closed: AtomicBool::new(false),
+        }
+    }
+
+    /// Append an event (producer side)
+    ///
+    /// # Returns
+    /// The event back if the ring is full
+    pub fn push(&self, event: RawEvent) -> Result<(), RawEvent> {
+        let tail = self.tail.load(Ordering::Relaxed);
+        let head = self.head.load(Ordering::Acquire);
+        if tail - head == RING_CAPACITY {
+            return Err(event);
+        }
+        // Safety: the slot is outside head..tail, so the consumer is not reading it
+        unsafe { (*self.slots[tail % RING_CAPACITY].get()).write(event) };
+        self.tail.store(tail + 1, Ordering::Release);
+        Ok(())
+    }
+
+    /// Move all published events into `out` (consumer side)
+    ///
+    /// # Returns
+    /// The number of events drained
+    pub fn drain_into(&self, out: &mut Vec<RawEvent>) -> usize {
+        let head = self.head.load(Ordering::Relaxed);
+        let tail = self.tail.load(Ordering::Acquire);
+        for index in head..tail {
+            // Safety: the slot is inside head..tail, so it was published and
+            // the producer will not overwrite it until `head` moves past it
+            out.push(unsafe { (*self.slots[index % RING_CAPACITY].get()).assume_init() });
+        }
+        self.head.store(tail, Ordering::Release);
+        tail - head
+    }
+
+    /// Whether the ring currently holds no events
+    pub fn is_empty(&self) -> bool {
+        self.head.load(Ordering::Acquire) == self.tail.load(Ordering::Acquire)
+    }
+
+    /// Mark the ring as abandoned by its consumer
+    pub fn close(&self) {
+        self.closed.store(true, Ordering::Release);
+    }
+
+    /// Whether the consumer has abandoned this ring
+    pub fn is_closed(&self) -> bool {
+        self.closed.load(Ordering::Acquire)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn event(thread_sequence: u64) -> RawEvent {
+        RawEvent {
+            instant: Instant::now(),
+            thread_sequence,
+            thread_id: 1,
+            lock_id: 2,
+            event: Events::MutexAcquired,
+            parent_id: None,
+            woken_thread: None,
+        }
+    }
+
+    #[test]
+    fn test_ring_fills_and_drains_in_order() {
+        let ring = EventRing::new();
+        for i in 0..RING_CAPACITY as u64 {
+            ring.push(event(i)).unwrap();
+        }
+        assert!(ring.push(event(0)).is_err());
+
+        let mut out = Vec::new();
+        assert_eq!(ring.drain_into(&mut out), RING_CAPACITY);
+        assert!(ring.is_empty());
+        assert!(
+            out.iter()
+                .enumerate()
+                .all(|(i, e)| e.thread_sequence == i as u64)
+        );
+
+        // Wrap around the end of the slot array
+        ring.push(event(7)).unwrap();
+        out.clear();
+        assert_eq!(ring.drain_into(&mut out), 1);
+        assert_eq!(out[0].thread_sequence, 7);
+    }
+
+    #[test]
+    fn test_concurrent_producer_and_consumer() {
+        let ring = std::sync::Arc::new(EventRing::new());
+        let producer = {
+            let ring = std::sync::Arc::clone(&ring);
+            std::thread::spawn(move || {
+                for i in 0..10_000 {
+                    let mut e = event(i);
+                    while let Err(back) = ring.push(e) {
+                        e = back;
+                        std::thread::yield_now();
+                    }
+                }
+            })
+        };
+
+        let mut out = Vec::new();
+        while out.len() < 10_000 {
+            ring.drain_into(&mut out);
+        }
+        producer.join().unwrap();
+        assert!(
+            out.iter()
+                .enumerate()
+                .all(|(i, e)| e.thread_sequence == i as u64)
+        );
+    }
+}
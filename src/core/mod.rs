@@ -22,15 +22,30 @@ pub(crate) use detector::*;
 
 pub mod thread;
 
+#[cfg(feature = "async")]
+pub mod r#async;
+
+#[cfg(feature = "logging-and-visualization")]
+pub mod analysis;
+
 pub(crate) mod locks;
+pub mod sampling;
+#[cfg(unix)]
+pub mod shared;
+#[cfg(feature = "lock-stats")]
+pub mod stats;
 pub mod stress;
 
+pub use sampling::Sampling;
 #[allow(unused_imports)]
-pub use stress::{StressConfig, StressMode};
+pub use stress::{StressConfig, StressMode, StressSchedule, stress_schedule, stress_seed};
 
 use anyhow::Result;
 #[cfg(feature = "logging-and-visualization")]
 use logger::EventLogger;
+#[cfg(feature = "logging-and-visualization")]
+pub use logger::{LogFormat, RecorderCapacity};
+use std::time::Duration;
 
 /// Deloxide configuration builder struct
 ///
@@ -65,6 +80,14 @@ pub struct Deloxide {
     #[cfg(feature = "logging-and-visualization")]
     log_path: Option<String>,
 
+    /// On-disk format of the log file
+    #[cfg(feature = "logging-and-visualization")]
+    log_format: LogFormat,
+
+    /// Window of the flight recorder, or None to stream every event to the log
+    #[cfg(feature = "logging-and-visualization")]
+    flight_recorder: Option<RecorderCapacity>,
+
     /// Callback function to invoke when a deadlock is detected
     callback: Box<dyn Fn(DeadlockInfo) + Send + Sync + 'static>,
 
@@ -72,6 +95,34 @@ pub struct Deloxide {
     #[cfg(feature = "lock-order-graph")]
     check_lock_order: bool,
 
+    /// Key lock order checking by lock class instead of lock instance
+    #[cfg(feature = "lock-order-graph")]
+    lock_order_by_class: bool,
+
+    /// Which acquisitions are tracked, or None to track all of them
+    sampling: Option<Sampling>,
+
+    /// How long a thread blocks before checking for a deadlock, or None to
+    /// check every contended acquisition immediately
+    deferred_detection: Option<Duration>,
+
+    /// Whether detection is switched on once the detector starts
+    detection: bool,
+
+    /// Signal that toggles detection on and off, if any
+    #[cfg(unix)]
+    toggle_signal: Option<i32>,
+
+    /// Count acquisitions, contention and wait times per lock (only
+    /// available with "lock-stats" feature)
+    #[cfg(feature = "lock-stats")]
+    lock_stats: bool,
+
+    /// File of the shared region to attach to for detection across
+    /// processes, or None to detect within this process only
+    #[cfg(unix)]
+    shared_memory: Option<std::path::PathBuf>,
+
     /// Stress testing mode (only available with "stress-test" feature)
     #[cfg(feature = "stress-test")]
     stress_mode: StressMode,
@@ -79,6 +130,11 @@ pub struct Deloxide {
     /// Stress testing configuration (only available with "stress-test" feature)
     #[cfg(feature = "stress-test")]
     stress_config: Option<StressConfig>,
+
+    /// Schedule of an earlier stress run to repeat (only available with
+    /// "stress-test" feature)
+    #[cfg(feature = "stress-test")]
+    stress_replay: Option<StressSchedule>,
 }
 
 impl Default for Deloxide {
@@ -98,6 +154,10 @@ impl Deloxide {
         Deloxide {
             #[cfg(feature = "logging-and-visualization")]
             log_path: Some("deloxide.log".to_string()),
+            #[cfg(feature = "logging-and-visualization")]
+            log_format: LogFormat::Json,
+            #[cfg(feature = "logging-and-visualization")]
+            flight_recorder: None,
             callback: Box::new(|info: DeadlockInfo| {
                 panic!(
                     "Deadlock detected: {}",
@@ -106,10 +166,23 @@ impl Deloxide {
             }),
             #[cfg(feature = "lock-order-graph")]
             check_lock_order: true,
+            #[cfg(feature = "lock-order-graph")]
+            lock_order_by_class: false,
+            sampling: None,
+            deferred_detection: None,
+            detection: true,
+            #[cfg(unix)]
+            toggle_signal: None,
+            #[cfg(feature = "lock-stats")]
+            lock_stats: false,
+            #[cfg(unix)]
+            shared_memory: None,
             #[cfg(feature = "stress-test")]
             stress_mode: StressMode::None,
             #[cfg(feature = "stress-test")]
             stress_config: None,
+            #[cfg(feature = "stress-test")]
+            stress_replay: None,
         }
     }
 
@@ -161,6 +234,62 @@ impl Deloxide {
         self
     }
 
+    /// Set the on-disk format of the log file
+    ///
+    /// The compact binary format is several times smaller than JSON lines and
+    /// much cheaper to write, which matters for long runs. `showcase` and the
+    /// `deloxide` CLI read both formats.
+    ///
+    /// # Arguments
+    /// * `format` - Format of the log file (JSON lines by default)
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Example
+    ///
+    /// ```rust
+    /// use deloxide::{Deloxide, LogFormat};
+    ///
+    /// let config = Deloxide::new()
+    ///     .with_log("logs/deadlock_{timestamp}.dlxb")
+    ///     .with_log_format(LogFormat::Binary);
+    /// ```
+    #[cfg(feature = "logging-and-visualization")]
+    pub fn with_log_format(mut self, format: LogFormat) -> Self {
+        self.log_format = format;
+        self
+    }
+
+    /// Keep only recent events in memory and write the log on demand
+    ///
+    /// In flight-recorder mode nothing is written while the program runs
+    /// normally. The log file is written only when a deadlock is detected or
+    /// the logs are flushed explicitly, and then contains the most recent
+    /// events plus the creation of every live thread and lock, which is
+    /// enough context for the showcase at close to zero steady-state cost.
+    ///
+    /// # Arguments
+    /// * `capacity` - How many recent events to keep, in total or per thread
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Example
+    ///
+    /// ```rust
+    /// use deloxide::{Deloxide, RecorderCapacity};
+    ///
+    /// let config = Deloxide::new()
+    ///     .with_log("deadlock.log")
+    ///     .with_flight_recorder(RecorderCapacity::Total(10_000));
+    /// ```
+    #[cfg(feature = "logging-and-visualization")]
+    pub fn with_flight_recorder(mut self, capacity: RecorderCapacity) -> Self {
+        self.flight_recorder = Some(capacity);
+        self
+    }
+
     /// Disable logging
     ///
     /// This function explicitly disables logging, even if the feature is enabled.
@@ -292,6 +421,238 @@ impl Deloxide {
         self
     }
 
+    /// Enable lock order checking keyed by lock class
+    ///
+    /// Instead of tracking the order of individual lock objects, every lock is
+    /// assigned to the class of the call site that created it (the location of
+    /// `Mutex::new` or `RwLock::new`). An ordering observed between two classes
+    /// then applies to all of their locks, so an inversion is reported even when
+    /// it involves lock objects that were never nested before, and the graph
+    /// stays as small as the code that creates locks.
+    ///
+    /// Nesting two locks of the same class is not checked. Reported cycles hold
+    /// class IDs, with their locations in `DeadlockInfo::lock_order_classes`.
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Note
+    /// This method is only available when the "lock-order-graph" feature is enabled.
+    ///
+    /// # Example
+    ///
+    /// ```rust
+    /// #[cfg(feature = "lock-order-graph")]
+    /// {
+    /// use deloxide::Deloxide;
+    ///
+    /// Deloxide::new()
+    ///     .with_lock_class_ordering()
+    ///     .callback(|info| {
+    ///         if let Some(classes) = info.lock_order_classes {
+    ///             println!("Lock classes taken in inconsistent order: {:?}", classes);
+    ///         }
+    ///     })
+    ///     .start()
+    ///     .expect("Failed to start detector");
+    /// }
+    /// ```
+    #[cfg(feature = "lock-order-graph")]
+    pub fn with_lock_class_ordering(mut self) -> Self {
+        self.check_lock_order = true;
+        self.lock_order_by_class = true;
+        self
+    }
+
+    /// Track only a sample of lock acquisitions
+    ///
+    /// Unsampled acquisitions skip the detector, the lock order graph and the
+    /// logger entirely, which caps the overhead of keeping detection enabled
+    /// in production. A deadlock is reported only when all acquisitions that
+    /// form it were sampled. Each release is handled the same way as its
+    /// acquisition, so sampling decisions that change while locks are held
+    /// never leave stale state in the detector.
+    ///
+    /// # Arguments
+    /// * `sampling` - Which acquisitions to track. Rates outside (0.0, 1.0]
+    ///   and windows with a zero `on` length are ignored.
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// use deloxide::{Deloxide, Sampling};
+    /// use std::time::Duration;
+    ///
+    /// // Track one second out of every ten
+    /// Deloxide::new()
+    ///     .with_sampling(Sampling::Windows {
+    ///         on: Duration::from_secs(1),
+    ///         off: Duration::from_secs(9),
+    ///     })
+    ///     .start()
+    ///     .expect("Failed to start detector");
+    /// ```
+    pub fn with_sampling(mut self, sampling: Sampling) -> Self {
+        self.sampling = Some(sampling);
+        self
+    }
+
+    /// Defer cycle detection until a thread has been blocked for `threshold`
+    ///
+    /// By default every contended acquisition searches the wait-for graph for
+    /// a cycle before it blocks. With deferred detection the wait is only
+    /// recorded, and a thread that is still blocked once `threshold` has
+    /// passed performs the search. Contended acquisitions get cheaper while a
+    /// deadlock is reported up to `threshold` later.
+    ///
+    /// # Arguments
+    /// * `threshold` - How long a thread blocks before it checks for a deadlock
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// use deloxide::Deloxide;
+    /// use std::time::Duration;
+    ///
+    /// Deloxide::new()
+    ///     .with_deferred_detection(Duration::from_millis(50))
+    ///     .start()
+    ///     .expect("Failed to start detector");
+    /// ```
+    pub fn with_deferred_detection(mut self, threshold: Duration) -> Self {
+        self.deferred_detection = Some(threshold);
+        self
+    }
+
+    /// Start with deadlock detection switched off
+    ///
+    /// While detection is off the tracked locks cost about as much as the
+    /// `parking_lot` locks they wrap. Switch it on at runtime with
+    /// `deloxide::enable_detection`, or with the signal set by
+    /// `with_toggle_signal`; locks that are already held are handed over
+    /// correctly. The `DELOXIDE_DETECTION` environment variable (`on` or
+    /// `off`) overrides this setting when the detector starts.
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// use deloxide::Deloxide;
+    ///
+    /// Deloxide::new()
+    ///     .with_detection_off()
+    ///     .start()
+    ///     .expect("Failed to start detector");
+    ///
+    /// // Later, e.g. while investigating a hang
+    /// deloxide::enable_detection();
+    /// ```
+    pub fn with_detection_off(mut self) -> Self {
+        self.detection = false;
+        self
+    }
+
+    /// Toggle deadlock detection on and off whenever the process receives
+    /// `signum`
+    ///
+    /// Replaces any handler the process has for the signal. The handler only
+    /// flips the detection switch, so it is safe to deliver at any time, e.g.
+    /// with `kill -USR2 <pid>`.
+    ///
+    /// # Arguments
+    /// * `signum` - Number of the signal, such as `SIGUSR2`
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Note
+    /// This method is only available on Unix.
+    #[cfg(unix)]
+    pub fn with_toggle_signal(mut self, signum: i32) -> Self {
+        self.toggle_signal = Some(signum);
+        self
+    }
+
+    /// Collect per-lock contention statistics
+    ///
+    /// Every tracked acquisition is counted, and contended acquisitions also
+    /// record how long they waited, into a log-bucketed histogram. Hold times
+    /// are measured from acquisition to release. The counters are recorded
+    /// per thread and merged only when a snapshot is taken, with
+    /// `deloxide::lock_stats`, `deloxide::lock_class_stats` or
+    /// `deloxide::contention_report`. Acquisitions skipped by sampling are not
+    /// counted.
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Note
+    /// This method is only available when the "lock-stats" feature is enabled.
+    ///
+    /// # Example
+    ///
+    /// ```rust
+    /// #[cfg(feature = "lock-stats")]
+    /// {
+    /// use deloxide::Deloxide;
+    ///
+    /// Deloxide::new()
+    ///     .with_lock_stats()
+    ///     .start()
+    ///     .expect("Failed to start detector");
+    ///
+    /// // ... run the workload ...
+    ///
+    /// println!("{}", deloxide::contention_report(10));
+    /// }
+    /// ```
+    #[cfg(feature = "lock-stats")]
+    pub fn with_lock_stats(mut self) -> Self {
+        self.lock_stats = true;
+        self
+    }
+
+    /// Detect deadlocks across processes through a shared memory region
+    ///
+    /// Every process that starts with the same region publishes the owners
+    /// and waiters of the locks it marks as shared (see [`crate::shared`]),
+    /// and one of them searches all of them for cycles. The threads of such
+    /// a deadlock are reported with their global IDs, which combine the
+    /// process ID and the thread ID.
+    ///
+    /// # Arguments
+    /// * `path` - File backing the region, created if it does not exist
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Note
+    /// This method is only available on Unix.
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// use deloxide::Deloxide;
+    ///
+    /// Deloxide::new()
+    ///     .with_shared_memory("/dev/shm/myapp.deloxide")
+    ///     .start()
+    ///     .expect("Failed to start detector");
+    /// ```
+    #[cfg(unix)]
+    pub fn with_shared_memory<P: AsRef<std::path::Path>>(mut self, path: P) -> Self {
+        self.shared_memory = Some(path.as_ref().to_path_buf());
+        self
+    }
+
     /// Initialize the deloxide deadlock detector with the configured settings
     ///
     /// This finalizes the configuration and starts the deadlock detector.
@@ -302,7 +663,11 @@ impl Deloxide {
     /// A Result that is Ok if initialization succeeded, or an error if it failed
     ///
     /// # Errors
-    /// Returns an error if logger initialization fails
+    /// Returns an error if logger initialization fails, if the shared
+    /// memory region cannot be attached, or if the toggle signal handler
+    /// cannot be installed. The detector is only started once no error can
+    /// occur, except for spawning the shared memory monitor thread: if that
+    /// fails, the detector stays started without cross-process detection.
     ///
     /// # Example
     ///
@@ -332,21 +697,48 @@ impl Deloxide {
     pub fn start(self) -> Result<()> {
         // Initialize the logger if enabled
         #[cfg(feature = "logging-and-visualization")]
-        let logger = if let Some(log_path) = self.log_path {
-            Some(EventLogger::with_file(log_path)?)
-        } else {
-            None
+        let logger = match (self.log_path, self.flight_recorder) {
+            (Some(log_path), Some(capacity)) => Some(EventLogger::with_flight_recorder(
+                log_path,
+                self.log_format,
+                capacity,
+            )?),
+            (Some(log_path), None) => Some(EventLogger::with_file_and_format(
+                log_path,
+                self.log_format,
+            )?),
+            (None, _) => None,
         };
 
+        // Install the signal handler and map the shared region before
+        // anything is started, so a failure leaves the detector untouched.
+        // A signal that arrives before the detector starts is overridden by
+        // the configured detection switch.
+        #[cfg(unix)]
+        if let Some(signum) = self.toggle_signal {
+            sampling::install_toggle_signal(signum)?;
+        }
+        #[cfg(unix)]
+        let monitor = self.shared_memory.map(shared::open).transpose()?;
+
         // Create configuration object
         let config = detector::DetectorConfig {
             callback: self.callback,
             #[cfg(feature = "lock-order-graph")]
             check_lock_order: self.check_lock_order,
+            #[cfg(feature = "lock-order-graph")]
+            lock_order_by_class: self.lock_order_by_class,
+            sampling: self.sampling,
+            deferred_detection: self.deferred_detection,
+            detection: self.detection,
+            #[cfg(feature = "lock-stats")]
+            lock_stats: self.lock_stats,
             #[cfg(feature = "stress-test")]
             stress_mode: self.stress_mode,
             #[cfg(feature = "stress-test")]
             stress_config: self.stress_config,
+            #[cfg(feature = "stress-test")]
+            stress_replay: self.stress_replay,
             #[cfg(feature = "logging-and-visualization")]
             logger,
         };
@@ -354,8 +746,17 @@ impl Deloxide {
         // Initialize the detector
         detector::init_detector(config);
 
+        #[cfg(unix)]
+        if let Some(monitor) = monitor {
+            monitor.spawn()?;
+        }
+
         // Print header
         println!("{}", crate::BANNER);
+        #[cfg(feature = "stress-test")]
+        if stress::stress_mode() != StressMode::None {
+            println!("Stress testing seed: {}", stress_seed());
+        }
 
         Ok(())
     }
@@ -398,6 +799,74 @@ impl Deloxide {
         self
     }
 
+    /// Enable PCT (probabilistic concurrency testing) stress testing
+    ///
+    /// Threads get random priorities that are enforced as delays before
+    /// nested lock acquisitions, and at `pct_depth - 1` random points of the
+    /// run the current thread drops to the lowest priority. See
+    /// [`StressMode::Pct`].
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Note
+    /// This method is only available when the "stress-test" feature is enabled.
+    #[cfg(feature = "stress-test")]
+    pub fn with_pct_stress(mut self) -> Self {
+        self.stress_mode = StressMode::Pct;
+        if self.stress_config.is_none() {
+            self.stress_config = Some(StressConfig::default());
+        }
+        self
+    }
+
+    /// Seed the random decisions of stress testing
+    ///
+    /// Runs with the same seed make the same decisions as long as every
+    /// thread reaches the same lock acquisitions. Without a seed, a random
+    /// one is picked and printed at startup.
+    ///
+    /// # Arguments
+    /// * `seed` - Seed of the run
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Note
+    /// This method is only available when the "stress-test" feature is enabled.
+    #[cfg(feature = "stress-test")]
+    pub fn with_stress_seed(mut self, seed: u64) -> Self {
+        self.stress_config
+            .get_or_insert_with(StressConfig::default)
+            .seed = Some(seed);
+        self
+    }
+
+    /// Repeat the delays of an earlier stress run
+    ///
+    /// Instead of deciding, each thread waits exactly where and as long as
+    /// it did in the recorded run. Get the schedule from
+    /// [`stress_schedule`](crate::stress_schedule), typically inside the
+    /// deadlock callback of the failing run.
+    ///
+    /// # Arguments
+    /// * `schedule` - The recorded schedule, which also sets the stress mode
+    ///
+    /// # Returns
+    /// The builder for method chaining
+    ///
+    /// # Note
+    /// This method is only available when the "stress-test" feature is enabled.
+    #[cfg(feature = "stress-test")]
+    pub fn with_stress_replay(mut self, schedule: StressSchedule) -> Self {
+        self.stress_mode = schedule.mode;
+        if self.stress_config.is_none() {
+            self.stress_config = Some(StressConfig::default());
+        }
+        self.stress_replay = Some(schedule);
+        self
+    }
+
     /// Configure stress testing parameters
     ///
     /// # Arguments
@@ -0,0 +1,246 @@
+//! Runtime sampling of tracked lock acquisitions
+//!
+//! Sampling bounds the cost of always-on detection. Each acquisition asks
+//! `is_sampled` once; an unsampled acquisition only touches the underlying
+//! lock and is invisible to the detector and the logger. The decision is
+//! stored in the guard, so the matching release is reported the same way
+//! the acquisition was, no matter how the sampling state changed in between.
+//! This keeps the held-lock sets and the wait-for graph free of ghost entries.
+//!
+//! The same check switches detection off altogether: until the detector is
+//! started, and whenever `disable_detection` is called, nothing is sampled
+//! and the locks cost what the `parking_lot` locks they wrap cost, plus one
+//! relaxed load and the owner store that lets a tracked waiter see who holds
+//! a lock. Because guards remember their decision, detection can be switched
+//! back on while locks are held: their owners are still visible to tracked
+//! waiters, and their releases stay unreported like their acquisitions.
+
+use crate::core::types::{LockId, ThreadId};
+use std::sync::atomic::{AtomicBool, AtomicU8, AtomicU64, Ordering};
+use std::time::Duration;
+
+/// Which lock acquisitions the detector tracks
+///
+/// A deadlock is only reported when every acquisition that forms it was
+/// sampled, so sampling trades detection coverage for lower overhead.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Sampling {
+    /// Track every acquisition made by a fixed fraction (0.0-1.0] of threads
+    Threads(f64),
+    /// Track every acquisition of a fixed fraction (0.0-1.0] of locks
+    Locks(f64),
+    /// Alternate between tracking everything for `on` and nothing for `off`
+    Windows {
+        /// Length of each tracked window
+        on: Duration,
+        /// Length of each untracked gap between windows
+        off: Duration,
+    },
+}
+
+impl Sampling {
+    /// Whether the sampling parameters describe a usable configuration
+    pub fn is_valid(&self) -> bool {
+        match *self {
+            Sampling::Threads(rate) | Sampling::Locks(rate) => rate > 0.0 && rate <= 1.0,
+            Sampling::Windows { on, .. } => !on.is_zero(),
+        }
+    }
+}
+
+/// Every acquisition is sampled
+const MODE_ALL: u8 = 0;
+/// Threads whose hash falls below `THRESHOLD` are sampled
+const MODE_THREADS: u8 = 1;
+/// Locks whose hash falls below `THRESHOLD` are sampled
+const MODE_LOCKS: u8 = 2;
+/// Acquisitions are sampled while `WINDOW_OPEN` is set
+const MODE_WINDOWS: u8 = 3;
+/// Detection is switched off, nothing is sampled
+const MODE_OFF: u8 = 4;
+
+/// Active sampling mode, off until the detector is started
+static MODE: AtomicU8 = AtomicU8::new(MODE_OFF);
+/// Sampling mode that detection runs in while it is switched on
+static CONFIGURED_MODE: AtomicU8 = AtomicU8::new(MODE_ALL);
+/// Hash threshold for the thread and lock modes
+static THRESHOLD: AtomicU64 = AtomicU64::new(u64::MAX);
+/// Whether a tracked window is currently open
+static WINDOW_OPEN: AtomicBool = AtomicBool::new(true);
+
+/// Spread sequential IDs over the whole `u64` range
+#[inline]
+fn spread(id: usize) -> u64 {
+    (id as u64).wrapping_mul(0x9E37_79B9_7F4A_7C15)
+}
+
+/// Map a rate in (0.0, 1.0] to a hash threshold
+fn threshold(rate: f64) -> u64 {
+    if rate >= 1.0 {
+        u64::MAX
+    } else {
+        (rate * u64::MAX as f64) as u64
+    }
+}
+
+/// Install a sampling configuration
+///
+/// Invalid configurations are ignored. A windowed configuration starts a
+/// background thread that opens and closes the windows.
+pub fn configure(sampling: Sampling) {
+    if !sampling.is_valid() {
+        return;
+    }
+
+    match sampling {
+        Sampling::Threads(rate) => {
+            THRESHOLD.store(threshold(rate), Ordering::Relaxed);
+            set_configured_mode(MODE_THREADS);
+        }
+        Sampling::Locks(rate) => {
+            THRESHOLD.store(threshold(rate), Ordering::Relaxed);
+            set_configured_mode(MODE_LOCKS);
+        }
+        Sampling::Windows { on, off } => {
+            WINDOW_OPEN.store(true, Ordering::Relaxed);
+            set_configured_mode(MODE_WINDOWS);
+            if !off.is_zero() {
+                let _ = std::thread::Builder::new()
+                    .name("deloxide-sampling".into())
+                    .spawn(move || {
+                        loop {
+                            std::thread::sleep(on);
+                            WINDOW_OPEN.store(false, Ordering::Relaxed);
+                            std::thread::sleep(off);
+                            WINDOW_OPEN.store(true, Ordering::Relaxed);
+                        }
+                    });
+            }
+        }
+    }
+}
+
+/// Switch to a new sampling mode, taking effect once detection is on
+fn set_configured_mode(mode: u8) {
+    CONFIGURED_MODE.store(mode, Ordering::Relaxed);
+    if MODE.load(Ordering::Relaxed) != MODE_OFF {
+        MODE.store(mode, Ordering::Release);
+    }
+}
+
+/// Switch deadlock detection on, in the configured sampling mode
+///
+/// Locks acquired while detection was off stay untracked until they are
+/// released, but their owners are visible to tracked waiters, so a deadlock
+/// through them is still found.
+pub fn enable_detection() {
+    MODE.store(CONFIGURED_MODE.load(Ordering::Relaxed), Ordering::Release);
+}
+
+/// Switch deadlock detection off
+///
+/// New acquisitions bypass the detector and the logger. Locks acquired while
+/// detection was on are still reported when released.
+pub fn disable_detection() {
+    MODE.store(MODE_OFF, Ordering::Release);
+}
+
+/// Whether deadlock detection is switched on
+pub fn is_detection_enabled() -> bool {
+    MODE.load(Ordering::Relaxed) != MODE_OFF
+}
+
+/// Environment variable that switches detection on or off when the detector
+/// starts (`on`/`off`, `1`/`0` or `true`/`false`)
+pub(crate) const DETECTION_ENV: &str = "DELOXIDE_DETECTION";
+
+/// Read the detection switch from `DELOXIDE_DETECTION`
+///
+/// # Returns
+/// The requested state, or None if the variable is unset or not understood
+pub(crate) fn detection_from_env() -> Option<bool> {
+    let value = std::env::var(DETECTION_ENV).ok()?;
+    match value.trim().to_ascii_lowercase().as_str() {
+        "1" | "on" | "true" => Some(true),
+        "0" | "off" | "false" => Some(false),
+        _ => None,
+    }
+}
+
+/// Toggle detection whenever the process receives `signum`
+///
+/// The handler only flips the detection switch, which is async-signal-safe.
+///
+/// # Errors
+/// Returns an error if the handler cannot be installed
+#[cfg(unix)]
+pub(crate) fn install_toggle_signal(signum: i32) -> anyhow::Result<()> {
+    use std::os::raw::c_int;
+
+    unsafe extern "C" {
+        fn signal(signum: c_int, handler: usize) -> usize;
+    }
+    /// Value returned by `signal` on failure
+    const SIG_ERR: usize = usize::MAX;
+
+    extern "C" fn toggle(_: c_int) {
+        if is_detection_enabled() {
+            disable_detection();
+        } else {
+            enable_detection();
+        }
+    }
+
+    let handler = toggle as extern "C" fn(c_int) as usize;
+    if unsafe { signal(signum, handler) } == SIG_ERR {
+        anyhow::bail!("cannot install a handler for signal {signum}");
+    }
+    Ok(())
+}
+
+/// Whether an acquisition of `lock_id` by `thread_id` should be tracked
+#[inline]
+pub fn is_sampled(thread_id: ThreadId, lock_id: LockId) -> bool {
+    match MODE.load(Ordering::Relaxed) {
+        MODE_ALL => true,
+        MODE_THREADS => spread(thread_id) <= THRESHOLD.load(Ordering::Relaxed),
+        MODE_LOCKS => spread(lock_id) <= THRESHOLD.load(Ordering::Relaxed),
+        MODE_WINDOWS => WINDOW_OPEN.load(Ordering::Relaxed),
+        _ => false,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_rate_validation() {
+        assert!(Sampling::Threads(1.0).is_valid());
+        assert!(Sampling::Locks(0.01).is_valid());
+        assert!(!Sampling::Threads(0.0).is_valid());
+        assert!(!Sampling::Locks(1.5).is_valid());
+        assert!(!Sampling::Threads(f64::NAN).is_valid());
+        assert!(
+            !Sampling::Windows {
+                on: Duration::ZERO,
+                off: Duration::from_millis(1),
+            }
+            .is_valid()
+        );
+    }
+
+    #[test]
+    fn test_threshold_selects_roughly_the_requested_fraction() {
+        for rate in [0.1, 0.25, 0.5, 0.9] {
+            let limit = threshold(rate);
+            let sampled = (1..=10_000).filter(|&id| spread(id) <= limit).count();
+            let expected = (rate * 10_000.0) as usize;
+            assert!(
+                sampled.abs_diff(expected) < 200,
+                "rate {rate}: sampled {sampled} of 10000"
+            );
+        }
+        assert!((1..=1000).all(|id| spread(id) <= threshold(1.0)));
+    }
+}
@@ -0,0 +1,596 @@
+//! Deadlock detection across processes over shared memory
+//!
+//! Locks shared between processes, such as `PTHREAD_PROCESS_SHARED` mutexes
+//! in a shared memory segment, are invisible to the detector of each single
+//! process. When a process attaches to a shared region, the owner of each
+//! shared lock and the lock each thread waits for are published there, keyed
+//! by a lock key every process agrees on (e.g. the offset of the mutex in its
+//! segment) and a global thread ID made of the process ID and the local
+//! thread ID.
+//!
+//! Publishing is a handful of lock-free atomic stores into the region, so an
+//! acquisition never waits for another process. One of the attached
+//! processes acts as the coordinator: its monitor thread periodically builds
+//! a `WaitForGraph` from the region and searches it for cycles. A cycle seen
+//! in two consecutive scans is published as a deadlock record, and every
+//! process with a thread in the cycle reports it through its own callback.
+//! If the coordinator stops updating its heartbeat, another process takes
+//! over, and the slots of processes that stopped are reclaimed.
+//!
+//! The region is a file of fixed size, typically under `/dev/shm`. A zeroed
+//! file is a valid empty region, so the first process to attach needs no
+//! set-up step.
+
+use crate::core::detector::deadlock_handling;
+use crate::core::graph::WaitForGraph;
+use crate::core::types::{DeadlockInfo, DeadlockSource, LockId, ThreadId, get_current_thread_id};
+use anyhow::{Result, bail};
+use chrono::Utc;
+use std::cell::Cell;
+use std::fs::OpenOptions;
+use std::os::raw::{c_int, c_long, c_void};
+use std::os::unix::io::AsRawFd;
+use std::path::Path;
+use std::sync::OnceLock;
+use std::sync::atomic::{AtomicU64, Ordering, fence};
+use std::thread;
+use std::time::{Duration, SystemTime, UNIX_EPOCH};
+
+/// Marks an initialized region of this layout
+const MAGIC: u64 = 0x444c_5853_484d_0001; // "DLXSHM" + layout version 1
+
+/// Number of processes that can attach at the same time
+const MAX_PROCESSES: usize = 256;
+/// Number of threads that can use shared locks at the same time
+const MAX_THREADS: usize = 4096;
+/// Number of distinct shared locks
+const MAX_LOCKS: usize = 8192;
+/// Longest cycle a deadlock record holds
+const MAX_CYCLE: usize = 32;
+
+/// How often the monitor thread of each process runs
+const SCAN_INTERVAL: Duration = Duration::from_millis(25);
+/// A process whose heartbeat is older than this is considered gone
+const STALE_AFTER_MS: u64 = 1000;
+
+/// Shared state of all attached processes
+#[repr(C)]
+struct Region {
+    header: Header,
+    processes: [ProcessSlot; MAX_PROCESSES],
+    threads: [ThreadSlot; MAX_THREADS],
+    locks: [LockSlot; MAX_LOCKS],
+}
+
+#[repr(C)]
+struct Header {
+    magic: AtomicU64,
+    /// Process ID of the coordinator, 0 if none
+    coordinator: AtomicU64,
+    /// When the coordinator last scanned, in ms since the Unix epoch
+    coordinator_heartbeat: AtomicU64,
+    /// Sequence number of the deadlock record, odd while it is written
+    record_sequence: AtomicU64,
+    /// Length of the cycle in the deadlock record
+    record_len: AtomicU64,
+    /// Global IDs of the threads in the cycle
+    record_threads: [AtomicU64; MAX_CYCLE],
+    /// Key of the lock each of those threads waits for
+    record_locks: [AtomicU64; MAX_CYCLE],
+}
+
+#[repr(C)]
+struct ProcessSlot {
+    /// Process ID, 0 if the slot is free
+    pid: AtomicU64,
+    /// When the process last checked in, in ms since the Unix epoch
+    heartbeat: AtomicU64,
+}
+
+#[repr(C)]
+struct ThreadSlot {
+    /// Global thread ID, 0 if the slot is free
+    id: AtomicU64,
+    /// Key of the lock the thread waits for, 0 if none
+    waits_for: AtomicU64,
+}
+
+#[repr(C)]
+struct LockSlot {
+    /// Lock key, 0 if the slot is free. Slots are never freed.
+    key: AtomicU64,
+    /// Global ID of the owning thread, 0 if unlocked
+    owner: AtomicU64,
+}
+
+/// The region this process is attached to
+static REGION: OnceLock<&'static Region> = OnceLock::new();
+
+// Shared memory mapping, declared here to avoid a dependency on libc
+unsafe extern "C" {
+    fn mmap(
+        addr: *mut c_void,
+        len: usize,
+        prot: c_int,
+        flags: c_int,
+        fd: c_int,
+        offset: c_long,
+    ) -> *mut c_void;
+}
+
+const PROT_READ: c_int = 1;
+const PROT_WRITE: c_int = 2;
+const MAP_SHARED: c_int = 1;
+
+/// Milliseconds since the Unix epoch, comparable across processes
+fn now_ms() -> u64 {
+    SystemTime::now()
+        .duration_since(UNIX_EPOCH)
+        .map_or(0, |elapsed| elapsed.as_millis() as u64)
+}
+
+/// Process ID of a global thread ID
+fn pid_of(global_id: u64) -> u64 {
+    global_id >> 32
+}
+
+/// Global ID of the current thread
+///
+/// # Returns
+/// The process ID in the upper 32 bits and the local thread ID in the lower
+/// 32 bits. This is also the thread ID reported in `DeadlockInfo` for
+/// deadlocks found across processes.
+pub fn global_thread_id() -> u64 {
+    (u64::from(std::process::id()) << 32) | (get_current_thread_id() as u32 as u64)
+}
+
+/// Spread keys over the slot tables
+fn home_slot(value: u64, len: usize) -> usize {
+    (value.wrapping_mul(0x9E37_79B9_7F4A_7C15) >> 32) as usize % len
+}
+
+impl Region {
+    /// Find the slot of a lock key, claiming a free one if `insert` is set
+    fn lock_slot(&self, key: u64, insert: bool) -> Option<&LockSlot> {
+        let start = home_slot(key, MAX_LOCKS);
+        for probe in 0..MAX_LOCKS {
+            let slot = &self.locks[(start + probe) % MAX_LOCKS];
+            match slot.key.load(Ordering::Acquire) {
+                k if k == key => return Some(slot),
+                0 if !insert => return None,
+                0 => match slot
+                    .key
+                    .compare_exchange(0, key, Ordering::AcqRel, Ordering::Acquire)
+                {
+                    Ok(_) => return Some(slot),
+                    Err(k) if k == key => return Some(slot),
+                    Err(_) => continue,
+                },
+                _ => continue,
+            }
+        }
+        None
+    }
+
+    /// Claim a free thread slot for `id`
+    fn claim_thread_slot(&self, id: u64) -> Option<usize> {
+        let start = home_slot(id, MAX_THREADS);
+        (0..MAX_THREADS)
+            .map(|probe| (start + probe) % MAX_THREADS)
+            .find(|&index| {
+                self.threads[index]
+                    .id
+                    .compare_exchange(0, id, Ordering::AcqRel, Ordering::Relaxed)
+                    .is_ok()
+            })
+    }
+
+    /// Claim a process slot, taking over the slot of a stopped process if needed
+    fn claim_process_slot(&self, pid: u64) -> Option<&ProcessSlot> {
+        let now = now_ms();
+        self.processes.iter().find(|slot| {
+            let current = slot.pid.load(Ordering::Acquire);
+            let free = current == 0
+                || now.saturating_sub(slot.heartbeat.load(Ordering::Acquire)) > STALE_AFTER_MS;
+            if free
+                && slot
+                    .pid
+                    .compare_exchange(current, pid, Ordering::AcqRel, Ordering::Relaxed)
+                    .is_ok()
+            {
+                slot.heartbeat.store(now, Ordering::Release);
+                true
+            } else {
+                false
+            }
+        })
+    }
+}
+
+/// Slot of the current thread in the region, freed when the thread exits
+struct ThreadHandle {
+    slot: Cell<Option<usize>>,
+}
+
+impl ThreadHandle {
+    /// Slot of the thread, claimed on first use
+    ///
+    /// A thread that finds the thread table full tries again the next time
+    /// it publishes something.
+    fn slot(&self, region: &Region) -> Option<usize> {
+        if self.slot.get().is_none() {
+            self.slot.set(region.claim_thread_slot(global_thread_id()));
+        }
+        self.slot.get()
+    }
+}
+
+impl Drop for ThreadHandle {
+    fn drop(&mut self) {
+        if let (Some(region), Some(index)) = (REGION.get(), self.slot.get()) {
+            let slot = &region.threads[index];
+            slot.waits_for.store(0, Ordering::Release);
+            slot.id.store(0, Ordering::Release);
+        }
+    }
+}
+
+thread_local! {
+    static THREAD_SLOT: ThreadHandle = const {
+        ThreadHandle {
+            slot: Cell::new(None),
+        }
+    };
+}
+
+/// Run `f` on the slot of the current thread and the slot of `key`
+///
+/// # Returns
+/// Whether the region is attached and both slots are available
+fn with_slots(key: u64, f: impl FnOnce(u64, &ThreadSlot, &LockSlot)) -> bool {
+    let Some(region) = REGION.get() else {
+        return false;
+    };
+    if key == 0 {
+        return false;
+    }
+    let Some(index) = THREAD_SLOT
+        .try_with(|handle| handle.slot(region))
+        .ok()
+        .flatten()
+    else {
+        return false;
+    };
+    let Some(lock) = region.lock_slot(key, true) else {
+        return false;
+    };
+    f(global_thread_id(), &region.threads[index], lock);
+    true
+}
+
+/// Publish that the current thread is about to block on the shared lock `key`
+///
+/// # Arguments
+/// * `key` - Key of the lock, the same in every process (0 is reserved)
+///
+/// # Returns
+/// Whether the wait was published, i.e. the region is attached and has room
+/// for the thread and the lock
+pub fn attempt(key: u64) -> bool {
+    with_slots(key, |_, thread, _| {
+        thread.waits_for.store(key, Ordering::Release)
+    })
+}
+
+/// Publish that the current thread acquired the shared lock `key`
+///
+/// # Arguments
+/// * `key` - Key of the lock
+///
+/// # Returns
+/// Whether the acquisition was published
+pub fn acquired(key: u64) -> bool {
+    with_slots(key, |id, thread, lock| {
+        lock.owner.store(id, Ordering::Release);
+        thread.waits_for.store(0, Ordering::Release);
+    })
+}
+
+/// Publish that the current thread released the shared lock `key`
+///
+/// # Arguments
+/// * `key` - Key of the lock
+///
+/// # Returns
+/// Whether the release was published
+pub fn released(key: u64) -> bool {
+    with_slots(key, |id, _, lock| {
+        let _ = lock
+            .owner
+            .compare_exchange(id, 0, Ordering::AcqRel, Ordering::Relaxed);
+    })
+}
+
+/// Withdraw a wait published by [`attempt`] that gave up, e.g. after a timeout
+///
+/// # Arguments
+/// * `key` - Key of the lock
+///
+/// # Returns
+/// Whether the withdrawal was published
+pub fn cancel_wait(key: u64) -> bool {
+    with_slots(key, |_, thread, _| {
+        let _ = thread
+            .waits_for
+            .compare_exchange(key, 0, Ordering::AcqRel, Ordering::Relaxed);
+    })
+}
+
+/// Whether this process is attached to a shared region
+pub fn is_attached() -> bool {
+    REGION.get().is_some()
+}
+
+/// Attach this process to the shared region at `path`, creating it if needed
+///
+/// Registers the process and starts its monitor thread. A process attaches
+/// to at most one region, for the rest of its life.
+///
+/// # Arguments
+/// * `path` - File backing the region, e.g. `/dev/shm/myapp.deloxide`
+///
+/// # Errors
+/// Returns an error if the file cannot be mapped, is not a region of this
+/// version, has no free process slot, or another region is already attached
+pub fn attach<P: AsRef<Path>>(path: P) -> Result<()> {
+    open(path)?.spawn()
+}
+
+/// Map the region at `path` and register the process, without starting
+/// its monitor
+///
+/// # Errors
+/// The same as [`attach`], except for spawning the monitor thread
+pub(crate) fn open<P: AsRef<Path>>(path: P) -> Result<Monitor> {
+    if is_attached() {
+        bail!("already attached to a shared region");
+    }
+
+    let path = path.as_ref();
+    let size = std::mem::size_of::<Region>();
+    let file = OpenOptions::new()
+        .read(true)
+        .write(true)
+        .create(true)
+        .truncate(false)
+        .open(path)?;
+    if file.metadata()?.len() < size as u64 {
+        file.set_len(size as u64)?;
+    }
+
+    // Safety: the mapping is shared, as large as `Region` and never unmapped.
+    // A zeroed file is a valid region, as it only holds atomic integers.
+    let region: &'static Region = unsafe {
+        let address = mmap(
+            std::ptr::null_mut(),
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            file.as_raw_fd(),
+            0,
+        );
+        if address as isize == -1 {
+            return Err(std::io::Error::last_os_error().into());
+        }
+        &*(address as *const Region)
+    };
+
+    let magic =
+        match region
+            .header
+            .magic
+            .compare_exchange(0, MAGIC, Ordering::AcqRel, Ordering::Acquire)
+        {
+            Ok(_) => MAGIC,
+            Err(existing) => existing,
+        };
+    if magic != MAGIC {
+        bail!("{} is not a Deloxide shared region", path.display());
+    }
+
+    let pid = u64::from(std::process::id());
+    let Some(process) = region.claim_process_slot(pid) else {
+        bail!("no free process slot in {}", path.display());
+    };
+    if REGION.set(region).is_err() {
+        bail!("already attached to a shared region");
+    }
+
+    Ok(Monitor {
+        region,
+        process,
+        pid,
+        candidate: None,
+        reported: None,
+        seen_sequence: region.header.record_sequence.load(Ordering::Acquire),
+    })
+}
+
+/// Monitor thread state of an attached process
+pub(crate) struct Monitor {
+    region: &'static Region,
+    process: &'static ProcessSlot,
+    pid: u64,
+    /// Sorted threads of the cycle found by the previous scan
+    candidate: Option<Vec<u64>>,
+    /// Sorted threads of the last cycle this process published
+    reported: Option<Vec<u64>>,
+    /// Sequence number of the last deadlock record handled
+    seen_sequence: u64,
+}
+
+impl Monitor {
+    /// Start the monitor thread of the process
+    ///
+    /// # Errors
+    /// Returns an error if the thread cannot be spawned
+    pub(crate) fn spawn(mut self) -> Result<()> {
+        thread::Builder::new()
+            .name("deloxide-shared-monitor".into())
+            .spawn(move || {
+                loop {
+                    thread::sleep(SCAN_INTERVAL);
+                    self.tick();
+                }
+            })?;
+        Ok(())
+    }
+
+    fn tick(&mut self) {
+        let now = now_ms();
+        self.process.heartbeat.store(now, Ordering::Release);
+
+        if self.is_coordinator(now) {
+            self.region
+                .header
+                .coordinator_heartbeat
+                .store(now, Ordering::Release);
+            self.scan(now);
+        }
+        self.check_record();
+    }
+
+    /// Whether this process coordinates, taking over from a stopped coordinator
+    fn is_coordinator(&self, now: u64) -> bool {
+        let header = &self.region.header;
+        let current = header.coordinator.load(Ordering::Acquire);
+        if current == self.pid {
+            return true;
+        }
+        let stale = now.saturating_sub(header.coordinator_heartbeat.load(Ordering::Acquire))
+            > STALE_AFTER_MS;
+        (current == 0 || stale)
+            && header
+                .coordinator
+                .compare_exchange(current, self.pid, Ordering::AcqRel, Ordering::Relaxed)
+                .is_ok()
+    }
+
+    /// Build the wait-for graph of all live processes and search it for a cycle
+    fn scan(&mut self, now: u64) {
+        let region = self.region;
+        let live: Vec<u64> = region
+            .processes
+            .iter()
+            .filter_map(|slot| {
+                let pid = slot.pid.load(Ordering::Acquire);
+                let fresh =
+                    now.saturating_sub(slot.heartbeat.load(Ordering::Acquire)) <= STALE_AFTER_MS;
+                (pid != 0 && fresh).then_some(pid)
+            })
+            .collect();
+
+        let mut graph = WaitForGraph::new();
+        let mut cycle = None;
+        for slot in &region.threads {
+            let id = slot.id.load(Ordering::Acquire);
+            if id == 0 {
+                continue;
+            }
+            if !live.contains(&pid_of(id)) {
+                // Left behind by a process that stopped
+                slot.waits_for.store(0, Ordering::Release);
+                let _ = slot
+                    .id
+                    .compare_exchange(id, 0, Ordering::AcqRel, Ordering::Relaxed);
+                continue;
+            }
+            let key = slot.waits_for.load(Ordering::Acquire);
+            let owner = match region.lock_slot(key, false) {
+                Some(lock) if key != 0 => lock.owner.load(Ordering::Acquire),
+                _ => continue,
+            };
+            if owner == 0 || owner == id || !live.contains(&pid_of(owner)) {
+                continue;
+            }
+            if let Some(found) = graph.add_edge(id as ThreadId, owner as ThreadId) {
+                cycle = Some(found);
+                break;
+            }
+        }
+
+        // The scan is not atomic, so only a cycle that persists is a deadlock
+        let Some(cycle) = cycle else {
+            self.candidate = None;
+            return;
+        };
+        let mut sorted: Vec<u64> = cycle.iter().map(|&id| id as u64).collect();
+        sorted.sort_unstable();
+        if self.candidate.as_ref() == Some(&sorted) && self.reported.as_ref() != Some(&sorted) {
+            self.publish(&cycle);
+            self.reported = Some(sorted.clone());
+        }
+        self.candidate = Some(sorted);
+    }
+
+    /// Write a deadlock record for the other processes to pick up
+    fn publish(&self, cycle: &[ThreadId]) {
+        let header = &self.region.header;
+        let len = cycle.len().min(MAX_CYCLE);
+        header.record_sequence.fetch_add(1, Ordering::AcqRel);
+        for (index, &thread) in cycle.iter().take(len).enumerate() {
+            let thread = thread as u64;
+            let waits_for = self
+                .region
+                .threads
+                .iter()
+                .find(|slot| slot.id.load(Ordering::Acquire) == thread)
+                .map_or(0, |slot| slot.waits_for.load(Ordering::Acquire));
+            header.record_threads[index].store(thread, Ordering::Relaxed);
+            header.record_locks[index].store(waits_for, Ordering::Relaxed);
+        }
+        header.record_len.store(len as u64, Ordering::Relaxed);
+        header.record_sequence.fetch_add(1, Ordering::Release);
+    }
+
+    /// Report a new deadlock record if a thread of this process is in it
+    fn check_record(&mut self) {
+        let header = &self.region.header;
+        let sequence = header.record_sequence.load(Ordering::Acquire);
+        if sequence == self.seen_sequence || sequence % 2 == 1 {
+            return;
+        }
+
+        let len = (header.record_len.load(Ordering::Relaxed) as usize).min(MAX_CYCLE);
+        let threads: Vec<u64> = header.record_threads[..len]
+            .iter()
+            .map(|thread| thread.load(Ordering::Relaxed))
+            .collect();
+        let locks: Vec<u64> = header.record_locks[..len]
+            .iter()
+            .map(|lock| lock.load(Ordering::Relaxed))
+            .collect();
+        fence(Ordering::Acquire);
+        if header.record_sequence.load(Ordering::Relaxed) != sequence {
+            // Rewritten while reading, try again on the next tick
+            return;
+        }
+        self.seen_sequence = sequence;
+
+        if threads.iter().any(|&thread| pid_of(thread) == self.pid) {
+            deadlock_handling::process_deadlock(DeadlockInfo {
+                source: DeadlockSource::WaitForGraph,
+                thread_cycle: threads.iter().map(|&thread| thread as ThreadId).collect(),
+                thread_waiting_for_locks: threads
+                    .iter()
+                    .zip(&locks)
+                    .map(|(&thread, &lock)| (thread as ThreadId, lock as LockId))
+                    .collect(),
+                lock_order_cycle: None,
+                lock_order_classes: None,
+                timestamp: Utc::now().to_rfc3339(),
+                verification_request: None,
+            });
+        }
+    }
+}
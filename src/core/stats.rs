@@ -0,0 +1,468 @@
+//! Per-lock contention statistics (only with the "lock-stats" feature)
+//!
+//! Once enabled, every sampled acquisition of a tracked Mutex or RwLock is
+//! counted, and contended acquisitions also record how long they waited. The
+//! counters are kept per thread: each thread updates its own table behind a
+//! lock nobody else takes outside of a snapshot, so recording never contends
+//! across threads. A snapshot sums the tables of the live threads and the
+//! totals left behind by threads that exited.
+//!
+//! Wait times go into a log-bucketed histogram in the style of HDR histograms:
+//! bucket `i` counts waits in `[2^i, 2^(i+1))` nanoseconds, so 40 buckets
+//! cover everything from a nanosecond to several minutes at a constant
+//! relative error.
+//!
+//! When a lock is destroyed its counters are folded into its lock class (see
+//! [`LockClass`](crate::core::detector::lock_class::LockClass)), so per-class
+//! totals cover the whole run while the per-lock view keeps only live locks.
+
+use crate::core::detector::{self, lock_class::LockClassId};
+use crate::core::types::LockId;
+use fxhash::FxHashMap;
+use parking_lot::Mutex;
+use smallvec::SmallVec;
+use std::cell::RefCell;
+use std::fmt::Write;
+use std::sync::Arc;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::time::{Duration, Instant};
+
+/// Number of buckets in a wait-time histogram
+pub const WAIT_HISTOGRAM_BUCKETS: usize = 40;
+
+/// Whether acquisitions are being counted
+static ENABLED: AtomicBool = AtomicBool::new(false);
+
+/// Raw counters of one lock as recorded by one thread
+#[derive(Clone, Copy)]
+struct Counters {
+    acquisitions: u64,
+    contended: u64,
+    wait_ns: u64,
+    max_wait_ns: u64,
+    hold_ns: u64,
+    max_hold_ns: u64,
+    wait_histogram: [u64; WAIT_HISTOGRAM_BUCKETS],
+}
+
+impl Default for Counters {
+    fn default() -> Self {
+        Counters {
+            acquisitions: 0,
+            contended: 0,
+            wait_ns: 0,
+            max_wait_ns: 0,
+            hold_ns: 0,
+            max_hold_ns: 0,
+            wait_histogram: [0; WAIT_HISTOGRAM_BUCKETS],
+        }
+    }
+}
+
+impl Counters {
+    /// Add the counts of `other` to these
+    fn merge(&mut self, other: &Counters) {
+        self.acquisitions += other.acquisitions;
+        self.contended += other.contended;
+        self.wait_ns += other.wait_ns;
+        self.max_wait_ns = self.max_wait_ns.max(other.max_wait_ns);
+        self.hold_ns += other.hold_ns;
+        self.max_hold_ns = self.max_hold_ns.max(other.max_hold_ns);
+        for (bucket, count) in self.wait_histogram.iter_mut().zip(other.wait_histogram) {
+            *bucket += count;
+        }
+    }
+
+    fn to_stats(self) -> ContentionStats {
+        ContentionStats {
+            acquisitions: self.acquisitions,
+            contended: self.contended,
+            total_wait: Duration::from_nanos(self.wait_ns),
+            max_wait: Duration::from_nanos(self.max_wait_ns),
+            total_hold: Duration::from_nanos(self.hold_ns),
+            max_hold: Duration::from_nanos(self.max_hold_ns),
+            wait_histogram: self.wait_histogram,
+        }
+    }
+}
+
+/// Counter table of one thread, keyed by lock
+type ThreadCounters = Arc<Mutex<FxHashMap<LockId, Counters>>>;
+
+/// Counters that no longer belong to a live thread
+#[derive(Default)]
+struct Retired {
+    /// Counters of live locks recorded by threads that exited
+    locks: FxHashMap<LockId, Counters>,
+    /// Counters of destroyed locks, by class
+    classes: FxHashMap<LockClassId, Counters>,
+}
+
+lazy_static::lazy_static! {
+    /// Counter tables of all live threads that recorded anything
+    static ref THREADS: Mutex<Vec<ThreadCounters>> = Mutex::new(Vec::new());
+    static ref RETIRED: Mutex<Retired> = Mutex::new(Retired::default());
+}
+
+/// Recording state of the current thread
+struct ThreadStats {
+    counters: ThreadCounters,
+    /// Locks this thread holds and when it acquired them, most recent last
+    held: RefCell<SmallVec<[(LockId, Instant); 8]>>,
+}
+
+impl ThreadStats {
+    fn register() -> Self {
+        let counters = ThreadCounters::default();
+        THREADS.lock().push(Arc::clone(&counters));
+        ThreadStats {
+            counters,
+            held: RefCell::new(SmallVec::new()),
+        }
+    }
+}
+
+impl Drop for ThreadStats {
+    fn drop(&mut self) {
+        // Keep THREADS locked until the counters are retired, so a snapshot
+        // never sees them twice or not at all
+        let mut threads = THREADS.lock();
+        threads.retain(|counters| !Arc::ptr_eq(counters, &self.counters));
+        let mut retired = RETIRED.lock();
+        for (lock_id, counters) in self.counters.lock().drain() {
+            retired.locks.entry(lock_id).or_default().merge(&counters);
+        }
+    }
+}
+
+thread_local! {
+    static THREAD_STATS: ThreadStats = ThreadStats::register();
+}
+
+/// Start counting acquisitions
+pub(crate) fn enable() {
+    ENABLED.store(true, Ordering::Relaxed);
+}
+
+/// Whether acquisitions are being counted
+#[inline]
+pub fn is_enabled() -> bool {
+    ENABLED.load(Ordering::Relaxed)
+}
+
+/// Histogram bucket of a wait of `nanos` nanoseconds
+fn bucket(nanos: u64) -> usize {
+    (nanos.max(1).ilog2() as usize).min(WAIT_HISTOGRAM_BUCKETS - 1)
+}
+
+/// Timestamp taken before a contended acquisition starts waiting
+///
+/// # Returns
+/// `None` while statistics are disabled
+#[inline]
+pub fn wait_start() -> Option<Instant> {
+    is_enabled().then(Instant::now)
+}
+
+/// Record that the current thread acquired `lock_id`
+///
+/// # Arguments
+/// * `lock_id` - ID of the acquired lock
+/// * `wait_start` - When the thread started waiting, or `None` if the
+///   acquisition was not contended
+#[inline]
+pub fn acquired(lock_id: LockId, wait_start: Option<Instant>) {
+    if is_enabled() {
+        record_acquired(lock_id, wait_start);
+    }
+}
+
+fn record_acquired(lock_id: LockId, wait_start: Option<Instant>) {
+    let now = Instant::now();
+    let _ = THREAD_STATS.try_with(|stats| {
+        {
+            let mut counters = stats.counters.lock();
+            let counters = counters.entry(lock_id).or_default();
+            counters.acquisitions += 1;
+            if let Some(start) = wait_start {
+                let waited = now.saturating_duration_since(start).as_nanos() as u64;
+                counters.contended += 1;
+                counters.wait_ns += waited;
+                counters.max_wait_ns = counters.max_wait_ns.max(waited);
+                counters.wait_histogram[bucket(waited)] += 1;
+            }
+        }
+        stats.held.borrow_mut().push((lock_id, now));
+    });
+}
+
+/// Resume the hold time of a lock reacquired after a condvar wait
+///
+/// The wait itself is not an acquisition and is not counted.
+#[inline]
+pub fn resumed(lock_id: LockId) {
+    if is_enabled() {
+        let _ =
+            THREAD_STATS.try_with(|stats| stats.held.borrow_mut().push((lock_id, Instant::now())));
+    }
+}
+
+/// Record that the current thread released `lock_id`
+///
+/// Releases without a matching acquisition on this thread (e.g. locks taken
+/// before statistics were enabled) are ignored.
+#[inline]
+pub fn released(lock_id: LockId) {
+    if is_enabled() {
+        record_released(lock_id);
+    }
+}
+
+fn record_released(lock_id: LockId) {
+    let _ = THREAD_STATS.try_with(|stats| {
+        let acquired_at = {
+            let mut held = stats.held.borrow_mut();
+            let Some(index) = held.iter().rposition(|&(id, _)| id == lock_id) else {
+                return;
+            };
+            held.remove(index).1
+        };
+        let held_ns = acquired_at.elapsed().as_nanos() as u64;
+        let mut counters = stats.counters.lock();
+        let counters = counters.entry(lock_id).or_default();
+        counters.hold_ns += held_ns;
+        counters.max_hold_ns = counters.max_hold_ns.max(held_ns);
+    });
+}
+
+/// Fold the counters of a destroyed lock into its class
+///
+/// # Arguments
+/// * `lock_id` - ID of the destroyed lock
+/// * `class` - Class of the lock, if it has one. Counters of classless locks
+///   are dropped.
+pub(crate) fn forget_lock(lock_id: LockId, class: Option<LockClassId>) {
+    let threads = THREADS.lock();
+    let mut total = Counters::default();
+    for counters in threads.iter() {
+        if let Some(counters) = counters.lock().remove(&lock_id) {
+            total.merge(&counters);
+        }
+    }
+    let mut retired = RETIRED.lock();
+    if let Some(counters) = retired.locks.remove(&lock_id) {
+        total.merge(&counters);
+    }
+    match class {
+        Some(class) if total.acquisitions > 0 => {
+            retired.classes.entry(class).or_default().merge(&total);
+        }
+        _ => {}
+    }
+}
+
+/// Contention counters of a lock or lock class
+#[derive(Debug, Clone, PartialEq)]
+pub struct ContentionStats {
+    /// Number of acquisitions
+    pub acquisitions: u64,
+    /// Number of acquisitions that had to wait for another thread
+    pub contended: u64,
+    /// Total time spent waiting by contended acquisitions
+    pub total_wait: Duration,
+    /// Longest single wait
+    pub max_wait: Duration,
+    /// Total time the lock was held
+    pub total_hold: Duration,
+    /// Longest single hold
+    pub max_hold: Duration,
+    /// Contended waits by duration: bucket `i` counts waits of
+    /// `[2^i, 2^(i+1))` nanoseconds (the last bucket also counts longer ones)
+    pub wait_histogram: [u64; WAIT_HISTOGRAM_BUCKETS],
+}
+
+impl ContentionStats {
+    /// Average wait of a contended acquisition
+    pub fn mean_wait(&self) -> Duration {
+        match self.contended {
+            0 => Duration::ZERO,
+            n => Duration::from_nanos((self.total_wait.as_nanos() / n as u128) as u64),
+        }
+    }
+
+    /// Upper bound of the wait time below which `quantile` of the contended
+    /// acquisitions fall, at histogram resolution
+    ///
+    /// # Arguments
+    /// * `quantile` - Fraction of waits, e.g. `0.99` for the 99th percentile
+    pub fn wait_quantile(&self, quantile: f64) -> Duration {
+        if self.contended == 0 {
+            return Duration::ZERO;
+        }
+        let rank = (quantile.clamp(0.0, 1.0) * self.contended as f64)
+            .ceil()
+            .max(1.0) as u64;
+        let mut seen = 0;
+        for (index, &count) in self.wait_histogram.iter().enumerate() {
+            seen += count;
+            if seen >= rank {
+                let upper = Duration::from_nanos(1u64 << (index + 1));
+                return upper.min(self.max_wait);
+            }
+        }
+        self.max_wait
+    }
+}
+
+/// Contention statistics of a single live lock
+#[derive(Debug, Clone, PartialEq)]
+pub struct LockStats {
+    /// ID of the lock
+    pub lock_id: LockId,
+    /// Name of the lock's class, if it has one
+    pub class: Option<String>,
+    /// Counters accumulated by all threads
+    pub stats: ContentionStats,
+}
+
+/// Contention statistics of a lock class, including its destroyed locks
+#[derive(Debug, Clone, PartialEq)]
+pub struct ClassStats {
+    /// Name of the class (`file:line:column` or a user-given name)
+    pub class: String,
+    /// Counters accumulated over all locks of the class
+    pub stats: ContentionStats,
+}
+
+/// Sum the counters of every live lock over all threads
+fn collect_live() -> FxHashMap<LockId, Counters> {
+    let threads = THREADS.lock();
+    let mut totals = FxHashMap::<LockId, Counters>::default();
+    for counters in threads.iter() {
+        for (&lock_id, counters) in counters.lock().iter() {
+            totals.entry(lock_id).or_default().merge(counters);
+        }
+    }
+    for (&lock_id, counters) in RETIRED.lock().locks.iter() {
+        totals.entry(lock_id).or_default().merge(counters);
+    }
+    totals
+}
+
+/// Order statistics most contended first: by total wait, then contended count
+fn by_contention(a: &ContentionStats, b: &ContentionStats) -> std::cmp::Ordering {
+    b.total_wait
+        .cmp(&a.total_wait)
+        .then(b.contended.cmp(&a.contended))
+        .then(b.acquisitions.cmp(&a.acquisitions))
+}
+
+/// Snapshot the statistics of every live lock, most contended first
+///
+/// # Returns
+/// One entry per lock that was acquired since statistics were enabled
+pub fn lock_stats() -> Vec<LockStats> {
+    let mut stats: Vec<LockStats> = collect_live()
+        .into_iter()
+        .map(|(lock_id, counters)| LockStats {
+            lock_id,
+            class: detector::assigned_lock_class(lock_id)
+                .and_then(detector::lock_class::class_name),
+            stats: counters.to_stats(),
+        })
+        .collect();
+    stats.sort_by(|a, b| by_contention(&a.stats, &b.stats).then(a.lock_id.cmp(&b.lock_id)));
+    stats
+}
+
+/// Snapshot the statistics of every lock class, most contended first
+///
+/// Only locks with a class (Rust locks and C locks created with a class
+/// name) are counted; destroyed locks stay in their class's totals.
+pub fn lock_class_stats() -> Vec<ClassStats> {
+    let mut totals = FxHashMap::<LockClassId, Counters>::default();
+    for (lock_id, counters) in collect_live() {
+        if let Some(class) = detector::assigned_lock_class(lock_id) {
+            totals.entry(class).or_default().merge(&counters);
+        }
+    }
+    for (&class, counters) in RETIRED.lock().classes.iter() {
+        totals.entry(class).or_default().merge(counters);
+    }
+
+    let mut stats: Vec<ClassStats> = totals
+        .into_iter()
+        .map(|(class, counters)| ClassStats {
+            class: detector::lock_class::class_name(class).unwrap_or_default(),
+            stats: counters.to_stats(),
+        })
+        .collect();
+    stats.sort_by(|a, b| by_contention(&a.stats, &b.stats).then(a.class.cmp(&b.class)));
+    stats
+}
+
+/// The `n` most contended live locks
+///
+/// # Arguments
+/// * `n` - Maximum number of locks to return
+pub fn most_contended_locks(n: usize) -> Vec<LockStats> {
+    let mut stats = lock_stats();
+    stats.truncate(n);
+    stats
+}
+
+/// Render the `n` most contended live locks as a text table
+///
+/// # Arguments
+/// * `n` - Maximum number of locks to list
+pub fn contention_report(n: usize) -> String {
+    let mut report = format!(
+        "{:>8}  {:>12}  {:>10}  {:>12}  {:>12}  {:>12}  {:>12}  class\n",
+        "lock", "acquisitions", "contended", "total wait", "p99 wait", "max wait", "max hold"
+    );
+    for lock in most_contended_locks(n) {
+        let stats = &lock.stats;
+        let _ = writeln!(
+            report,
+            "{:>8}  {:>12}  {:>10}  {:>12}  {:>12}  {:>12}  {:>12}  {}",
+            lock.lock_id,
+            stats.acquisitions,
+            stats.contended,
+            format!("{:.1?}", stats.total_wait),
+            format!("{:.1?}", stats.wait_quantile(0.99)),
+            format!("{:.1?}", stats.max_wait),
+            format!("{:.1?}", stats.max_hold),
+            lock.class.as_deref().unwrap_or("-"),
+        );
+    }
+    report
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_buckets_are_log2_of_nanoseconds() {
+        assert_eq!(bucket(0), 0);
+        assert_eq!(bucket(1), 0);
+        assert_eq!(bucket(3), 1);
+        assert_eq!(bucket(1_000), 9);
+        assert_eq!(bucket(u64::MAX), WAIT_HISTOGRAM_BUCKETS - 1);
+    }
+
+    #[test]
+    fn test_quantiles_follow_the_histogram() {
+        let mut counters = Counters::default();
+        for nanos in [100, 100, 100, 10_000] {
+            counters.contended += 1;
+            counters.wait_ns += nanos;
+            counters.max_wait_ns = counters.max_wait_ns.max(nanos);
+            counters.wait_histogram[bucket(nanos)] += 1;
+        }
+        let stats = counters.to_stats();
+        assert_eq!(stats.wait_quantile(0.5), Duration::from_nanos(128));
+        assert_eq!(stats.wait_quantile(1.0), Duration::from_nanos(10_000));
+        assert_eq!(stats.mean_wait(), Duration::from_nanos(2_575));
+    }
+}
@@ -1,16 +1,27 @@
 // src/core/stress.rs
 // This module provides stress testing functionality for Deloxide
 // It's only compiled when the "stress-test" feature is enabled
+//
+// Every run has a seed. Each thread derives its own random stream from the
+// seed and its thread ID, so decisions never go through shared random state
+// and a run can be repeated by passing the same seed. Each thread also logs
+// the most recent delays it chose; the log is a `StressSchedule` that can be
+// replayed exactly with `Deloxide::with_stress_replay`, even in the modes
+// whose decisions depend on what other threads did.
 #![allow(dead_code)]
 
 use crate::core::types::{LockId, ThreadId};
 use fxhash::FxHashMap;
-use parking_lot::Mutex;
+use parking_lot::{Mutex, RwLock};
+use std::cell::RefCell;
+use std::collections::{BTreeMap, VecDeque};
+use std::fmt;
+use std::str::FromStr;
+use std::sync::Arc;
+use std::sync::atomic::{AtomicU8, AtomicU64, AtomicUsize, Ordering};
 use std::thread;
 use std::time::Duration;
 
-use rand::{Rng, rng};
-
 /// Stress testing modes available in Deloxide
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
 pub enum StressMode {
@@ -21,6 +32,49 @@ pub enum StressMode {
     RandomPreemption,
     /// Component-based delays using lock acquisition patterns
     ComponentBased,
+    /// Probabilistic concurrency testing (PCT) with random thread priorities
+    ///
+    /// Every thread gets a random priority, and at `pct_depth - 1` randomly
+    /// chosen acquisition points the thread that reaches it drops below all
+    /// others. The OS scheduler cannot be told to run threads by priority,
+    /// so priorities are enforced as delays before nested acquisitions:
+    /// the lower a thread's priority, the longer it waits.
+    Pct,
+}
+
+impl StressMode {
+    /// Name of the mode in a [`StressSchedule`]
+    fn name(self) -> &'static str {
+        match self {
+            StressMode::None => "none",
+            StressMode::RandomPreemption => "random",
+            StressMode::ComponentBased => "component",
+            StressMode::Pct => "pct",
+        }
+    }
+
+    fn from_index(index: u8) -> Self {
+        match index {
+            1 => StressMode::RandomPreemption,
+            2 => StressMode::ComponentBased,
+            3 => StressMode::Pct,
+            _ => StressMode::None,
+        }
+    }
+}
+
+impl FromStr for StressMode {
+    type Err = String;
+
+    fn from_str(name: &str) -> Result<Self, Self::Err> {
+        match name {
+            "none" => Ok(StressMode::None),
+            "random" => Ok(StressMode::RandomPreemption),
+            "component" => Ok(StressMode::ComponentBased),
+            "pct" => Ok(StressMode::Pct),
+            _ => Err(format!("unknown stress mode `{name}`")),
+        }
+    }
 }
 
 /// Configuration options for stress testing
@@ -34,6 +88,16 @@ pub struct StressConfig {
     pub max_delay_us: u64,
     /// Whether to preempt after lock releases
     pub preempt_after_release: bool,
+    /// Seed of the run, or None to pick a random one
+    ///
+    /// The seed in use is available from [`stress_seed`] either way.
+    pub seed: Option<u64>,
+    /// Number of priority change points plus one in PCT mode (the bug depth
+    /// PCT targets; 2 suffices for deadlocks between two threads)
+    pub pct_depth: usize,
+    /// Expected number of acquisition points in a run, over which PCT
+    /// spreads its change points
+    pub pct_steps: u64,
 }
 
 impl Default for StressConfig {
@@ -43,6 +107,9 @@ impl Default for StressConfig {
             min_delay_us: 250,  // 250us
             max_delay_us: 2000, // 2ms
             preempt_after_release: true,
+            seed: None,
+            pct_depth: 3,
+            pct_steps: 1000,
         }
     }
 }
@@ -55,6 +122,7 @@ impl StressConfig {
             min_delay_us: 500,
             max_delay_us: 5000,
             preempt_after_release: true,
+            ..Self::default()
         }
     }
 
@@ -65,193 +133,515 @@ impl StressConfig {
             min_delay_us: 20,
             max_delay_us: 100,
             preempt_after_release: false,
+            ..Self::default()
         }
     }
 }
 
-/// State for tracking lock relationships
-#[derive(Default)]
-struct ComponentTracker {
-    /// Maps locks to their component IDs
-    components: FxHashMap<LockId, usize>,
-    /// Records lock acquisition order
-    acquisitions: Vec<(LockId, LockId)>,
+/// The delays a stress run chose, by thread
+///
+/// Each thread numbers its lock acquisitions, the stress decision points,
+/// from zero; a schedule maps a thread ID to the decision points at which
+/// it was delayed and for how many microseconds. Replaying requires threads
+/// to get the same IDs, which holds as long as they first touch Deloxide in
+/// the same order.
+///
+/// The text form produced by `Display` and read by `FromStr` is:
+///
+/// ```text
+/// mode pct
+/// seed 42
+/// thread 2 3:1200 5:800
+/// ```
+#[derive(Debug, Clone, PartialEq, Eq, Default)]
+pub struct StressSchedule {
+    /// Mode the run used
+    pub mode: StressMode,
+    /// Seed the run used
+    pub seed: u64,
+    /// `(decision point, delay in microseconds)` pairs per thread
+    pub delays: BTreeMap<ThreadId, Vec<(u64, u64)>>,
 }
 
-impl ComponentTracker {
-    fn new() -> Self {
-        Default::default()
+impl fmt::Display for StressSchedule {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        writeln!(f, "mode {}", self.mode.name())?;
+        writeln!(f, "seed {}", self.seed)?;
+        for (thread_id, delays) in &self.delays {
+            write!(f, "thread {thread_id}")?;
+            for (decision, delay_us) in delays {
+                write!(f, " {decision}:{delay_us}")?;
+            }
+            writeln!(f)?;
+        }
+        Ok(())
     }
+}
 
-    fn record_acquisition(&mut self, from_lock: LockId, to_lock: LockId) {
-        self.acquisitions.push((from_lock, to_lock));
+impl FromStr for StressSchedule {
+    type Err = String;
 
-        // Assign components (simple approach)
-        if !self.components.contains_key(&from_lock) {
-            let comp_id = self.components.len();
-            self.components.insert(from_lock, comp_id);
+    fn from_str(text: &str) -> Result<Self, Self::Err> {
+        fn number(word: &str) -> Result<u64, String> {
+            word.parse().map_err(|_| format!("invalid number `{word}`"))
         }
 
-        if !self.components.contains_key(&to_lock) {
-            let from_comp = *self.components.get(&from_lock).unwrap();
-            self.components.insert(to_lock, from_comp);
+        let mut schedule = StressSchedule::default();
+        for line in text.lines().map(str::trim).filter(|line| !line.is_empty()) {
+            let mut words = line.split_whitespace();
+            match (words.next(), words.next()) {
+                (Some("mode"), Some(mode)) => schedule.mode = mode.parse()?,
+                (Some("seed"), Some(seed)) => schedule.seed = number(seed)?,
+                (Some("thread"), Some(thread_id)) => {
+                    let delays = words
+                        .map(|pair| {
+                            let (decision, delay_us) = pair
+                                .split_once(':')
+                                .ok_or_else(|| format!("invalid delay `{pair}`"))?;
+                            Ok((number(decision)?, number(delay_us)?))
+                        })
+                        .collect::<Result<_, String>>()?;
+                    schedule
+                        .delays
+                        .insert(number(thread_id)? as ThreadId, delays);
+                }
+                _ => return Err(format!("invalid schedule line `{line}`")),
+            }
         }
+        Ok(schedule)
     }
+}
 
-    fn should_delay(&self, from_lock: LockId, to_lock: LockId) -> bool {
-        let from_comp = self
-            .components
-            .get(&from_lock)
-            .copied()
-            .unwrap_or(usize::MAX);
-        let to_comp = self.components.get(&to_lock).copied().unwrap_or(usize::MAX);
+/// SplitMix64, a small and fast generator with a stable output sequence
+///
+/// Unlike the generators behind `rand`, its sequence can never change with
+/// a dependency update, so a seed reproduces the same run on every build.
+struct SplitMix64(u64);
+
+impl SplitMix64 {
+    fn next(&mut self) -> u64 {
+        self.0 = self.0.wrapping_add(0x9E37_79B9_7F4A_7C15);
+        let mut z = self.0;
+        z = (z ^ (z >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+        z ^ (z >> 31)
+    }
 
-        // If both locks are in the same component (potential cycle)
-        if from_comp == to_comp && from_comp != usize::MAX {
-            return true;
+    /// Uniform value in `0..bound` (`bound` must not be 0)
+    fn below(&mut self, bound: u64) -> u64 {
+        ((self.next() as u128 * bound as u128) >> 64) as u64
+    }
+
+    /// Uniform value in `min..=max`
+    fn between(&mut self, min: u64, max: u64) -> u64 {
+        if min >= max {
+            min
+        } else {
+            min + self.below(max - min + 1)
         }
+    }
 
-        // If there's a reverse acquisition pattern
-        self.acquisitions
-            .iter()
-            .any(|&(f, t)| f == to_lock && t == from_lock)
+    /// Whether an event of `probability` happens
+    fn chance(&mut self, probability: f64) -> bool {
+        ((self.next() >> 11) as f64 / (1u64 << 53) as f64) < probability
     }
 }
 
-/// Global state for stress testing
-struct StressState {
-    /// Track lock relationships
-    tracker: ComponentTracker,
-    /// Count preemptions per lock
-    preemption_counts: FxHashMap<LockId, usize>,
+/// Maximum number of PCT change points
+const MAX_CHANGE_POINTS: usize = 16;
+
+/// Lock slots of the component table (must be a power of two)
+const COMPONENT_SLOTS: usize = 4096;
+
+/// Bits of the acquisition edge filter (must be a power of two)
+const EDGE_BITS: usize = 1 << 16;
+
+/// Priorities handed out to threads in PCT mode, above the change point
+/// priorities `0..pct_depth - 1`
+const PCT_PRIORITY_LEVELS: u64 = 1 << 16;
+
+/// Number of the current run, so thread state left from an earlier run is
+/// reinitialized
+static RUN: AtomicU64 = AtomicU64::new(0);
+static MODE: AtomicU8 = AtomicU8::new(0);
+static SEED: AtomicU64 = AtomicU64::new(0);
+
+/// Acquisition points reached by all threads in PCT mode
+static PCT_STEP: AtomicU64 = AtomicU64::new(0);
+/// Steps at which the reaching thread drops its priority (`u64::MAX` if unused)
+static PCT_CHANGE_POINTS: [AtomicU64; MAX_CHANGE_POINTS] =
+    [const { AtomicU64::new(u64::MAX) }; MAX_CHANGE_POINTS];
+
+/// Component of each lock plus one, by hashed lock ID (0 if unassigned)
+///
+/// Locks that collide share a component, which only makes delays more
+/// likely; the table never grows, unlike a map of every lock seen.
+static COMPONENTS: [AtomicUsize; COMPONENT_SLOTS] =
+    [const { AtomicUsize::new(0) }; COMPONENT_SLOTS];
+static NEXT_COMPONENT: AtomicUsize = AtomicUsize::new(1);
+
+/// Bloom filter style bitmap of acquisition edges `(held, acquired)` seen
+static EDGES: [AtomicU64; EDGE_BITS / 64] = [const { AtomicU64::new(0) }; EDGE_BITS / 64];
+
+/// `(decision point, delay in microseconds)` pairs of one thread, in order
+type Delays = Arc<[(u64, u64)]>;
+
+/// Delays to replay, by thread
+static REPLAY: RwLock<Option<Arc<FxHashMap<ThreadId, Delays>>>> = RwLock::new(None);
+
+/// Number of most recent delays each thread keeps for `stress_schedule`
+const DELAY_LOG_CAPACITY: usize = 1024;
+
+/// Number of delay logs kept before those of exited threads are forgotten
+const MAX_DELAY_LOGS: usize = 256;
+
+/// Delay logs of the threads that took a stress decision in this run
+///
+/// A log no longer shared with its thread belongs to a thread that exited.
+/// The oldest of those is forgotten to make room once `MAX_DELAY_LOGS` are
+/// kept, so short-lived threads do not pile up over a long run.
+type DelayLog = Arc<Mutex<VecDeque<(u64, u64)>>>;
+static LOGS: Mutex<Vec<(ThreadId, DelayLog)>> = Mutex::new(Vec::new());
+
+/// Stress state of one thread
+struct ThreadStress {
+    run: u64,
+    thread_id: ThreadId,
+    rng: SplitMix64,
+    /// Decision points this thread has reached
+    decisions: u64,
+    /// PCT priority, higher runs first
+    priority: u64,
+    /// Delays this thread chose, only locked by others to build a schedule
+    log: DelayLog,
+    /// Delays to replay instead of deciding, and the next one to use
+    replay: Option<(Delays, usize)>,
 }
 
-impl StressState {
-    fn new() -> Self {
-        StressState {
-            tracker: ComponentTracker::new(),
-            preemption_counts: FxHashMap::default(),
+impl ThreadStress {
+    fn new(run: u64, thread_id: ThreadId) -> Self {
+        let mut rng = SplitMix64(SEED.load(Ordering::Relaxed) ^ mix(thread_id as u64));
+        let priority = MAX_CHANGE_POINTS as u64 + rng.below(PCT_PRIORITY_LEVELS);
+        let log = DelayLog::default();
+        let mut logs = LOGS.lock();
+        if logs.len() >= MAX_DELAY_LOGS
+            && let Some(exited) = logs.iter().position(|(_, log)| Arc::strong_count(log) == 1)
+        {
+            logs.remove(exited);
+        }
+        logs.push((thread_id, Arc::clone(&log)));
+        drop(logs);
+        let replay = REPLAY.read().as_ref().map(|replay| {
+            let delays = replay.get(&thread_id).cloned().unwrap_or_default();
+            (delays, 0)
+        });
+
+        ThreadStress {
+            run,
+            thread_id,
+            rng,
+            decisions: 0,
+            priority,
+            log,
+            replay,
         }
     }
 
-    fn record_acquisition(&mut self, from_lock: LockId, to_lock: LockId) {
-        self.tracker.record_acquisition(from_lock, to_lock);
+    /// Delay recorded for the current decision point
+    fn replayed_delay(&mut self) -> Option<u64> {
+        let (delays, next) = self.replay.as_mut()?;
+        match delays.get(*next) {
+            Some(&(decision, delay_us)) if decision == self.decisions => {
+                *next += 1;
+                Some(delay_us)
+            }
+            _ => None,
+        }
     }
+}
 
-    fn should_delay_component(&self, from_lock: LockId, to_lock: LockId) -> bool {
-        self.tracker.should_delay(from_lock, to_lock)
+thread_local! {
+    static THREAD_STRESS: RefCell<Option<ThreadStress>> = const { RefCell::new(None) };
+}
+
+/// Scramble a value so that nearby inputs give unrelated outputs
+fn mix(value: u64) -> u64 {
+    SplitMix64(value).next()
+}
+
+/// Start a stress run, resetting all state from the previous one
+///
+/// # Arguments
+/// * `mode` - Stress mode of the run
+/// * `config` - Configuration of the run
+/// * `replay` - Schedule of an earlier run to repeat, if any
+///
+/// # Returns
+/// The seed of the run
+pub(crate) fn begin_run(
+    mode: StressMode,
+    config: &StressConfig,
+    replay: Option<&StressSchedule>,
+) -> u64 {
+    MODE.store(mode as u8, Ordering::Relaxed);
+    let seed = replay
+        .map(|schedule| schedule.seed)
+        .or(config.seed)
+        .unwrap_or_else(rand::random);
+    SEED.store(seed, Ordering::Relaxed);
+
+    let mut rng = SplitMix64(seed);
+    let change_points = config.pct_depth.saturating_sub(1).min(MAX_CHANGE_POINTS);
+    for (index, point) in PCT_CHANGE_POINTS.iter().enumerate() {
+        let step = if index < change_points {
+            1 + rng.below(config.pct_steps.max(1))
+        } else {
+            u64::MAX
+        };
+        point.store(step, Ordering::Relaxed);
     }
+    PCT_STEP.store(0, Ordering::Relaxed);
 
-    fn track_preemption(&mut self, lock_id: LockId) {
-        *self.preemption_counts.entry(lock_id).or_insert(0) += 1;
+    for slot in &COMPONENTS {
+        slot.store(0, Ordering::Relaxed);
     }
+    for word in &EDGES {
+        word.store(0, Ordering::Relaxed);
+    }
+    NEXT_COMPONENT.store(1, Ordering::Relaxed);
+
+    *REPLAY.write() = replay.map(|schedule| {
+        Arc::new(
+            schedule
+                .delays
+                .iter()
+                .map(|(&thread_id, delays)| (thread_id, Arc::from(delays.as_slice())))
+                .collect(),
+        )
+    });
+    LOGS.lock().clear();
+    RUN.fetch_add(1, Ordering::Release);
+    seed
 }
 
-lazy_static::lazy_static! {
-    static ref STRESS_STATE: Mutex<StressState> = Mutex::new(StressState::new());
+/// Environment variable that overrides the stress mode of a run
+pub(crate) const STRESS_MODE_ENV: &str = "DELOXIDE_STRESS_MODE";
+/// Environment variable that overrides the stress seed of a run
+pub(crate) const STRESS_SEED_ENV: &str = "DELOXIDE_STRESS_SEED";
+
+/// Apply the stress mode and seed given in the environment, if any
+///
+/// This lets a campaign runner vary the stress settings of a scenario from
+/// the outside, for Rust and C programs alike. Invalid values are reported
+/// and ignored.
+pub(crate) fn apply_env_overrides(mode: &mut StressMode, config: &mut Option<StressConfig>) {
+    if let Ok(name) = std::env::var(STRESS_MODE_ENV) {
+        match name.parse() {
+            Ok(env_mode) => *mode = env_mode,
+            Err(err) => eprintln!("Ignoring {STRESS_MODE_ENV}: {err}"),
+        }
+    }
+    if let Ok(seed) = std::env::var(STRESS_SEED_ENV) {
+        match seed.parse() {
+            Ok(seed) => config.get_or_insert_with(StressConfig::default).seed = Some(seed),
+            Err(_) => eprintln!("Ignoring {STRESS_SEED_ENV}: invalid seed `{seed}`"),
+        }
+    }
+    if *mode != StressMode::None && config.is_none() {
+        *config = Some(StressConfig::default());
+    }
+}
+
+/// Mode of the current stress run
+pub(crate) fn stress_mode() -> StressMode {
+    StressMode::from_index(MODE.load(Ordering::Relaxed))
+}
+
+/// Seed of the current stress run
+///
+/// Pass it as [`StressConfig::seed`] to repeat the random decisions of a
+/// run, or use [`stress_schedule`] to repeat its delays exactly.
+pub fn stress_seed() -> u64 {
+    SEED.load(Ordering::Relaxed)
+}
+
+/// The delays chosen so far in the current stress run
+///
+/// Take it from the deadlock callback to capture the schedule that led to a
+/// deadlock, then pass it to
+/// [`Deloxide::with_stress_replay`](crate::Deloxide::with_stress_replay).
+///
+/// To bound memory over long runs, only the 1024 most recent delays of each
+/// thread are kept, and threads that exited are forgotten, oldest first,
+/// once 256 threads have logs. A replay repeats the delays it holds at
+/// their decision points and takes no delay at the decisions it lacks.
+pub fn stress_schedule() -> StressSchedule {
+    let mut schedule = StressSchedule {
+        mode: stress_mode(),
+        seed: stress_seed(),
+        delays: BTreeMap::new(),
+    };
+    for (thread_id, log) in LOGS.lock().iter() {
+        let log = log.lock();
+        if !log.is_empty() {
+            schedule
+                .delays
+                .insert(*thread_id, log.iter().copied().collect());
+        }
+    }
+    schedule
 }
 
 /// Apply a delay to the current thread
 pub fn apply_delay(min_us: u64, max_us: u64) {
-    let mut rng = rng();
-    let delay_us = if min_us == max_us {
-        min_us
-    } else {
-        rng.random_range(min_us..=max_us)
-    };
+    let delay_us = with_thread_rng(|rng| rng.between(min_us, max_us));
     thread::sleep(Duration::from_micros(delay_us));
 }
 
+/// Run `f` with the current thread's generator
+fn with_thread_rng<T>(f: impl FnOnce(&mut SplitMix64) -> T) -> T {
+    THREAD_STRESS.with(|state| {
+        let mut state = state.borrow_mut();
+        let state = thread_state(&mut state, crate::core::types::get_current_thread_id());
+        f(&mut state.rng)
+    })
+}
+
+/// The current thread's stress state, (re)initialized for the current run
+fn thread_state(state: &mut Option<ThreadStress>, thread_id: ThreadId) -> &mut ThreadStress {
+    let run = RUN.load(Ordering::Acquire);
+    if state
+        .as_ref()
+        .is_none_or(|state| state.run != run || state.thread_id != thread_id)
+    {
+        *state = Some(ThreadStress::new(run, thread_id));
+    }
+    state.as_mut().unwrap()
+}
+
 /// Perform a random preemption if probability check passes
-#[allow(unused_variables)]
-pub fn try_random_preemption(
-    thread_id: ThreadId,
-    lock_id: LockId,
+fn try_random_preemption(
+    rng: &mut SplitMix64,
     held_locks: &[LockId],
     config: &StressConfig,
 ) -> Option<u64> {
     // Only apply random preemption if the thread already holds locks.
     // This prevents "random backoff" which can desynchronize threads and prevent deadlocks.
-    if held_locks.is_empty() {
-        return None;
-    }
-
-    let prob_int = (config.preemption_probability * 1_000_000.0) as u64;
-    if prob_int == 0 {
+    if held_locks.is_empty() || !rng.chance(config.preemption_probability) {
         return None;
     }
+    Some(rng.between(config.min_delay_us, config.max_delay_us))
+}
 
-    let mut rng = rng();
+/// Slot of a lock in the component table
+fn component_slot(lock_id: LockId) -> &'static AtomicUsize {
+    &COMPONENTS[mix(lock_id as u64) as usize & (COMPONENT_SLOTS - 1)]
+}
 
-    if rng.random_range(0..1_000_000) < prob_int {
-        // Track this preemption
-        let mut state = STRESS_STATE.lock();
-        state.track_preemption(lock_id);
-        drop(state); // Release lock before returning
+/// Bit of an acquisition edge in the edge filter
+fn edge_bit(from_lock: LockId, to_lock: LockId) -> (&'static AtomicU64, u64) {
+    let bit = mix(((from_lock as u64) << 32) ^ to_lock as u64) as usize & (EDGE_BITS - 1);
+    (&EDGES[bit / 64], 1 << (bit % 64))
+}
 
-        // Calculate delay
-        let min_us = config.min_delay_us;
-        let max_us = config.max_delay_us;
+/// Record that a thread holding `from_lock` acquires `to_lock`
+fn record_acquisition(from_lock: LockId, to_lock: LockId) {
+    let (word, mask) = edge_bit(from_lock, to_lock);
+    if word.load(Ordering::Relaxed) & mask == 0 {
+        word.fetch_or(mask, Ordering::Relaxed);
+    }
 
-        let delay_us = if min_us == max_us {
-            min_us
-        } else {
-            rng.random_range(min_us..=max_us)
+    // Assign components (simple approach): a new lock starts its own
+    // component, and a lock first reached from another joins its component
+    let from_slot = component_slot(from_lock);
+    let mut from_comp = from_slot.load(Ordering::Relaxed);
+    if from_comp == 0 {
+        let comp = NEXT_COMPONENT.fetch_add(1, Ordering::Relaxed);
+        from_comp = match from_slot.compare_exchange(0, comp, Ordering::Relaxed, Ordering::Relaxed)
+        {
+            Ok(_) => comp,
+            Err(existing) => existing,
         };
-        Some(delay_us)
-    } else {
-        None
     }
+    let _ = component_slot(to_lock).compare_exchange(
+        0,
+        from_comp,
+        Ordering::Relaxed,
+        Ordering::Relaxed,
+    );
+}
+
+/// Whether acquiring `to_lock` while holding `from_lock` may close a cycle
+fn should_delay_component(from_lock: LockId, to_lock: LockId) -> bool {
+    let from_comp = component_slot(from_lock).load(Ordering::Relaxed);
+    let to_comp = component_slot(to_lock).load(Ordering::Relaxed);
+
+    // If both locks are in the same component (potential cycle)
+    if from_comp == to_comp && from_comp != 0 {
+        return true;
+    }
+
+    // If there's a reverse acquisition pattern
+    let (word, mask) = edge_bit(to_lock, from_lock);
+    word.load(Ordering::Relaxed) & mask != 0
 }
 
 /// Apply component-based delay strategy
-#[allow(unused_variables)]
-pub fn apply_component_delay(
-    thread_id: ThreadId,
+fn apply_component_delay(
+    rng: &mut SplitMix64,
     lock_id: LockId,
     held_locks: &[LockId],
     config: &StressConfig,
 ) -> Option<u64> {
-    if held_locks.is_empty() {
-        return None;
-    }
-
     let mut should_delay = false;
 
     // Check relationships with held locks
-    let mut state = STRESS_STATE.lock();
     for &held_lock in held_locks {
         // Record the acquisition pattern for future analysis
-        state.record_acquisition(held_lock, lock_id);
+        record_acquisition(held_lock, lock_id);
 
         // Check if this acquisition pattern should be delayed
-        if state.should_delay_component(held_lock, lock_id) {
+        if should_delay_component(held_lock, lock_id) {
             should_delay = true;
             break;
         }
     }
 
-    if should_delay {
-        state.track_preemption(lock_id);
-        drop(state); // Release lock before returning
+    should_delay.then(|| rng.between(config.min_delay_us, config.max_delay_us))
+}
 
-        // Calculate delay
-        let min_us = config.min_delay_us;
-        let max_us = config.max_delay_us;
+/// Apply PCT priorities as delays
+fn apply_pct_delay(
+    state: &mut ThreadStress,
+    held_locks: &[LockId],
+    config: &StressConfig,
+) -> Option<u64> {
+    let step = PCT_STEP.fetch_add(1, Ordering::Relaxed) + 1;
+    if let Some(index) = PCT_CHANGE_POINTS
+        .iter()
+        .position(|point| point.load(Ordering::Relaxed) == step)
+    {
+        // Change point `index` gets priority `index`, below every thread
+        // that has not passed a change point yet
+        state.priority = index as u64;
+    }
 
-        let mut rng = rng();
-        let delay_us = if min_us == max_us {
-            min_us
-        } else {
-            rng.random_range(min_us..=max_us)
-        };
-        Some(delay_us)
-    } else {
-        None
+    if held_locks.is_empty() {
+        return None;
     }
+
+    // Scale the delay by how low the priority is: the highest priority
+    // threads run on, a thread just past a change point waits the longest
+    let top = MAX_CHANGE_POINTS as u64 + PCT_PRIORITY_LEVELS;
+    let lowness = (top - state.priority) as f64 / top as f64;
+    let delay_us = (config.max_delay_us as f64 * lowness) as u64;
+    (delay_us >= config.min_delay_us && delay_us > 0).then_some(delay_us)
 }
 
 /// Apply stress testing before lock acquisition
+///
+/// # Returns
+/// The delay in microseconds the current thread should wait, if any
 pub fn calculate_stress_delay(
     mode: StressMode,
     thread_id: ThreadId,
@@ -259,13 +649,94 @@ pub fn calculate_stress_delay(
     held_locks: &[LockId],
     config: &StressConfig,
 ) -> Option<u64> {
-    match mode {
-        StressMode::None => None,
+    if mode == StressMode::None {
+        return None;
+    }
 
-        StressMode::RandomPreemption => {
-            try_random_preemption(thread_id, lock_id, held_locks, config)
+    THREAD_STRESS.with(|state| {
+        let mut state = state.borrow_mut();
+        let state = thread_state(&mut state, thread_id);
+
+        let delay = if state.replay.is_some() {
+            state.replayed_delay()
+        } else {
+            match mode {
+                StressMode::None => None,
+                StressMode::RandomPreemption => {
+                    try_random_preemption(&mut state.rng, held_locks, config)
+                }
+                StressMode::ComponentBased => {
+                    apply_component_delay(&mut state.rng, lock_id, held_locks, config)
+                }
+                StressMode::Pct => apply_pct_delay(state, held_locks, config),
+            }
+        };
+
+        if let Some(delay_us) = delay {
+            let mut log = state.log.lock();
+            if log.len() == DELAY_LOG_CAPACITY {
+                log.pop_front();
+            }
+            log.push_back((state.decisions, delay_us));
+        }
+        state.decisions += 1;
+        delay
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Serializes the tests, as a run's state is global
+    static RUNS: Mutex<()> = Mutex::new(());
+
+    #[test]
+    fn test_seeded_decisions_repeat() {
+        let _run = RUNS.lock();
+        let config = StressConfig {
+            seed: Some(7),
+            ..StressConfig::default()
+        };
+        let decide = || {
+            begin_run(StressMode::RandomPreemption, &config, None);
+            (0..64)
+                .map(|lock_id| {
+                    calculate_stress_delay(StressMode::RandomPreemption, 1, lock_id, &[99], &config)
+                })
+                .collect::<Vec<_>>()
+        };
+
+        let first = decide();
+        assert!(first.iter().any(Option::is_some) && first.iter().any(Option::is_none));
+        assert_eq!(first, decide());
+
+        // The chosen delays form a schedule that survives a text round trip
+        let schedule = stress_schedule();
+        assert_eq!(schedule.mode, StressMode::RandomPreemption);
+        assert_eq!(schedule.seed, 7);
+        let delays = &schedule.delays[&1];
+        assert_eq!(delays.len(), first.iter().flatten().count());
+        assert_eq!(schedule.to_string().parse::<StressSchedule>(), Ok(schedule));
+    }
+
+    #[test]
+    fn test_delay_log_keeps_most_recent_decisions() {
+        let _run = RUNS.lock();
+        let config = StressConfig {
+            seed: Some(11),
+            preemption_probability: 1.0,
+            ..StressConfig::default()
+        };
+        begin_run(StressMode::RandomPreemption, &config, None);
+        let decisions = DELAY_LOG_CAPACITY as u64 + 10;
+        for lock_id in 0..decisions as LockId {
+            calculate_stress_delay(StressMode::RandomPreemption, 2, lock_id, &[99], &config);
         }
 
-        StressMode::ComponentBased => apply_component_delay(thread_id, lock_id, held_locks, config),
+        let delays = &stress_schedule().delays[&2];
+        assert_eq!(delays.len(), DELAY_LOG_CAPACITY);
+        assert_eq!(delays.first().unwrap().0, 10);
+        assert_eq!(delays.last().unwrap().0, decisions - 1);
     }
 }
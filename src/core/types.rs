@@ -1,4 +1,6 @@
+use fxhash::FxHasher;
 use serde::{Deserialize, Serialize};
+use std::hash::{Hash, Hasher};
 use std::sync::atomic::{AtomicUsize, Ordering};
 
 /// Thread identifier type
@@ -13,7 +15,7 @@ static THREAD_ID_COUNTER: AtomicUsize = AtomicUsize::new(1);
 thread_local! {
     static THREAD_ID: ThreadId = {
         // Each thread gets a unique ID once when this is first accessed
-        THREAD_ID_COUNTER.fetch_add(1, Ordering::SeqCst)
+        THREAD_ID_COUNTER.fetch_add(1, Ordering::Relaxed)
     };
 }
 
@@ -23,6 +25,15 @@ pub fn get_current_thread_id() -> ThreadId {
     THREAD_ID.with(|&id| id)
 }
 
+/// Allocate an ID for an async task
+///
+/// Tasks take their IDs from the same counter as threads, so the detector
+/// can treat them as threads of their own.
+#[cfg(feature = "async")]
+pub(crate) fn next_task_id() -> ThreadId {
+    THREAD_ID_COUNTER.fetch_add(1, Ordering::Relaxed)
+}
+
 /// Lock identifier type
 ///
 /// Uniquely identifies a mutex/lock in the application. Each Mutex
@@ -92,11 +103,67 @@ pub enum Events {
     CondvarNotifyAll,
 }
 
+/// Compact event codes, shared by the binary log format and the showcase encoder
+#[cfg(feature = "logging-and-visualization")]
+const EVENT_CODES: [(Events, u8); 21] = [
+    // Thread lifecycle
+    (Events::ThreadSpawn, 0),
+    (Events::ThreadExit, 1),
+    // Mutex lifecycle
+    (Events::MutexSpawn, 2),
+    (Events::MutexExit, 3),
+    // RwLock lifecycle
+    (Events::RwSpawn, 4),
+    (Events::RwExit, 5),
+    // Condvar lifecycle
+    (Events::CondvarSpawn, 6),
+    (Events::CondvarExit, 7),
+    // Mutex interactions
+    (Events::MutexAttempt, 10),
+    (Events::MutexAcquired, 11),
+    (Events::MutexReleased, 12),
+    // RwLock interactions
+    (Events::RwReadAttempt, 20),
+    (Events::RwReadAcquired, 21),
+    (Events::RwReadReleased, 22),
+    (Events::RwWriteAttempt, 23),
+    (Events::RwWriteAcquired, 24),
+    (Events::RwWriteReleased, 25),
+    // Condvar interactions
+    (Events::CondvarWaitBegin, 30),
+    (Events::CondvarWaitEnd, 31),
+    (Events::CondvarNotifyOne, 32),
+    (Events::CondvarNotifyAll, 33),
+];
+
+#[cfg(feature = "logging-and-visualization")]
+impl Events {
+    /// Compact code of this event, as understood by the visualization frontend
+    pub fn code(self) -> u8 {
+        EVENT_CODES
+            .iter()
+            .find(|&&(event, _)| event == self)
+            .map(|&(_, code)| code)
+            .expect("every event has a code")
+    }
+
+    /// Look up the event with the given compact code
+    ///
+    /// # Returns
+    /// The event, or `None` if the code is not assigned
+    pub fn from_code(code: u8) -> Option<Self> {
+        EVENT_CODES
+            .iter()
+            .find(|&&(_, c)| c == code)
+            .map(|&(event, _)| event)
+    }
+}
+
 /// Source of deadlock detection
 ///
 /// Indicates which detection mechanism identified the deadlock and the
 /// level of certainty about the deadlock.
-#[derive(Debug, Clone, Copy, Serialize, Deserialize, PartialEq, Eq)]
+#[derive(Debug, Clone, Copy, Serialize, Deserialize, PartialEq, Eq, Hash)]
 pub enum DeadlockSource {
     /// Deadlock detected via wait-for graph (actual runtime deadlock)
     ///
@@ -145,9 +212,19 @@ pub struct DeadlockInfo {
     /// wait-for cycle, this field contains the cycle of locks that violates the
     /// established lock ordering. For example, if lock 1 -> lock 2 -> lock 3 -> lock 1
     /// forms a cycle, this would be Some(vec![1, 2, 3, 1]).
+    ///
+    /// When lock order checking is keyed by lock class, the cycle holds lock
+    /// class IDs instead and `lock_order_classes` names each of them.
     #[serde(skip_serializing_if = "Option::is_none")]
     pub lock_order_cycle: Option<Vec<LockId>>,
 
+    /// Names of the lock classes in `lock_order_cycle` (class mode only)
+    ///
+    /// Each entry is the `file:line:column` that created the locks of the
+    /// class, or the name given to the class through the C API.
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub lock_order_classes: Option<Vec<String>>,
+
     /// Timestamp when the deadlock was detected
     ///
     /// ISO-8601 formatted timestamp indicating when the deadlock was detected.
@@ -156,6 +233,38 @@ pub struct DeadlockInfo {
     pub verification_request: Option<(LockId, ThreadId)>,
 }
 
+impl DeadlockInfo {
+    /// Identify the locks behind this report, regardless of when and by
+    /// which threads it was detected
+    ///
+    /// The fingerprint hashes the source with the sorted locks (or lock
+    /// classes) of the cycle. It does not depend on where the cycle starts,
+    /// so every repeat of the same lock order violation, and every report of
+    /// a deadlock on the same locks, has the same fingerprint. Reports whose
+    /// fingerprint was already delivered are coalesced by the dispatcher
+    /// (see `report_stats`).
+    ///
+    /// # Returns
+    /// A hash of the source and the locks of the cycle
+    pub fn fingerprint(&self) -> u64 {
+        let mut locks: Vec<LockId> = match &self.lock_order_cycle {
+            Some(cycle) => cycle.clone(),
+            None => self
+                .thread_waiting_for_locks
+                .iter()
+                .map(|&(_, lock)| lock)
+                .collect(),
+        };
+        locks.sort_unstable();
+        locks.dedup();
+
+        let mut hasher = FxHasher::default();
+        self.source.hash(&mut hasher);
+        locks.hash(&mut hasher);
+        hasher.finish()
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
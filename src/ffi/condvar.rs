@@ -1,10 +1,26 @@
 use crate::core::detector::condvar::create_condvar;
 use crate::core::locks::condvar::Condvar;
-use crate::ffi::FFI_GUARD;
+use crate::ffi::lazy::{self, LazyHandle};
+use crate::ffi::mutex::FfiMutex;
 use std::cell::RefCell;
 use std::ffi::{c_int, c_ulong, c_void};
 use std::time::Duration;
 
+const _: () = assert!(
+    lazy::fits_storage::<Condvar>(lazy::COND_STORAGE_SIZE),
+    "Condvar does not fit deloxide_cond_t"
+);
+
+/// Borrow the condition variable behind a C handle, constructing it on first use
+///
+/// # Safety
+/// `handle` must be a live pointer returned by one of the `deloxide_create_condvar*`
+/// functions, or point to a `deloxide_cond_t` that was initialized.
+#[inline]
+unsafe fn condvar_from_handle<'a>(handle: *mut c_void) -> &'a Condvar {
+    unsafe { LazyHandle::get(handle, Condvar::new) }
+}
+
 // Each thread can hold condition variable wait state
 thread_local! {
     static FFI_CONDVAR_WAIT_STATE: RefCell<Option<(*mut c_void, *mut c_void)>> = const { RefCell::new(None) };
@@ -23,8 +39,7 @@ thread_local! {
 /// - Any usage from C must ensure not to free or move the returned pointer by other means.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_create_condvar() -> *mut c_void {
-    let condvar = Box::new(Condvar::new());
-    Box::into_raw(condvar) as *mut c_void
+    LazyHandle::into_raw(Condvar::new())
 }
 
 /// Create a new tracked condition variable with specified creator thread ID.
@@ -45,13 +60,13 @@ pub unsafe extern "C" fn deloxide_create_condvar() -> *mut c_void {
 pub unsafe extern "C" fn deloxide_create_condvar_with_creator(
     _creator_thread_id: usize,
 ) -> *mut c_void {
-    let condvar = Box::new(Condvar::new());
+    let condvar = Condvar::new();
 
     // Register the specified thread as the creator
     // so we just create the condvar normally
     create_condvar(condvar.id());
 
-    Box::into_raw(condvar) as *mut c_void
+    LazyHandle::into_raw(condvar)
 }
 
 /// Destroy a tracked condition variable.
@@ -67,8 +82,53 @@ pub unsafe extern "C" fn deloxide_destroy_condvar(condvar: *mut c_void) {
     if condvar.is_null() {
         return;
     }
-    let _condvar: Box<Condvar> = unsafe { Box::from_raw(condvar as *mut Condvar) };
-    // Drop happens automatically
+    unsafe { LazyHandle::<Condvar>::free(condvar) };
+}
+
+/// Initialize a caller-allocated condition variable.
+///
+/// Equivalent to assigning `DELOXIDE_COND_INITIALIZER`; see `deloxide_mutex_init`.
+///
+/// # Arguments
+/// * `condvar` - Pointer to a `deloxide_cond_t`.
+///
+/// # Returns
+/// * 0 on success
+/// * -1 if condvar is NULL
+///
+/// # Safety
+/// - `condvar` must point to writable, suitably aligned `deloxide_cond_t` storage.
+/// - A condition variable that is already in use must be destroyed with `deloxide_cond_destroy` first.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_cond_init(condvar: *mut c_void) -> c_int {
+    if condvar.is_null() {
+        return -1;
+    }
+
+    unsafe { LazyHandle::<Condvar>::init_in_place(condvar) };
+    0
+}
+
+/// Destroy a caller-allocated condition variable.
+///
+/// # Arguments
+/// * `condvar` - Pointer to a `deloxide_cond_t`.
+///
+/// # Returns
+/// * 0 on success
+/// * -1 if condvar is NULL
+///
+/// # Safety
+/// - `condvar` must point to an initialized `deloxide_cond_t`, not to a handle from `deloxide_create_condvar`.
+/// - No thread may wait on the condition variable during or after this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_cond_destroy(condvar: *mut c_void) -> c_int {
+    if condvar.is_null() {
+        return -1;
+    }
+
+    unsafe { LazyHandle::<Condvar>::destroy_in_place(condvar) };
+    0
 }
 
 /// Wait on a condition variable.
@@ -100,10 +160,11 @@ pub unsafe extern "C" fn deloxide_condvar_wait(condvar: *mut c_void, mutex: *mut
         return -2;
     }
 
-    let condvar_ref = unsafe { &*(condvar as *const Condvar) };
+    let condvar_ref = unsafe { condvar_from_handle(condvar) };
+    let ffi_mutex = unsafe { FfiMutex::from_handle(mutex) };
 
-    // Get the current mutex guard for this specific mutex from thread-local storage
-    let mut guard = match FFI_GUARD.with(|map| map.borrow_mut().remove(&mutex)) {
+    // Take the guard of this thread's acquisition out of the mutex
+    let mut guard = match ffi_mutex.take_guard() {
         Some(guard) => guard,
         None => return -3, // Mutex not held by this thread
     };
@@ -116,10 +177,8 @@ pub unsafe extern "C" fn deloxide_condvar_wait(condvar: *mut c_void, mutex: *mut
     // Perform the wait operation
     condvar_ref.wait(&mut guard);
 
-    // Store the guard back in thread-local storage for this mutex
-    FFI_GUARD.with(|map| {
-        map.borrow_mut().insert(mutex, guard);
-    });
+    // The mutex is held again, so the guard goes back next to it
+    ffi_mutex.restore_guard(guard);
 
     // Clear wait state
     FFI_CONDVAR_WAIT_STATE.with(|cell| {
@@ -164,10 +223,11 @@ pub unsafe extern "C" fn deloxide_condvar_wait_timeout(
         return -2;
     }
 
-    let condvar_ref = unsafe { &*(condvar as *const Condvar) };
+    let condvar_ref = unsafe { condvar_from_handle(condvar) };
+    let ffi_mutex = unsafe { FfiMutex::from_handle(mutex) };
 
-    // Get the current mutex guard for this specific mutex from thread-local storage
-    let mut guard = match FFI_GUARD.with(|map| map.borrow_mut().remove(&mutex)) {
+    // Take the guard of this thread's acquisition out of the mutex
+    let mut guard = match ffi_mutex.take_guard() {
         Some(guard) => guard,
         None => return -3, // Mutex not held by this thread
     };
@@ -181,10 +241,8 @@ pub unsafe extern "C" fn deloxide_condvar_wait_timeout(
     let timeout = Duration::from_millis(timeout_ms);
     let timed_out = condvar_ref.wait_timeout(&mut guard, timeout);
 
-    // Store the guard back in thread-local storage for this mutex
-    FFI_GUARD.with(|map| {
-        map.borrow_mut().insert(mutex, guard);
-    });
+    // The mutex is held again, so the guard goes back next to it
+    ffi_mutex.restore_guard(guard);
 
     // Clear wait state
     FFI_CONDVAR_WAIT_STATE.with(|cell| {
@@ -218,7 +276,7 @@ pub unsafe extern "C" fn deloxide_condvar_notify_one(condvar: *mut c_void) -> c_
         return -1;
     }
 
-    let condvar_ref = unsafe { &*(condvar as *const Condvar) };
+    let condvar_ref = unsafe { condvar_from_handle(condvar) };
     condvar_ref.notify_one();
     0
 }
@@ -243,7 +301,7 @@ pub unsafe extern "C" fn deloxide_condvar_notify_all(condvar: *mut c_void) -> c_
         return -1;
     }
 
-    let condvar_ref = unsafe { &*(condvar as *const Condvar) };
+    let condvar_ref = unsafe { condvar_from_handle(condvar) };
     condvar_ref.notify_all();
     0
 }
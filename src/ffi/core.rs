@@ -1,15 +1,28 @@
+use crate::Sampling;
 use crate::core::detector;
 #[cfg(feature = "logging-and-visualization")]
 use crate::core::logger;
-use crate::ffi::{DEADLOCK_CALLBACK, DEADLOCK_DETECTED, INITIALIZED, IS_LOGGING_ENABLED};
+use crate::core::sampling;
+use crate::ffi::deadlock_info::ReportBuffer;
+use crate::ffi::{
+    DEADLOCK_CALLBACK, DEADLOCK_DETECTED, DEADLOCK_INFO_CALLBACK, DEFERRED_DETECTION_MS,
+    DETECTION_OFF, INITIALIZED, IS_LOGGING_ENABLED, SAMPLING,
+};
 use std::ffi::{CStr, CString};
 use std::os::raw::{c_char, c_int};
 use std::sync::atomic::Ordering;
+use std::time::Duration;
 
+#[cfg(feature = "lock-order-graph")]
+use crate::ffi::LOCK_ORDER_MODE;
+#[cfg(feature = "lock-stats")]
+use crate::ffi::LOCK_STATS;
+#[cfg(feature = "logging-and-visualization")]
+use crate::ffi::{FLIGHT_RECORDER_CAPACITY, FLIGHT_RECORDER_PER_THREAD, LOG_FORMAT};
 #[cfg(feature = "stress-test")]
-use crate::StressMode;
+use crate::ffi::{STRESS_CONFIG, STRESS_MODE, STRESS_SEED};
 #[cfg(feature = "stress-test")]
-use crate::ffi::{STRESS_CONFIG, STRESS_MODE};
+use crate::{StressConfig, StressMode};
 
 /// Initialize deloxide.
 ///
@@ -59,7 +72,21 @@ pub unsafe extern "C" fn deloxide_init(
 
         #[cfg(feature = "logging-and-visualization")]
         let logger = if let Some(log_path) = log_path_option {
-            match logger::EventLogger::with_file(log_path) {
+            let format = match LOG_FORMAT.load(Ordering::SeqCst) {
+                1 => logger::LogFormat::Binary,
+                _ => logger::LogFormat::Json,
+            };
+            let capacity = FLIGHT_RECORDER_CAPACITY.load(Ordering::SeqCst);
+            let result = if capacity == 0 {
+                logger::EventLogger::with_file_and_format(log_path, format)
+            } else if FLIGHT_RECORDER_PER_THREAD.load(Ordering::SeqCst) {
+                let capacity = logger::RecorderCapacity::PerThread(capacity);
+                logger::EventLogger::with_flight_recorder(log_path, format, capacity)
+            } else {
+                let capacity = logger::RecorderCapacity::Total(capacity);
+                logger::EventLogger::with_flight_recorder(log_path, format, capacity)
+            };
+            match result {
                 Ok(logger) => {
                     IS_LOGGING_ENABLED.store(true, Ordering::SeqCst);
                     Some(logger)
@@ -79,11 +106,22 @@ pub unsafe extern "C" fn deloxide_init(
             IS_LOGGING_ENABLED.store(false, Ordering::SeqCst);
         }
 
+        // The structured callback's buffer is allocated here, never per report
+        let info_callback = DEADLOCK_INFO_CALLBACK
+            .lock()
+            .map(|callback| (callback, parking_lot::Mutex::new(ReportBuffer::new())));
+
         // Create callback closure that sets flag and calls C callback
         let deadlock_callback = move |deadlock_info| {
             #[allow(static_mut_refs)]
             DEADLOCK_DETECTED.store(true, Ordering::SeqCst);
 
+            if let Some((callback, buffer)) = &info_callback {
+                let mut buffer = buffer.lock();
+                let report = buffer.report(&deadlock_info);
+                callback(&report);
+            }
+
             // Call C callback if provided
             if let Some(cb) = DEADLOCK_CALLBACK {
                 // Format deadlock info as JSON
@@ -100,7 +138,17 @@ pub unsafe extern "C" fn deloxide_init(
         let config = detector::DetectorConfig {
             callback: Box::new(deadlock_callback),
             #[cfg(feature = "lock-order-graph")]
-            check_lock_order: false, // FFI doesn't support lock order checking
+            check_lock_order: LOCK_ORDER_MODE.load(Ordering::SeqCst) != 0,
+            #[cfg(feature = "lock-order-graph")]
+            lock_order_by_class: LOCK_ORDER_MODE.load(Ordering::SeqCst) == 2,
+            sampling: SAMPLING.lock().take(),
+            deferred_detection: match DEFERRED_DETECTION_MS.load(Ordering::SeqCst) {
+                0 => None,
+                ms => Some(Duration::from_millis(ms)),
+            },
+            detection: !DETECTION_OFF.load(Ordering::SeqCst),
+            #[cfg(feature = "lock-stats")]
+            lock_stats: LOCK_STATS.load(Ordering::SeqCst),
             #[cfg(feature = "stress-test")]
             stress_mode: {
                 #[cfg(feature = "stress-test")]
@@ -108,6 +156,7 @@ pub unsafe extern "C" fn deloxide_init(
                     match STRESS_MODE.load(Ordering::SeqCst) {
                         1 => StressMode::RandomPreemption,
                         2 => StressMode::ComponentBased,
+                        3 => StressMode::Pct,
                         _ => StressMode::None,
                     }
                 }
@@ -125,13 +174,18 @@ pub unsafe extern "C" fn deloxide_init(
                 #[cfg(feature = "stress-test")]
                 {
                     #[allow(static_mut_refs)]
-                    STRESS_CONFIG.take()
+                    STRESS_CONFIG.take().map(|config| StressConfig {
+                        seed: STRESS_SEED.lock().take().or(config.seed),
+                        ..config
+                    })
                 }
                 #[cfg(not(feature = "stress-test"))]
                 {
                     None
                 }
             },
+            #[cfg(feature = "stress-test")]
+            stress_replay: None,
             #[cfg(feature = "logging-and-visualization")]
             logger,
         };
@@ -144,6 +198,288 @@ pub unsafe extern "C" fn deloxide_init(
     }
 }
 
+/// Select the on-disk format of the log file (only with "logging-and-visualization" feature)
+///
+/// Must be called before `deloxide_init`, which creates the log file.
+///
+/// # Arguments
+/// * `format` - `0` for JSON lines (the default), `1` for the compact binary format
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-1` if logging-and-visualization feature is not enabled
+/// * `-2` if the format is unknown
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_set_log_format(format: c_int) -> c_int {
+    #[cfg(feature = "logging-and-visualization")]
+    {
+        if INITIALIZED.load(Ordering::SeqCst) {
+            return 1; // Already initialized
+        }
+        if !(0..=1).contains(&format) {
+            return -2; // Unknown format
+        }
+
+        LOG_FORMAT.store(format as u8, Ordering::SeqCst);
+        0
+    }
+
+    #[cfg(not(feature = "logging-and-visualization"))]
+    {
+        // Return error if logging feature is not enabled
+        -1
+    }
+}
+
+/// Enable flight-recorder logging (only with "logging-and-visualization" feature)
+///
+/// Instead of streaming every event to the log file, keep only the most
+/// recent events in memory. The file passed to `deloxide_init` is written
+/// when a deadlock is detected or `deloxide_flush_logs` is called.
+/// Must be called before `deloxide_init`.
+///
+/// # Arguments
+/// * `capacity` - Number of recent events to keep (must be non-zero)
+/// * `per_thread` - Non-zero to keep `capacity` events for each thread instead of in total
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-1` if logging-and-visualization feature is not enabled
+/// * `-2` if `capacity` is zero
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_enable_flight_recorder(
+    capacity: usize,
+    per_thread: c_int,
+) -> c_int {
+    #[cfg(feature = "logging-and-visualization")]
+    {
+        if INITIALIZED.load(Ordering::SeqCst) {
+            return 1; // Already initialized
+        }
+        if capacity == 0 {
+            return -2; // Nothing to record
+        }
+
+        FLIGHT_RECORDER_PER_THREAD.store(per_thread != 0, Ordering::SeqCst);
+        FLIGHT_RECORDER_CAPACITY.store(capacity, Ordering::SeqCst);
+        0
+    }
+
+    #[cfg(not(feature = "logging-and-visualization"))]
+    {
+        // Return error if logging feature is not enabled
+        -1
+    }
+}
+
+/// Enable lock order checking (only with "lock-order-graph" feature)
+///
+/// When enabled, the detector reports inconsistent lock acquisition orders
+/// as potential deadlocks, even if no thread is blocked yet. Must be called
+/// before `deloxide_init`.
+///
+/// # Arguments
+/// * `by_class` - If non-zero, key the ordering by lock class instead of by
+///   lock instance (see `deloxide_create_mutex_with_class`)
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-1` if lock-order-graph feature is not enabled
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_enable_lock_order_checking(by_class: c_int) -> c_int {
+    #[cfg(feature = "lock-order-graph")]
+    {
+        if INITIALIZED.load(Ordering::SeqCst) {
+            return 1; // Already initialized
+        }
+
+        LOCK_ORDER_MODE.store(if by_class != 0 { 2 } else { 1 }, Ordering::SeqCst);
+        0
+    }
+
+    #[cfg(not(feature = "lock-order-graph"))]
+    {
+        // Return error if lock-order-graph feature is not enabled
+        -1
+    }
+}
+
+/// Track only the lock acquisitions of a fraction of threads
+///
+/// Acquisitions made by unsampled threads skip deadlock detection, lock order
+/// checking and logging. Must be called before `deloxide_init`. Replaces any
+/// sampling configured earlier.
+///
+/// # Arguments
+/// * `rate` - Fraction of threads to track, in (0.0, 1.0]
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-2` if `rate` is out of range
+///
+/// # Safety
+/// This function only writes to a global behind a lock and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_enable_thread_sampling(rate: f64) -> c_int {
+    set_sampling(Sampling::Threads(rate))
+}
+
+/// Track only the acquisitions of a fraction of locks
+///
+/// Acquisitions of unsampled locks skip deadlock detection, lock order
+/// checking and logging. Must be called before `deloxide_init`. Replaces any
+/// sampling configured earlier.
+///
+/// # Arguments
+/// * `rate` - Fraction of locks to track, in (0.0, 1.0]
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-2` if `rate` is out of range
+///
+/// # Safety
+/// This function only writes to a global behind a lock and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_enable_lock_sampling(rate: f64) -> c_int {
+    set_sampling(Sampling::Locks(rate))
+}
+
+/// Track lock acquisitions only during periodic windows
+///
+/// Every acquisition is tracked for `on_ms` milliseconds, then none for
+/// `off_ms` milliseconds, and so on. Must be called before `deloxide_init`.
+/// Replaces any sampling configured earlier.
+///
+/// # Arguments
+/// * `on_ms` - Length of each tracked window in milliseconds (must be non-zero)
+/// * `off_ms` - Length of each untracked gap in milliseconds
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-2` if `on_ms` is zero
+///
+/// # Safety
+/// This function only writes to a global behind a lock and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_enable_window_sampling(on_ms: u64, off_ms: u64) -> c_int {
+    set_sampling(Sampling::Windows {
+        on: Duration::from_millis(on_ms),
+        off: Duration::from_millis(off_ms),
+    })
+}
+
+/// Defer cycle detection until a thread has been blocked for a while
+///
+/// Contended acquisitions only record what they wait for. A thread that is
+/// still blocked after `threshold_ms` milliseconds searches for a deadlock
+/// through itself. Must be called before `deloxide_init`.
+///
+/// # Arguments
+/// * `threshold_ms` - How long a thread blocks before checking, in milliseconds (must be non-zero)
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-2` if `threshold_ms` is zero
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_enable_deferred_detection(threshold_ms: u64) -> c_int {
+    if INITIALIZED.load(Ordering::SeqCst) {
+        return 1; // Already initialized
+    }
+    if threshold_ms == 0 {
+        return -2; // Would check immediately
+    }
+
+    DEFERRED_DETECTION_MS.store(threshold_ms, Ordering::SeqCst);
+    0
+}
+
+/// Store a sampling configuration for `deloxide_init`
+fn set_sampling(sampling: Sampling) -> c_int {
+    if INITIALIZED.load(Ordering::SeqCst) {
+        return 1; // Already initialized
+    }
+    if !sampling.is_valid() {
+        return -2; // Invalid rate or window
+    }
+
+    *SAMPLING.lock() = Some(sampling);
+    0
+}
+
+/// Switch deadlock detection on
+///
+/// Before `deloxide_init` this undoes `deloxide_disable_detection`. After it,
+/// lock operations are tracked again from the next acquisition on, and locks
+/// held in the meantime are handed over to the detector when released.
+///
+/// # Returns
+/// * `0` on success
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_enable_detection() -> c_int {
+    DETECTION_OFF.store(false, Ordering::SeqCst);
+    if INITIALIZED.load(Ordering::SeqCst) {
+        sampling::enable_detection();
+    }
+    0
+}
+
+/// Switch deadlock detection off
+///
+/// Before `deloxide_init` this makes the detector start with detection off.
+/// While it is off, lock operations skip the detector entirely.
+///
+/// # Returns
+/// * `0` on success
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_disable_detection() -> c_int {
+    DETECTION_OFF.store(true, Ordering::SeqCst);
+    if INITIALIZED.load(Ordering::SeqCst) {
+        sampling::disable_detection();
+    }
+    0
+}
+
+/// Check whether deadlock detection is switched on
+///
+/// # Returns
+/// * `1` if lock operations are being tracked
+/// * `0` if detection is off, or the detector has not been initialized
+///
+/// # Safety
+/// This function only reads atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_is_detection_enabled() -> c_int {
+    sampling::is_detection_enabled() as c_int
+}
+
 /// Check if a deadlock has been detected.
 ///
 /// This function returns whether the deadlock detector has detected a deadlock
@@ -185,6 +521,36 @@ pub unsafe extern "C" fn deloxide_reset_deadlock_flag() {
     }
 }
 
+/// Get the counters of deadlock reports.
+///
+/// Repeats of a report that was already delivered are coalesced, and reports
+/// are dropped while the callback falls behind.
+///
+/// # Arguments
+/// * `delivered` - Receives the number of reports passed to the callback (may be NULL)
+/// * `coalesced` - Receives the number of repeats that were only counted (may be NULL)
+/// * `dropped` - Receives the number of reports dropped for a full queue (may be NULL)
+///
+/// # Safety
+/// Each non-NULL pointer must be valid for writing a `u64`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_get_report_stats(
+    delivered: *mut u64,
+    coalesced: *mut u64,
+    dropped: *mut u64,
+) {
+    let stats = detector::report_stats();
+    for (out, value) in [
+        (delivered, stats.delivered),
+        (coalesced, stats.coalesced),
+        (dropped, stats.dropped),
+    ] {
+        if !out.is_null() {
+            unsafe { out.write(value) };
+        }
+    }
+}
+
 /// Check if logging is enabled.
 ///
 /// # Returns
@@ -0,0 +1,178 @@
+//! Structured deadlock reports for C callbacks
+//!
+//! The JSON callback of `deloxide_init` allocates a string per report and
+//! leaves the parsing to the C side. The structured callback instead gets a
+//! `deloxide_deadlock_info` whose arrays point into a buffer allocated once
+//! at initialization, so delivering a report allocates nothing. Reports are
+//! delivered one at a time by the dispatcher thread, which is the only user
+//! of the buffer.
+
+use crate::core::types::{DeadlockInfo, DeadlockSource};
+use crate::ffi::{DEADLOCK_INFO_CALLBACK, INITIALIZED};
+use std::os::raw::c_int;
+use std::ptr;
+use std::sync::atomic::Ordering;
+use std::time::Instant;
+
+/// Entries per array of a report (`DELOXIDE_DEADLOCK_INFO_CAPACITY`)
+const CAPACITY: usize = 64;
+
+/// A structured deadlock callback
+pub type DeadlockInfoCallback = extern "C" fn(*const DeloxideDeadlockInfo);
+
+/// A thread and the lock it waits for, as laid out by `deloxide_thread_wait`
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct DeloxideThreadWait {
+    pub thread_id: usize,
+    pub lock_id: usize,
+}
+
+/// A deadlock report, as laid out by `deloxide_deadlock_info`
+#[repr(C)]
+pub struct DeloxideDeadlockInfo {
+    /// `0` for a wait-for cycle, `1` for a lock order violation
+    pub source: c_int,
+    pub thread_cycle: *const usize,
+    pub thread_cycle_len: usize,
+    pub waits: *const DeloxideThreadWait,
+    pub waits_len: usize,
+    /// NULL unless the report is a lock order violation
+    pub lock_order_cycle: *const usize,
+    pub lock_order_cycle_len: usize,
+    /// Nanoseconds since `deloxide_init` on a monotonic clock
+    pub timestamp_ns: u64,
+    /// Non-zero if an array was longer than the buffer and got cut short
+    pub truncated: c_int,
+}
+
+/// Preallocated storage the arrays of a report point into
+pub(crate) struct ReportBuffer {
+    thread_cycle: [usize; CAPACITY],
+    waits: [DeloxideThreadWait; CAPACITY],
+    lock_order_cycle: [usize; CAPACITY],
+    /// Time of `deloxide_init`, the origin of `timestamp_ns`
+    epoch: Instant,
+}
+
+/// Copy as much of `source` into `target` as fits
+///
+/// # Returns
+/// The number of entries copied and whether the source was longer
+fn fill<T>(target: &mut [T], source: impl ExactSizeIterator<Item = T>) -> (usize, bool) {
+    let truncated = source.len() > target.len();
+    let mut copied = 0;
+    for (slot, value) in target.iter_mut().zip(source) {
+        *slot = value;
+        copied += 1;
+    }
+    (copied, truncated)
+}
+
+impl ReportBuffer {
+    pub(crate) fn new() -> Box<Self> {
+        Box::new(ReportBuffer {
+            thread_cycle: [0; CAPACITY],
+            waits: [DeloxideThreadWait {
+                thread_id: 0,
+                lock_id: 0,
+            }; CAPACITY],
+            lock_order_cycle: [0; CAPACITY],
+            epoch: Instant::now(),
+        })
+    }
+
+    /// Copy a deadlock into the buffer and describe it for C
+    ///
+    /// The returned report borrows the buffer and is only valid until the
+    /// next call.
+    pub(crate) fn report(&mut self, info: &DeadlockInfo) -> DeloxideDeadlockInfo {
+        let (thread_cycle_len, cycle_cut) =
+            fill(&mut self.thread_cycle, info.thread_cycle.iter().copied());
+        let (waits_len, waits_cut) = fill(
+            &mut self.waits,
+            info.thread_waiting_for_locks
+                .iter()
+                .map(|&(thread_id, lock_id)| DeloxideThreadWait { thread_id, lock_id }),
+        );
+        let (lock_order_cycle, lock_order_cycle_len, order_cut) = match &info.lock_order_cycle {
+            Some(cycle) => {
+                let (len, cut) = fill(&mut self.lock_order_cycle, cycle.iter().copied());
+                (self.lock_order_cycle.as_ptr(), len, cut)
+            }
+            None => (ptr::null(), 0, false),
+        };
+
+        DeloxideDeadlockInfo {
+            source: match info.source {
+                DeadlockSource::WaitForGraph => 0,
+                DeadlockSource::LockOrderViolation => 1,
+            },
+            thread_cycle: self.thread_cycle.as_ptr(),
+            thread_cycle_len,
+            waits: self.waits.as_ptr(),
+            waits_len,
+            lock_order_cycle,
+            lock_order_cycle_len,
+            timestamp_ns: self.epoch.elapsed().as_nanos() as u64,
+            truncated: (cycle_cut || waits_cut || order_cut) as c_int,
+        }
+    }
+}
+
+/// Register a callback that receives deadlocks as structs instead of JSON
+///
+/// The report and its arrays are only valid during the callback; copy what
+/// you need to keep. Delivering a report allocates nothing, which makes the
+/// callback suitable for triggering core dumps or recovery under memory
+/// pressure. It is invoked in addition to the JSON callback given to
+/// `deloxide_init`, if any. Must be called before `deloxide_init`.
+///
+/// # Arguments
+/// * `callback` - Function to call for each deadlock, or NULL to remove it
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+///
+/// # Safety
+/// `callback` must be safe to call from the detector's dispatcher thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_set_deadlock_info_callback(
+    callback: Option<DeadlockInfoCallback>,
+) -> c_int {
+    if INITIALIZED.load(Ordering::SeqCst) {
+        return 1; // Already initialized
+    }
+
+    *DEADLOCK_INFO_CALLBACK.lock() = callback;
+    0
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_report_points_into_buffer_and_truncates() {
+        let mut buffer = ReportBuffer::new();
+        let info = DeadlockInfo {
+            source: DeadlockSource::WaitForGraph,
+            thread_cycle: (1..=CAPACITY + 5).collect(),
+            thread_waiting_for_locks: vec![(1, 10), (2, 20)],
+            lock_order_cycle: None,
+            lock_order_classes: None,
+            timestamp: String::new(),
+            verification_request: None,
+        };
+
+        let report = buffer.report(&info);
+        assert_eq!(report.source, 0);
+        assert_eq!(report.thread_cycle_len, CAPACITY);
+        assert_eq!(report.truncated, 1);
+        assert!(report.lock_order_cycle.is_null());
+        let waits = unsafe { std::slice::from_raw_parts(report.waits, report.waits_len) };
+        assert_eq!(waits[1].thread_id, 2);
+        assert_eq!(waits[1].lock_id, 20);
+    }
+}
@@ -0,0 +1,180 @@
+//! In-place storage for C lock objects
+//!
+//! C code embeds `deloxide_mutex_t`, `deloxide_rwlock_t` and `deloxide_cond_t`
+//! directly in its structs and initializes globals with all-zero static
+//! initializers, so the Rust object behind a handle cannot be constructed
+//! up front. A [`LazyHandle`] is a state byte followed by uninitialized room
+//! for the object: all-zero bytes are a valid, not yet constructed handle,
+//! and the object (including its lock ID and detector registration) is
+//! constructed on first use.
+//!
+//! Handles returned by the `deloxide_create_*` functions use the same layout,
+//! already constructed, so every lock function accepts both kinds of handle.
+
+use std::cell::UnsafeCell;
+use std::ffi::c_void;
+use std::mem::MaybeUninit;
+use std::sync::atomic::{AtomicU8, Ordering};
+
+/// Size of `deloxide_mutex_t` in `include/deloxide.h`
+pub(crate) const MUTEX_STORAGE_SIZE: usize = 128;
+/// Size of `deloxide_rwlock_t` in `include/deloxide.h`
+pub(crate) const RWLOCK_STORAGE_SIZE: usize = 128;
+/// Size of `deloxide_cond_t` in `include/deloxide.h`
+pub(crate) const COND_STORAGE_SIZE: usize = 32;
+/// Alignment of the C storage types
+pub(crate) const STORAGE_ALIGN: usize = 8;
+
+/// The object has not been constructed (all-zero storage)
+const UNINIT: u8 = 0;
+/// One thread is constructing the object
+const INITIALIZING: u8 = 1;
+/// The object is constructed and ready for use
+const READY: u8 = 2;
+
+/// A C lock object constructed on first use
+#[repr(C)]
+pub(crate) struct LazyHandle<T> {
+    state: AtomicU8,
+    value: UnsafeCell<MaybeUninit<T>>,
+}
+
+impl<T> LazyHandle<T> {
+    /// Move an already constructed object to the heap and return its C handle
+    pub(crate) fn into_raw(value: T) -> *mut c_void {
+        let handle = Box::new(LazyHandle {
+            state: AtomicU8::new(READY),
+            value: UnsafeCell::new(MaybeUninit::new(value)),
+        });
+        Box::into_raw(handle) as *mut c_void
+    }
+
+    /// Free a handle returned by [`LazyHandle::into_raw`]
+    ///
+    /// # Safety
+    /// `handle` must come from `into_raw` and must not be used afterwards.
+    pub(crate) unsafe fn free(handle: *mut c_void) {
+        drop(unsafe { Box::from_raw(handle as *mut LazyHandle<T>) });
+    }
+
+    /// Reset caller-owned storage to the not yet constructed state
+    ///
+    /// # Safety
+    /// `storage` must point to writable storage of the C type for `T`. Any
+    /// object it held previously is leaked, not dropped.
+    pub(crate) unsafe fn init_in_place(storage: *mut c_void) {
+        unsafe { (*(storage as *mut LazyHandle<T>)).state = AtomicU8::new(UNINIT) };
+    }
+
+    /// Drop the object in caller-owned storage, if it was ever constructed
+    ///
+    /// The storage is left in the not yet constructed state and can be used
+    /// again.
+    ///
+    /// # Safety
+    /// `storage` must be a handle that no other thread is using.
+    pub(crate) unsafe fn destroy_in_place(storage: *mut c_void) {
+        let handle = unsafe { &mut *(storage as *mut LazyHandle<T>) };
+        if *handle.state.get_mut() == READY {
+            unsafe { handle.value.get_mut().assume_init_drop() };
+        }
+        *handle.state.get_mut() = UNINIT;
+    }
+
+    /// Get the object behind a handle, constructing it on first use
+    ///
+    /// # Safety
+    /// `handle` must be a live handle of the C type for `T`.
+    #[inline]
+    pub(crate) unsafe fn get<'a>(handle: *mut c_void, init: impl FnOnce() -> T) -> &'a T {
+        let handle = unsafe { &*(handle as *const LazyHandle<T>) };
+        if handle.state.load(Ordering::Acquire) != READY {
+            handle.construct(init);
+        }
+        // Safety: the state is READY, so the value is initialized
+        unsafe { (*handle.value.get()).assume_init_ref() }
+    }
+
+    /// Construct the object, or wait for the thread that is constructing it
+    #[cold]
+    fn construct(&self, init: impl FnOnce() -> T) {
+        match self.state.compare_exchange(
+            UNINIT,
+            INITIALIZING,
+            Ordering::Acquire,
+            Ordering::Acquire,
+        ) {
+            Ok(_) => {
+                // Safety: winning the exchange grants exclusive access to the value
+                unsafe { (*self.value.get()).write(init()) };
+                self.state.store(READY, Ordering::Release);
+            }
+            Err(_) => {
+                while self.state.load(Ordering::Acquire) != READY {
+                    std::thread::yield_now();
+                }
+            }
+        }
+    }
+}
+
+impl<T> Drop for LazyHandle<T> {
+    fn drop(&mut self) {
+        if *self.state.get_mut() == READY {
+            // Safety: the state is READY, so the value is initialized
+            unsafe { self.value.get_mut().assume_init_drop() };
+        }
+    }
+}
+
+/// Check at compile time that `LazyHandle<T>` fits the C storage type
+pub(crate) const fn fits_storage<T>(size: usize) -> bool {
+    std::mem::size_of::<LazyHandle<T>>() <= size
+        && std::mem::align_of::<LazyHandle<T>>() <= STORAGE_ALIGN
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::AtomicUsize;
+
+    static CONSTRUCTED: AtomicUsize = AtomicUsize::new(0);
+
+    struct Counted(usize);
+
+    impl Drop for Counted {
+        fn drop(&mut self) {
+            CONSTRUCTED.fetch_sub(1, Ordering::SeqCst);
+        }
+    }
+
+    fn counted() -> Counted {
+        Counted(CONSTRUCTED.fetch_add(1, Ordering::SeqCst) + 1)
+    }
+
+    #[test]
+    fn test_zeroed_storage_is_constructed_once() {
+        // What a static initializer produces
+        let mut storage = [0u64; MUTEX_STORAGE_SIZE / 8];
+        let handle = storage.as_mut_ptr() as *mut c_void;
+
+        let threads: Vec<_> = (0..4)
+            .map(|_| {
+                let handle = handle as usize;
+                std::thread::spawn(move || unsafe {
+                    LazyHandle::get(handle as *mut c_void, counted).0
+                })
+            })
+            .collect();
+        let values: Vec<_> = threads.into_iter().map(|t| t.join().unwrap()).collect();
+        assert!(values.windows(2).all(|w| w[0] == w[1]));
+        assert_eq!(CONSTRUCTED.load(Ordering::SeqCst), 1);
+
+        // Destroying drops the object and allows a fresh one afterwards
+        unsafe { LazyHandle::<Counted>::destroy_in_place(handle) };
+        assert_eq!(CONSTRUCTED.load(Ordering::SeqCst), 0);
+        unsafe { LazyHandle::get(handle, counted) };
+        assert_eq!(CONSTRUCTED.load(Ordering::SeqCst), 1);
+        unsafe { LazyHandle::<Counted>::destroy_in_place(handle) };
+    }
+}
@@ -8,25 +8,23 @@
 /// including initialization, mutex tracking, thread tracking, and deadlock detection.
 mod condvar;
 mod core;
+mod deadlock_info;
+mod lazy;
 mod mutex;
+#[cfg(all(feature = "preload", target_os = "linux"))]
+#[doc(hidden)]
+pub mod preload;
 mod rwlock;
+#[cfg(unix)]
+mod shared;
 #[cfg(feature = "logging-and-visualization")]
 mod showcase;
+mod stats;
 mod stress;
 mod thread;
 
-use crate::core::locks::mutex::MutexGuard;
-use std::cell::RefCell;
-use std::collections::HashMap;
-use std::ffi::c_void;
 use std::os::raw::c_char;
-use std::sync::atomic::AtomicBool;
-
-// We'll keep each Rust guard alive here until the C code calls unlock.
-thread_local! {
-    // Each thread can hold multiple mutex guards at a time, keyed by the raw mutex pointer
-    static FFI_GUARD: RefCell<HashMap<*mut c_void, MutexGuard<'static, ()>>> = RefCell::new(HashMap::new());
-}
+use std::sync::atomic::{AtomicBool, AtomicU64};
 
 // Globals to track initialization state
 static INITIALIZED: AtomicBool = AtomicBool::new(false);
@@ -36,12 +34,46 @@ static IS_LOGGING_ENABLED: AtomicBool = AtomicBool::new(false);
 // Optional callback function provided by C code
 static mut DEADLOCK_CALLBACK: Option<extern "C" fn(*const c_char)> = None;
 
+// Optional structured callback, registered before deloxide_init
+static DEADLOCK_INFO_CALLBACK: parking_lot::Mutex<Option<deadlock_info::DeadlockInfoCallback>> =
+    parking_lot::Mutex::new(None);
+
+// Sampling configuration applied by deloxide_init (None tracks everything)
+static SAMPLING: parking_lot::Mutex<Option<crate::Sampling>> = parking_lot::Mutex::new(None);
+
+// Deferred detection threshold applied by deloxide_init (0 checks immediately)
+static DEFERRED_DETECTION_MS: AtomicU64 = AtomicU64::new(0);
+
+// Whether deloxide_init starts with detection switched off
+static DETECTION_OFF: AtomicBool = AtomicBool::new(false);
+
 #[cfg(feature = "stress-test")]
 use crate::StressConfig;
-#[cfg(feature = "stress-test")]
+#[cfg(any(
+    feature = "stress-test",
+    feature = "lock-order-graph",
+    feature = "logging-and-visualization"
+))]
 use std::sync::atomic::AtomicU8;
+#[cfg(feature = "logging-and-visualization")]
+use std::sync::atomic::AtomicUsize;
 
 #[cfg(feature = "stress-test")]
-static STRESS_MODE: AtomicU8 = AtomicU8::new(0); // 0=None, 1=Random, 2=Component
+static STRESS_MODE: AtomicU8 = AtomicU8::new(0); // 0=None, 1=Random, 2=Component, 3=PCT
 #[cfg(feature = "stress-test")]
 static mut STRESS_CONFIG: Option<StressConfig> = None;
+#[cfg(feature = "stress-test")]
+static STRESS_SEED: parking_lot::Mutex<Option<u64>> = parking_lot::Mutex::new(None);
+
+#[cfg(feature = "lock-order-graph")]
+static LOCK_ORDER_MODE: AtomicU8 = AtomicU8::new(0); // 0=Off, 1=Per lock, 2=Per class
+
+#[cfg(feature = "lock-stats")]
+static LOCK_STATS: AtomicBool = AtomicBool::new(false);
+
+#[cfg(feature = "logging-and-visualization")]
+static LOG_FORMAT: AtomicU8 = AtomicU8::new(0); // 0=JSON, 1=Binary
+#[cfg(feature = "logging-and-visualization")]
+static FLIGHT_RECORDER_CAPACITY: AtomicUsize = AtomicUsize::new(0); // 0=Stream every event
+#[cfg(feature = "logging-and-visualization")]
+static FLIGHT_RECORDER_PER_THREAD: AtomicBool = AtomicBool::new(false);
@@ -1,8 +1,162 @@
 use crate::core::detector::mutex::create_mutex;
-use crate::ffi::FFI_GUARD;
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+use crate::core::detector::{self, lock_class::LockClass};
+use crate::core::locks::mutex::{MutexGuard, lock_distinct};
+use crate::core::types::get_current_thread_id;
+use crate::ffi::lazy::{self, LazyHandle};
 use crate::{Mutex, ThreadId};
+use std::cell::UnsafeCell;
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+use std::ffi::CStr;
 use std::ffi::c_void;
-use std::os::raw::c_int;
+use std::os::raw::{c_char, c_int, c_ulong};
+use std::time::Duration;
+
+/// Object behind a C mutex handle
+///
+/// A mutex has at most one owner, so the guard of the current acquisition is
+/// kept next to the lock itself. Lock and unlock need no per-thread lookup:
+/// only the thread that holds the mutex ever touches the guard slot.
+pub(crate) struct FfiMutex {
+    /// Guard of the current owner, `None` while unlocked. Declared first so
+    /// that it is dropped before the mutex it borrows.
+    guard: UnsafeCell<Option<MutexGuard<'static, ()>>>,
+    mutex: Mutex<()>,
+}
+
+// Safety: `guard` is only accessed by the thread that holds `mutex`, and the
+// lock's acquire/release ordering hands it from one owner to the next.
+unsafe impl Sync for FfiMutex {}
+
+impl Drop for FfiMutex {
+    fn drop(&mut self) {
+        // C code may destroy a mutex that a (deadlocked) thread still holds.
+        // Releasing it here would let a blocked thread acquire freed memory,
+        // so the stale guard is leaked and its waiters stay blocked.
+        if let Some(guard) = self.guard.get_mut().take() {
+            std::mem::forget(guard);
+        }
+    }
+}
+
+const _: () = assert!(
+    lazy::fits_storage::<FfiMutex>(lazy::MUTEX_STORAGE_SIZE),
+    "FfiMutex does not fit deloxide_mutex_t"
+);
+
+impl FfiMutex {
+    fn new(mutex: Mutex<()>) -> Self {
+        FfiMutex {
+            guard: UnsafeCell::new(None),
+            mutex,
+        }
+    }
+
+    /// Move a mutex to the heap and return its C handle
+    fn into_raw(mutex: Mutex<()>) -> *mut c_void {
+        LazyHandle::into_raw(FfiMutex::new(mutex))
+    }
+
+    /// Construct the mutex of a statically initialized `deloxide_mutex_t`
+    ///
+    /// Runs on the first use of the handle, so that is when the mutex gets
+    /// its ID and the calling thread is recorded as its creator.
+    #[cold]
+    fn lazy() -> Self {
+        let mutex = Mutex::new(());
+        #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+        detector::set_lock_class(mutex.id(), LockClass::Unique);
+        FfiMutex::new(mutex)
+    }
+
+    /// Borrow the mutex behind a C handle, constructing it on first use
+    ///
+    /// # Safety
+    /// `handle` must be a live pointer returned by one of the `deloxide_create_mutex*`
+    /// functions, or point to a `deloxide_mutex_t` that was initialized.
+    #[inline]
+    pub(crate) unsafe fn from_handle<'a>(handle: *mut c_void) -> &'a FfiMutex {
+        unsafe { LazyHandle::get(handle, FfiMutex::lazy) }
+    }
+
+    /// The tracked mutex
+    pub(crate) fn mutex(&self) -> &Mutex<()> {
+        &self.mutex
+    }
+
+    /// Acquire the mutex and keep the guard until `unlock`
+    pub(crate) fn lock(&self) {
+        self.keep_guard(self.mutex.lock());
+    }
+
+    /// Acquire the mutex if it is free
+    ///
+    /// # Returns
+    /// `false` if the mutex is held
+    pub(crate) fn try_lock(&self) -> bool {
+        self.mutex
+            .try_lock()
+            .map(|guard| self.keep_guard(guard))
+            .is_some()
+    }
+
+    /// Acquire the mutex, blocking for at most `timeout`
+    ///
+    /// # Returns
+    /// `false` if the timeout ran out first
+    pub(crate) fn lock_for(&self, timeout: Duration) -> bool {
+        self.mutex
+            .try_lock_for(timeout)
+            .map(|guard| self.keep_guard(guard))
+            .is_some()
+    }
+
+    /// Keep the guard of an acquisition of this mutex until `unlock`
+    fn keep_guard(&self, guard: MutexGuard<'_, ()>) {
+        // Safety: the guard borrows `self.mutex`, which lives as long as the
+        // handle, and it is dropped before the mutex (see field order).
+        // We hold the mutex, so no other thread accesses the slot.
+        unsafe {
+            *self.guard.get() = Some(std::mem::transmute::<
+                MutexGuard<'_, ()>,
+                MutexGuard<'static, ()>,
+            >(guard));
+        }
+    }
+
+    /// Release the mutex
+    ///
+    /// # Returns
+    /// `false` if the calling thread does not hold the mutex
+    pub(crate) fn unlock(&self) -> bool {
+        match self.take_guard() {
+            Some(guard) => {
+                drop(guard);
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Take the guard of the calling thread's acquisition out of the slot
+    ///
+    /// # Returns
+    /// `None` if the calling thread does not hold the mutex
+    pub(crate) fn take_guard(&self) -> Option<MutexGuard<'static, ()>> {
+        // Check ownership first, so a wrong thread never touches the slot
+        if !self.mutex.is_held_by(get_current_thread_id()) {
+            return None;
+        }
+        // Safety: the calling thread holds the mutex
+        unsafe { (*self.guard.get()).take() }
+    }
+
+    /// Put back a guard taken with `take_guard` once the mutex is held again
+    pub(crate) fn restore_guard(&self, guard: MutexGuard<'static, ()>) {
+        // Safety: the guard proves the calling thread holds the mutex
+        unsafe { *self.guard.get() = Some(guard) };
+    }
+}
 
 /// Create a new tracked mutex.
 ///
@@ -17,8 +171,57 @@ use std::os::raw::c_int;
 /// - Any usage from C must ensure not to free or move the returned pointer by other means.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_create_mutex() -> *mut c_void {
-    let mutex = Box::new(Mutex::new(()));
-    Box::into_raw(mutex) as *mut c_void
+    let mutex = Mutex::new(());
+
+    // Every C mutex would share this call site, so give it a class of its own
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    detector::set_lock_class(mutex.id(), LockClass::Unique);
+
+    FfiMutex::into_raw(mutex)
+}
+
+/// Create a new tracked mutex belonging to a named lock class.
+///
+/// When lock order checking is keyed by class (see
+/// `deloxide_enable_lock_order_checking`), all mutexes created with the same
+/// class name share one node in the lock order graph. An ordering learned
+/// from one pair of mutexes then applies to every other pair of the same
+/// classes. Without class ordering the name is ignored.
+///
+/// # Arguments
+/// * `class_name` - Null-terminated class name, or NULL for a class of its own
+///
+/// # Returns
+/// * Void pointer to the mutex, or NULL on allocation failure
+///
+/// # Safety
+/// - `class_name` must be NULL or a valid null-terminated string.
+/// - The returned pointer is a raw pointer to a heap allocation and must be freed by `deloxide_destroy_mutex`.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_create_mutex_with_class(
+    class_name: *const c_char,
+) -> *mut c_void {
+    let mutex = Mutex::new(());
+
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    detector::set_lock_class(mutex.id(), unsafe { ffi_lock_class(class_name) });
+
+    FfiMutex::into_raw(mutex)
+}
+
+/// Map an optional C class name to a lock class
+///
+/// # Safety
+/// `class_name` must be NULL or a valid null-terminated string.
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+pub(crate) unsafe fn ffi_lock_class(class_name: *const c_char) -> LockClass {
+    if class_name.is_null() {
+        LockClass::Unique
+    } else {
+        let name = unsafe { CStr::from_ptr(class_name) };
+        LockClass::Named(name.to_string_lossy().into_owned())
+    }
 }
 
 /// Create a new tracked mutex with specified creator thread ID.
@@ -39,12 +242,15 @@ pub unsafe extern "C" fn deloxide_create_mutex() -> *mut c_void {
 pub unsafe extern "C" fn deloxide_create_mutex_with_creator(
     creator_thread_id: usize,
 ) -> *mut c_void {
-    let mutex = Box::new(Mutex::new(()));
+    let mutex = Mutex::new(());
 
     // Register the specified thread as the creator
     create_mutex(mutex.id(), Some(creator_thread_id as ThreadId));
 
-    Box::into_raw(mutex) as *mut c_void
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    detector::set_lock_class(mutex.id(), LockClass::Unique);
+
+    FfiMutex::into_raw(mutex)
 }
 
 /// Destroy a tracked mutex.
@@ -61,26 +267,75 @@ pub unsafe extern "C" fn deloxide_create_mutex_with_creator(
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_destroy_mutex(mutex: *mut c_void) {
     if !mutex.is_null() {
-        unsafe {
-            drop(Box::from_raw(mutex as *mut Mutex<()>));
-        }
+        unsafe { LazyHandle::<FfiMutex>::free(mutex) };
     }
 }
 
+/// Initialize a caller-allocated mutex.
+///
+/// Equivalent to assigning `DELOXIDE_MUTEX_INITIALIZER`. No memory is
+/// allocated: the mutex gets its ID and is registered with the detector on
+/// first use, and the thread that first uses it is recorded as its creator.
+///
+/// # Arguments
+/// * `mutex` - Pointer to a `deloxide_mutex_t`, e.g. a field of a C struct.
+///
+/// # Returns
+/// * `0` on success
+/// * `-1` if the mutex pointer is NULL
+///
+/// # Safety
+/// - `mutex` must point to writable, suitably aligned `deloxide_mutex_t` storage.
+/// - A mutex that is already in use must be destroyed with `deloxide_mutex_destroy` first.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_mutex_init(mutex: *mut c_void) -> c_int {
+    if mutex.is_null() {
+        return -1;
+    }
+
+    unsafe { LazyHandle::<FfiMutex>::init_in_place(mutex) };
+    0
+}
+
+/// Destroy a caller-allocated mutex.
+///
+/// Removes the mutex from the detector's tracking if it was ever used. The
+/// storage itself belongs to the caller and can be initialized again.
+///
+/// # Arguments
+/// * `mutex` - Pointer to a `deloxide_mutex_t`.
+///
+/// # Returns
+/// * `0` on success
+/// * `-1` if the mutex pointer is NULL
+///
+/// # Safety
+/// - `mutex` must point to an initialized `deloxide_mutex_t`, not to a handle from `deloxide_create_mutex`.
+/// - The caller must ensure no thread uses the mutex during or after this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_mutex_destroy(mutex: *mut c_void) -> c_int {
+    if mutex.is_null() {
+        return -1;
+    }
+
+    unsafe { LazyHandle::<FfiMutex>::destroy_in_place(mutex) };
+    0
+}
+
 /// Lock a tracked mutex.
 ///
 /// Attempts to acquire the lock on a mutex while tracking the operation
 /// for deadlock detection.
 ///
 /// # Arguments
-/// * `mutex` - Pointer to a mutex created with `deloxide_create_mutex`.
+/// * `mutex` - Pointer to a mutex created with `deloxide_create_mutex`, or to an initialized `deloxide_mutex_t`.
 ///
 /// # Returns
 /// * `0` on success
 /// * `-1` if the mutex pointer is NULL
 ///
 /// # Safety
-/// - The caller must pass a valid pointer to a `Mutex<()>`.
+/// - The caller must pass a valid pointer to a mutex created with `deloxide_create_mutex` or to an initialized `deloxide_mutex_t`.
 /// - The lock is re-entrant in the sense of C code, but you must not call `deloxide_lock` twice on the same mutex from the same thread without calling `deloxide_unlock`.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_lock_mutex(mutex: *mut c_void) -> c_int {
@@ -88,16 +343,116 @@ pub unsafe extern "C" fn deloxide_lock_mutex(mutex: *mut c_void) -> c_int {
         return -1;
     }
 
-    unsafe {
-        let mutex_ref = &*(mutex as *const Mutex<()>);
-        let guard = mutex_ref.lock();
+    unsafe { FfiMutex::from_handle(mutex) }.lock();
+    0
+}
+
+/// Try to lock a tracked mutex without blocking.
+///
+/// A failed attempt is not logged and adds no wait-for edge, so trylock and
+/// back-off loops stay cheap and cannot cause false deadlock reports.
+///
+/// # Arguments
+/// * `mutex` - Pointer to a mutex created with `deloxide_create_mutex`, or to an initialized `deloxide_mutex_t`.
+///
+/// # Returns
+/// * `0` if the mutex was acquired
+/// * `1` if the mutex is held
+/// * `-1` if the mutex pointer is NULL
+///
+/// # Safety
+/// - The caller must pass a valid pointer, as for `deloxide_lock_mutex`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_try_lock_mutex(mutex: *mut c_void) -> c_int {
+    if mutex.is_null() {
+        return -1;
+    }
+
+    if unsafe { FfiMutex::from_handle(mutex) }.try_lock() {
+        0
+    } else {
+        1
+    }
+}
+
+/// Lock a tracked mutex, giving up after a timeout.
+///
+/// While blocked the thread waits for the owner like in `deloxide_lock_mutex`,
+/// so a deadlock is still detected. If the timeout runs out first, the wait is
+/// withdrawn from the detector.
+///
+/// # Arguments
+/// * `mutex` - Pointer to a mutex created with `deloxide_create_mutex`, or to an initialized `deloxide_mutex_t`.
+/// * `timeout_ms` - Timeout in milliseconds.
+///
+/// # Returns
+/// * `0` if the mutex was acquired
+/// * `1` on timeout
+/// * `-1` if the mutex pointer is NULL
+///
+/// # Safety
+/// - The caller must pass a valid pointer, as for `deloxide_lock_mutex`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_lock_mutex_timeout(
+    mutex: *mut c_void,
+    timeout_ms: c_ulong,
+) -> c_int {
+    if mutex.is_null() {
+        return -1;
+    }
+
+    let timeout = Duration::from_millis(timeout_ms);
+    if unsafe { FfiMutex::from_handle(mutex) }.lock_for(timeout) {
+        0
+    } else {
+        1
+    }
+}
+
+/// Lock several tracked mutexes at once.
+///
+/// Acquires every mutex without holding some of them while blocking on
+/// another, so two calls over the same mutexes cannot deadlock whatever order
+/// they list them in, and no lock order is recorded between them. Each mutex
+/// is released separately with `deloxide_unlock_mutex`.
+///
+/// # Arguments
+/// * `mutexes` - Array of `n` pointers to mutexes created with `deloxide_create_mutex`, or to initialized `deloxide_mutex_t`s.
+/// * `n` - Number of mutexes in the array.
+///
+/// # Returns
+/// * `0` on success
+/// * `-1` if the array or one of its pointers is NULL
+/// * `-2` if the same mutex appears twice
+///
+/// # Safety
+/// - `mutexes` must point to `n` pointers, each valid as for `deloxide_lock_mutex`.
+/// - The calling thread must not already hold any of the mutexes.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_lock_mutexes(mutexes: *const *mut c_void, n: usize) -> c_int {
+    if n == 0 {
+        return 0;
+    }
+    if mutexes.is_null() {
+        return -1;
+    }
 
-        #[allow(clippy::missing_transmute_annotations)]
-        FFI_GUARD.with(|map| {
-            map.borrow_mut().insert(mutex, std::mem::transmute(guard));
-        });
+    let handles = unsafe { std::slice::from_raw_parts(mutexes, n) };
+    if handles.iter().any(|handle| handle.is_null()) {
+        return -1;
     }
+    let ffi_mutexes: Vec<&FfiMutex> = handles
+        .iter()
+        .map(|&handle| unsafe { FfiMutex::from_handle(handle) })
+        .collect();
+    let locks: Vec<&Mutex<()>> = ffi_mutexes.iter().map(|mutex| mutex.mutex()).collect();
 
+    let Some(guards) = lock_distinct(&locks) else {
+        return -2;
+    };
+    for (mutex, guard) in ffi_mutexes.iter().zip(guards) {
+        mutex.keep_guard(guard);
+    }
     0
 }
 
@@ -111,22 +466,22 @@ pub unsafe extern "C" fn deloxide_lock_mutex(mutex: *mut c_void) -> c_int {
 /// # Returns
 /// * `0` on success
 /// * `-1` if the mutex pointer is NULL
+/// * `-2` if the mutex is not held by the current thread
 ///
 /// # Safety
-/// - The pointer must be valid (i.e., a previously created `Mutex<()>`).
-/// - The mutex must have been previously locked by the current thread.
+/// - The pointer must be valid (i.e., a mutex created with `deloxide_create_mutex`).
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_unlock_mutex(mutex: *mut c_void) -> c_int {
     if mutex.is_null() {
         return -1;
     }
 
-    // Drop the guard we stashed above; this actually unlocks the Mutex
-    FFI_GUARD.with(|map| {
-        map.borrow_mut().remove(&mutex);
-    });
-
-    0
+    // Dropping the guard stored next to the mutex actually unlocks it
+    if unsafe { FfiMutex::from_handle(mutex) }.unlock() {
+        0
+    } else {
+        -2
+    }
 }
 
 /// Get the creator thread ID of a mutex.
@@ -140,15 +495,14 @@ pub unsafe extern "C" fn deloxide_unlock_mutex(mutex: *mut c_void) -> c_int {
 /// * Thread ID of the creator thread, or 0 if the mutex is NULL
 ///
 /// # Safety
-/// - The caller must pass a valid pointer to a `Mutex<()>`.
+/// - The caller must pass a valid pointer to a mutex created with `deloxide_create_mutex`.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_get_mutex_creator(mutex: *mut c_void) -> usize {
     if mutex.is_null() {
         return 0;
     }
 
-    unsafe {
-        let mutex_ref = &*(mutex as *const Mutex<()>);
-        mutex_ref.creator_thread_id()
-    }
+    unsafe { FfiMutex::from_handle(mutex) }
+        .mutex()
+        .creator_thread_id()
 }
@@ -0,0 +1,1310 @@
+//! Hooks behind the `LD_PRELOAD` pthread shim (only with the "preload" feature)
+//!
+//! `libdeloxide_preload.so` (the `deloxide-preload` crate in `preload/`)
+//! exports `pthread_mutex_*`, `pthread_rwlock_*`, `pthread_cond_*`,
+//! `pthread_create` and `pthread_exit`, and forwards each call here. The real
+//! pthread object still does the locking, so every pthread feature keeps
+//! working (recursive and robust mutexes, timed waits, process-shared locks).
+//! The hooks only report the same events the tracked Rust locks report, using
+//! the same fast and slow paths.
+//!
+//! pthread objects carry no room for a lock ID, so the hooks keep a side
+//! table per object kind, keyed by the object's address. The tables are
+//! fixed-size open-addressing hash tables whose slots are claimed with a
+//! single compare-and-swap, so the uncontended `pthread_mutex_lock` path is a
+//! hash, one or two loads and the real `pthread_mutex_trylock`.
+//!
+//! Calls made while a thread is already inside the detector, before [`init`]
+//! or after a thread finished its start routine are forwarded untouched.
+
+#[cfg(feature = "lock-order-graph")]
+use crate::core::detector::{self, lock_class::LockClass};
+use crate::core::detector::{condvar, deadlock_handling, mutex, rwlock, thread};
+use crate::core::locks::next_lock_id;
+#[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+use crate::core::locks::read_tracking::FastReaders;
+use crate::core::logger;
+use crate::core::types::{DeadlockInfo, Events, LockId, ThreadId, get_current_thread_id};
+use std::alloc::{Layout, alloc_zeroed};
+use std::cell::Cell;
+use std::ffi::{CStr, CString, c_char, c_int, c_void};
+use std::sync::OnceLock;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+
+/// Default number of slots of each side table
+const DEFAULT_SLOTS: usize = 1 << 16;
+
+/// Slots probed before a lookup gives up and the object goes untracked
+const MAX_PROBES: usize = 64;
+
+/// Key of a slot that was never claimed
+const EMPTY: usize = 0;
+
+/// Lock ID of a slot whose object has not been used since it was claimed or destroyed
+const NO_ID: LockId = 0;
+
+/// Lock ID of a slot whose object is being registered with the detector
+const REGISTERING: LockId = LockId::MAX;
+
+/// `EOWNERDEAD`: a robust mutex was acquired after its owner died
+const EOWNERDEAD: c_int = 130;
+
+const RTLD_NEXT: *mut c_void = -1isize as *mut c_void;
+
+unsafe extern "C" {
+    fn dlsym(handle: *mut c_void, symbol: *const c_char) -> *mut c_void;
+    #[cfg(target_env = "gnu")]
+    fn dlvsym(handle: *mut c_void, symbol: *const c_char, version: *const c_char) -> *mut c_void;
+    fn _exit(status: c_int) -> !;
+}
+
+/// Start routine of a pthread
+///
+/// `C-unwind`, because `pthread_exit` unwinds through the start routine.
+pub type StartRoutine = unsafe extern "C-unwind" fn(*mut c_void) -> *mut c_void;
+
+type LockFn = unsafe extern "C" fn(*mut c_void) -> c_int;
+type TimedLockFn = unsafe extern "C" fn(*mut c_void, *const c_void) -> c_int;
+type WaitFn = unsafe extern "C" fn(*mut c_void, *mut c_void) -> c_int;
+type TimedWaitFn = unsafe extern "C" fn(*mut c_void, *mut c_void, *const c_void) -> c_int;
+type CreateFn =
+    unsafe extern "C" fn(*mut c_void, *const c_void, StartRoutine, *mut c_void) -> c_int;
+type ExitFn = unsafe extern "C-unwind" fn(*mut c_void) -> !;
+
+/// The libc implementations behind the interposed functions
+struct Real {
+    mutex_lock: LockFn,
+    mutex_trylock: LockFn,
+    mutex_timedlock: TimedLockFn,
+    mutex_unlock: LockFn,
+    mutex_destroy: LockFn,
+    rwlock_rdlock: LockFn,
+    rwlock_tryrdlock: LockFn,
+    rwlock_timedrdlock: TimedLockFn,
+    rwlock_wrlock: LockFn,
+    rwlock_trywrlock: LockFn,
+    rwlock_timedwrlock: TimedLockFn,
+    rwlock_unlock: LockFn,
+    rwlock_destroy: LockFn,
+    cond_wait: WaitFn,
+    cond_timedwait: TimedWaitFn,
+    cond_signal: LockFn,
+    cond_broadcast: LockFn,
+    cond_destroy: LockFn,
+    create: CreateFn,
+    exit: ExitFn,
+}
+
+/// Look up the next definition of `name`, preferring symbol `version`
+///
+/// # Safety
+/// `F` must be the function pointer type of the symbol.
+unsafe fn next_symbol<F: Copy>(name: &CStr, version: Option<&CStr>) -> F {
+    #[cfg(target_env = "gnu")]
+    let mut symbol = match version {
+        Some(version) => unsafe { dlvsym(RTLD_NEXT, name.as_ptr(), version.as_ptr()) },
+        None => std::ptr::null_mut(),
+    };
+    #[cfg(not(target_env = "gnu"))]
+    let mut symbol = {
+        let _ = version;
+        std::ptr::null_mut()
+    };
+    if symbol.is_null() {
+        symbol = unsafe { dlsym(RTLD_NEXT, name.as_ptr()) };
+    }
+    if symbol.is_null() {
+        eprintln!("deloxide: cannot find {}", name.to_string_lossy());
+        std::process::abort();
+    }
+    unsafe { std::mem::transmute_copy(&symbol) }
+}
+
+/// The real pthread functions, resolved on first use
+fn real() -> &'static Real {
+    static REAL: OnceLock<Real> = OnceLock::new();
+    REAL.get_or_init(|| unsafe {
+        // glibc keeps the pre-2.3.2 condvar ABI under the unversioned name
+        let cond = Some(c"GLIBC_2.3.2");
+        Real {
+            mutex_lock: next_symbol(c"pthread_mutex_lock", None),
+            mutex_trylock: next_symbol(c"pthread_mutex_trylock", None),
+            mutex_timedlock: next_symbol(c"pthread_mutex_timedlock", None),
+            mutex_unlock: next_symbol(c"pthread_mutex_unlock", None),
+            mutex_destroy: next_symbol(c"pthread_mutex_destroy", None),
+            rwlock_rdlock: next_symbol(c"pthread_rwlock_rdlock", None),
+            rwlock_tryrdlock: next_symbol(c"pthread_rwlock_tryrdlock", None),
+            rwlock_timedrdlock: next_symbol(c"pthread_rwlock_timedrdlock", None),
+            rwlock_wrlock: next_symbol(c"pthread_rwlock_wrlock", None),
+            rwlock_trywrlock: next_symbol(c"pthread_rwlock_trywrlock", None),
+            rwlock_timedwrlock: next_symbol(c"pthread_rwlock_timedwrlock", None),
+            rwlock_unlock: next_symbol(c"pthread_rwlock_unlock", None),
+            rwlock_destroy: next_symbol(c"pthread_rwlock_destroy", None),
+            cond_wait: next_symbol(c"pthread_cond_wait", cond),
+            cond_timedwait: next_symbol(c"pthread_cond_timedwait", cond),
+            cond_signal: next_symbol(c"pthread_cond_signal", cond),
+            cond_broadcast: next_symbol(c"pthread_cond_broadcast", cond),
+            cond_destroy: next_symbol(c"pthread_cond_destroy", cond),
+            create: next_symbol(c"pthread_create", None),
+            exit: next_symbol(c"pthread_exit", None),
+        }
+    })
+}
+
+/// Set once the detector is initialized and the side tables exist
+static ACTIVE: AtomicBool = AtomicBool::new(false);
+
+thread_local! {
+    /// Whether pthread calls of this thread bypass the detector
+    ///
+    /// Set while the thread runs detector code, so locks taken inside
+    /// the detector or its dependencies are not reported, and for good once
+    /// the thread's start routine returned and its detector state is gone.
+    static BYPASS: Cell<bool> = const { Cell::new(false) };
+}
+
+/// Marks the current thread as inside the detector until dropped
+struct Tracking;
+
+impl Drop for Tracking {
+    fn drop(&mut self) {
+        let _ = BYPASS.try_with(|bypass| bypass.set(false));
+    }
+}
+
+/// Start reporting a pthread call, unless the call must be forwarded untouched
+#[inline]
+fn enter() -> Option<Tracking> {
+    if !ACTIVE.load(Ordering::Relaxed) {
+        return None;
+    }
+    BYPASS
+        .try_with(|bypass| {
+            if bypass.get() {
+                None
+            } else {
+                bypass.set(true);
+                Some(Tracking)
+            }
+        })
+        .ok()
+        .flatten()
+}
+
+/// Per-object state whose all-zero bit pattern is the valid initial state
+///
+/// # Safety
+/// Implementors must be valid when zero-initialized.
+unsafe trait Zeroable {
+    /// Return to the initial state
+    fn reset(&self);
+}
+
+/// Side table state of a pthread mutex
+struct MutexState {
+    /// Thread holding the mutex, 0 if none
+    owner: AtomicUsize,
+    /// Recursive acquisitions on top of the first one (owner only)
+    depth: AtomicUsize,
+    /// Whether the detector knows about the current acquisition (owner only)
+    tracked: AtomicBool,
+}
+
+unsafe impl Zeroable for MutexState {
+    fn reset(&self) {
+        self.owner.store(0, Ordering::Relaxed);
+        self.depth.store(0, Ordering::Relaxed);
+        self.tracked.store(false, Ordering::Relaxed);
+    }
+}
+
+/// Side table state of a pthread RwLock
+struct RwLockState {
+    /// Thread holding the write lock, 0 if none
+    writer: AtomicUsize,
+    /// Whether the detector knows about the current write acquisition (writer only)
+    tracked: AtomicBool,
+    /// Writers blocked on the lock; while nonzero, readers report to the detector
+    writers_waiting: AtomicUsize,
+    /// Readers that took the fast path, all gone once the lock is destroyed
+    #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+    readers: FastReaders,
+}
+
+unsafe impl Zeroable for RwLockState {
+    fn reset(&self) {
+        self.writer.store(0, Ordering::Relaxed);
+        self.tracked.store(false, Ordering::Relaxed);
+        self.writers_waiting.store(0, Ordering::Relaxed);
+    }
+}
+
+/// Condition variables only need their ID
+unsafe impl Zeroable for () {
+    fn reset(&self) {}
+}
+
+/// One entry of a side table
+struct Slot<S> {
+    /// Address of the pthread object, [`EMPTY`] if unclaimed
+    key: AtomicUsize,
+    /// Lock ID, [`NO_ID`] or [`REGISTERING`] until registered
+    id: AtomicUsize,
+    state: S,
+}
+
+impl<S: Zeroable> Slot<S> {
+    /// The lock ID of the object, registering it on first use
+    #[inline]
+    fn lock_id(&self, register: fn() -> LockId) -> LockId {
+        let id = self.id.load(Ordering::Acquire);
+        if id != NO_ID && id != REGISTERING {
+            return id;
+        }
+        self.register(register)
+    }
+
+    #[cold]
+    fn register(&self, register: fn() -> LockId) -> LockId {
+        loop {
+            match self
+                .id
+                .compare_exchange(NO_ID, REGISTERING, Ordering::Acquire, Ordering::Acquire)
+            {
+                Ok(_) => {
+                    let id = register();
+                    self.id.store(id, Ordering::Release);
+                    return id;
+                }
+                Err(REGISTERING) => std::thread::yield_now(),
+                Err(id) => return id,
+            }
+        }
+    }
+
+    /// The lock ID of an object that is in use
+    #[inline]
+    fn registered_id(&self) -> Option<LockId> {
+        let id = self.id.load(Ordering::Acquire);
+        (id != NO_ID && id != REGISTERING).then_some(id)
+    }
+
+    /// Forget the object at this address after it was destroyed
+    ///
+    /// The slot keeps its key: memory is usually reused for the same kind of
+    /// object, which then gets a fresh ID on first use.
+    fn retire(&self) -> Option<LockId> {
+        self.state.reset();
+        match self.id.swap(NO_ID, Ordering::AcqRel) {
+            NO_ID | REGISTERING => None,
+            id => Some(id),
+        }
+    }
+}
+
+/// Lock-free map from pthread object addresses to their [`Slot`]s
+struct SideTable<S: 'static> {
+    slots: &'static [Slot<S>],
+    shift: u32,
+    /// Set once an object did not fit, so the warning is printed only once
+    overflowed: AtomicBool,
+}
+
+impl<S: Zeroable> SideTable<S> {
+    /// Allocate a table of at least `capacity` slots
+    ///
+    /// The allocation is zeroed, so pages of unused slots are never touched.
+    /// It lives until the process exits.
+    fn new(capacity: usize) -> Self {
+        let len = capacity.next_power_of_two().max(MAX_PROBES);
+        let layout = Layout::array::<Slot<S>>(len).expect("side table too large");
+        // Safety: `Slot<S>` is valid when zeroed (atomics and `S: Zeroable`)
+        let slots = unsafe {
+            let ptr = alloc_zeroed(layout) as *mut Slot<S>;
+            if ptr.is_null() {
+                std::alloc::handle_alloc_error(layout);
+            }
+            std::slice::from_raw_parts(ptr, len)
+        };
+        SideTable {
+            slots,
+            shift: usize::BITS - len.trailing_zeros(),
+            overflowed: AtomicBool::new(false),
+        }
+    }
+
+    #[inline]
+    fn home(&self, addr: usize) -> usize {
+        // Fibonacci hashing; the low bits of an address are mostly alignment
+        ((addr as u64 >> 3).wrapping_mul(0x9E37_79B9_7F4A_7C15) >> self.shift) as usize
+    }
+
+    /// The slot of an object that was used before
+    #[inline]
+    fn find(&self, addr: usize) -> Option<&'static Slot<S>> {
+        let mask = self.slots.len() - 1;
+        let mut index = self.home(addr);
+        for _ in 0..MAX_PROBES {
+            let slot = &self.slots[index];
+            match slot.key.load(Ordering::Acquire) {
+                key if key == addr => return Some(slot),
+                EMPTY => return None,
+                _ => index = (index + 1) & mask,
+            }
+        }
+        None
+    }
+
+    /// The slot of an object, claiming one on its first use
+    ///
+    /// # Returns
+    /// `None` if the neighbourhood of the object's home slot is full
+    #[inline]
+    fn find_or_insert(&self, addr: usize) -> Option<&'static Slot<S>> {
+        let mask = self.slots.len() - 1;
+        let mut index = self.home(addr);
+        for _ in 0..MAX_PROBES {
+            let slot = &self.slots[index];
+            let mut key = slot.key.load(Ordering::Acquire);
+            if key == EMPTY {
+                key = match slot.key.compare_exchange(
+                    EMPTY,
+                    addr,
+                    Ordering::AcqRel,
+                    Ordering::Acquire,
+                ) {
+                    Ok(_) => return Some(slot),
+                    Err(key) => key,
+                };
+            }
+            if key == addr {
+                return Some(slot);
+            }
+            index = (index + 1) & mask;
+        }
+        self.overflow();
+        None
+    }
+
+    #[cold]
+    fn overflow(&self) {
+        if !self.overflowed.swap(true, Ordering::Relaxed) {
+            eprintln!(
+                "deloxide: preload side table is full, some locks are not tracked \
+                 (raise DELOXIDE_PRELOAD_SLOTS)"
+            );
+        }
+    }
+}
+
+struct Tables {
+    mutexes: SideTable<MutexState>,
+    rwlocks: SideTable<RwLockState>,
+    condvars: SideTable<()>,
+}
+
+static TABLES: OnceLock<Tables> = OnceLock::new();
+
+#[inline]
+fn tables() -> &'static Tables {
+    // ACTIVE is only set after the tables exist
+    TABLES.get().expect("preload hooks used before init")
+}
+
+fn register_mutex() -> LockId {
+    let id = next_lock_id();
+    mutex::create_mutex(id, None);
+    // Like C mutexes, every pthread mutex gets a class of its own
+    #[cfg(feature = "lock-order-graph")]
+    detector::set_lock_class(id, LockClass::Unique);
+    id
+}
+
+fn register_rwlock() -> LockId {
+    let id = next_lock_id();
+    rwlock::create_rwlock(id, None);
+    #[cfg(feature = "lock-order-graph")]
+    detector::set_lock_class(id, LockClass::Unique);
+    id
+}
+
+fn register_condvar() -> LockId {
+    let id = next_lock_id();
+    condvar::create_condvar(id);
+    id
+}
+
+fn owner_hint(owner: &AtomicUsize) -> Option<ThreadId> {
+    match owner.load(Ordering::Acquire) {
+        0 => None,
+        owner => Some(owner),
+    }
+}
+
+/// Report a detected cycle unless the edge to `expected_owner` went stale
+fn report_unless_stale(
+    info: DeadlockInfo,
+    thread_id: ThreadId,
+    lock_id: LockId,
+    expected_owner: Option<ThreadId>,
+    owner: &AtomicUsize,
+) {
+    let stale = expected_owner.is_some_and(|expected| {
+        !deadlock_handling::verify_deadlock_edges(
+            &info,
+            thread_id,
+            lock_id,
+            expected,
+            owner.load(Ordering::Relaxed),
+        )
+    });
+    if !stale {
+        deadlock_handling::process_deadlock(info);
+    }
+}
+
+/// Report an acquisition that did not have to wait
+///
+/// Mirrors the fast paths of `Mutex::lock` and `RwLock::write`: the detector
+/// only hears about it when lock order checking needs every held lock.
+///
+/// # Returns
+/// Whether the detector now tracks the acquisition
+#[inline]
+#[allow(unused_variables)]
+fn uncontended(
+    thread_id: ThreadId,
+    lock_id: LockId,
+    attempt: Events,
+    acquired: Events,
+    complete: fn(ThreadId, LockId),
+) -> bool {
+    #[cfg(feature = "logging-and-visualization")]
+    if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+        logger::log_interaction_event(thread_id, lock_id, attempt);
+    }
+
+    #[cfg(feature = "lock-order-graph")]
+    {
+        complete(thread_id, lock_id);
+        true
+    }
+
+    #[cfg(not(feature = "lock-order-graph"))]
+    {
+        #[cfg(feature = "logging-and-visualization")]
+        if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+            logger::log_interaction_event(thread_id, lock_id, acquired);
+        }
+        false
+    }
+}
+
+/// Initialize the detector for a preloaded process
+///
+/// Called by the shim's constructor before `main`. Reads:
+/// * `DELOXIDE_LOG` - log file path (ignored without "logging-and-visualization")
+/// * `DELOXIDE_DEADLOCK_EXIT_CODE` - exit the process with this status once a
+///   deadlock was reported, instead of leaving it hanging
+/// * `DELOXIDE_PRELOAD_SLOTS` - slots of each side table (default 65536)
+pub fn init() {
+    BYPASS.with(|bypass| bypass.set(true));
+    let slots = std::env::var("DELOXIDE_PRELOAD_SLOTS")
+        .ok()
+        .and_then(|s| s.parse().ok())
+        .unwrap_or(DEFAULT_SLOTS);
+    real();
+    TABLES.get_or_init(|| Tables {
+        mutexes: SideTable::new(slots),
+        rwlocks: SideTable::new(slots),
+        condvars: SideTable::new(slots),
+    });
+
+    #[cfg(feature = "logging-and-visualization")]
+    let log_path = std::env::var("DELOXIDE_LOG")
+        .ok()
+        .and_then(|path| CString::new(path).ok());
+    #[cfg(not(feature = "logging-and-visualization"))]
+    let log_path: Option<CString> = None;
+    let log_ptr = log_path.as_ref().map_or(std::ptr::null(), |p| p.as_ptr());
+    let result = unsafe { super::core::deloxide_init(log_ptr, Some(report_deadlock)) };
+    if result != 0 {
+        eprintln!("deloxide: failed to initialize the detector ({result})");
+    }
+
+    ACTIVE.store(result == 0, Ordering::Release);
+    let _ = BYPASS.try_with(|bypass| bypass.set(false));
+}
+
+extern "C" fn report_deadlock(json_info: *const c_char) {
+    let info = unsafe { CStr::from_ptr(json_info) };
+    eprintln!("deloxide: deadlock detected: {}", info.to_string_lossy());
+
+    if let Some(code) = std::env::var("DELOXIDE_DEADLOCK_EXIT_CODE")
+        .ok()
+        .and_then(|code| code.parse().ok())
+    {
+        // The deadlocked threads never return, so skip the exit handlers
+        #[cfg(feature = "logging-and-visualization")]
+        let _ = logger::flush_logs();
+        unsafe { _exit(code) };
+    }
+}
+
+/// Shared implementation of `pthread_mutex_lock` and `pthread_mutex_timedlock`
+///
+/// A wait that `block` gives up on is withdrawn from the detector.
+#[inline]
+unsafe fn lock_mutex(mutex: *mut c_void, block: impl Fn() -> c_int) -> c_int {
+    let Some(_tracking) = enter() else {
+        return block();
+    };
+    let Some(slot) = tables().mutexes.find_or_insert(mutex as usize) else {
+        return block();
+    };
+    let state = &slot.state;
+    let thread_id = get_current_thread_id();
+
+    // Relocking a recursive or error-checking mutex, which never waits
+    // for this thread itself
+    if state.owner.load(Ordering::Relaxed) == thread_id {
+        let result = block();
+        if result == 0 {
+            state.depth.fetch_add(1, Ordering::Relaxed);
+        }
+        return result;
+    }
+
+    let lock_id = slot.lock_id(register_mutex);
+
+    #[cfg(not(feature = "stress-test"))]
+    if unsafe { (real().mutex_trylock)(mutex) } == 0 {
+        state.owner.store(thread_id, Ordering::Release);
+        let tracked = uncontended(
+            thread_id,
+            lock_id,
+            Events::MutexAttempt,
+            Events::MutexAcquired,
+            mutex::complete_acquire,
+        );
+        state.tracked.store(tracked, Ordering::Relaxed);
+        return 0;
+    }
+
+    let owner = owner_hint(&state.owner);
+    if let Some(info) = mutex::acquire_slow(thread_id, lock_id, owner) {
+        report_unless_stale(info, thread_id, lock_id, owner, &state.owner);
+    }
+
+    let result = block();
+    if result == 0 || result == EOWNERDEAD {
+        mutex::complete_acquire(thread_id, lock_id);
+        state.owner.store(thread_id, Ordering::Release);
+        state.tracked.store(true, Ordering::Relaxed);
+    } else {
+        mutex::cancel_wait(thread_id, lock_id);
+    }
+    result
+}
+
+/// `pthread_mutex_lock`
+///
+/// # Safety
+/// Same contract as `pthread_mutex_lock`.
+#[inline]
+pub unsafe fn mutex_lock(mutex: *mut c_void) -> c_int {
+    unsafe { lock_mutex(mutex, || (real().mutex_lock)(mutex)) }
+}
+
+/// `pthread_mutex_trylock`
+///
+/// # Safety
+/// Same contract as `pthread_mutex_trylock`.
+#[inline]
+pub unsafe fn mutex_trylock(mutex: *mut c_void) -> c_int {
+    let real = real();
+    let Some(_tracking) = enter() else {
+        return unsafe { (real.mutex_trylock)(mutex) };
+    };
+    let Some(slot) = tables().mutexes.find_or_insert(mutex as usize) else {
+        return unsafe { (real.mutex_trylock)(mutex) };
+    };
+    let state = &slot.state;
+    let thread_id = get_current_thread_id();
+
+    let relock = state.owner.load(Ordering::Relaxed) == thread_id;
+    let result = unsafe { (real.mutex_trylock)(mutex) };
+    if result != 0 && result != EOWNERDEAD {
+        return result;
+    }
+    if relock {
+        state.depth.fetch_add(1, Ordering::Relaxed);
+        return result;
+    }
+
+    let lock_id = slot.lock_id(register_mutex);
+    state.owner.store(thread_id, Ordering::Release);
+    let tracked = uncontended(
+        thread_id,
+        lock_id,
+        Events::MutexAttempt,
+        Events::MutexAcquired,
+        mutex::complete_acquire,
+    );
+    state.tracked.store(tracked, Ordering::Relaxed);
+    result
+}
+
+/// `pthread_mutex_timedlock`
+///
+/// Waits like `pthread_mutex_lock`, so a deadlock between timed waiters is
+/// still reported, and withdraws the wait if it times out.
+///
+/// # Safety
+/// Same contract as `pthread_mutex_timedlock`.
+pub unsafe fn mutex_timedlock(mutex: *mut c_void, abstime: *const c_void) -> c_int {
+    unsafe { lock_mutex(mutex, || (real().mutex_timedlock)(mutex, abstime)) }
+}
+
+/// `pthread_mutex_unlock`
+///
+/// # Safety
+/// Same contract as `pthread_mutex_unlock`.
+#[inline]
+pub unsafe fn mutex_unlock(mutex: *mut c_void) -> c_int {
+    let real = real();
+    let Some(_tracking) = enter() else {
+        return unsafe { (real.mutex_unlock)(mutex) };
+    };
+    let Some(slot) = tables().mutexes.find(mutex as usize) else {
+        return unsafe { (real.mutex_unlock)(mutex) };
+    };
+    let (state, Some(lock_id)) = (&slot.state, slot.registered_id()) else {
+        return unsafe { (real.mutex_unlock)(mutex) };
+    };
+    let thread_id = get_current_thread_id();
+
+    match state.owner.load(Ordering::Relaxed) {
+        // Acquired before the shim was active
+        0 => {}
+        owner if owner == thread_id => {
+            if state.depth.load(Ordering::Relaxed) > 0 {
+                state.depth.fetch_sub(1, Ordering::Relaxed);
+            } else {
+                state.owner.store(0, Ordering::Release);
+                if state.tracked.swap(false, Ordering::Relaxed) {
+                    mutex::release_mutex(thread_id, lock_id);
+                } else {
+                    #[cfg(feature = "logging-and-visualization")]
+                    if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+                        logger::log_interaction_event(thread_id, lock_id, Events::MutexReleased);
+                    }
+                }
+            }
+        }
+        owner => {
+            return unsafe {
+                unlock_for(
+                    owner,
+                    lock_id,
+                    &state.owner,
+                    mutex,
+                    real.mutex_unlock,
+                    mutex::release_mutex,
+                )
+            };
+        }
+    }
+    unsafe { (real.mutex_unlock)(mutex) }
+}
+
+/// Unlock a lock on behalf of the thread that acquired it
+///
+/// glibc lets any thread unlock a normal mutex or RwLock, and some programs
+/// hand locks between threads that way. The real unlock runs first, since
+/// error-checking locks refuse it; the owner is then released in the
+/// detector, which ignores the release if the lock has moved on already.
+unsafe fn unlock_for(
+    owner: ThreadId,
+    lock_id: LockId,
+    owner_slot: &AtomicUsize,
+    lock: *mut c_void,
+    unlock: LockFn,
+    release: fn(ThreadId, LockId),
+) -> c_int {
+    let result = unsafe { unlock(lock) };
+    if result == 0 {
+        let _ = owner_slot.compare_exchange(owner, 0, Ordering::AcqRel, Ordering::Relaxed);
+        release(owner, lock_id);
+    }
+    result
+}
+
+/// `pthread_mutex_destroy`
+///
+/// # Safety
+/// Same contract as `pthread_mutex_destroy`.
+pub unsafe fn mutex_destroy(mutex: *mut c_void) -> c_int {
+    let real = real();
+    if let Some(_tracking) = enter()
+        && let Some(slot) = tables().mutexes.find(mutex as usize)
+        && let Some(lock_id) = slot.retire()
+    {
+        mutex::destroy_mutex(lock_id);
+    }
+    unsafe { (real.mutex_destroy)(mutex) }
+}
+
+/// Take a read lock without waiting, through the fast path of `RwLock::read`
+///
+/// Without lock order checking the reader is published in the lock's reader
+/// slots before `try_lock` runs, where a blocking writer finds it. With it,
+/// the read is recorded in the detector together with its acquisition.
+///
+/// # Returns
+/// The result of `try_lock`, or None without calling it if a writer is
+/// waiting (or every reader slot is taken) and the detector has to be asked
+#[allow(unused_variables)]
+fn read_fast(
+    state: &RwLockState,
+    thread_id: ThreadId,
+    lock_id: LockId,
+    try_lock: impl FnOnce() -> c_int,
+) -> Option<c_int> {
+    #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+    {
+        let slot = match state.readers.enter(thread_id, &state.writers_waiting) {
+            Ok(slot) => slot,
+            Err(linked) => {
+                if linked {
+                    rwlock::unlink_reader(thread_id, lock_id);
+                }
+                return None;
+            }
+        };
+        let result = try_lock();
+        if result != 0 {
+            if FastReaders::release(slot) {
+                rwlock::unlink_reader(thread_id, lock_id);
+            }
+            return Some(result);
+        }
+
+        #[cfg(feature = "logging-and-visualization")]
+        if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+            logger::log_interaction_event(thread_id, lock_id, Events::RwReadAttempt);
+            logger::log_interaction_event(thread_id, lock_id, Events::RwReadAcquired);
+        }
+        Some(0)
+    }
+
+    #[cfg(all(feature = "lock-order-graph", not(feature = "stress-test")))]
+    {
+        if state.writers_waiting.load(Ordering::Acquire) != 0 {
+            return None;
+        }
+        Some(try_read_tracked(thread_id, lock_id, try_lock))
+    }
+
+    #[cfg(feature = "stress-test")]
+    None
+}
+
+/// Take a read lock without waiting, registered atomically with the detector
+fn try_read_tracked(
+    thread_id: ThreadId,
+    lock_id: LockId,
+    try_lock: impl FnOnce() -> c_int,
+) -> c_int {
+    let mut result = 0;
+    rwlock::try_read(thread_id, lock_id, || {
+        result = try_lock();
+        (result == 0).then_some(())
+    });
+    result
+}
+
+/// Shared implementation of `pthread_rwlock_rdlock` and `pthread_rwlock_timedrdlock`
+///
+/// A wait that `block` gives up on is withdrawn from the detector.
+unsafe fn read_lock(rwlock: *mut c_void, block: impl FnOnce() -> c_int) -> c_int {
+    let Some(_tracking) = enter() else {
+        return block();
+    };
+    let Some(slot) = tables().rwlocks.find_or_insert(rwlock as usize) else {
+        return block();
+    };
+    let thread_id = get_current_thread_id();
+
+    // pthread reports EDEADLK for a writer read-locking, never a wait
+    if slot.state.writer.load(Ordering::Relaxed) == thread_id {
+        return block();
+    }
+
+    let lock_id = slot.lock_id(register_rwlock);
+
+    if read_fast(&slot.state, thread_id, lock_id, || unsafe {
+        (real().rwlock_tryrdlock)(rwlock)
+    }) == Some(0)
+    {
+        return 0;
+    }
+
+    let acquired = rwlock::attempt_read(thread_id, lock_id, || {
+        (unsafe { (real().rwlock_tryrdlock)(rwlock) } == 0).then_some(())
+    });
+    if acquired.is_some() {
+        return 0;
+    }
+
+    let result = block();
+    if result == 0 {
+        rwlock::complete_read(thread_id, lock_id);
+    } else {
+        mutex::cancel_wait(thread_id, lock_id);
+    }
+    result
+}
+
+/// `pthread_rwlock_rdlock`
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_rdlock`.
+pub unsafe fn rwlock_rdlock(rwlock: *mut c_void) -> c_int {
+    unsafe { read_lock(rwlock, || (real().rwlock_rdlock)(rwlock)) }
+}
+
+/// `pthread_rwlock_timedrdlock`
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_timedrdlock`.
+pub unsafe fn rwlock_timedrdlock(rwlock: *mut c_void, abstime: *const c_void) -> c_int {
+    unsafe { read_lock(rwlock, || (real().rwlock_timedrdlock)(rwlock, abstime)) }
+}
+
+/// `pthread_rwlock_tryrdlock`
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_tryrdlock`.
+pub unsafe fn rwlock_tryrdlock(rwlock: *mut c_void) -> c_int {
+    let real = real();
+    let Some(_tracking) = enter() else {
+        return unsafe { (real.rwlock_tryrdlock)(rwlock) };
+    };
+    let Some(slot) = tables().rwlocks.find_or_insert(rwlock as usize) else {
+        return unsafe { (real.rwlock_tryrdlock)(rwlock) };
+    };
+    let thread_id = get_current_thread_id();
+    let lock_id = slot.lock_id(register_rwlock);
+    let try_lock = || unsafe { (real.rwlock_tryrdlock)(rwlock) };
+    match read_fast(&slot.state, thread_id, lock_id, try_lock) {
+        Some(result) => result,
+        None => try_read_tracked(thread_id, lock_id, try_lock),
+    }
+}
+
+/// Shared implementation of `pthread_rwlock_wrlock` and `pthread_rwlock_timedwrlock`
+///
+/// A wait that `block` gives up on is withdrawn from the detector.
+unsafe fn write_lock(rwlock: *mut c_void, block: impl Fn() -> c_int) -> c_int {
+    let Some(_tracking) = enter() else {
+        return block();
+    };
+    let Some(slot) = tables().rwlocks.find_or_insert(rwlock as usize) else {
+        return block();
+    };
+    let state = &slot.state;
+    let thread_id = get_current_thread_id();
+
+    // pthread reports EDEADLK for a writer relocking
+    if state.writer.load(Ordering::Relaxed) == thread_id {
+        return block();
+    }
+
+    let lock_id = slot.lock_id(register_rwlock);
+
+    #[cfg(not(feature = "stress-test"))]
+    if unsafe { (real().rwlock_trywrlock)(rwlock) } == 0 {
+        state.writer.store(thread_id, Ordering::Release);
+        let tracked = uncontended(
+            thread_id,
+            lock_id,
+            Events::RwWriteAttempt,
+            Events::RwWriteAcquired,
+            rwlock::complete_write,
+        );
+        state.tracked.store(tracked, Ordering::Relaxed);
+        return 0;
+    }
+
+    // From here on, new readers report to the detector
+    state.writers_waiting.fetch_add(1, Ordering::SeqCst);
+
+    // Readers that took the fast path are only known to the lock's state
+    #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+    let link_fast_readers = || state.readers.link(thread_id);
+    #[cfg(any(feature = "lock-order-graph", feature = "stress-test"))]
+    let link_fast_readers = std::iter::empty;
+
+    let writer = owner_hint(&state.writer);
+    if let Some(info) = rwlock::acquire_write_slow(thread_id, lock_id, writer, link_fast_readers) {
+        report_unless_stale(info, thread_id, lock_id, writer, &state.writer);
+    }
+
+    let result = block();
+    state.writers_waiting.fetch_sub(1, Ordering::Release);
+    if result == 0 {
+        rwlock::complete_write(thread_id, lock_id);
+        state.writer.store(thread_id, Ordering::Release);
+        state.tracked.store(true, Ordering::Relaxed);
+    } else {
+        mutex::cancel_wait(thread_id, lock_id);
+    }
+    result
+}
+
+/// `pthread_rwlock_wrlock`
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_wrlock`.
+pub unsafe fn rwlock_wrlock(rwlock: *mut c_void) -> c_int {
+    unsafe { write_lock(rwlock, || (real().rwlock_wrlock)(rwlock)) }
+}
+
+/// `pthread_rwlock_trywrlock`
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_trywrlock`.
+pub unsafe fn rwlock_trywrlock(rwlock: *mut c_void) -> c_int {
+    let real = real();
+    let Some(_tracking) = enter() else {
+        return unsafe { (real.rwlock_trywrlock)(rwlock) };
+    };
+    let Some(slot) = tables().rwlocks.find_or_insert(rwlock as usize) else {
+        return unsafe { (real.rwlock_trywrlock)(rwlock) };
+    };
+    let result = unsafe { (real.rwlock_trywrlock)(rwlock) };
+    if result == 0 {
+        let state = &slot.state;
+        let thread_id = get_current_thread_id();
+        let lock_id = slot.lock_id(register_rwlock);
+        logger::log_interaction_event(thread_id, lock_id, Events::RwWriteAttempt);
+        rwlock::complete_write(thread_id, lock_id);
+        state.writer.store(thread_id, Ordering::Release);
+        state.tracked.store(true, Ordering::Relaxed);
+    }
+    result
+}
+
+/// `pthread_rwlock_timedwrlock`
+///
+/// Like `pthread_mutex_timedlock`, waits like the blocking call and
+/// withdraws the wait if it times out.
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_timedwrlock`.
+pub unsafe fn rwlock_timedwrlock(rwlock: *mut c_void, abstime: *const c_void) -> c_int {
+    unsafe { write_lock(rwlock, || (real().rwlock_timedwrlock)(rwlock, abstime)) }
+}
+
+/// `pthread_rwlock_unlock`, for both read and write locks
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_unlock`.
+pub unsafe fn rwlock_unlock(rwlock: *mut c_void) -> c_int {
+    let real = real();
+    let Some(_tracking) = enter() else {
+        return unsafe { (real.rwlock_unlock)(rwlock) };
+    };
+    let Some(slot) = tables().rwlocks.find(rwlock as usize) else {
+        return unsafe { (real.rwlock_unlock)(rwlock) };
+    };
+    let (state, Some(lock_id)) = (&slot.state, slot.registered_id()) else {
+        return unsafe { (real.rwlock_unlock)(rwlock) };
+    };
+    let thread_id = get_current_thread_id();
+
+    // No reader can hold the lock while a writer is recorded
+    match state.writer.load(Ordering::Relaxed) {
+        0 => {
+            #[cfg(not(any(feature = "lock-order-graph", feature = "stress-test")))]
+            let fast = state.readers.release_thread(thread_id);
+            #[cfg(any(feature = "lock-order-graph", feature = "stress-test"))]
+            let fast = None;
+
+            // Only a writer that linked a fast reader added a wait-for edge towards it
+            if fast != Some(false) {
+                rwlock::release_read(thread_id, lock_id);
+            } else {
+                #[cfg(feature = "logging-and-visualization")]
+                if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+                    logger::log_interaction_event(thread_id, lock_id, Events::RwReadReleased);
+                }
+            }
+        }
+        writer if writer == thread_id => {
+            state.writer.store(0, Ordering::Release);
+            if state.tracked.swap(false, Ordering::Relaxed) {
+                rwlock::release_write(thread_id, lock_id);
+            } else {
+                #[cfg(feature = "logging-and-visualization")]
+                if logger::LOGGING_ENABLED.load(Ordering::Relaxed) {
+                    logger::log_interaction_event(thread_id, lock_id, Events::RwWriteReleased);
+                }
+            }
+        }
+        writer => {
+            return unsafe {
+                unlock_for(
+                    writer,
+                    lock_id,
+                    &state.writer,
+                    rwlock,
+                    real.rwlock_unlock,
+                    rwlock::release_write,
+                )
+            };
+        }
+    }
+    unsafe { (real.rwlock_unlock)(rwlock) }
+}
+
+/// `pthread_rwlock_destroy`
+///
+/// # Safety
+/// Same contract as `pthread_rwlock_destroy`.
+pub unsafe fn rwlock_destroy(rwlock: *mut c_void) -> c_int {
+    let real = real();
+    if let Some(_tracking) = enter()
+        && let Some(slot) = tables().rwlocks.find(rwlock as usize)
+        && let Some(lock_id) = slot.retire()
+    {
+        rwlock::destroy_rwlock(lock_id);
+    }
+    unsafe { (real.rwlock_destroy)(rwlock) }
+}
+
+/// Shared implementation of `pthread_cond_wait` and `pthread_cond_timedwait`
+///
+/// Reports the same sequence as `Condvar::wait`: the mutex is released for
+/// the wait and reacquired afterwards.
+unsafe fn cond_wait_with(
+    cond: *mut c_void,
+    mutex: *mut c_void,
+    wait: impl FnOnce() -> c_int,
+) -> c_int {
+    let Some(_tracking) = enter() else {
+        return wait();
+    };
+    let tables = tables();
+    let thread_id = get_current_thread_id();
+    let Some(mutex_slot) = tables.mutexes.find(mutex as usize) else {
+        return wait();
+    };
+    let state = &mutex_slot.state;
+    let (Some(mutex_id), true) = (
+        mutex_slot.registered_id(),
+        state.owner.load(Ordering::Relaxed) == thread_id,
+    ) else {
+        return wait();
+    };
+    let Some(cond_slot) = tables.condvars.find_or_insert(cond as usize) else {
+        return wait();
+    };
+    let cond_id = cond_slot.lock_id(register_condvar);
+
+    condvar::begin_wait(thread_id, cond_id, mutex_id);
+    let depth = state.depth.swap(0, Ordering::Relaxed);
+    state.owner.store(0, Ordering::Release);
+    state.tracked.store(false, Ordering::Relaxed);
+    mutex::release_mutex(thread_id, mutex_id);
+
+    let result = wait();
+
+    // The mutex is held again, whether the wait was signalled or timed out
+    state.owner.store(thread_id, Ordering::Release);
+    state.depth.store(depth, Ordering::Relaxed);
+    state.tracked.store(true, Ordering::Relaxed);
+    mutex::complete_acquire(thread_id, mutex_id);
+    condvar::end_wait(thread_id, cond_id, mutex_id);
+    logger::log_interaction_event(thread_id, cond_id, Events::CondvarWaitEnd);
+    result
+}
+
+/// `pthread_cond_wait`
+///
+/// # Safety
+/// Same contract as `pthread_cond_wait`.
+pub unsafe fn cond_wait(cond: *mut c_void, mutex: *mut c_void) -> c_int {
+    unsafe { cond_wait_with(cond, mutex, || (real().cond_wait)(cond, mutex)) }
+}
+
+/// `pthread_cond_timedwait`
+///
+/// # Safety
+/// Same contract as `pthread_cond_timedwait`.
+pub unsafe fn cond_timedwait(
+    cond: *mut c_void,
+    mutex: *mut c_void,
+    abstime: *const c_void,
+) -> c_int {
+    unsafe {
+        cond_wait_with(cond, mutex, || {
+            (real().cond_timedwait)(cond, mutex, abstime)
+        })
+    }
+}
+
+/// `pthread_cond_signal`
+///
+/// # Safety
+/// Same contract as `pthread_cond_signal`.
+pub unsafe fn cond_signal(cond: *mut c_void) -> c_int {
+    let real = real();
+    if let Some(_tracking) = enter()
+        && let Some(slot) = tables().condvars.find_or_insert(cond as usize)
+    {
+        condvar::notify_one(slot.lock_id(register_condvar), get_current_thread_id());
+    }
+    unsafe { (real.cond_signal)(cond) }
+}
+
+/// `pthread_cond_broadcast`
+///
+/// # Safety
+/// Same contract as `pthread_cond_broadcast`.
+pub unsafe fn cond_broadcast(cond: *mut c_void) -> c_int {
+    let real = real();
+    if let Some(_tracking) = enter()
+        && let Some(slot) = tables().condvars.find_or_insert(cond as usize)
+    {
+        condvar::notify_all(slot.lock_id(register_condvar), get_current_thread_id());
+    }
+    unsafe { (real.cond_broadcast)(cond) }
+}
+
+/// `pthread_cond_destroy`
+///
+/// # Safety
+/// Same contract as `pthread_cond_destroy`.
+pub unsafe fn cond_destroy(cond: *mut c_void) -> c_int {
+    let real = real();
+    if let Some(_tracking) = enter()
+        && let Some(slot) = tables().condvars.find(cond as usize)
+        && let Some(cond_id) = slot.retire()
+    {
+        condvar::destroy_condvar(cond_id);
+    }
+    unsafe { (real.cond_destroy)(cond) }
+}
+
+/// What a tracked thread needs before it runs its start routine
+struct Start {
+    routine: StartRoutine,
+    arg: *mut c_void,
+    parent: ThreadId,
+}
+
+/// Start routine of every thread created while the shim is active
+unsafe extern "C-unwind" fn start_tracked(start: *mut c_void) -> *mut c_void {
+    // Move everything out first: `pthread_exit` unwinds through this frame,
+    // so nothing here may need dropping while the routine runs
+    let Start {
+        routine,
+        arg,
+        parent,
+    } = *unsafe { Box::from_raw(start as *mut Start) };
+    let thread_id = get_current_thread_id();
+
+    if let Some(_tracking) = enter() {
+        thread::spawn_thread(thread_id, Some(parent));
+    }
+    let result = unsafe { routine(arg) };
+    exit_tracked(thread_id);
+    result
+}
+
+/// Report the exit of the current thread and stop reporting its pthread calls
+fn exit_tracked(thread_id: ThreadId) {
+    if let Some(tracking) = enter() {
+        thread::exit_thread(thread_id);
+        // Thread-local destructors may still lock, but the thread is gone
+        std::mem::forget(tracking);
+    }
+}
+
+/// `pthread_create`
+///
+/// # Safety
+/// Same contract as `pthread_create`.
+pub unsafe fn create(
+    thread: *mut c_void,
+    attr: *const c_void,
+    routine: StartRoutine,
+    arg: *mut c_void,
+) -> c_int {
+    let real = real();
+    let Some(_tracking) = enter() else {
+        return unsafe { (real.create)(thread, attr, routine, arg) };
+    };
+    let start = Box::into_raw(Box::new(Start {
+        routine,
+        arg,
+        parent: get_current_thread_id(),
+    }));
+    let result = unsafe { (real.create)(thread, attr, start_tracked, start as *mut c_void) };
+    if result != 0 {
+        drop(unsafe { Box::from_raw(start) });
+    }
+    result
+}
+
+/// `pthread_exit`
+///
+/// # Safety
+/// Same contract as `pthread_exit`.
+pub unsafe fn exit(retval: *mut c_void) -> ! {
+    exit_tracked(get_current_thread_id());
+    unsafe { (real().exit)(retval) }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_side_table_claims_one_slot_per_address() {
+        let table = SideTable::<MutexState>::new(MAX_PROBES);
+        let addrs: Vec<usize> = (1..=MAX_PROBES).map(|i| i * 64).collect();
+        for &addr in &addrs {
+            assert!(table.find(addr).is_none());
+            let slot = table.find_or_insert(addr).unwrap();
+            assert!(std::ptr::eq(slot, table.find(addr).unwrap()));
+        }
+        // Full: a new address does not fit, known ones are still found
+        assert!(table.find_or_insert(usize::MAX & !7).is_none());
+        assert!(addrs.iter().all(|&addr| table.find(addr).is_some()));
+
+        // A destroyed object keeps its slot but needs a new ID
+        let slot = table.find(addrs[0]).unwrap();
+        slot.id.store(42, Ordering::Relaxed);
+        assert_eq!(slot.retire(), Some(42));
+        assert_eq!(slot.registered_id(), None);
+    }
+
+    #[test]
+    fn test_concurrent_inserts_agree() {
+        let table: &'static SideTable<()> = Box::leak(Box::new(SideTable::new(1024)));
+        let threads: Vec<_> = (0..4)
+            .map(|_| {
+                std::thread::spawn(move || {
+                    (1..=256usize)
+                        .map(|i| table.find_or_insert(i * 16).unwrap() as *const _ as usize)
+                        .collect::<Vec<_>>()
+                })
+            })
+            .collect();
+        let results: Vec<_> = threads.into_iter().map(|t| t.join().unwrap()).collect();
+        assert!(results.windows(2).all(|w| w[0] == w[1]));
+    }
+}
@@ -1,13 +1,166 @@
 use crate::core::detector::rwlock::create_rwlock;
-use crate::core::locks::rwlock::RwLock;
-use crate::core::types::ThreadId;
-use std::cell::RefCell;
-use std::ffi::{c_int, c_void};
+#[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+use crate::core::detector::{self, lock_class::LockClass};
+use crate::core::locks::rwlock::{RwLock, RwLockReadGuard, RwLockWriteGuard};
+use crate::core::types::{ThreadId, get_current_thread_id};
+use crate::ffi::lazy::{self, LazyHandle};
+use smallvec::SmallVec;
+use std::cell::{RefCell, UnsafeCell};
+use std::ffi::{c_char, c_int, c_void};
+
+/// Read guards held by one thread, most recent last
+type ReadGuards = SmallVec<[(*const FfiRwLock, RwLockReadGuard<'static, ()>); 4]>;
 
-// Each thread can hold one read and one write guard at a time (per-thread tracking)
 thread_local! {
-    static FFI_RW_READ_GUARD: RefCell<Option<crate::core::locks::rwlock::RwLockReadGuard<'static, ()>>> = const {RefCell::new(None)};
-    static FFI_RW_WRITE_GUARD: RefCell<Option<crate::core::locks::rwlock::RwLockWriteGuard<'static, ()>>> = const {RefCell::new(None)};
+    /// Read guards of the current thread
+    ///
+    /// An RwLock can have many readers, so read guards cannot live in the
+    /// lock like the write guard. Threads rarely hold more than a few read
+    /// locks and release them in reverse order, so a short stack searched
+    /// from the top finds the guard without hashing.
+    static FFI_READ_GUARDS: RefCell<ReadGuards> = RefCell::new(SmallVec::new());
+}
+
+/// Object behind a C RwLock handle
+///
+/// Like `FfiMutex`, the guard of the single writer is kept next to the lock.
+pub(crate) struct FfiRwLock {
+    /// Guard of the current writer, `None` while not write-locked. Declared
+    /// first so that it is dropped before the lock it borrows.
+    write_guard: UnsafeCell<Option<RwLockWriteGuard<'static, ()>>>,
+    rwlock: RwLock<()>,
+}
+
+// Safety: `write_guard` is only accessed by the thread holding the write lock
+unsafe impl Sync for FfiRwLock {}
+
+impl Drop for FfiRwLock {
+    fn drop(&mut self) {
+        // See `FfiMutex`: never release a write lock on destruction
+        if let Some(guard) = self.write_guard.get_mut().take() {
+            std::mem::forget(guard);
+        }
+    }
+}
+
+const _: () = assert!(
+    lazy::fits_storage::<FfiRwLock>(lazy::RWLOCK_STORAGE_SIZE),
+    "FfiRwLock does not fit deloxide_rwlock_t"
+);
+
+impl FfiRwLock {
+    /// Move an RwLock to the heap and return its C handle
+    fn into_raw(rwlock: RwLock<()>) -> *mut c_void {
+        LazyHandle::into_raw(FfiRwLock {
+            write_guard: UnsafeCell::new(None),
+            rwlock,
+        })
+    }
+
+    /// Construct the RwLock of a statically initialized `deloxide_rwlock_t`
+    #[cold]
+    fn lazy() -> Self {
+        let rwlock = RwLock::new(());
+        #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+        detector::set_lock_class(rwlock.id(), LockClass::Unique);
+        FfiRwLock {
+            write_guard: UnsafeCell::new(None),
+            rwlock,
+        }
+    }
+
+    /// Borrow the RwLock behind a C handle, constructing it on first use
+    ///
+    /// # Safety
+    /// `handle` must be a live pointer returned by one of the `deloxide_create_rwlock*`
+    /// functions, or point to a `deloxide_rwlock_t` that was initialized.
+    #[inline]
+    unsafe fn from_handle<'a>(handle: *mut c_void) -> &'a FfiRwLock {
+        unsafe { LazyHandle::get(handle, FfiRwLock::lazy) }
+    }
+
+    /// Acquire a read lock and keep the guard until `unlock_read`
+    fn read(&self) {
+        self.keep_read_guard(self.rwlock.read());
+    }
+
+    /// Acquire a read lock if no writer holds the RwLock
+    ///
+    /// # Returns
+    /// `false` if the read lock could not be taken without blocking
+    fn try_read(&self) -> bool {
+        self.rwlock
+            .try_read()
+            .map(|guard| self.keep_read_guard(guard))
+            .is_some()
+    }
+
+    /// Keep a read guard of the calling thread until `unlock_read`
+    fn keep_read_guard(&self, guard: RwLockReadGuard<'_, ()>) {
+        // Safety: the guard borrows `self.rwlock`; C code must release its
+        // read locks before destroying the RwLock
+        let guard = unsafe {
+            std::mem::transmute::<RwLockReadGuard<'_, ()>, RwLockReadGuard<'static, ()>>(guard)
+        };
+        FFI_READ_GUARDS.with(|guards| guards.borrow_mut().push((self as *const _, guard)));
+    }
+
+    /// Release a read lock of the calling thread
+    ///
+    /// # Returns
+    /// `false` if the calling thread holds no read lock on this RwLock
+    fn unlock_read(&self) -> bool {
+        let guard = FFI_READ_GUARDS.with(|guards| {
+            let mut guards = guards.borrow_mut();
+            let pos = guards
+                .iter()
+                .rposition(|(lock, _)| std::ptr::eq(*lock, self))?;
+            Some(guards.remove(pos).1)
+        });
+        // Dropped outside the borrow, releasing may log or call the detector
+        guard.is_some()
+    }
+
+    /// Acquire the write lock and keep the guard until `unlock_write`
+    fn write(&self) {
+        self.keep_write_guard(self.rwlock.write());
+    }
+
+    /// Acquire the write lock if the RwLock is free
+    ///
+    /// # Returns
+    /// `false` if the RwLock is held
+    fn try_write(&self) -> bool {
+        self.rwlock
+            .try_write()
+            .map(|guard| self.keep_write_guard(guard))
+            .is_some()
+    }
+
+    /// Keep the write guard until `unlock_write`
+    fn keep_write_guard(&self, guard: RwLockWriteGuard<'_, ()>) {
+        // Safety: see `FfiMutex::keep_guard`. We hold the write lock, so no other
+        // thread accesses the slot.
+        unsafe {
+            *self.write_guard.get() = Some(std::mem::transmute::<
+                RwLockWriteGuard<'_, ()>,
+                RwLockWriteGuard<'static, ()>,
+            >(guard));
+        }
+    }
+
+    /// Release the write lock
+    ///
+    /// # Returns
+    /// `false` if the calling thread does not hold the write lock
+    fn unlock_write(&self) -> bool {
+        // Check ownership first, so a wrong thread never touches the slot
+        if !self.rwlock.is_write_held_by(get_current_thread_id()) {
+            return false;
+        }
+        // Safety: the calling thread holds the write lock
+        unsafe { (*self.write_guard.get()).take() }.is_some()
+    }
 }
 
 /// Create a new tracked RwLock (reader-writer lock).
@@ -19,8 +172,36 @@ thread_local! {
 /// - The returned pointer is a raw pointer and must be destroyed with `deloxide_destroy_rwlock`.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_create_rwlock() -> *mut c_void {
-    let rwlock = Box::new(RwLock::new(()));
-    Box::into_raw(rwlock) as *mut c_void
+    let rwlock = RwLock::new(());
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    detector::set_lock_class(rwlock.id(), LockClass::Unique);
+    FfiRwLock::into_raw(rwlock)
+}
+
+/// Create a new tracked RwLock belonging to a named lock class.
+///
+/// See `deloxide_create_mutex_with_class`; mutexes and RwLocks may share a class name.
+///
+/// # Arguments
+/// * `class_name` - Null-terminated class name, or NULL for a class of its own
+///
+/// # Returns
+/// * Void pointer to the RwLock, or NULL on allocation failure
+///
+/// # Safety
+/// - `class_name` must be NULL or a valid null-terminated string.
+/// - The pointer must be freed using `deloxide_destroy_rwlock`.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_create_rwlock_with_class(
+    class_name: *const c_char,
+) -> *mut c_void {
+    let rwlock = RwLock::new(());
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    detector::set_lock_class(rwlock.id(), unsafe {
+        crate::ffi::mutex::ffi_lock_class(class_name)
+    });
+    FfiRwLock::into_raw(rwlock)
 }
 
 /// Create a new tracked RwLock with specified creator thread ID.
@@ -37,9 +218,11 @@ pub unsafe extern "C" fn deloxide_create_rwlock() -> *mut c_void {
 pub unsafe extern "C" fn deloxide_create_rwlock_with_creator(
     creator_thread_id: usize,
 ) -> *mut c_void {
-    let rwlock = Box::new(RwLock::new(()));
+    let rwlock = RwLock::new(());
     create_rwlock(rwlock.id(), Some(creator_thread_id as ThreadId));
-    Box::into_raw(rwlock) as *mut c_void
+    #[cfg(any(feature = "lock-order-graph", feature = "lock-stats"))]
+    detector::set_lock_class(rwlock.id(), LockClass::Unique);
+    FfiRwLock::into_raw(rwlock)
 }
 
 /// Destroy a tracked RwLock.
@@ -53,10 +236,54 @@ pub unsafe extern "C" fn deloxide_create_rwlock_with_creator(
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_destroy_rwlock(rwlock: *mut c_void) {
     if !rwlock.is_null() {
-        unsafe {
-            drop(Box::from_raw(rwlock as *mut RwLock<()>));
-        }
+        unsafe { LazyHandle::<FfiRwLock>::free(rwlock) };
+    }
+}
+
+/// Initialize a caller-allocated RwLock.
+///
+/// Equivalent to assigning `DELOXIDE_RWLOCK_INITIALIZER`; see `deloxide_mutex_init`.
+///
+/// # Arguments
+/// * `rwlock` - Pointer to a `deloxide_rwlock_t`.
+///
+/// # Returns
+/// * `0` on success
+/// * `-1` if the pointer is NULL
+///
+/// # Safety
+/// - `rwlock` must point to writable, suitably aligned `deloxide_rwlock_t` storage.
+/// - An RwLock that is already in use must be destroyed with `deloxide_rwlock_destroy` first.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_rwlock_init(rwlock: *mut c_void) -> c_int {
+    if rwlock.is_null() {
+        return -1;
     }
+
+    unsafe { LazyHandle::<FfiRwLock>::init_in_place(rwlock) };
+    0
+}
+
+/// Destroy a caller-allocated RwLock.
+///
+/// # Arguments
+/// * `rwlock` - Pointer to a `deloxide_rwlock_t`.
+///
+/// # Returns
+/// * `0` on success
+/// * `-1` if the pointer is NULL
+///
+/// # Safety
+/// - `rwlock` must point to an initialized `deloxide_rwlock_t`, not to a handle from `deloxide_create_rwlock`.
+/// - No thread may use or hold the RwLock during or after this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_rwlock_destroy(rwlock: *mut c_void) -> c_int {
+    if rwlock.is_null() {
+        return -1;
+    }
+
+    unsafe { LazyHandle::<FfiRwLock>::destroy_in_place(rwlock) };
+    0
 }
 
 /// Lock an RwLock for reading.
@@ -69,26 +296,42 @@ pub unsafe extern "C" fn deloxide_destroy_rwlock(rwlock: *mut c_void) {
 /// * `-1` if pointer is NULL
 ///
 /// # Safety
-/// - Do not call twice from the same thread without unlocking.
-/// - Must use `deloxide_rw_unlock_read` to unlock.
+/// - Must use `deloxide_rw_unlock_read` from the same thread to unlock.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_rw_lock_read(rwlock: *mut c_void) -> c_int {
     if rwlock.is_null() {
         return -1;
     }
-    let rwlock_ref = unsafe { &*(rwlock as *const RwLock<()>) };
-    let guard = rwlock_ref.read();
-    unsafe {
-        FFI_RW_READ_GUARD.with(|slot| {
-            *slot.borrow_mut() = Some(std::mem::transmute::<
-                crate::core::locks::rwlock::RwLockReadGuard<'_, ()>,
-                crate::core::locks::rwlock::RwLockReadGuard<'_, ()>,
-            >(guard))
-        });
-    }
+    unsafe { FfiRwLock::from_handle(rwlock) }.read();
     0
 }
 
+/// Try to lock an RwLock for reading without blocking.
+///
+/// A failed attempt is not logged and adds no wait-for edge.
+///
+/// # Arguments
+/// * `rwlock` - Pointer to an RwLock.
+///
+/// # Returns
+/// * `0` if the read lock was acquired
+/// * `1` if the RwLock is write-locked
+/// * `-1` if pointer is NULL
+///
+/// # Safety
+/// - Must use `deloxide_rw_unlock_read` from the same thread to unlock.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_rw_try_read(rwlock: *mut c_void) -> c_int {
+    if rwlock.is_null() {
+        return -1;
+    }
+    if unsafe { FfiRwLock::from_handle(rwlock) }.try_read() {
+        0
+    } else {
+        1
+    }
+}
+
 /// Unlock an RwLock after reading.
 ///
 /// # Arguments
@@ -97,15 +340,17 @@ pub unsafe extern "C" fn deloxide_rw_lock_read(rwlock: *mut c_void) -> c_int {
 /// # Returns
 /// * `0` on success
 /// * `-1` if pointer is NULL
+/// * `-2` if the current thread holds no read lock on `rwlock`
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_rw_unlock_read(rwlock: *mut c_void) -> c_int {
     if rwlock.is_null() {
         return -1;
     }
-    FFI_RW_READ_GUARD.with(|slot| {
-        let _ = slot.borrow_mut().take();
-    });
-    0
+    if unsafe { FfiRwLock::from_handle(rwlock) }.unlock_read() {
+        0
+    } else {
+        -2
+    }
 }
 
 /// Lock an RwLock for writing.
@@ -125,20 +370,36 @@ pub unsafe extern "C" fn deloxide_rw_lock_write(rwlock: *mut c_void) -> c_int {
     if rwlock.is_null() {
         return -1;
     }
-    let rwlock_ref = unsafe { &*(rwlock as *const RwLock<()>) };
-    let guard = rwlock_ref.write();
-    unsafe {
-        FFI_RW_WRITE_GUARD.with(|slot| {
-            *slot.borrow_mut() = Some(std::mem::transmute::<
-                crate::core::locks::rwlock::RwLockWriteGuard<'_, ()>,
-                crate::core::locks::rwlock::RwLockWriteGuard<'_, ()>,
-            >(guard))
-        });
-    }
-
+    unsafe { FfiRwLock::from_handle(rwlock) }.write();
     0
 }
 
+/// Try to lock an RwLock for writing without blocking.
+///
+/// A failed attempt is not logged and adds no wait-for edge.
+///
+/// # Arguments
+/// * `rwlock` - Pointer to an RwLock.
+///
+/// # Returns
+/// * `0` if the write lock was acquired
+/// * `1` if the RwLock is held
+/// * `-1` if pointer is NULL
+///
+/// # Safety
+/// - Must use `deloxide_rw_unlock_write` to unlock.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_rw_try_write(rwlock: *mut c_void) -> c_int {
+    if rwlock.is_null() {
+        return -1;
+    }
+    if unsafe { FfiRwLock::from_handle(rwlock) }.try_write() {
+        0
+    } else {
+        1
+    }
+}
+
 /// Unlock an RwLock after writing.
 ///
 /// # Arguments
@@ -147,15 +408,17 @@ pub unsafe extern "C" fn deloxide_rw_lock_write(rwlock: *mut c_void) -> c_int {
 /// # Returns
 /// * `0` on success
 /// * `-1` if pointer is NULL
+/// * `-2` if the current thread does not hold the write lock
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn deloxide_rw_unlock_write(rwlock: *mut c_void) -> c_int {
     if rwlock.is_null() {
         return -1;
     }
-    FFI_RW_WRITE_GUARD.with(|slot| {
-        let _ = slot.borrow_mut().take();
-    });
-    0
+    if unsafe { FfiRwLock::from_handle(rwlock) }.unlock_write() {
+        0
+    } else {
+        -2
+    }
 }
 
 /// Get the creator thread ID of an RwLock.
@@ -170,6 +433,7 @@ pub unsafe extern "C" fn deloxide_get_rwlock_creator(rwlock: *mut c_void) -> usi
     if rwlock.is_null() {
         return 0;
     }
-    let rwlock_ref = unsafe { &*(rwlock as *const RwLock<()>) };
-    rwlock_ref.creator_thread_id()
+    unsafe { FfiRwLock::from_handle(rwlock) }
+        .rwlock
+        .creator_thread_id()
 }
@@ -0,0 +1,112 @@
+use crate::core::shared;
+use crate::ffi::INITIALIZED;
+use std::ffi::CStr;
+use std::os::raw::{c_char, c_int};
+use std::sync::atomic::Ordering;
+
+/// Attach this process to a shared memory region for cross-process detection
+///
+/// Must be called after `deloxide_init`, whose callback then also receives
+/// the deadlocks found across processes.
+///
+/// # Arguments
+/// * `path` - File backing the region as a null-terminated C string, created
+///   if it does not exist
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already attached
+/// * `-1` if path is NULL or contains invalid UTF-8
+/// * `-2` if the region could not be attached
+/// * `-3` if the detector is not initialized
+///
+/// # Safety
+/// `path` must be NULL or a valid null-terminated string.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_attach_shared_memory(path: *const c_char) -> c_int {
+    if path.is_null() {
+        return -1;
+    }
+    let Ok(path) = (unsafe { CStr::from_ptr(path) }).to_str() else {
+        return -1; // Invalid UTF-8
+    };
+    if !INITIALIZED.load(Ordering::SeqCst) {
+        return -3;
+    }
+    if shared::is_attached() {
+        return 1;
+    }
+    match shared::attach(path) {
+        Ok(()) => 0,
+        Err(_) => -2,
+    }
+}
+
+/// Map whether an annotation was published to a return code
+fn published(recorded: bool) -> c_int {
+    if recorded { 0 } else { 1 }
+}
+
+/// Publish that the current thread is about to block on a shared lock
+///
+/// # Arguments
+/// * `key` - Key of the lock, the same in every process (0 is reserved)
+///
+/// # Returns
+/// * `0` if published
+/// * `1` if not attached, or the region has no room for the thread or lock
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_shared_lock_attempt(key: u64) -> c_int {
+    published(shared::attempt(key))
+}
+
+/// Publish that the current thread acquired a shared lock
+///
+/// # Arguments
+/// * `key` - Key of the lock
+///
+/// # Returns
+/// * `0` if published
+/// * `1` if not attached, or the region has no room for the thread or lock
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_shared_lock_acquired(key: u64) -> c_int {
+    published(shared::acquired(key))
+}
+
+/// Publish that the current thread released a shared lock
+///
+/// # Arguments
+/// * `key` - Key of the lock
+///
+/// # Returns
+/// * `0` if published
+/// * `1` if not attached, or the region has no room for the thread or lock
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_shared_lock_released(key: u64) -> c_int {
+    published(shared::released(key))
+}
+
+/// Withdraw a published wait on a shared lock that gave up
+///
+/// # Arguments
+/// * `key` - Key of the lock
+///
+/// # Returns
+/// * `0` if published
+/// * `1` if not attached, or the region has no room for the thread or lock
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_shared_lock_cancel(key: u64) -> c_int {
+    published(shared::cancel_wait(key))
+}
@@ -0,0 +1,119 @@
+use std::os::raw::c_int;
+
+#[cfg(feature = "lock-stats")]
+use crate::core::stats;
+#[cfg(feature = "lock-stats")]
+use crate::ffi::{INITIALIZED, LOCK_STATS};
+#[cfg(feature = "lock-stats")]
+use std::sync::atomic::Ordering;
+
+/// Number of buckets in a wait-time histogram (`DELOXIDE_WAIT_HISTOGRAM_BUCKETS`)
+const WAIT_HISTOGRAM_BUCKETS: usize = 40;
+
+/// Contention statistics of one lock, as laid out by `deloxide_lock_stats`
+#[repr(C)]
+pub struct DeloxideLockStats {
+    /// ID of the lock
+    pub lock_id: usize,
+    /// Number of acquisitions
+    pub acquisitions: u64,
+    /// Number of acquisitions that had to wait
+    pub contended: u64,
+    /// Total wait of contended acquisitions in nanoseconds
+    pub total_wait_ns: u64,
+    /// Longest single wait in nanoseconds
+    pub max_wait_ns: u64,
+    /// Total hold time in nanoseconds
+    pub total_hold_ns: u64,
+    /// Longest single hold in nanoseconds
+    pub max_hold_ns: u64,
+    /// Contended waits by duration, bucket `i` covering `[2^i, 2^(i+1))` ns
+    pub wait_histogram: [u64; WAIT_HISTOGRAM_BUCKETS],
+}
+
+#[cfg(feature = "lock-stats")]
+const _: () = assert!(WAIT_HISTOGRAM_BUCKETS == stats::WAIT_HISTOGRAM_BUCKETS);
+
+#[cfg(feature = "lock-stats")]
+impl From<&stats::LockStats> for DeloxideLockStats {
+    fn from(lock: &stats::LockStats) -> Self {
+        let nanos = |duration: std::time::Duration| duration.as_nanos() as u64;
+        DeloxideLockStats {
+            lock_id: lock.lock_id,
+            acquisitions: lock.stats.acquisitions,
+            contended: lock.stats.contended,
+            total_wait_ns: nanos(lock.stats.total_wait),
+            max_wait_ns: nanos(lock.stats.max_wait),
+            total_hold_ns: nanos(lock.stats.total_hold),
+            max_hold_ns: nanos(lock.stats.max_hold),
+            wait_histogram: lock.stats.wait_histogram,
+        }
+    }
+}
+
+/// Enable per-lock contention statistics (only with "lock-stats" feature)
+///
+/// Must be called before `deloxide_init`.
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-1` if lock-stats feature is not enabled
+///
+/// # Safety
+/// This function only writes to atomics and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_enable_lock_stats() -> c_int {
+    #[cfg(feature = "lock-stats")]
+    {
+        if INITIALIZED.load(Ordering::SeqCst) {
+            return 1; // Already initialized
+        }
+
+        LOCK_STATS.store(true, Ordering::SeqCst);
+        0
+    }
+
+    #[cfg(not(feature = "lock-stats"))]
+    {
+        -1
+    }
+}
+
+/// Take a snapshot of the statistics of all live locks
+///
+/// Locks are written most contended first, so a buffer of `capacity`
+/// entries receives the `capacity` most contended locks.
+///
+/// # Arguments
+/// * `buffer` - Buffer for up to `capacity` entries (may be NULL if `capacity` is 0)
+/// * `capacity` - Number of entries the buffer can hold
+///
+/// # Returns
+/// * The number of locks with statistics, which may exceed `capacity`
+/// * `-1` if lock-stats feature is not enabled
+///
+/// # Safety
+/// `buffer` must point to writable memory for `capacity` entries.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_get_lock_stats(
+    buffer: *mut DeloxideLockStats,
+    capacity: usize,
+) -> c_int {
+    #[cfg(feature = "lock-stats")]
+    {
+        let snapshot = stats::lock_stats();
+        if !buffer.is_null() {
+            for (index, lock) in snapshot.iter().take(capacity).enumerate() {
+                unsafe { buffer.add(index).write(lock.into()) };
+            }
+        }
+        snapshot.len().min(c_int::MAX as usize) as c_int
+    }
+
+    #[cfg(not(feature = "lock-stats"))]
+    {
+        -1
+    }
+}
@@ -4,7 +4,7 @@ use std::os::raw::{c_int, c_ulong};
 #[cfg(feature = "stress-test")]
 use crate::core::StressConfig;
 #[cfg(feature = "stress-test")]
-use crate::ffi::{INITIALIZED, STRESS_CONFIG, STRESS_MODE};
+use crate::ffi::{INITIALIZED, STRESS_CONFIG, STRESS_MODE, STRESS_SEED};
 #[cfg(feature = "stress-test")]
 use std::sync::atomic::Ordering;
 
@@ -41,11 +41,12 @@ pub unsafe extern "C" fn deloxide_enable_random_stress(
         STRESS_MODE.store(1, Ordering::SeqCst);
 
         unsafe {
-            STRESS_CONFIG = Some(crate::core::stress::StressConfig {
+            STRESS_CONFIG = Some(StressConfig {
                 preemption_probability: probability,
                 min_delay_us,
                 max_delay_us,
                 preempt_after_release: true,
+                ..StressConfig::default()
             });
         }
 
@@ -95,6 +96,62 @@ pub unsafe extern "C" fn deloxide_enable_component_stress(
                 min_delay_us,
                 max_delay_us,
                 preempt_after_release: true,
+                ..StressConfig::default()
+            });
+        }
+
+        0
+    }
+
+    #[cfg(not(feature = "stress-test"))]
+    {
+        // Return error if stress-test feature is not enabled
+        -1
+    }
+}
+
+/// Enable PCT (probabilistic concurrency testing) stress testing (only with "stress-test" feature)
+///
+/// Threads get random priorities that are enforced as delays before nested
+/// lock acquisitions, and at `depth - 1` random acquisition points the
+/// current thread drops to the lowest priority.
+///
+/// # Arguments
+/// * `depth` - Bug depth to target, the number of change points plus one
+/// * `steps` - Expected number of lock acquisitions in a run
+/// * `min_delay_us` - Shortest delay worth waiting, in microseconds
+/// * `max_delay_us` - Delay of the lowest priority thread, in microseconds
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-1` if stress-test feature is not enabled
+///
+/// # Safety
+/// This function writes to mutable static variables and should be called before initialization.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_enable_pct_stress(
+    depth: c_ulong,
+    steps: c_ulong,
+    min_delay_us: c_ulong,
+    max_delay_us: c_ulong,
+) -> c_int {
+    #[cfg(feature = "stress-test")]
+    {
+        if INITIALIZED.load(Ordering::SeqCst) {
+            return 1; // Already initialized
+        }
+
+        STRESS_MODE.store(3, Ordering::SeqCst);
+
+        unsafe {
+            STRESS_CONFIG = Some(StressConfig {
+                min_delay_us,
+                max_delay_us,
+                pct_depth: depth as usize,
+                pct_steps: steps,
+                ..StressConfig::default()
             });
         }
 
@@ -108,6 +165,61 @@ pub unsafe extern "C" fn deloxide_enable_component_stress(
     }
 }
 
+/// Seed the random decisions of stress testing (only with "stress-test" feature)
+///
+/// Runs with the same seed make the same decisions as long as every thread
+/// reaches the same lock acquisitions. Without a seed, a random one is used;
+/// `deloxide_get_stress_seed` tells which.
+///
+/// # Arguments
+/// * `seed` - Seed of the run
+///
+/// # Returns
+/// * `0` on success
+/// * `1` if already initialized
+/// * `-1` if stress-test feature is not enabled
+///
+/// # Safety
+/// This function only writes to a mutex-protected static and is safe to call from any thread.
+#[unsafe(no_mangle)]
+#[allow(unused_variables)]
+pub unsafe extern "C" fn deloxide_set_stress_seed(seed: u64) -> c_int {
+    #[cfg(feature = "stress-test")]
+    {
+        if INITIALIZED.load(Ordering::SeqCst) {
+            return 1; // Already initialized
+        }
+
+        *STRESS_SEED.lock() = Some(seed);
+        0
+    }
+
+    #[cfg(not(feature = "stress-test"))]
+    {
+        -1
+    }
+}
+
+/// Get the seed of the current stress run (only with "stress-test" feature)
+///
+/// # Returns
+/// The seed, or `0` if stress testing is not enabled
+///
+/// # Safety
+/// This function only reads an atomic and is safe to call from any thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn deloxide_get_stress_seed() -> u64 {
+    #[cfg(feature = "stress-test")]
+    {
+        crate::core::stress::stress_seed()
+    }
+
+    #[cfg(not(feature = "stress-test"))]
+    {
+        0
+    }
+}
+
 /// Disable stress testing (only with "stress-test" feature)
 ///
 /// This function disables any previously enabled stress testing mode.
@@ -231,32 +231,115 @@
 //!         min_delay_us: 200,
 //!         max_delay_us: 1500,
 //!         preempt_after_release: true,
+//!         ..StressConfig::default()
 //!     })
 //!     .start()
 //!     .unwrap();
+//!
+//! // PCT priority scheduling with a fixed seed, so a failing run repeats
+//! Deloxide::new()
+//!     .with_pct_stress()
+//!     .with_stress_seed(42)
+//!     .start()
+//!     .unwrap();
+//! }
+//! ```
+//!
+//! The delays a run chose can be captured with `stress_schedule()`, typically
+//! in the deadlock callback, and replayed exactly:
+//!
+//! ```rust,no_run
+//! #[cfg(feature = "stress-test")]
+//! {
+//! use deloxide::{Deloxide, StressSchedule};
+//!
+//! let schedule: StressSchedule = std::fs::read_to_string("schedule.txt")
+//!     .unwrap()
+//!     .parse()
+//!     .unwrap();
+//! Deloxide::new().with_stress_replay(schedule).start().unwrap();
+//! }
+//! ```
+//!
+//! ## Lock Statistics (optional feature)
+//!
+//! Enable the `lock-stats` feature to count acquisitions, contention, wait and
+//! hold times per lock and per lock class.
+//!
+//! ```toml
+//! # Cargo.toml
+//! [dependencies]
+//! deloxide = { version = "1.0.0", features = ["lock-stats"] }
+//! ```
+//!
+//! ```rust
+//! #[cfg(feature = "lock-stats")]
+//! {
+//! use deloxide::Deloxide;
+//!
+//! Deloxide::new().with_lock_stats().start().unwrap();
+//!
+//! // ... run the workload ...
+//!
+//! for lock in deloxide::most_contended_locks(5) {
+//!     println!(
+//!         "lock {} waited {:?} over {} contended acquisitions (p99 {:?})",
+//!         lock.lock_id,
+//!         lock.stats.total_wait,
+//!         lock.stats.contended,
+//!         lock.stats.wait_quantile(0.99),
+//!     );
+//! }
 //! }
 //! ```
 
 mod core;
 pub use core::{
-    Deloxide,
+    Deloxide, Sampling,
+    detector::{ReportStats, report_repeats, report_stats},
     locks::condvar::Condvar,
-    locks::mutex::{Mutex, MutexGuard},
+    locks::mutex::{Mutex, MutexGuard, lock_many},
     locks::rwlock::{RwLock, RwLockReadGuard, RwLockWriteGuard},
+    sampling::{disable_detection, enable_detection, is_detection_enabled},
     thread,
     types::{DeadlockInfo, DeadlockSource, LockId, ThreadId},
 };
 
+#[cfg(feature = "async")]
+pub use core::r#async;
+
+#[cfg(unix)]
+pub use core::shared;
+
 #[cfg(feature = "stress-test")]
-pub use core::{StressConfig, StressMode};
+pub use core::{StressConfig, StressMode, StressSchedule, stress_schedule, stress_seed};
+
+#[cfg(feature = "lock-stats")]
+pub use core::stats::{
+    ClassStats, ContentionStats, LockStats, WAIT_HISTOGRAM_BUCKETS, contention_report,
+    lock_class_stats, lock_stats, most_contended_locks,
+};
 
 #[cfg(feature = "logging-and-visualization")]
 mod showcase;
 #[cfg(feature = "logging-and-visualization")]
-pub use showcase::{showcase, showcase_this};
+pub use core::analysis::{LockOrderInversion, LockUsage, LogAnalysis, analyze_log};
+#[cfg(feature = "logging-and-visualization")]
+pub use core::{LogFormat, RecorderCapacity};
+#[cfg(feature = "logging-and-visualization")]
+pub use showcase::{serve, showcase, showcase_this};
 
 pub mod ffi;
 
+/// Internal building blocks exposed for the benchmarks in `benches/`
+///
+/// Not part of the public API; may change without notice.
+#[doc(hidden)]
+pub mod __bench {
+    pub use crate::core::detector::Detector;
+    pub use crate::core::graph::WaitForGraph;
+}
+
 // Ascii art font name "miniwi"
 const BANNER: &str = r#"
 ▄ ▄▖▖ ▄▖▖▖▄▖▄ ▄▖    ▗   ▄▖  ▄▖
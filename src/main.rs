@@ -1,7 +1,10 @@
 use anyhow::Result;
-use clap::Parser;
-use deloxide::showcase;
+use clap::{Parser, Subcommand};
+use deloxide::{analyze_log, serve, showcase};
 use std::path::PathBuf;
+use std::time::Duration;
+
+mod campaign;
 
 /// Deloxide CLI - Cross-Language Deadlock Detector with Visualization
 ///
@@ -15,20 +18,118 @@ use std::path::PathBuf;
 #[command(
     author,
     version,
-    about = "Deloxide - Cross-Language Deadlock Detector With Visualization Support"
+    about = "Deloxide - Cross-Language Deadlock Detector With Visualization Support",
+    args_conflicts_with_subcommands = true
 )]
 struct Cli {
+    #[command(subcommand)]
+    command: Option<Commands>,
+
     /// Path to the log file to visualize
     ///
-    /// This should be a JSON log file produced by Deloxide's logging functionality.
+    /// This should be a log file produced by Deloxide's logging functionality,
+    /// either as JSON lines or in the compact binary format.
     /// The file contains records of thread-lock interactions that will be visualized.
-    log_file: PathBuf,
+    log_file: Option<PathBuf>,
+}
+
+#[derive(Subcommand)]
+enum Commands {
+    /// Visualize a log file (the same as passing the log file directly)
+    Showcase {
+        /// Path to the log file to visualize
+        log_file: PathBuf,
+    },
+
+    /// Host the visualization locally and stream a log into it
+    ///
+    /// Unlike showcase, the log stays on this machine and may be of any
+    /// size. The log can still be being written: the visualization follows
+    /// it as it grows and starts over when it is rewritten.
+    Serve {
+        /// Path to the log file to visualize
+        log_file: PathBuf,
+
+        /// Port to listen on (0 picks a free one)
+        #[arg(long, default_value_t = 0)]
+        port: u16,
+
+        /// Only print the address instead of opening the browser
+        #[arg(long)]
+        no_open: bool,
+    },
+
+    /// Check a log for lock order inversions and report the most contended locks
+    ///
+    /// Runs the lock order check of the "lock-order-graph" feature offline,
+    /// so a program only needs logging enabled to have its lock order
+    /// verified later.
+    Analyze {
+        /// Path to the log file to analyze
+        log_file: PathBuf,
+
+        /// Number of locks to list in the contention table
+        #[arg(long, default_value_t = 20)]
+        top: usize,
+
+        /// Number of threads to analyze with (defaults to the number of cores)
+        #[arg(long)]
+        jobs: Option<usize>,
+    },
+
+    /// Run a deadlock scenario many times under stress and report how often it manifests
+    ///
+    /// The scenario must be built with the "stress-test" feature and exit
+    /// successfully when Deloxide detected its deadlock, like the deadlock
+    /// tests do. Each run gets its stress mode and seed through the
+    /// DELOXIDE_STRESS_MODE and DELOXIDE_STRESS_SEED environment variables.
+    Campaign {
+        /// Stress modes to compare (none, random, component, pct)
+        #[arg(long, value_delimiter = ',', default_value = "random,component,pct")]
+        modes: Vec<String>,
+
+        /// Maximum number of runs per mode
+        #[arg(long, default_value_t = 1000)]
+        iterations: u64,
+
+        /// Runs per mode before stopping early is considered
+        #[arg(long, default_value_t = 30)]
+        min_iterations: u64,
+
+        /// Stop once every 95% interval is at most this wide on each side
+        #[arg(long, default_value_t = 0.03)]
+        precision: f64,
+
+        /// Number of runs in parallel (defaults to the number of cores)
+        #[arg(long)]
+        jobs: Option<usize>,
+
+        /// Seconds after which a run is killed and counted as missed
+        #[arg(long, default_value_t = 10.0)]
+        timeout: f64,
+
+        /// Campaign seed, from which every run's seed is derived (random by default)
+        #[arg(long)]
+        seed: Option<u64>,
+
+        /// Append the results to this CSV file
+        #[arg(long)]
+        csv: Option<PathBuf>,
+
+        /// Scenario name in the CSV output (defaults to the program name)
+        #[arg(long)]
+        label: Option<String>,
+
+        /// Scenario program and its arguments
+        #[arg(required = true, last = true)]
+        command: Vec<String>,
+    },
 }
 
 /// Main entry point for the Deloxide CLI application
 ///
 /// This function parses command-line arguments and launches the visualization
-/// for the specified log file.
+/// for the specified log file, or runs the requested subcommand.
 ///
 /// # Returns
 /// A Result that is Ok if the visualization was successful, or an error if it failed
@@ -38,8 +139,67 @@ struct Cli {
 /// - The log file could not be read
 /// - The log file could not be processed
 /// - The browser could not be opened
+/// - The visualization server could not be started
+/// - A campaign scenario could not be started
 fn main() -> Result<()> {
     let cli = Cli::parse();
-    showcase(cli.log_file)?;
+    match cli.command {
+        Some(Commands::Showcase { log_file }) => showcase(log_file)?,
+        Some(Commands::Serve {
+            log_file,
+            port,
+            no_open,
+        }) => serve(log_file, port, !no_open)?,
+        Some(Commands::Analyze {
+            log_file,
+            top,
+            jobs,
+        }) => {
+            let jobs = jobs.unwrap_or_else(|| {
+                std::thread::available_parallelism().map_or(1, |cores| cores.get())
+            });
+            print!("{}", analyze_log(log_file, jobs)?.report(top));
+        }
+        Some(Commands::Campaign {
+            modes,
+            iterations,
+            min_iterations,
+            precision,
+            jobs,
+            timeout,
+            seed,
+            csv,
+            label,
+            command,
+        }) => {
+            let label = label.unwrap_or_else(|| {
+                PathBuf::from(&command[0])
+                    .file_name()
+                    .map_or_else(|| command[0].clone(), |name| name.to_string_lossy().into())
+            });
+            campaign::Campaign {
+                command,
+                modes,
+                iterations,
+                min_iterations,
+                precision,
+                jobs: jobs.unwrap_or_else(|| {
+                    std::thread::available_parallelism().map_or(1, |cores| cores.get())
+                }),
+                timeout: Duration::from_secs_f64(timeout),
+                seed: seed.unwrap_or_else(rand::random),
+                label,
+                csv,
+            }
+            .run()?
+        }
+        None => match cli.log_file {
+            Some(log_file) => showcase(log_file)?,
+            None => {
+                use clap::CommandFactory;
+                Cli::command().print_help()?;
+            }
+        },
+    }
     Ok(())
 }
@@ -1,4 +1,5 @@
-use crate::core::types::DeadlockInfo;
+use crate::core::logger::binary::{self, BinaryRecord};
+use crate::core::types::{DeadlockInfo, Events as EventKind};
 use anyhow::{Context, Result};
 use base64::alphabet::URL_SAFE;
 use base64::engine::{Engine as _, general_purpose};
@@ -6,8 +7,8 @@ use flate2::Compression;
 use flate2::write::GzEncoder;
 use rmp_serde;
 use serde::{Deserialize, Serialize};
-use std::fs::File;
-use std::io::{BufRead, BufReader, Write};
+use std::collections::{BTreeMap, BTreeSet};
+use std::io::{BufRead, Write};
 use std::path::Path;
 
 /// Converts a log file to a compact, compressed, encoded format suitable for URL parameters
@@ -15,8 +16,8 @@ use std::path::Path;
 /// This function processes a Deloxide log file and converts it into a format that can be
 /// transmitted as a URL parameter for web-based visualization. It performs several steps:
 ///
-/// 1. Parse the JSON log file into structured data
-/// 2. Convert to a more compact representation
+/// 1. Parse the log file (JSON lines or the binary format) into structured data
+/// 2. Convert to a more compact representation, with graph keyframes
 /// 3. Serialize to MessagePack binary format
 /// 4. Compress using GZIP
 /// 5. Encode using Base64URL for safe transmission in URLs
@@ -34,48 +35,29 @@ use std::path::Path;
 /// - Failed to compress or encode the data
 /// ```
 pub(crate) fn process_log_for_url<P: AsRef<Path>>(log_path: P) -> Result<String> {
-    // Parse the input file
-    let file = File::open(log_path).context("Failed to open log file")?;
-    let reader = BufReader::new(file);
+    // Read the input file
+    let bytes = std::fs::read(log_path).context("Failed to open log file")?;
 
     // Create compact data structure
-    let mut compact_events = Vec::new();
-    let mut terminal_deadlock: Option<DeadlockCompact> = None;
-
-    // Process each line
-    for line in reader.lines() {
-        let line = line.context("Failed to read line from log file")?;
-        if let Ok(entry) = serde_json::from_str::<LogEntry>(&line) {
-            // Process each log entry
-            let event = parse_log_entry(entry).context("Failed to parse log entry")?;
-            compact_events.push(event);
-        } else if let Ok(dl) = serde_json::from_str::<DeadlockRecord>(&line) {
-            terminal_deadlock = Some(DeadlockCompact {
-                thread_cycle: dl.deadlock.thread_cycle.iter().map(|&t| t as u64).collect(),
-                thread_waiting_for_locks: dl
-                    .deadlock
-                    .thread_waiting_for_locks
-                    .iter()
-                    .map(|&(t, l)| (t as u64, l as u64))
-                    .collect(),
-                timestamp: dl.deadlock.timestamp.clone(),
-            });
+    let mut payload: Payload = Default::default();
+
+    if binary::is_binary_log(&bytes) {
+        // Binary records already carry event codes, no JSON round trip needed
+        for record in binary::decode(&bytes).context("Failed to decode binary log")? {
+            push_binary_record(record, &mut payload);
+        }
+    } else {
+        // Process each line
+        for line in bytes.lines() {
+            let line = line.context("Failed to read line from log file")?;
+            push_json_line(&line, &mut payload)?;
         }
     }
 
-    // Encode as a fixed 2-tuple: [events, deadlock_or_null]
-    let compact_output: (Events, Option<DeadlockCompact>) = (compact_events, terminal_deadlock);
+    add_keyframes(&mut payload, KEYFRAME_INTERVAL);
 
-    // 1. Convert to MessagePack
-    let msgpack =
-        rmp_serde::to_vec(&compact_output).context("Failed to convert data to MessagePack")?;
-
-    // 2. Apply Gzip compression
-    let mut encoder = GzEncoder::new(Vec::new(), Compression::best());
-    encoder
-        .write_all(&msgpack)
-        .context("Failed to compress data")?;
-    let compressed = encoder.finish().context("Failed to finish compression")?;
+    // 1. Convert to MessagePack and 2. apply Gzip compression
+    let compressed = compress_payload(&payload, Compression::best())?;
 
     // 3. Apply Base64URL encoding
     let base64_engine = general_purpose::GeneralPurpose::new(&URL_SAFE, general_purpose::PAD);
@@ -84,6 +66,180 @@ pub(crate) fn process_log_for_url<P: AsRef<Path>>(log_path: P) -> Result<String>
     Ok(encoded)
 }
 
+/// Events, terminal deadlock and graph keyframes of a log, encoded as a
+/// fixed 3-tuple `[events, deadlock_or_null, keyframes]` for the visualization
+pub(crate) type Payload = (Events, Option<DeadlockCompact>, Vec<Keyframe>);
+
+/// Number of events between two keyframes (`KEYFRAME_INTERVAL` in
+/// `frontend/js/utils.js`)
+const KEYFRAME_INTERVAL: usize = 1000;
+
+/// Snapshot of the visualized graph: `(events, threads, locks, links)`
+///
+/// Describes the graph after the first `events` events in sequence order.
+/// A link `(thread, lock, event_code)` is the last attempt, acquisition or
+/// wait of a thread on a lock that it has not released since. The frontend
+/// seeks by starting from the nearest keyframe instead of the first event.
+pub(crate) type Keyframe = (u64, Vec<u64>, Vec<u64>, Vec<(u64, u64, u8)>);
+
+/// Graph of active threads, locks and their links, as drawn by the frontend
+#[derive(Default)]
+struct GraphReplay {
+    threads: BTreeSet<u64>,
+    locks: BTreeSet<u64>,
+    links: BTreeMap<(u64, u64), u8>,
+}
+
+impl GraphReplay {
+    /// Apply one event, following `GraphStates.apply` in the frontend
+    fn apply(&mut self, &(_, thread_id, lock_id, code, ..): &Event) {
+        let Some(event) = EventKind::from_code(code) else {
+            return;
+        };
+        match event {
+            EventKind::ThreadSpawn if thread_id != 0 => {
+                self.threads.insert(thread_id);
+            }
+            EventKind::ThreadExit if thread_id != 0 => {
+                self.threads.remove(&thread_id);
+                self.links.retain(|&(thread, _), _| thread != thread_id);
+            }
+            EventKind::ThreadSpawn
+            | EventKind::MutexSpawn
+            | EventKind::RwSpawn
+            | EventKind::CondvarSpawn
+                if lock_id != 0 =>
+            {
+                self.locks.insert(lock_id);
+            }
+            EventKind::ThreadExit
+            | EventKind::MutexExit
+            | EventKind::RwExit
+            | EventKind::CondvarExit
+                if lock_id != 0 =>
+            {
+                self.locks.remove(&lock_id);
+                self.links.retain(|&(_, lock), _| lock != lock_id);
+            }
+            EventKind::MutexAttempt
+            | EventKind::MutexAcquired
+            | EventKind::RwReadAttempt
+            | EventKind::RwReadAcquired
+            | EventKind::RwWriteAttempt
+            | EventKind::RwWriteAcquired
+            | EventKind::CondvarWaitBegin
+                if thread_id != 0 && lock_id != 0 =>
+            {
+                self.threads.insert(thread_id);
+                self.locks.insert(lock_id);
+                self.links.insert((thread_id, lock_id), code);
+            }
+            EventKind::MutexReleased
+            | EventKind::RwReadReleased
+            | EventKind::RwWriteReleased
+            | EventKind::CondvarWaitEnd
+                if thread_id != 0 && lock_id != 0 =>
+            {
+                self.threads.insert(thread_id);
+                self.locks.insert(lock_id);
+                self.links.remove(&(thread_id, lock_id));
+            }
+            _ => {}
+        }
+    }
+
+    fn keyframe(&self, events: u64) -> Keyframe {
+        (
+            events,
+            self.threads.iter().copied().collect(),
+            self.locks.iter().copied().collect(),
+            self.links
+                .iter()
+                .map(|(&(thread, lock), &code)| (thread, lock, code))
+                .collect(),
+        )
+    }
+}
+
+/// Sort the events of a payload and add a keyframe every `interval` events
+pub(crate) fn add_keyframes(payload: &mut Payload, interval: usize) {
+    // The frontend replays events in sequence order
+    payload.0.sort_by_key(|event| event.0);
+    payload.2.clear();
+
+    let mut graph = GraphReplay::default();
+    for (index, event) in payload.0.iter().enumerate() {
+        graph.apply(event);
+        if (index + 1) % interval == 0 {
+            payload.2.push(graph.keyframe(index as u64 + 1));
+        }
+    }
+}
+
+/// Add a record of a binary log to the payload
+pub(crate) fn push_binary_record(record: BinaryRecord, payload: &mut Payload) {
+    match record {
+        BinaryRecord::Event(e) => payload.0.push((
+            e.sequence,
+            e.thread_id,
+            e.lock_id,
+            e.event.code(),
+            e.timestamp,
+            e.parent_id,
+            e.woken_thread,
+        )),
+        BinaryRecord::Deadlock(info) => {
+            payload.1 = Some(compact_deadlock(&info));
+        }
+    }
+}
+
+/// Add a line of a JSON log to the payload
+///
+/// Lines that are neither an event nor a deadlock record are skipped.
+///
+/// # Errors
+/// Returns an error if an event has an invalid type
+pub(crate) fn push_json_line(line: &str, payload: &mut Payload) -> Result<()> {
+    if let Ok(entry) = serde_json::from_str::<LogEntry>(line) {
+        // Process each log entry
+        let event = parse_log_entry(entry).context("Failed to parse log entry")?;
+        payload.0.push(event);
+    } else if let Ok(dl) = serde_json::from_str::<DeadlockRecord>(line) {
+        payload.1 = Some(compact_deadlock(&dl.deadlock));
+    }
+    Ok(())
+}
+
+/// Serialize a payload to MessagePack and compress it with Gzip
+///
+/// # Arguments
+/// * `payload` - Events and deadlock to encode
+/// * `level` - Gzip compression level; URLs want the smallest output,
+///   streamed chunks want the fastest
+pub(crate) fn compress_payload(payload: &Payload, level: Compression) -> Result<Vec<u8>> {
+    let msgpack = rmp_serde::to_vec(payload).context("Failed to convert data to MessagePack")?;
+
+    let mut encoder = GzEncoder::new(Vec::new(), level);
+    encoder
+        .write_all(&msgpack)
+        .context("Failed to compress data")?;
+    encoder.finish().context("Failed to finish compression")
+}
+
+/// Reduce a deadlock record to the fields the visualization uses
+fn compact_deadlock(info: &DeadlockInfo) -> DeadlockCompact {
+    DeadlockCompact {
+        thread_cycle: info.thread_cycle.iter().map(|&t| t as u64).collect(),
+        thread_waiting_for_locks: info
+            .thread_waiting_for_locks
+            .iter()
+            .map(|&(t, l)| (t as u64, l as u64))
+            .collect(),
+        timestamp: info.timestamp.clone(),
+    }
+}
+
 /// Log entry structure from the file (simplified - no graph data)
 #[derive(Debug, Deserialize)]
 struct LogEntry {
@@ -107,9 +263,9 @@ struct LogEntry {
 
 // Compact Event format: (sequence, thread_id, lock_id, event_code, timestamp, parent_id, woken_thread)
 // parent_id and woken_thread are Option<u64> stored as u64, with 0 indicating None
-type Event = (u64, u64, u64, u8, f64, u64, u64);
+pub(crate) type Event = (u64, u64, u64, u8, f64, u64, u64);
 
-type Events = Vec<Event>;
+pub(crate) type Events = Vec<Event>;
 
 #[derive(Serialize, Deserialize)]
 pub struct DeadlockCompact {
@@ -133,44 +289,9 @@ pub struct DeadlockCompact {
 /// Returns an error if the event type is invalid
 fn parse_log_entry(entry: LogEntry) -> Result<Event> {
     // Convert event to compact format - each event type gets a unique code
-    let event_code = match entry.event.as_str() {
-        // Thread lifecycle
-        "ThreadSpawn" => 0u8,
-        "ThreadExit" => 1u8,
-
-        // Mutex lifecycle
-        "MutexSpawn" => 2u8,
-        "MutexExit" => 3u8,
-
-        // RwLock lifecycle
-        "RwSpawn" => 4u8,
-        "RwExit" => 5u8,
-
-        // Condvar lifecycle
-        "CondvarSpawn" => 6u8,
-        "CondvarExit" => 7u8,
-
-        // Mutex interactions
-        "MutexAttempt" => 10u8,
-        "MutexAcquired" => 11u8,
-        "MutexReleased" => 12u8,
-
-        // RwLock interactions
-        "RwReadAttempt" => 20u8,
-        "RwReadAcquired" => 21u8,
-        "RwReadReleased" => 22u8,
-        "RwWriteAttempt" => 23u8,
-        "RwWriteAcquired" => 24u8,
-        "RwWriteReleased" => 25u8,
-
-        // Condvar interactions
-        "CondvarWaitBegin" => 30u8,
-        "CondvarWaitEnd" => 31u8,
-        "CondvarNotifyOne" => 32u8,
-        "CondvarNotifyAll" => 33u8,
-
-        other => anyhow::bail!("Invalid event type: '{}'", other),
-    };
+    let event_code = serde_json::from_value::<EventKind>(serde_json::Value::String(entry.event))
+        .map_err(|e| anyhow::anyhow!("Invalid event type: {e}"))?
+        .code();
 
     // Convert parent_id and woken_thread to u64, using 0 to represent None
     let parent_id = entry.parent_id.unwrap_or(0);
@@ -221,6 +342,46 @@ mod tests {
         assert_eq!(result.6, 0); // woken_thread (None = 0)
     }
 
+    #[test]
+    fn test_keyframes_snapshot_the_graph() {
+        let event = |sequence, thread_id, lock_id, event: EventKind| {
+            (sequence, thread_id, lock_id, event.code(), 0.0, 0, 0)
+        };
+        let mut payload: Payload = Default::default();
+        // Out of order, as a log might be written
+        payload.0 = vec![
+            event(1, 1, 0, EventKind::ThreadSpawn),
+            event(0, 0, 7, EventKind::MutexSpawn),
+            event(2, 1, 7, EventKind::MutexAttempt),
+            event(3, 1, 7, EventKind::MutexAcquired),
+            event(4, 2, 0, EventKind::ThreadSpawn),
+            event(5, 2, 7, EventKind::MutexAttempt),
+            event(6, 1, 7, EventKind::MutexReleased),
+            event(7, 1, 0, EventKind::ThreadExit),
+        ];
+
+        add_keyframes(&mut payload, 2);
+        let sequences: Vec<u64> = payload.0.iter().map(|event| event.0).collect();
+        assert_eq!(sequences, (0..8).collect::<Vec<_>>());
+
+        let attempt = EventKind::MutexAttempt.code();
+        let acquired = EventKind::MutexAcquired.code();
+        assert_eq!(
+            payload.2,
+            [
+                (2, vec![1], vec![7], vec![]),
+                (4, vec![1], vec![7], vec![(1, 7, acquired)]),
+                (
+                    6,
+                    vec![1, 2],
+                    vec![7],
+                    vec![(1, 7, acquired), (2, 7, attempt)]
+                ),
+                (8, vec![2], vec![7], vec![(2, 7, attempt)]),
+            ]
+        );
+    }
+
     #[test]
     fn test_unique_event_codes() {
         let events = vec![
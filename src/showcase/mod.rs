@@ -1,5 +1,7 @@
 pub mod encoder;
+mod server;
 use encoder::process_log_for_url;
+pub use server::serve;
 
 use crate::core::logger::{self};
 use anyhow::{Context, Result};
@@ -0,0 +1,373 @@
+//! Local visualization server
+//!
+//! [`showcase`](super::showcase) packs the whole log into a URL for the
+//! hosted frontend, which gets slow on large logs and stops working once the
+//! URL outgrows what browsers accept. The server instead hosts the bundled
+//! frontend itself and hands the log out in chunks: the frontend asks for
+//! the events after a cursor, renders what it has, and keeps asking, so it
+//! starts drawing before the log is fully parsed and follows a log that is
+//! still being written.
+//!
+//! A chunk is the same MessagePack payload as the URL form, gzipped at the
+//! fastest level since it never has to fit into a URL. The cursor comes
+//! back in the `X-Deloxide-Cursor` header; `X-Deloxide-Pending` says more of
+//! the log is already available and `X-Deloxide-Reset` says the log shrank
+//! (it was rewritten, as flight-recorder logs are) and the frontend should
+//! start over.
+
+use super::encoder::{self, Payload};
+use crate::core::logger::binary::{self, BinaryDecoder};
+use anyhow::{Context, Result, bail};
+use flate2::Compression;
+use std::fs::File;
+use std::io::{BufRead, BufReader, Read, Seek, SeekFrom, Write};
+use std::net::{Ipv4Addr, TcpListener, TcpStream};
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+use std::thread;
+
+/// Bytes of the log read per chunk (a chunk is extended to hold at least
+/// one complete record)
+const CHUNK_BYTES: usize = 1 << 20;
+
+/// Path the frontend requests chunks from
+const LOG_ENDPOINT: &str = "/api/log";
+
+/// Frontend files compiled into the binary, by request path
+const ASSETS: &[(&str, &str, &[u8])] = &[
+    (
+        "/index.html",
+        "text/html; charset=utf-8",
+        include_bytes!("../../frontend/index.html"),
+    ),
+    (
+        "/css/style.css",
+        "text/css; charset=utf-8",
+        include_bytes!("../../frontend/css/style.css"),
+    ),
+    (
+        "/js/app.js",
+        "text/javascript; charset=utf-8",
+        include_bytes!("../../frontend/js/app.js"),
+    ),
+    (
+        "/js/utils.js",
+        "text/javascript; charset=utf-8",
+        include_bytes!("../../frontend/js/utils.js"),
+    ),
+    (
+        "/img/logo.png",
+        "image/png",
+        include_bytes!("../../frontend/img/logo.png"),
+    ),
+    (
+        "/img/mini-logo.png",
+        "image/png",
+        include_bytes!("../../frontend/img/mini-logo.png"),
+    ),
+    (
+        "/img/favicon.ico",
+        "image/x-icon",
+        include_bytes!("../../frontend/img/favicon.ico"),
+    ),
+];
+
+/// Position of a reader in a log
+///
+/// For binary logs it also carries the running values of the decoder, since
+/// records are delta encoded. Sent to the frontend as
+/// `offset-sequence-nanos`.
+#[derive(Debug, Default, Clone, Copy, PartialEq)]
+struct Cursor {
+    offset: u64,
+    sequence: u64,
+    nanos: u64,
+}
+
+impl Cursor {
+    fn parse(text: &str) -> Option<Self> {
+        let mut parts = text.split('-').map(str::parse::<u64>);
+        let cursor = Cursor {
+            offset: parts.next()?.ok()?,
+            sequence: parts.next()?.ok()?,
+            nanos: parts.next()?.ok()?,
+        };
+        parts.next().is_none().then_some(cursor)
+    }
+
+    fn encode(&self) -> String {
+        format!("{}-{}-{}", self.offset, self.sequence, self.nanos)
+    }
+}
+
+/// The events after a cursor
+struct Chunk {
+    payload: Payload,
+    cursor: Cursor,
+    /// The log shrank below the cursor and was read from the start
+    reset: bool,
+    /// More of the log is available right away
+    pending: bool,
+}
+
+/// Read the complete records of the log following `cursor`
+fn read_chunk(log_path: &Path, cursor: Cursor) -> Result<Chunk> {
+    let mut file = File::open(log_path).context("Failed to open log file")?;
+    let len = file.metadata()?.len();
+    let reset = cursor.offset > len;
+    let mut cursor = if reset { Cursor::default() } else { cursor };
+
+    let mut header = Vec::with_capacity(BinaryDecoder::HEADER_LEN);
+    (&mut file)
+        .take(BinaryDecoder::HEADER_LEN as u64)
+        .read_to_end(&mut header)?;
+    let is_binary = binary::is_binary_log(&header);
+    if is_binary && header.len() < BinaryDecoder::HEADER_LEN {
+        // The header itself is still being written
+        return Ok(Chunk {
+            payload: Default::default(),
+            cursor,
+            reset,
+            pending: false,
+        });
+    }
+    let epoch_wall = if is_binary {
+        cursor.offset = cursor.offset.max(BinaryDecoder::HEADER_LEN as u64);
+        BinaryDecoder::new(&header)?.epoch_wall
+    } else {
+        0.0
+    };
+
+    let mut payload: Payload = Default::default();
+    let mut limit = CHUNK_BYTES;
+    let consumed = loop {
+        let mut bytes = Vec::new();
+        file.seek(SeekFrom::Start(cursor.offset))?;
+        (&mut file).take(limit as u64).read_to_end(&mut bytes)?;
+
+        let consumed = if is_binary {
+            let mut decoder = BinaryDecoder::resume(epoch_wall, cursor.sequence, cursor.nanos);
+            let mut records = Vec::new();
+            let consumed = decoder
+                .decode(&bytes, &mut records)
+                .context("Failed to decode binary log")?;
+            for record in records {
+                encoder::push_binary_record(record, &mut payload);
+            }
+            cursor.sequence = decoder.sequence;
+            cursor.nanos = decoder.nanos;
+            consumed
+        } else {
+            // Only complete lines; the last one may still be being written
+            let complete = bytes
+                .iter()
+                .rposition(|&byte| byte == b'\n')
+                .map_or(0, |end| end + 1);
+            for line in bytes[..complete].lines() {
+                encoder::push_json_line(&line?, &mut payload)?;
+            }
+            complete
+        };
+
+        // A single record larger than the chunk: read more of it
+        if consumed == 0 && bytes.len() == limit {
+            limit *= 2;
+            continue;
+        }
+        break consumed;
+    };
+
+    cursor.offset += consumed as u64;
+    Ok(Chunk {
+        payload,
+        cursor,
+        reset,
+        pending: cursor.offset < len && consumed > 0,
+    })
+}
+
+/// Write a complete HTTP response and close the connection
+fn respond(
+    stream: &mut TcpStream,
+    status: &str,
+    content_type: &str,
+    extra_headers: &[(&str, String)],
+    body: &[u8],
+) -> std::io::Result<()> {
+    let mut head = format!(
+        "HTTP/1.1 {status}\r\nContent-Type: {content_type}\r\nContent-Length: {}\r\nConnection: close\r\n",
+        body.len()
+    );
+    for (name, value) in extra_headers {
+        head.push_str(&format!("{name}: {value}\r\n"));
+    }
+    head.push_str("\r\n");
+    stream.write_all(head.as_bytes())?;
+    stream.write_all(body)?;
+    stream.flush()
+}
+
+/// Serve one request
+fn handle(mut stream: TcpStream, log_path: &Path) -> Result<()> {
+    let mut request_line = String::new();
+    let mut reader = BufReader::new(stream.try_clone()?);
+    reader.read_line(&mut request_line)?;
+    // Skip the headers, nothing in them matters here
+    let mut header = String::new();
+    while reader.read_line(&mut header)? > 2 {
+        header.clear();
+    }
+
+    let mut words = request_line.split_whitespace();
+    let (Some(method), Some(target)) = (words.next(), words.next()) else {
+        bail!("Malformed request line {request_line:?}");
+    };
+    if method != "GET" {
+        respond(
+            &mut stream,
+            "405 Method Not Allowed",
+            "text/plain",
+            &[],
+            b"",
+        )?;
+        return Ok(());
+    }
+    let (path, query) = target.split_once('?').unwrap_or((target, ""));
+
+    if path == LOG_ENDPOINT {
+        let cursor = query
+            .split('&')
+            .find_map(|pair| pair.strip_prefix("cursor="))
+            .and_then(Cursor::parse)
+            .unwrap_or_default();
+        match read_chunk(log_path, cursor).and_then(|chunk| {
+            Ok((
+                encoder::compress_payload(&chunk.payload, Compression::fast())?,
+                chunk,
+            ))
+        }) {
+            Ok((body, chunk)) => respond(
+                &mut stream,
+                "200 OK",
+                "application/octet-stream",
+                &[
+                    ("Cache-Control", "no-store".to_string()),
+                    ("X-Deloxide-Cursor", chunk.cursor.encode()),
+                    ("X-Deloxide-Pending", u8::from(chunk.pending).to_string()),
+                    ("X-Deloxide-Reset", u8::from(chunk.reset).to_string()),
+                ],
+                &body,
+            )?,
+            Err(err) => respond(
+                &mut stream,
+                "500 Internal Server Error",
+                "text/plain",
+                &[],
+                format!("{err:#}").as_bytes(),
+            )?,
+        }
+        return Ok(());
+    }
+
+    let path = if path == "/" { "/index.html" } else { path };
+    match ASSETS.iter().find(|(asset, _, _)| *asset == path) {
+        Some((_, content_type, body)) => respond(&mut stream, "200 OK", content_type, &[], body)?,
+        None => respond(
+            &mut stream,
+            "404 Not Found",
+            "text/plain",
+            &[],
+            b"Not found",
+        )?,
+    }
+    Ok(())
+}
+
+/// Serve the visualization of a log locally
+///
+/// Hosts the bundled frontend on `127.0.0.1` and streams the log to it in
+/// chunks, following the file as it grows. Unlike [`showcase`](super::showcase),
+/// the log never leaves the machine and its size is not limited by URL
+/// lengths. Runs until the process is stopped.
+///
+/// # Arguments
+/// * `log_path` - Path to the log file, which may still be being written
+/// * `port` - Port to listen on, or 0 to pick a free one
+/// * `open_browser` - Whether to open the visualization in the default browser
+///
+/// # Errors
+/// Returns an error if:
+/// - The log file does not exist
+/// - The port could not be bound
+/// - Failed to open the browser
+///
+/// # Example
+///
+/// ```no_run
+/// // Follow the log of a running process on http://127.0.0.1:8080
+/// deloxide::serve("deadlock.log", 8080, true).expect("Failed to serve visualization");
+/// ```
+pub fn serve<P: AsRef<Path>>(log_path: P, port: u16, open_browser: bool) -> Result<()> {
+    let log_path: Arc<PathBuf> = Arc::new(log_path.as_ref().to_path_buf());
+    if !log_path.exists() {
+        bail!("Log file {} does not exist", log_path.display());
+    }
+
+    let listener = TcpListener::bind((Ipv4Addr::LOCALHOST, port)).context("Failed to bind port")?;
+    let url = format!("http://{}/?stream={LOG_ENDPOINT}", listener.local_addr()?);
+    println!("Serving {} at {url} (Ctrl+C to stop)", log_path.display());
+    if open_browser {
+        webbrowser::open(&url).context("Failed to open browser")?;
+    }
+
+    for stream in listener.incoming() {
+        let Ok(stream) = stream else { continue };
+        let log_path = Arc::clone(&log_path);
+        thread::spawn(move || {
+            if let Err(err) = handle(stream, &log_path) {
+                eprintln!("Request failed: {err:#}");
+            }
+        });
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+
+    #[test]
+    fn test_chunks_follow_a_growing_json_log() {
+        let mut log = tempfile::NamedTempFile::new().unwrap();
+        let event = |sequence: u64| {
+            format!(
+                "{{\"sequence\":{sequence},\"thread_id\":1,\"lock_id\":2,\"event\":\"MutexAcquired\",\"timestamp\":1.0}}\n"
+            )
+        };
+        write!(log, "{}{}", event(0), event(1)).unwrap();
+        // Half of a line that is still being written
+        let partial = event(2);
+        log.write_all(&partial.as_bytes()[..10]).unwrap();
+        log.flush().unwrap();
+
+        let chunk = read_chunk(log.path(), Cursor::default()).unwrap();
+        let sequences: Vec<u64> = chunk.payload.0.iter().map(|event| event.0).collect();
+        assert_eq!(sequences, [0, 1]);
+        assert!(!chunk.reset);
+        assert_eq!(Cursor::parse(&chunk.cursor.encode()), Some(chunk.cursor));
+
+        log.write_all(&partial.as_bytes()[10..]).unwrap();
+        log.flush().unwrap();
+        let next = read_chunk(log.path(), chunk.cursor).unwrap();
+        assert_eq!(next.payload.0.len(), 1);
+        assert_eq!(next.payload.0[0].0, 2);
+        assert!(!next.pending);
+
+        // A rewritten, shorter log starts over
+        log.as_file().set_len(0).unwrap();
+        let restarted = read_chunk(log.path(), next.cursor).unwrap();
+        assert!(restarted.reset);
+        assert!(restarted.payload.0.is_empty());
+    }
+}
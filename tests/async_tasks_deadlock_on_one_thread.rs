@@ -0,0 +1,104 @@
+#![cfg(feature = "async")]
+
+use deloxide::DeadlockSource;
+use deloxide::r#async::{Mutex, track};
+use std::future::Future;
+use std::pin::Pin;
+use std::sync::mpsc::{self, Sender};
+use std::sync::{Arc, Mutex as StdMutex};
+use std::task::{Context, Poll, Wake, Waker};
+use std::thread;
+mod common;
+use common::{DEADLOCK_TIMEOUT, expect_deadlock, start_detector};
+
+type BoxedTask = Pin<Box<dyn Future<Output = ()> + Send>>;
+
+/// A task of the single-threaded executor below, rescheduled when woken
+struct Task {
+    future: StdMutex<Option<BoxedTask>>,
+    queue: Sender<Arc<Task>>,
+}
+
+impl Wake for Task {
+    fn wake(self: Arc<Self>) {
+        let _ = self.queue.clone().send(self);
+    }
+}
+
+/// Run all tasks on one thread until none of them can make progress
+fn spawn_executor(tasks: Vec<BoxedTask>) {
+    let (queue, ready) = mpsc::channel();
+    for future in tasks {
+        let task = Arc::new(Task {
+            future: StdMutex::new(Some(future)),
+            queue: queue.clone(),
+        });
+        queue.send(task).unwrap();
+    }
+
+    thread::spawn(move || {
+        for task in ready {
+            let mut slot = task.future.lock().unwrap();
+            if let Some(future) = slot.as_mut() {
+                let waker = Waker::from(Arc::clone(&task));
+                if future
+                    .as_mut()
+                    .poll(&mut Context::from_waker(&waker))
+                    .is_ready()
+                {
+                    *slot = None;
+                }
+            }
+        }
+    });
+}
+
+/// Let the other tasks run once
+async fn yield_now() {
+    let mut yielded = false;
+    std::future::poll_fn(|cx| {
+        if yielded {
+            Poll::Ready(())
+        } else {
+            yielded = true;
+            cx.waker().wake_by_ref();
+            Poll::Pending
+        }
+    })
+    .await
+}
+
+#[test]
+fn test_async_tasks_deadlock_on_one_thread() {
+    let harness = start_detector();
+
+    let a = Arc::new(Mutex::new("A"));
+    let b = Arc::new(Mutex::new("B"));
+
+    // Both tasks run on the same thread, so only their task identities tell
+    // the two sides of the cycle apart
+    let first = {
+        let (a, b) = (Arc::clone(&a), Arc::clone(&b));
+        track(async move {
+            let _a = a.lock().await;
+            yield_now().await;
+            let _b = b.lock().await;
+        })
+    };
+    let second = {
+        let (a, b) = (Arc::clone(&a), Arc::clone(&b));
+        track(async move {
+            let _b = b.lock().await;
+            yield_now().await;
+            let _a = a.lock().await;
+        })
+    };
+    let tasks = [first.task_id(), second.task_id()];
+    spawn_executor(vec![Box::pin(first), Box::pin(second)]);
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    if info.source == DeadlockSource::WaitForGraph {
+        assert_eq!(info.thread_cycle.len(), 2);
+        assert!(tasks.iter().all(|task| info.thread_cycle.contains(task)));
+    }
+}
@@ -14,12 +14,18 @@ pub struct DetectorHarness {
     pub detected: Arc<StdMutex<bool>>,
 }
 
+#[allow(dead_code)]
 pub fn start_detector() -> DetectorHarness {
+    start_detector_with(Deloxide::new())
+}
+
+#[allow(dead_code)]
+pub fn start_detector_with(builder: Deloxide) -> DetectorHarness {
     let (tx, rx) = mpsc::channel::<DeadlockInfo>();
     let detected = Arc::new(StdMutex::new(false));
     let flag = Arc::clone(&detected);
 
-    let builder = Deloxide::new().callback(move |info| {
+    let builder = builder.callback(move |info| {
         #[cfg(feature = "logging-and-visualization")]
         {
             let _ = showcase_this();
@@ -0,0 +1,59 @@
+#![cfg(feature = "compact-locks")]
+
+use deloxide::{Mutex, thread};
+use std::collections::HashSet;
+use std::sync::{Arc, Barrier};
+use std::time::Duration;
+mod common;
+use common::{DEADLOCK_TIMEOUT, expect_deadlock, start_detector};
+
+#[test]
+fn test_compact_mutex_lazy_registration() {
+    let harness = start_detector();
+    assert!(
+        std::mem::size_of::<Mutex<u64>>() <= std::mem::size_of::<parking_lot::Mutex<u64>>() + 8
+    );
+
+    // IDs taken from per-thread blocks stay unique across threads
+    let creators: Vec<_> = (0..4)
+        .map(|_| thread::spawn(|| (0..1000).map(|_| Mutex::new(()).id()).collect::<Vec<_>>()))
+        .collect();
+    let mut ids = HashSet::new();
+    for creator in creators {
+        for id in creator.join().unwrap() {
+            assert!(ids.insert(id), "Lock ID {id} was handed out twice");
+        }
+    }
+
+    // Locks only ever taken uncontended are unknown to the detector until
+    // the deadlock, which still has to be reported
+    let a = Arc::new(Mutex::new("A"));
+    let b = Arc::new(Mutex::new("B"));
+    for _ in 0..100 {
+        drop((a.lock(), b.lock()));
+    }
+
+    let barrier = Arc::new(Barrier::new(2));
+    for (first, second) in [(&a, &b), (&b, &a)] {
+        let (first, second) = (Arc::clone(first), Arc::clone(second));
+        let barrier = Arc::clone(&barrier);
+        thread::spawn(move || {
+            let _first = first.lock();
+            barrier.wait();
+            thread::sleep(Duration::from_millis(50));
+            let _second = second.lock();
+        });
+    }
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    assert_eq!(info.thread_cycle.len(), 2);
+    let mut locks: Vec<_> = info
+        .thread_waiting_for_locks
+        .iter()
+        .map(|&(_, lock)| lock)
+        .collect();
+    locks.sort_unstable();
+    let mut expected = vec![a.id(), b.id()];
+    expected.sort_unstable();
+    assert_eq!(locks, expected);
+}
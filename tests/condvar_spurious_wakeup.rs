@@ -45,3 +45,25 @@ fn test_condvar_spurious_wakeup_no_deadlock() {
     assert_no_deadlock(&harness, NO_DEADLOCK_TIMEOUT);
     // Not asserting notify_count value strictly; primary check is absence of deadlock
 }
+
+#[test]
+fn test_condvar_timed_out_waiter_is_not_woken_later() {
+    let harness = start_detector();
+
+    let m = DMutex::new(());
+    let cv = Condvar::new();
+
+    // Nobody notifies, so the wait times out while still queued on the condvar
+    {
+        let mut g = m.lock();
+        assert!(cv.wait_timeout(&mut g, std::time::Duration::from_millis(10)));
+    }
+
+    // Notifying must not wake the finished wait, which would leave this
+    // thread waiting for a mutex it holds itself
+    let g = m.lock();
+    cv.notify_one();
+    drop(g);
+
+    assert_no_deadlock(&harness, NO_DEADLOCK_TIMEOUT);
+}
@@ -0,0 +1,74 @@
+use deloxide::{Deloxide, Mutex, RwLock, thread};
+use std::sync::Arc;
+use std::time::Duration;
+mod common;
+use common::{DEADLOCK_TIMEOUT, NO_DEADLOCK_TIMEOUT, expect_deadlock, start_detector_with};
+
+const THRESHOLD: Duration = Duration::from_millis(50);
+
+#[test]
+fn test_deferred_detection_reports_each_deadlock_once() {
+    let harness = start_detector_with(Deloxide::new().with_deferred_detection(THRESHOLD));
+
+    // Contention that resolves before the threshold is never checked
+    let shared = Arc::new(Mutex::new(0));
+    let workers: Vec<_> = (0..4)
+        .map(|_| {
+            let shared = Arc::clone(&shared);
+            thread::spawn(move || {
+                for _ in 0..200 {
+                    *shared.lock() += 1;
+                }
+            })
+        })
+        .collect();
+    for worker in workers {
+        worker.join().unwrap();
+    }
+    assert!(harness.rx.try_recv().is_err());
+
+    // Mutex cycle: both threads stay blocked past the threshold
+    let mutex_a = Arc::new(Mutex::new(()));
+    let mutex_b = Arc::new(Mutex::new(()));
+    for (first, second) in [
+        (Arc::clone(&mutex_a), Arc::clone(&mutex_b)),
+        (Arc::clone(&mutex_b), Arc::clone(&mutex_a)),
+    ] {
+        thread::spawn(move || {
+            let _first = first.lock();
+            thread::sleep(Duration::from_millis(100));
+            let _second = second.lock();
+        });
+    }
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    assert_eq!(info.thread_cycle.len(), 2);
+    assert_eq!(info.thread_waiting_for_locks.len(), 2);
+
+    // Both threads keep checking, but the cycle is only reported once
+    assert!(
+        harness.rx.recv_timeout(4 * THRESHOLD).is_err(),
+        "Deadlock reported twice"
+    );
+
+    // RwLock cycle between two writers
+    let lock_a = Arc::new(RwLock::new(()));
+    let lock_b = Arc::new(RwLock::new(()));
+    for (first, second) in [
+        (Arc::clone(&lock_a), Arc::clone(&lock_b)),
+        (Arc::clone(&lock_b), Arc::clone(&lock_a)),
+    ] {
+        thread::spawn(move || {
+            let _first = first.write();
+            thread::sleep(Duration::from_millis(100));
+            let _second = second.write();
+        });
+    }
+
+    // Lock order checking may report the inversion before anyone blocks
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    if info.lock_order_cycle.is_none() {
+        assert_eq!(info.thread_cycle.len(), 2);
+    }
+    assert!(harness.rx.recv_timeout(NO_DEADLOCK_TIMEOUT).is_err());
+}
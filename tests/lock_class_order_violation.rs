@@ -0,0 +1,74 @@
+#![cfg(feature = "lock-order-graph")]
+
+use deloxide::{DeadlockInfo, DeadlockSource, Deloxide, Mutex};
+use std::sync::mpsc;
+mod common;
+use common::DEADLOCK_TIMEOUT;
+
+fn new_account() -> Mutex<u64> {
+    Mutex::new(0)
+}
+
+fn new_ledger() -> Mutex<Vec<u64>> {
+    Mutex::new(Vec::new())
+}
+
+#[test]
+fn test_inversion_between_different_instances_of_two_classes() {
+    let (tx, rx) = mpsc::channel::<DeadlockInfo>();
+    Deloxide::new()
+        .with_lock_class_ordering()
+        .callback(move |info| {
+            let _ = tx.send(info);
+        })
+        .start()
+        .expect("Failed to initialize detector");
+
+    // Nesting locks of the same class is never an ordering edge
+    let first = new_account();
+    let second = new_account();
+    {
+        let _a = first.lock();
+        let _b = second.lock();
+    }
+    {
+        let _b = second.lock();
+        let _a = first.lock();
+    }
+
+    // Establish account -> ledger with one pair of objects...
+    let account = new_account();
+    let ledger = new_ledger();
+    {
+        let _a = account.lock();
+        let _l = ledger.lock();
+    }
+
+    // ...and take ledger -> account on a pair that was never nested before
+    let other_account = new_account();
+    let other_ledger = new_ledger();
+    {
+        let _l = other_ledger.lock();
+        let _a = other_account.lock();
+    }
+
+    let info = rx
+        .recv_timeout(DEADLOCK_TIMEOUT)
+        .expect("Class order inversion should be reported");
+    assert_eq!(info.source, DeadlockSource::LockOrderViolation);
+
+    let classes = info
+        .lock_order_classes
+        .expect("Class mode should name the lock classes");
+    assert_eq!(classes.len(), info.lock_order_cycle.unwrap().len());
+    assert!(
+        classes
+            .iter()
+            .all(|class| class.contains("lock_class_order_violation.rs")),
+        "Classes should be the creating call sites: {classes:?}"
+    );
+    assert!(
+        rx.try_recv().is_err(),
+        "Only the inversion should be reported"
+    );
+}
@@ -0,0 +1,43 @@
+use deloxide::{Mutex, lock_many, thread};
+use std::sync::Arc;
+use std::time::Duration;
+mod common;
+use common::{NO_DEADLOCK_TIMEOUT, assert_no_deadlock, start_detector};
+
+#[test]
+fn test_lock_many_dining_philosophers() {
+    let harness = start_detector();
+
+    let num_philosophers = 5;
+    let meals = 50;
+
+    let forks: Vec<Arc<Mutex<usize>>> = (0..num_philosophers)
+        .map(|_| Arc::new(Mutex::new(0)))
+        .collect();
+
+    // Taking the left fork and then the right one deadlocks (and, with the
+    // lock order graph, closes a cycle). Taking both at once does neither.
+    let handles: Vec<_> = (0..num_philosophers)
+        .map(|i| {
+            let left_fork = Arc::clone(&forks[i]);
+            let right_fork = Arc::clone(&forks[(i + 1) % num_philosophers]);
+            thread::spawn(move || {
+                for _ in 0..meals {
+                    let mut guards = lock_many(&[&*left_fork, &*right_fork]);
+                    *guards[0] += 1;
+                    *guards[1] += 1000;
+                    thread::sleep(Duration::from_micros(100));
+                }
+            })
+        })
+        .collect();
+
+    for handle in handles {
+        handle.join().unwrap();
+    }
+
+    // The guards come back in the order the forks were passed in
+    assert!(forks.iter().all(|fork| *fork.lock() == 1001 * meals));
+
+    assert_no_deadlock(&harness, NO_DEADLOCK_TIMEOUT);
+}
@@ -0,0 +1,48 @@
+#![cfg(feature = "lock-order-graph")]
+
+use deloxide::{DeadlockSource, Deloxide, Mutex, report_repeats, report_stats};
+use std::sync::Arc;
+use std::thread;
+mod common;
+use common::{DEADLOCK_TIMEOUT, NO_DEADLOCK_TIMEOUT, expect_deadlock, start_detector_with};
+
+const WORKERS: usize = 8;
+
+#[test]
+fn test_lock_order_violation_repeats_coalesced() {
+    let harness = start_detector_with(Deloxide::new().with_lock_order_checking());
+
+    let a = Arc::new(Mutex::new("A"));
+    let b = Arc::new(Mutex::new("B"));
+    {
+        let _a = a.lock();
+        let _b = b.lock();
+    }
+
+    // Every worker of the pool repeats the same inversion
+    let workers: Vec<_> = (0..WORKERS)
+        .map(|_| {
+            let (a, b) = (Arc::clone(&a), Arc::clone(&b));
+            thread::spawn(move || {
+                let _b = b.lock();
+                let _a = a.lock();
+            })
+        })
+        .collect();
+    for worker in workers {
+        worker.join().unwrap();
+    }
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    assert_eq!(info.source, DeadlockSource::LockOrderViolation);
+    assert!(
+        harness.rx.recv_timeout(NO_DEADLOCK_TIMEOUT).is_err(),
+        "Repeats of the inversion should not reach the callback"
+    );
+
+    let stats = report_stats();
+    assert_eq!(stats.delivered, 1);
+    assert_eq!(stats.coalesced, WORKERS as u64 - 1);
+    assert_eq!(stats.dropped, 0);
+    assert_eq!(report_repeats(info.fingerprint()), WORKERS as u64 - 1);
+}
@@ -0,0 +1,70 @@
+#![cfg(feature = "lock-stats")]
+
+use deloxide::{Deloxide, Mutex, thread};
+use std::sync::{Arc, mpsc};
+use std::time::Duration;
+mod common;
+use common::{NO_DEADLOCK_TIMEOUT, assert_no_deadlock, start_detector_with};
+
+fn new_mutex() -> Mutex<u32> {
+    // Every mutex created here shares this call site's class
+    Mutex::new(0)
+}
+
+#[test]
+fn test_contention_is_counted_per_lock_and_class() {
+    let harness = start_detector_with(Deloxide::new().with_lock_stats());
+
+    let hot = Arc::new(new_mutex());
+    let cold = new_mutex();
+    let (held_tx, held_rx) = mpsc::channel();
+
+    // One thread holds the hot lock while the main thread blocks on it
+    let holder = {
+        let hot = Arc::clone(&hot);
+        thread::spawn(move || {
+            let _guard = hot.lock();
+            held_tx.send(()).unwrap();
+            std::thread::sleep(Duration::from_millis(50));
+        })
+    };
+    held_rx.recv().unwrap();
+    *hot.lock() += 1;
+    holder.join().unwrap();
+    *cold.lock() += 1;
+
+    let stats = deloxide::lock_stats();
+    assert_eq!(stats[0].lock_id, hot.id(), "hot lock should rank first");
+    let hot_stats = &stats[0].stats;
+    assert_eq!(hot_stats.acquisitions, 2);
+    assert!(hot_stats.contended >= 1);
+    assert!(hot_stats.max_wait >= Duration::from_millis(30));
+    assert!(hot_stats.max_hold >= Duration::from_millis(30));
+    assert_eq!(
+        hot_stats.wait_histogram.iter().sum::<u64>(),
+        hot_stats.contended
+    );
+    assert!(hot_stats.wait_quantile(1.0) >= Duration::from_millis(30));
+    assert!(stats[0].class.as_deref().unwrap().contains("lock_stats.rs"));
+
+    let cold_id = cold.id();
+    let cold_stats = stats.iter().find(|lock| lock.lock_id == cold_id).unwrap();
+    assert_eq!(cold_stats.stats.acquisitions, 1);
+    assert!(deloxide::contention_report(1).contains(&hot.id().to_string()));
+
+    // A destroyed lock leaves the per-lock view but stays in its class
+    drop(cold);
+    assert!(
+        deloxide::lock_stats()
+            .iter()
+            .all(|lock| lock.lock_id != cold_id)
+    );
+    let classes = deloxide::lock_class_stats();
+    let class = classes
+        .iter()
+        .find(|class| class.class.contains("lock_stats.rs"))
+        .unwrap();
+    assert_eq!(class.stats.acquisitions, 3);
+
+    assert_no_deadlock(&harness, NO_DEADLOCK_TIMEOUT);
+}
@@ -0,0 +1,65 @@
+use deloxide::{Deloxide, Mutex, thread};
+use std::sync::{Arc, Barrier};
+use std::time::Duration;
+mod common;
+use common::{DEADLOCK_TIMEOUT, assert_no_deadlock, expect_deadlock, start_detector_with};
+
+fn spawn_cycle(first: Arc<Mutex<i32>>, second: Arc<Mutex<i32>>) {
+    for (a, b) in [(Arc::clone(&first), Arc::clone(&second)), (second, first)] {
+        thread::spawn(move || {
+            let _guard_a = a.lock();
+            thread::sleep(Duration::from_millis(100));
+            let _guard_b = b.lock();
+        });
+    }
+}
+
+#[test]
+fn test_runtime_switch_hands_over_held_locks() {
+    let harness = start_detector_with(Deloxide::new().with_detection_off());
+    assert!(!deloxide::is_detection_enabled());
+
+    // A deadlock formed while detection is off goes unreported
+    spawn_cycle(Arc::new(Mutex::new(0)), Arc::new(Mutex::new(0)));
+    assert_no_deadlock(&harness, Duration::from_millis(400));
+
+    // Taken while detection is off and still held once it is switched on
+    let held = Arc::new(Mutex::new(0));
+    let other = Arc::new(Mutex::new(0));
+    let switched = Arc::new(Barrier::new(3));
+    {
+        let (held, other, switched) =
+            (Arc::clone(&held), Arc::clone(&other), Arc::clone(&switched));
+        thread::spawn(move || {
+            let _guard_held = held.lock();
+            switched.wait();
+            thread::sleep(Duration::from_millis(100));
+            let _guard_other = other.lock();
+        });
+    }
+    {
+        let (held, other, switched) =
+            (Arc::clone(&held), Arc::clone(&other), Arc::clone(&switched));
+        thread::spawn(move || {
+            switched.wait();
+            let _guard_other = other.lock();
+            thread::sleep(Duration::from_millis(100));
+            let _guard_held = held.lock();
+        });
+    }
+
+    thread::sleep(Duration::from_millis(50));
+    deloxide::enable_detection();
+    assert!(deloxide::is_detection_enabled());
+    switched.wait();
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    assert_eq!(info.thread_cycle.len(), 2);
+    let mut locks: Vec<_> = info
+        .thread_waiting_for_locks
+        .iter()
+        .map(|&(_, lock)| lock)
+        .collect();
+    locks.sort_unstable();
+    assert_eq!(locks, vec![held.id(), other.id()]);
+}
@@ -0,0 +1,69 @@
+use deloxide::{Deloxide, Mutex, Sampling, thread};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+mod common;
+use common::{DEADLOCK_TIMEOUT, assert_no_deadlock, expect_deadlock, start_detector_with};
+
+const WINDOW: Duration = Duration::from_secs(1);
+
+fn sleep_until(deadline: Instant) {
+    if let Some(remaining) = deadline.checked_duration_since(Instant::now()) {
+        thread::sleep(remaining);
+    }
+}
+
+fn spawn_cycle(first: Arc<Mutex<i32>>, second: Arc<Mutex<i32>>) {
+    for (a, b) in [(Arc::clone(&first), Arc::clone(&second)), (second, first)] {
+        thread::spawn(move || {
+            let _guard_a = a.lock();
+            thread::sleep(Duration::from_millis(100));
+            let _guard_b = b.lock();
+        });
+    }
+}
+
+#[test]
+fn test_window_sampling_skips_gaps_and_leaves_no_ghost_state() {
+    // Tracked during [0s, 1s), untracked during [1s, 2s), tracked again after
+    let harness = start_detector_with(Deloxide::new().with_sampling(Sampling::Windows {
+        on: WINDOW,
+        off: WINDOW,
+    }));
+    let start = Instant::now();
+
+    // Acquired while sampled, released while unsampled. Contention sends
+    // the acquisition through the detector, which records this thread as owner.
+    let held = Arc::new(Mutex::new(0));
+    let holder = {
+        let held = Arc::clone(&held);
+        thread::spawn(move || {
+            let _guard = held.lock();
+            thread::sleep(Duration::from_millis(100));
+        })
+    };
+    thread::sleep(Duration::from_millis(20));
+    let guard = held.lock();
+    holder.join().unwrap();
+
+    // A deadlock formed entirely in the gap goes unreported
+    sleep_until(start + WINDOW + Duration::from_millis(200));
+    drop(guard);
+    spawn_cycle(Arc::new(Mutex::new(0)), Arc::new(Mutex::new(0)));
+    assert_no_deadlock(&harness, Duration::from_millis(400));
+
+    // Back in a window, the released lock must not still look owned by
+    // this thread, or the new cycle through it would be hidden
+    sleep_until(start + 2 * WINDOW + Duration::from_millis(200));
+    let other = Arc::new(Mutex::new(0));
+    spawn_cycle(Arc::clone(&held), Arc::clone(&other));
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    assert_eq!(info.thread_cycle.len(), 2);
+    let mut locks: Vec<_> = info
+        .thread_waiting_for_locks
+        .iter()
+        .map(|&(_, lock)| lock)
+        .collect();
+    locks.sort_unstable();
+    assert_eq!(locks, vec![held.id(), other.id()]);
+}
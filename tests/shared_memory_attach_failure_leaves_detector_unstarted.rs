@@ -0,0 +1,32 @@
+#![cfg(unix)]
+
+use deloxide::{Deloxide, Mutex, thread};
+use std::sync::Arc;
+use std::time::Duration;
+mod common;
+use common::{DEADLOCK_TIMEOUT, expect_deadlock, start_detector};
+
+#[test]
+fn test_shared_memory_attach_failure_leaves_detector_unstarted() {
+    // The region cannot be created, so this start must not take effect
+    let failed = Deloxide::new()
+        .with_shared_memory("/nonexistent-deloxide-dir/region")
+        .callback(|_| panic!("callback of a failed start was installed"))
+        .start();
+    assert!(failed.is_err());
+
+    let harness = start_detector();
+
+    let first = Arc::new(Mutex::new(0));
+    let second = Arc::new(Mutex::new(0));
+    for (a, b) in [(Arc::clone(&first), Arc::clone(&second)), (second, first)] {
+        thread::spawn(move || {
+            let _guard_a = a.lock();
+            thread::sleep(Duration::from_millis(100));
+            let _guard_b = b.lock();
+        });
+    }
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    assert_eq!(info.thread_cycle.len(), 2);
+}
@@ -0,0 +1,52 @@
+#![cfg(unix)]
+
+use deloxide::{Deloxide, shared};
+use std::env;
+use std::process::{self, Command};
+mod common;
+use common::{DEADLOCK_TIMEOUT, expect_deadlock, start_detector_with};
+
+/// Set in the child process to the path of the region
+const CHILD_REGION_ENV: &str = "DELOXIDE_SHARED_TEST_REGION";
+
+const LOCK_A: u64 = 1;
+const LOCK_B: u64 = 2;
+
+/// Hold one lock and wait for the other, and expect the cycle through the
+/// other process to be reported here as well
+fn hold_and_wait(region: &str, held: u64, wanted: u64) -> Vec<deloxide::ThreadId> {
+    let harness = start_detector_with(Deloxide::new().with_shared_memory(region));
+    assert!(shared::acquired(held));
+    assert!(shared::attempt(wanted));
+    expect_deadlock(&harness, DEADLOCK_TIMEOUT).thread_cycle
+}
+
+#[test]
+fn test_shared_memory_cross_process_deadlock() {
+    if let Ok(region) = env::var(CHILD_REGION_ENV) {
+        hold_and_wait(&region, LOCK_B, LOCK_A);
+        return;
+    }
+
+    let region = env::temp_dir().join(format!("deloxide_shared_{}.region", process::id()));
+    let region = region.to_str().unwrap().to_string();
+    let mut child = Command::new(env::current_exe().unwrap())
+        .args(["test_shared_memory_cross_process_deadlock", "--exact"])
+        .env(CHILD_REGION_ENV, &region)
+        .spawn()
+        .expect("Failed to start the other process");
+
+    let cycle = hold_and_wait(&region, LOCK_A, LOCK_B);
+    let status = child.wait().unwrap();
+    let _ = std::fs::remove_file(&region);
+
+    // Global thread IDs carry the process ID in their upper half
+    let pids: Vec<u64> = cycle.iter().map(|&thread| thread as u64 >> 32).collect();
+    assert_eq!(cycle.len(), 2);
+    assert!(pids.contains(&u64::from(process::id())));
+    assert!(pids.contains(&u64::from(child.id())));
+    assert!(
+        status.success(),
+        "the other process did not see the deadlock"
+    );
+}
@@ -0,0 +1,21 @@
+#![cfg(unix)]
+
+use deloxide::shared;
+use std::env;
+use std::process;
+
+#[test]
+fn test_shared_memory_publish_before_attach() {
+    // Nothing is published before the process attaches
+    assert!(!shared::attempt(1));
+
+    let region = env::temp_dir().join(format!("deloxide_publish_{}.region", process::id()));
+    let attached = shared::attach(&region);
+    let _ = std::fs::remove_file(&region);
+    attached.unwrap();
+
+    // The same thread gets a slot once the region is there
+    assert!(shared::attempt(1));
+    assert!(shared::acquired(1));
+    assert!(shared::released(1));
+}
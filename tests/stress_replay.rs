@@ -0,0 +1,51 @@
+#![cfg(feature = "stress-test")]
+
+use deloxide::{Deloxide, Mutex, StressMode, StressSchedule, thread};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+mod common;
+use common::{NO_DEADLOCK_TIMEOUT, assert_no_deadlock, start_detector_with};
+
+const REPLAYED_DELAY: Duration = Duration::from_millis(300);
+
+#[test]
+fn test_replayed_delays_are_applied_and_logged() {
+    // Delay the first acquisition of every thread
+    let mut schedule = StressSchedule {
+        mode: StressMode::Pct,
+        seed: 42,
+        ..StressSchedule::default()
+    };
+    for thread_id in 1..=64 {
+        schedule
+            .delays
+            .insert(thread_id, vec![(0, REPLAYED_DELAY.as_micros() as u64)]);
+    }
+    let harness = start_detector_with(Deloxide::new().with_stress_replay(schedule));
+    assert_eq!(deloxide::stress_seed(), 42);
+
+    // Under stress testing every acquisition is a decision point, so each
+    // thread waits before its first lock
+    let lock = Arc::new(Mutex::new(0));
+    let other = {
+        let lock = Arc::clone(&lock);
+        thread::spawn(move || *lock.lock() += 1)
+    };
+    let start = Instant::now();
+    *lock.lock() += 1;
+    assert!(start.elapsed() >= REPLAYED_DELAY);
+    other.join().unwrap();
+
+    let recorded = deloxide::stress_schedule();
+    assert_eq!(recorded.mode, StressMode::Pct);
+    assert_eq!(recorded.delays.len(), 2);
+    assert!(
+        recorded
+            .delays
+            .values()
+            .all(|delays| *delays == [(0, REPLAYED_DELAY.as_micros() as u64)])
+    );
+    assert_eq!(recorded.to_string().parse::<StressSchedule>(), Ok(recorded));
+
+    assert_no_deadlock(&harness, NO_DEADLOCK_TIMEOUT);
+}
@@ -0,0 +1,45 @@
+use deloxide::{Mutex, thread};
+use std::sync::{Arc, Barrier};
+use std::time::Duration;
+mod common;
+use common::{
+    DEADLOCK_TIMEOUT, NO_DEADLOCK_TIMEOUT, assert_no_deadlock, expect_deadlock, start_detector,
+};
+
+#[test]
+fn test_timed_lock_deadlock_reported_self_wait_not() {
+    let harness = start_detector();
+
+    // Held by this thread: the attempt times out instead of waiting for itself
+    let mutex = Mutex::new(0);
+    let guard = mutex.lock();
+    assert!(mutex.try_lock_for(Duration::from_millis(50)).is_none());
+    assert_no_deadlock(&harness, NO_DEADLOCK_TIMEOUT);
+    drop(guard);
+
+    // Timed waiters that wait for each other are reported, then give up
+    let a = Arc::new(Mutex::new(0));
+    let b = Arc::new(Mutex::new(0));
+    let barrier = Arc::new(Barrier::new(2));
+    let waiters: Vec<_> = [(Arc::clone(&a), Arc::clone(&b)), (b, a)]
+        .into_iter()
+        .map(|(first, second)| {
+            let barrier = Arc::clone(&barrier);
+            thread::spawn(move || {
+                let _first = first.lock();
+                barrier.wait();
+                second.try_lock_for(Duration::from_millis(1500)).is_none()
+            })
+        })
+        .collect();
+
+    let info = expect_deadlock(&harness, DEADLOCK_TIMEOUT);
+    assert_eq!(info.thread_cycle.len(), 2);
+    // Once one of them times out, the other may take its lock
+    let gave_up = waiters
+        .into_iter()
+        .map(|waiter| waiter.join().unwrap())
+        .filter(|&gave_up| gave_up)
+        .count();
+    assert!(gave_up >= 1);
+}
@@ -0,0 +1,51 @@
+use deloxide::{Mutex, RwLock, thread};
+use std::sync::{Arc, Barrier};
+use std::time::Duration;
+mod common;
+use common::{NO_DEADLOCK_TIMEOUT, assert_no_deadlock, start_detector};
+
+#[test]
+fn test_timed_lock_no_stale_edges() {
+    let harness = start_detector();
+
+    let first = Arc::new(Mutex::new(()));
+    let second = Arc::new(Mutex::new(()));
+    let rwlock = Arc::new(RwLock::new(()));
+    let barrier = Arc::new(Barrier::new(2));
+
+    let holder = {
+        let (first, second, rwlock, barrier) = (
+            Arc::clone(&first),
+            Arc::clone(&second),
+            Arc::clone(&rwlock),
+            Arc::clone(&barrier),
+        );
+        thread::spawn(move || {
+            let _first = first.lock();
+            let _write = rwlock.write();
+            barrier.wait();
+            // Wait for the other thread to give up on both locks
+            barrier.wait();
+
+            // Blocks on the other thread. Had its attempts left wait-for
+            // edges behind, this would close a false cycle.
+            drop(second.lock());
+        })
+    };
+
+    let second_guard = second.lock();
+    barrier.wait();
+    assert!(first.try_lock().is_none());
+    assert!(rwlock.try_read().is_none());
+    assert!(rwlock.try_write().is_none());
+    assert!(first.try_lock_for(Duration::from_millis(50)).is_none());
+    barrier.wait();
+
+    // Let the holder queue up behind us
+    thread::sleep(Duration::from_millis(100));
+    drop(second_guard);
+    holder.join().unwrap();
+
+    assert!(first.try_lock_for(Duration::from_millis(50)).is_some());
+    assert_no_deadlock(&harness, NO_DEADLOCK_TIMEOUT);
+}